@@ -0,0 +1,126 @@
+#include "ArtifactStore.hpp"
+#include "AtomicFile.hpp"
+#include "BinaryGraphFormat.hpp"
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace dijkstra {
+namespace data {
+
+using artifact::ArtifactEntry;
+using artifact::ArtifactFileHeader;
+
+void ArtifactWriter::addRaw(const std::string& name, uint32_t version, uint32_t elementSize,
+                            const void* data, uint64_t length) {
+    if (name.empty() || name.size() > artifact::MAX_NAME_LENGTH) {
+        throw std::invalid_argument("Invalid artifact name: " + name);
+    }
+    artifacts_.push_back({name, version, elementSize, data, length});
+}
+
+bool ArtifactWriter::write(const std::string& filePath) const {
+    std::vector<ArtifactEntry> entries;
+    entries.reserve(artifacts_.size());
+    uint64_t offset = binary::alignOffset(sizeof(ArtifactFileHeader) + artifacts_.size() * sizeof(ArtifactEntry));
+    for (const auto& pending : artifacts_) {
+        ArtifactEntry entry = {};
+        std::memcpy(entry.name, pending.name.data(), pending.name.size());
+        entry.version = pending.version;
+        entry.elementSize = pending.elementSize;
+        entry.offset = offset;
+        entry.length = pending.length;
+        entries.push_back(entry);
+        offset = binary::alignOffset(offset + pending.length);
+    }
+    
+    ArtifactFileHeader header = {};
+    std::memcpy(header.magic, artifact::ARTIFACT_MAGIC, sizeof(header.magic));
+    header.endianTag = binary::ENDIAN_TAG;
+    header.versionMajor = artifact::ARTIFACT_FORMAT_MAJOR;
+    header.versionMinor = artifact::ARTIFACT_FORMAT_MINOR;
+    header.fileSize = offset;
+    header.graphHash = graphHash_;
+    header.artifactCount = static_cast<uint32_t>(entries.size());
+    
+    // Replaced as a whole, so processes that still map the previous version
+    // keep a consistent view of it
+    AtomicFile file(filePath);
+    if (!file.isOpen()) {
+        return false;
+    }
+    
+    file.write(&header, sizeof(header));
+    file.write(entries.data(), entries.size() * sizeof(ArtifactEntry));
+    
+    static const char padding[binary::SECTION_ALIGNMENT] = {};
+    uint64_t position = sizeof(ArtifactFileHeader) + entries.size() * sizeof(ArtifactEntry);
+    for (size_t i = 0; i < artifacts_.size(); ++i) {
+        file.write(padding, entries[i].offset - position);
+        if (artifacts_[i].length > 0) {
+            file.write(artifacts_[i].data, artifacts_[i].length);
+        }
+        position = entries[i].offset + artifacts_[i].length;
+    }
+    file.write(padding, header.fileSize - position);
+    return file.commit();
+}
+
+std::shared_ptr<const ArtifactReader> ArtifactReader::open(const std::string& filePath, uint64_t graphHash) {
+    std::error_code ec;
+    if (!std::filesystem::exists(filePath, ec)) {
+        return nullptr;
+    }
+    
+    auto reader = std::shared_ptr<ArtifactReader>(new ArtifactReader());
+    try {
+        reader->file_ = std::make_unique<MappedFile>(filePath);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+    
+    const MappedFile& file = *reader->file_;
+    ArtifactFileHeader header;
+    if (file.size() < sizeof(header)) {
+        return nullptr;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    
+    if (std::memcmp(header.magic, artifact::ARTIFACT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.endianTag != binary::ENDIAN_TAG ||
+        header.versionMajor != artifact::ARTIFACT_FORMAT_MAJOR ||
+        header.fileSize > file.size() ||
+        header.graphHash != graphHash) {
+        return nullptr;
+    }
+    
+    uint64_t tableEnd = sizeof(header) + uint64_t(header.artifactCount) * sizeof(ArtifactEntry);
+    if (tableEnd > file.size()) {
+        return nullptr;
+    }
+    reader->entries_.resize(header.artifactCount);
+    std::memcpy(reader->entries_.data(), file.data() + sizeof(header),
+                reader->entries_.size() * sizeof(ArtifactEntry));
+    
+    return reader;
+}
+
+const void* ArtifactReader::findRaw(const std::string& name, uint32_t version, uint32_t elementSize,
+                                    uint64_t length, size_t alignment) const {
+    for (const auto& entry : entries_) {
+        if (std::strncmp(entry.name, name.c_str(), sizeof(entry.name)) != 0) {
+            continue;
+        }
+        
+        if (entry.version != version || entry.elementSize != elementSize || entry.length != length ||
+            entry.length > file_->size() || entry.offset > file_->size() - entry.length ||
+            entry.offset % alignment != 0) {
+            return nullptr; // Stale or malformed: the caller rebuilds it
+        }
+        return file_->data() + entry.offset;
+    }
+    return nullptr;
+}
+
+} // namespace data
+} // namespace dijkstra
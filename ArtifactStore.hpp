@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * Preprocessing artifact container stored next to a binary graph file.
+ * 
+ * Layout (native byte order, identified by the endian tag):
+ * 
+ *   ArtifactFileHeader            magic, version, graph content hash
+ *   ArtifactEntry[artifactCount]  name, artifact version, element size, location
+ *   payloads, each on a 64-byte boundary
+ * 
+ * Each artifact is a flat array tagged with the version of the code that
+ * built it. A reader ignores the whole file if the graph hash does not match
+ * and ignores individual artifacts whose version or size is unexpected, so
+ * callers can rebuild just what is stale.
+ */
+namespace artifact {
+
+constexpr char ARTIFACT_MAGIC[8] = {'D', 'J', 'K', 'A', 'R', 'T', 'F', 'X'};
+constexpr uint16_t ARTIFACT_FORMAT_MAJOR = 1;
+constexpr uint16_t ARTIFACT_FORMAT_MINOR = 0;
+constexpr size_t MAX_NAME_LENGTH = 23;
+
+struct ArtifactFileHeader {
+    char magic[8];
+    uint32_t endianTag;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint64_t fileSize;
+    uint64_t graphHash;      ///< Content hash of the graph the artifacts were built from
+    uint32_t artifactCount;
+    uint32_t reserved;
+};
+
+struct ArtifactEntry {
+    char name[MAX_NAME_LENGTH + 1]; ///< NUL-terminated artifact name
+    uint32_t version;               ///< Version of the algorithm that produced the artifact
+    uint32_t elementSize;
+    uint64_t offset;
+    uint64_t length;
+};
+
+static_assert(sizeof(ArtifactFileHeader) == 40, "ArtifactFileHeader layout must not depend on the compiler");
+static_assert(sizeof(ArtifactEntry) == 48, "ArtifactEntry layout must not depend on the compiler");
+
+} // namespace artifact
+
+/**
+ * @class ArtifactWriter
+ * @brief Collects artifact arrays and writes them into a container file.
+ * 
+ * Only pointers are recorded; the arrays must stay alive until write() returns.
+ */
+class ArtifactWriter {
+public:
+    /**
+     * @brief Constructs a writer for artifacts of a given graph.
+     * @param graphHash Content hash of the graph the artifacts belong to
+     */
+    explicit ArtifactWriter(uint64_t graphHash) : graphHash_(graphHash) {}
+    
+    /**
+     * @brief Add an artifact array.
+     * @param name Artifact name (at most 23 characters)
+     * @param version Version of the algorithm that produced it
+     * @param data First element
+     * @param count Number of elements
+     */
+    template <typename T>
+    void add(const std::string& name, uint32_t version, const T* data, size_t count) {
+        addRaw(name, version, sizeof(T), data, count * sizeof(T));
+    }
+    
+    /**
+     * @brief Write the container, replacing any existing file atomically.
+     * @param filePath Path to the output file
+     * @return true if successful, false otherwise
+     */
+    bool write(const std::string& filePath) const;
+
+private:
+    struct Pending {
+        std::string name;
+        uint32_t version;
+        uint32_t elementSize;
+        const void* data;
+        uint64_t length;
+    };
+    
+    uint64_t graphHash_;
+    std::vector<Pending> artifacts_;
+    
+    void addRaw(const std::string& name, uint32_t version, uint32_t elementSize,
+                const void* data, uint64_t length);
+};
+
+/**
+ * @class ArtifactReader
+ * @brief Read-only mapping of an artifact container.
+ */
+class ArtifactReader {
+public:
+    /**
+     * @brief Map a container if it exists and matches the expected graph.
+     * @param filePath Path to the container
+     * @param graphHash Content hash of the graph in use
+     * @return The reader, or nullptr if the file is missing, malformed, or was
+     *         built from a different graph
+     */
+    static std::shared_ptr<const ArtifactReader> open(const std::string& filePath, uint64_t graphHash);
+    
+    /**
+     * @brief Look up an artifact array.
+     * @param name Artifact name
+     * @param version Expected artifact version
+     * @param count Expected number of elements
+     * @return Pointer into the mapping, or nullptr if the artifact is absent,
+     *         has another version, or has the wrong size
+     */
+    template <typename T>
+    const T* find(const std::string& name, uint32_t version, size_t count) const {
+        return static_cast<const T*>(findRaw(name, version, sizeof(T), count * sizeof(T), alignof(T)));
+    }
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    std::vector<artifact::ArtifactEntry> entries_;
+    
+    const void* findRaw(const std::string& name, uint32_t version, uint32_t elementSize,
+                        uint64_t length, size_t alignment) const;
+};
+
+} // namespace data
+} // namespace dijkstra
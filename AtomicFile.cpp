@@ -0,0 +1,137 @@
+#include "AtomicFile.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+constexpr char TEMP_SUFFIX[] = ".tmp";
+
+std::string parentDirectory(const std::string& path) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    return parent.empty() ? std::string(".") : parent.string();
+}
+
+} // namespace
+
+#if defined(__unix__) || defined(__APPLE__)
+
+AtomicFile::AtomicFile(std::string path) : path_(std::move(path)) {
+    std::string pattern = path_ + ".XXXXXX" + TEMP_SUFFIX;
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    fd_ = ::mkstemps(name.data(), static_cast<int>(sizeof(TEMP_SUFFIX) - 1));
+    if (fd_ >= 0) {
+        tempPath_ = name.data();
+        ::fchmod(fd_, 0644); // mkstemps creates owner-only files
+    }
+}
+
+AtomicFile::~AtomicFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    if (!committed_ && !tempPath_.empty()) {
+        ::unlink(tempPath_.c_str());
+    }
+}
+
+bool AtomicFile::isOpen() const {
+    return fd_ >= 0;
+}
+
+void AtomicFile::write(const void* data, size_t length) {
+    const char* bytes = static_cast<const char*>(data);
+    while (good_ && length > 0) {
+        ssize_t written = ::write(fd_, bytes, length);
+        if (written < 0) {
+            good_ = errno == EINTR;
+            continue;
+        }
+        bytes += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+bool AtomicFile::commit() {
+    if (fd_ < 0 || !good_ || ::fsync(fd_) != 0) {
+        return false;
+    }
+    good_ = ::close(fd_) == 0;
+    fd_ = -1;
+    if (!good_ || ::rename(tempPath_.c_str(), path_.c_str()) != 0) {
+        return false;
+    }
+    committed_ = true;
+    return syncDirectory(parentDirectory(path_));
+}
+
+bool AtomicFile::syncDirectory(const std::string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+#else
+
+AtomicFile::AtomicFile(std::string path) : path_(std::move(path)) {
+    static std::atomic<uint64_t> counter{0};
+    tempPath_ = path_ + "." +
+                std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "-" +
+                std::to_string(counter.fetch_add(1)) + TEMP_SUFFIX;
+    stream_.open(tempPath_, std::ios::binary | std::ios::trunc);
+}
+
+AtomicFile::~AtomicFile() {
+    stream_.close();
+    if (!committed_) {
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+    }
+}
+
+bool AtomicFile::isOpen() const {
+    return stream_.is_open();
+}
+
+void AtomicFile::write(const void* data, size_t length) {
+    stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+}
+
+bool AtomicFile::commit() {
+    if (!stream_.is_open() || !stream_.flush()) {
+        return false;
+    }
+    stream_.close();
+    std::error_code ec;
+    std::filesystem::rename(tempPath_, path_, ec);
+    committed_ = !ec;
+    return committed_;
+}
+
+bool AtomicFile::syncDirectory(const std::string&) {
+    return true;
+}
+
+#endif
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class AtomicFile
+ * @brief Replaces a file as a whole: writes go to a temporary file that commit() renames over it.
+ * 
+ * The temporary file has a unique name in the target's directory, ending in
+ * ".tmp", so concurrent writers of the same path never share one; the last
+ * rename wins. Readers, including processes that still map the previous
+ * version, see either the old or the new contents. commit() syncs the data
+ * before the rename and the directory after it, so once it returns the new
+ * file survives a crash. A file that is not committed is removed.
+ */
+class AtomicFile {
+public:
+    /**
+     * @brief Creates the temporary file; check isOpen() before writing.
+     * @param path Path of the file to replace
+     */
+    explicit AtomicFile(std::string path);
+    
+    /**
+     * @brief Removes the temporary file unless it was committed.
+     */
+    ~AtomicFile();
+    
+    AtomicFile(const AtomicFile&) = delete;
+    AtomicFile& operator=(const AtomicFile&) = delete;
+    
+    bool isOpen() const;
+    const std::string& getPath() const { return path_; }
+    
+    /**
+     * @brief Append bytes; a failure is reported by commit().
+     */
+    void write(const void* data, size_t length);
+    
+    /**
+     * @brief Sync the temporary file, rename it over the target and sync the directory.
+     * @return true if the target now holds everything written
+     */
+    bool commit();
+    
+    /**
+     * @brief Make the creation, rename or removal of a directory's entries durable.
+     * @param directory Directory to sync
+     * @return true on success (always on platforms without directory sync)
+     */
+    static bool syncDirectory(const std::string& directory);
+
+private:
+    std::string path_;
+    std::string tempPath_;
+    int fd_ = -1;
+    std::ofstream stream_; ///< Used instead of fd_ where POSIX files are unavailable
+    bool good_ = true;
+    bool committed_ = false;
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace dijkstra {
+namespace server {
+namespace batch {
+
+/**
+ * Layout of a binary batch result stream (all integers in the writer's native
+ * byte order, identified by the endian tag):
+ * 
+ *   StreamHeader
+ *   for every query: RecordHeader, then uint32_t[pathLength] node indices
+ * 
+ * Node indices refer to the graph the batch was run against, so a reader needs
+ * the same graph file to turn them back into node IDs. Records follow input
+ * order only if the batch was run with ordered output; the line number tells
+ * them apart either way.
+ */
+
+constexpr char BATCH_MAGIC[8] = {'D', 'J', 'K', 'B', 'A', 'T', 'C', 'H'};
+constexpr uint32_t ENDIAN_TAG = 0x01020304;
+constexpr uint16_t BATCH_FORMAT_MAJOR = 1;
+constexpr uint16_t BATCH_FORMAT_MINOR = 1; ///< 1.1 added Status::TIMED_OUT
+
+/**
+ * @enum Status
+ * @brief Outcome of one query.
+ */
+enum class Status : uint8_t {
+    FOUND = 0,     ///< Path found; totals and path are filled in
+    NOT_FOUND = 1, ///< Both nodes exist but no path connects them
+    INVALID = 2,   ///< Malformed line, unknown node or unknown mode
+    TIMED_OUT = 3  ///< The search ran past the query timeout (since 1.1)
+};
+
+/**
+ * @struct StreamHeader
+ * @brief Fixed-size header at the start of a binary batch stream.
+ */
+struct StreamHeader {
+    char magic[8];
+    uint32_t endianTag;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint64_t nodeCount; ///< Node count of the graph, as a sanity check for readers
+};
+
+/**
+ * @struct RecordHeader
+ * @brief Fixed-size part of the record for one query.
+ */
+struct RecordHeader {
+    uint64_t line;          ///< 1-based input line number
+    double totalDistance;
+    double totalTime;
+    double totalCost;
+    uint32_t pathLength;    ///< Number of node indices that follow
+    uint8_t status;         ///< Status
+    uint8_t mode;           ///< graph::PathFinder::OptimizationMode
+    uint16_t reserved;
+};
+
+static_assert(sizeof(StreamHeader) == 24, "StreamHeader layout must not depend on the compiler");
+static_assert(sizeof(RecordHeader) == 40, "RecordHeader layout must not depend on the compiler");
+
+} // namespace batch
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,406 @@
+#include "BatchRunner.hpp"
+#include "BatchFormat.hpp"
+#include "../data/JsonHandler.hpp"
+#include "../data/JsonWriter.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @brief A run of whole input lines and, once answered, its output.
+ */
+struct BatchRunner::Block {
+    uint64_t sequence = 0;
+    uint64_t firstLine = 0; ///< Line number of the first line in text
+    std::string text;
+    std::string output;
+};
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+
+static_assert(sizeof(Index) == sizeof(uint32_t), "Binary records store node indices as uint32_t");
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Start timing a query, unless its search statistics time it already.
+ */
+std::chrono::steady_clock::time_point startTimer() {
+    return graph::SearchStats::ENABLED ? std::chrono::steady_clock::time_point() : std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Record a route query timed from startTimer().
+ */
+void recordQuery(QueryMetrics::Shard& metrics, graph::PathFinder::OptimizationMode mode,
+                 const graph::PathResult& result, std::chrono::steady_clock::time_point started,
+                 const graph::SearchStats& stats) {
+    uint64_t elapsed = stats.elapsedNanoseconds;
+    if (!graph::SearchStats::ENABLED) {
+        elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started).count());
+    }
+    metrics.record(QueryMetrics::QueryType::ROUTE, mode,
+                   result.isInterrupted() ? QueryMetrics::Result::TIMED_OUT : QueryMetrics::Result::ANSWERED,
+                   elapsed, stats.nodesSettled);
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(const graph::CompactGraph& graph, unsigned threads)
+    : graph_(graph), threads_(util::resolveThreadCount(threads)) {
+}
+
+uint64_t BatchRunner::run(std::istream& input, std::ostream& output) {
+    queries_ = 0;
+    found_ = 0;
+    invalid_ = 0;
+    timedOut_ = 0;
+    searchStats_ = graph::SearchStats();
+    metrics_.clear();
+    
+    if (format_ == OutputFormat::BINARY) {
+        batch::StreamHeader header{};
+        std::memcpy(header.magic, batch::BATCH_MAGIC, sizeof(header.magic));
+        header.endianTag = batch::ENDIAN_TAG;
+        header.versionMajor = batch::BATCH_FORMAT_MAJOR;
+        header.versionMinor = batch::BATCH_FORMAT_MINOR;
+        header.nodeCount = graph_.getNodeCount();
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    
+    // Blocks flow reader -> pending -> worker -> (finished, if ordered) -> output
+    std::mutex mutex;
+    std::condition_variable blockReady; ///< Signals workers: a block is pending or input ended
+    std::condition_variable blockDone;  ///< Signals the reader: a block was written
+    std::deque<Block> pending;
+    size_t inFlight = 0;                ///< Blocks read but not yet written
+    bool inputDone = false;
+    bool aborted = false;
+    std::exception_ptr error;
+    
+    std::mutex outputMutex;
+    std::map<uint64_t, Block> finished;
+    uint64_t nextToWrite = 0;
+    
+    const size_t window = static_cast<size_t>(threads_) * BLOCKS_PER_THREAD;
+    
+    auto abort = [&](std::exception_ptr cause) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            error = cause;
+        }
+        aborted = true;
+        blockReady.notify_all();
+        blockDone.notify_all();
+    };
+    
+    // Write every block that may go out now; returns how many were written
+    auto writeBlock = [&](Block block) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        size_t written = 0;
+        if (!ordered_) {
+            output.write(block.output.data(), static_cast<std::streamsize>(block.output.size()));
+            ++written;
+        } else {
+            finished.emplace(block.sequence, std::move(block));
+            for (auto it = finished.begin(); it != finished.end() && it->first == nextToWrite; ) {
+                output.write(it->second.output.data(), static_cast<std::streamsize>(it->second.output.size()));
+                it = finished.erase(it);
+                ++nextToWrite;
+                ++written;
+            }
+        }
+        if (!output) {
+            throw std::runtime_error("Failed to write batch results");
+        }
+        return written;
+    };
+    
+    auto worker = [&]() {
+        try {
+            graph::CompactPathFinder finder(graph_);
+            finder.setComponentIndex(components_);
+            util::StopCondition stop;
+            stop.setTimeout(queryTimeout_);
+            finder.setStopCondition(stop);
+            QueryMetrics::Shard& metrics = metrics_.addShard();
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                blockReady.wait(lock, [&] { return !pending.empty() || inputDone || aborted; });
+                if (aborted || pending.empty()) {
+                    return;
+                }
+                Block block = std::move(pending.front());
+                pending.pop_front();
+                lock.unlock();
+                
+                graph::SearchStats stats;
+                answer(finder, block, stats, metrics);
+                size_t written = writeBlock(std::move(block));
+                
+                lock.lock();
+                inFlight -= written;
+                searchStats_ += stats;
+                blockDone.notify_one();
+            }
+        } catch (...) {
+            abort(std::current_exception());
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    workers.reserve(threads_);
+    for (unsigned t = 0; t < threads_; ++t) {
+        workers.emplace_back(worker);
+    }
+    
+    // Read blocks of whole lines; a partial last line is carried into the next block
+    try {
+        std::string carry;
+        uint64_t line = 1;
+        uint64_t sequence = 0;
+        for (bool end = false; !end; ) {
+            Block block;
+            block.text = std::move(carry);
+            carry.clear();
+            size_t kept = block.text.size();
+            block.text.resize(kept + BLOCK_BYTES);
+            input.read(block.text.data() + kept, static_cast<std::streamsize>(BLOCK_BYTES));
+            size_t got = static_cast<size_t>(input.gcount());
+            block.text.resize(kept + got);
+            end = got < BLOCK_BYTES;
+            
+            if (!end) {
+                size_t cut = block.text.rfind('\n');
+                if (cut == std::string::npos) {
+                    carry = std::move(block.text); // A line longer than a block
+                    continue;
+                }
+                carry.assign(block.text, cut + 1, std::string::npos);
+                block.text.resize(cut + 1);
+            }
+            if (block.text.empty()) {
+                break;
+            }
+            
+            block.sequence = sequence++;
+            block.firstLine = line;
+            line += static_cast<uint64_t>(std::count(block.text.begin(), block.text.end(), '\n'));
+            
+            std::unique_lock<std::mutex> lock(mutex);
+            blockDone.wait(lock, [&] { return inFlight < window || aborted; });
+            if (aborted) {
+                break;
+            }
+            ++inFlight;
+            pending.push_back(std::move(block));
+            blockReady.notify_one();
+        }
+        if (input.bad()) {
+            throw std::runtime_error("Failed to read batch queries");
+        }
+    } catch (...) {
+        abort(std::current_exception());
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputDone = true;
+    }
+    blockReady.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    output.flush();
+    if (!output) {
+        throw std::runtime_error("Failed to write batch results");
+    }
+    return getQueryCount();
+}
+
+void BatchRunner::answer(graph::CompactPathFinder& finder, Block& block, graph::SearchStats& stats,
+                         QueryMetrics::Shard& metrics) {
+    const bool binary = format_ == OutputFormat::BINARY;
+    std::ostringstream json;
+    data::JsonWriter writer(json);
+    std::vector<Index> path;
+    uint64_t queries = 0;
+    uint64_t found = 0;
+    uint64_t invalid = 0;
+    uint64_t timedOut = 0;
+    
+    const std::string_view text = block.text;
+    uint64_t lineNumber = block.firstLine;
+    for (size_t begin = 0; begin < text.size(); ++lineNumber) {
+        size_t end = std::min(text.find('\n', begin), text.size());
+        std::string_view line = text.substr(begin, end - begin);
+        begin = end + 1;
+        if (lineNumber == 1 && line.substr(0, 3) == "\xEF\xBB\xBF") {
+            line.remove_prefix(3); // UTF-8 byte order mark
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        line = trim(line);
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        
+        std::string_view fields[3];
+        size_t fieldCount = 0;
+        for (size_t start = 0; ; ) {
+            size_t comma = line.find(',', start);
+            if (fieldCount < 3) {
+                fields[fieldCount] = trim(line.substr(start, comma == std::string_view::npos ? comma : comma - start));
+            }
+            ++fieldCount;
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+        
+        Index source = graph::CompactGraph::INVALID_INDEX;
+        Index destination = graph::CompactGraph::INVALID_INDEX;
+        OptimizationMode mode = defaultMode_;
+        std::string error;
+        bool typed = false; // Whether the line is a route query in a known mode, as QueryHandler counts it
+        const auto lookupStarted = std::chrono::steady_clock::now();
+        if (fieldCount < 2 || fieldCount > 3) {
+            error = "Expected source,destination[,mode]";
+        } else {
+            source = graph_.findNode(fields[0]);
+            destination = graph_.findNode(fields[1]);
+            if (lineNumber == 1 && source == graph::CompactGraph::INVALID_INDEX &&
+                (fields[0] == "source" || fields[0] == "from")) {
+                continue; // Column names
+            }
+            if (fieldCount == 3 && !fields[2].empty() && !graph::PathFinder::parseMode(fields[2], mode)) {
+                error = "Invalid mode: " + std::string(fields[2]);
+            } else if (source == graph::CompactGraph::INVALID_INDEX) {
+                typed = true;
+                error = "Unknown node: " + std::string(fields[0]);
+            } else if (destination == graph::CompactGraph::INVALID_INDEX) {
+                typed = true;
+                error = "Unknown node: " + std::string(fields[1]);
+            }
+        }
+        
+        ++queries;
+        if (!error.empty()) {
+            ++invalid;
+            // Same classification as the server's /metrics: a failed route, or an unclassifiable request
+            if (typed) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - lookupStarted);
+                metrics.record(QueryMetrics::QueryType::ROUTE, mode, QueryMetrics::Result::FAILED,
+                               static_cast<uint64_t>(elapsed.count()), 0);
+            } else {
+                metrics.recordRejected();
+            }
+        }
+        
+        if (binary) {
+            batch::RecordHeader record{};
+            record.line = lineNumber;
+            record.mode = static_cast<uint8_t>(mode);
+            record.status = static_cast<uint8_t>(batch::Status::INVALID);
+            if (error.empty()) {
+                const auto started = startTimer();
+                graph::PathResult result = finder.findShortestPath(source, destination, mode, path);
+                recordQuery(metrics, mode, result, started, finder.getLastStats());
+                stats += finder.getLastStats();
+                record.status = static_cast<uint8_t>(result.isFound() ? batch::Status::FOUND
+                                                     : result.isInterrupted() ? batch::Status::TIMED_OUT
+                                                     : batch::Status::NOT_FOUND);
+                record.totalDistance = result.getTotalDistance();
+                record.totalTime = result.getTotalTime();
+                record.totalCost = result.getTotalCost();
+                record.pathLength = static_cast<uint32_t>(path.size());
+                found += result.isFound() ? 1 : 0;
+                timedOut += result.isInterrupted() ? 1 : 0;
+            } else {
+                path.clear();
+            }
+            append(block.output, record);
+            for (Index node : path) {
+                append(block.output, node);
+            }
+            continue;
+        }
+        
+        // Keys in sorted order, as in nlohmann::json::dump()
+        writer.beginObject();
+        if (error.empty()) {
+            const auto started = startTimer();
+            graph::PathResult result = finder.findShortestPath(source, destination, mode);
+            recordQuery(metrics, mode, result, started, finder.getLastStats());
+            stats += finder.getLastStats();
+            found += result.isFound() ? 1 : 0;
+            timedOut += result.isInterrupted() ? 1 : 0;
+            writer.member("from", fields[0]);
+            writer.member("line", lineNumber);
+            writer.key("result");
+            data::JsonHandler::writePathResult(writer, result);
+            if (includeStats_) {
+                writer.key("stats");
+                data::JsonHandler::writeSearchStats(writer, finder.getLastStats());
+            }
+            writer.member("to", fields[1]);
+        } else {
+            writer.member("error", error);
+            writer.member("line", lineNumber);
+        }
+        writer.endObject().newline();
+    }
+    
+    if (!binary) {
+        writer.flush();
+        block.output = json.str();
+    }
+    block.text = std::string(); // Release the input while the block waits to be written
+    
+    queries_.fetch_add(queries, std::memory_order_relaxed);
+    found_.fetch_add(found, std::memory_order_relaxed);
+    invalid_.fetch_add(invalid, std::memory_order_relaxed);
+    timedOut_.fetch_add(timedOut, std::memory_order_relaxed);
+}
+
+} // namespace server
+} // namespace dijkstra
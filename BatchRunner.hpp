@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include "../graph/CompactGraph.hpp"
+#include "../graph/CompactPathFinder.hpp"
+#include "../graph/ComponentIndex.hpp"
+#include "QueryMetrics.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class BatchRunner
+ * @brief Answers a stream of origin-destination queries in parallel.
+ * 
+ * Input is text with one `source,destination[,mode]` query per line, where
+ * mode is "distance", "time", "cost" or "balanced" and defaults to the
+ * runner's default mode. Fields are not quoted; spaces around them are
+ * ignored. Blank lines, lines starting with '#' and a first line naming its
+ * columns ("source,..." or "from,...") are skipped.
+ * 
+ * Input is read in blocks of whole lines that the workers take in turn, each
+ * with its own search workspace, and at most a few blocks per worker are held
+ * in memory, so inputs of any length stream through in constant memory.
+ * Results are written as one JSON object per line,
+ * `{"from":...,"line":N,"result":{...},"to":...}` with the result as written by
+ * JsonHandler::writePathResult (or `{"error":"...","line":N}`), or as binary
+ * records described in BatchFormat.hpp. With ordered output the results
+ * appear in input order; otherwise each block is written as soon as it is done.
+ * 
+ * With a query timeout, a search that runs past it is abandoned and reported
+ * with the "timed_out" status, so a few pathological pairs cannot stall a run.
+ * Each query's search latency is recorded in QueryMetrics as a route query.
+ * As in QueryHandler, a line naming an unknown node counts as a failed route
+ * query, and a malformed line or unknown mode as a rejected request.
+ */
+class BatchRunner {
+public:
+    using OptimizationMode = graph::PathFinder::OptimizationMode;
+    
+    enum class OutputFormat {
+        JSON_LINES, ///< One JSON object per query
+        BINARY      ///< batch::StreamHeader followed by one record per query
+    };
+    
+    static constexpr size_t BLOCK_BYTES = 1 << 16;    ///< Input read per block
+    static constexpr size_t BLOCKS_PER_THREAD = 4;    ///< Blocks in flight per worker
+    
+    /**
+     * @brief Constructs a runner for a graph.
+     * @param graph Graph to query (shared, not copied)
+     * @param threads Number of query workers (0 = one per hardware thread)
+     */
+    explicit BatchRunner(const graph::CompactGraph& graph, unsigned threads = 0);
+    
+    /**
+     * @brief Use component labels to reject unreachable queries without searching.
+     * @param components Component index of the same graph
+     */
+    void setComponentIndex(const graph::ComponentIndex& components) { components_ = components; }
+    
+    void setOutputFormat(OutputFormat format) { format_ = format; }
+    void setOrdered(bool ordered) { ordered_ = ordered; }
+    void setDefaultMode(OptimizationMode mode) { defaultMode_ = mode; }
+    
+    /**
+     * @brief Add each query's search statistics to its JSON line as "stats".
+     */
+    void setIncludeStats(bool includeStats) { includeStats_ = includeStats; }
+    
+    /**
+     * @brief Limit the search time spent on one query.
+     * @param timeout Time allowed per query (zero for no limit)
+     */
+    void setQueryTimeout(std::chrono::steady_clock::duration timeout) { queryTimeout_ = timeout; }
+    
+    /**
+     * @brief Answer every query in the input.
+     * @param input Query lines
+     * @param output Receives the results
+     * @return Number of queries answered, including invalid ones
+     * @throws std::runtime_error if reading the input or writing the output fails
+     */
+    uint64_t run(std::istream& input, std::ostream& output);
+    
+    unsigned getThreadCount() const { return threads_; }
+    uint64_t getQueryCount() const { return queries_.load(std::memory_order_relaxed); }
+    uint64_t getFoundCount() const { return found_.load(std::memory_order_relaxed); }
+    uint64_t getInvalidCount() const { return invalid_.load(std::memory_order_relaxed); }
+    uint64_t getTimedOutCount() const { return timedOut_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Get the search statistics summed over the last run.
+     */
+    const graph::SearchStats& getSearchStats() const { return searchStats_; }
+    
+    /**
+     * @brief Get the latency histograms and counters of the last run.
+     */
+    const QueryMetrics& getMetrics() const { return metrics_; }
+
+private:
+    struct Block;
+    
+    graph::CompactGraph graph_;
+    graph::ComponentIndex components_;
+    unsigned threads_;
+    OutputFormat format_ = OutputFormat::JSON_LINES;
+    bool ordered_ = true;
+    OptimizationMode defaultMode_ = OptimizationMode::DISTANCE;
+    bool includeStats_ = false;
+    std::chrono::steady_clock::duration queryTimeout_ = std::chrono::steady_clock::duration::zero();
+    
+    std::atomic<uint64_t> queries_{0};
+    std::atomic<uint64_t> found_{0};
+    std::atomic<uint64_t> invalid_{0};
+    std::atomic<uint64_t> timedOut_{0};
+    graph::SearchStats searchStats_;
+    QueryMetrics metrics_;
+    
+    void answer(graph::CompactPathFinder& finder, Block& block, graph::SearchStats& stats,
+                QueryMetrics::Shard& metrics);
+};
+
+} // namespace server
+} // namespace dijkstra
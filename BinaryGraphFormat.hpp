@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace dijkstra {
+namespace data {
+namespace binary {
+
+/**
+ * On-disk layout of a binary graph file (all integers in the writer's native
+ * byte order, identified by the endian tag):
+ * 
+ *   FileHeader
+ *   SectionEntry[sectionCount]
+ *   section payloads, each starting on a SECTION_ALIGNMENT boundary
+ * 
+ * Every section is a flat array copied verbatim from a CompactGraph column, so
+ * a reader can point straight into a read-only mapping of the file.
+ */
+
+constexpr char GRAPH_MAGIC[8] = {'D', 'J', 'K', 'G', 'R', 'A', 'P', 'H'};
+constexpr uint32_t ENDIAN_TAG = 0x01020304;         ///< Reads as 0x04030201 on the other byte order
+constexpr uint16_t GRAPH_FORMAT_MAJOR = 1;           ///< Incompatible layout changes bump this
+constexpr uint16_t GRAPH_FORMAT_MINOR = 1;           ///< Backward-compatible additions bump this
+constexpr size_t SECTION_ALIGNMENT = 64;             ///< Sections start on cache-line boundaries
+
+/**
+ * @enum SectionId
+ * @brief Identifies the column stored in a section.
+ */
+enum class SectionId : uint32_t {
+    OFFSETS = 1,          ///< uint64_t[nodeCount + 1] CSR row offsets
+    TARGETS = 2,          ///< uint32_t[edgeCount] edge destinations
+    DISTANCES = 3,        ///< double[edgeCount]
+    TIMES = 4,            ///< double[edgeCount]
+    COSTS = 5,            ///< double[edgeCount]
+    MODES = 6,            ///< uint8_t[edgeCount] (optional)
+    LATITUDES = 7,        ///< double[nodeCount] (optional)
+    LONGITUDES = 8,       ///< double[nodeCount] (optional)
+    ID_ORDER = 9,         ///< uint32_t[nodeCount] node indices sorted by ID
+    NODE_ID_OFFSETS = 10, ///< uint64_t[nodeCount + 1]
+    NODE_ID_CHARS = 11,   ///< char[]
+    NODE_NAME_OFFSETS = 12, ///< uint64_t[nodeCount + 1]
+    NODE_NAME_CHARS = 13, ///< char[]
+    EDGE_ID_OFFSETS = 14, ///< uint64_t[edgeCount + 1]
+    EDGE_ID_CHARS = 15,   ///< char[]
+    CONTENT_HASH = 16     ///< uint64_t[1] hash of all other sections (since 1.1)
+};
+
+/**
+ * @struct FileHeader
+ * @brief Fixed-size header at the start of a binary graph file.
+ */
+struct FileHeader {
+    char magic[8];
+    uint32_t endianTag;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint64_t fileSize;
+    uint64_t nodeCount;
+    uint64_t edgeCount;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+/**
+ * @struct SectionEntry
+ * @brief Location of one section within the file.
+ */
+struct SectionEntry {
+    uint32_t id;          ///< SectionId
+    uint32_t elementSize; ///< Size of one array element in bytes
+    uint64_t offset;      ///< Byte offset from the start of the file
+    uint64_t length;      ///< Payload length in bytes
+};
+
+static_assert(sizeof(FileHeader) == 48, "FileHeader layout must not depend on the compiler");
+static_assert(sizeof(SectionEntry) == 24, "SectionEntry layout must not depend on the compiler");
+
+/**
+ * @brief Round a file offset up to the section alignment.
+ */
+inline uint64_t alignOffset(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+} // namespace binary
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,294 @@
+#include "BinaryGraphHandler.hpp"
+#include "AtomicFile.hpp"
+#include "BinaryGraphFormat.hpp"
+#include "ContentHash.hpp"
+#include "MappedFile.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using binary::FileHeader;
+using binary::SectionEntry;
+using binary::SectionId;
+
+struct SectionPayload {
+    SectionId id;
+    uint32_t elementSize;
+    const void* data;
+    uint64_t length;
+};
+
+template <typename T>
+SectionPayload makeSection(SectionId id, const T* data, size_t count) {
+    return {id, static_cast<uint32_t>(sizeof(T)), data, static_cast<uint64_t>(count * sizeof(T))};
+}
+
+std::vector<SectionPayload> collectSections(const graph::CompactGraph& graph) {
+    const auto& columns = graph.getColumns();
+    const size_t nodeCount = columns.nodeCount;
+    const size_t edgeCount = columns.edgeCount;
+    
+    std::vector<SectionPayload> sections = {
+        makeSection(SectionId::OFFSETS, columns.offsets, nodeCount + 1),
+        makeSection(SectionId::TARGETS, columns.targets, edgeCount),
+        makeSection(SectionId::DISTANCES, columns.distances, edgeCount),
+        makeSection(SectionId::TIMES, columns.times, edgeCount),
+        makeSection(SectionId::COSTS, columns.costs, edgeCount),
+        makeSection(SectionId::ID_ORDER, columns.idOrder, nodeCount),
+        makeSection(SectionId::NODE_ID_OFFSETS, columns.nodeIds.offsets, nodeCount + 1),
+        makeSection(SectionId::NODE_ID_CHARS, columns.nodeIds.chars, columns.nodeIds.offsets[nodeCount]),
+        makeSection(SectionId::NODE_NAME_OFFSETS, columns.nodeNames.offsets, nodeCount + 1),
+        makeSection(SectionId::NODE_NAME_CHARS, columns.nodeNames.chars, columns.nodeNames.offsets[nodeCount]),
+        makeSection(SectionId::EDGE_ID_OFFSETS, columns.edgeIds.offsets, edgeCount + 1),
+        makeSection(SectionId::EDGE_ID_CHARS, columns.edgeIds.chars, columns.edgeIds.offsets[edgeCount])
+    };
+    
+    if (columns.modes) {
+        sections.push_back(makeSection(SectionId::MODES, columns.modes, edgeCount));
+    }
+    if (columns.latitudes && columns.longitudes) {
+        sections.push_back(makeSection(SectionId::LATITUDES, columns.latitudes, nodeCount));
+        sections.push_back(makeSection(SectionId::LONGITUDES, columns.longitudes, nodeCount));
+    }
+    
+    return sections;
+}
+
+/**
+ * @brief Bounds-checked view of the section table of a mapped file.
+ */
+class SectionReader {
+public:
+    SectionReader(const MappedFile& file, const FileHeader& header)
+        : file_(file) {
+        uint64_t tableEnd = sizeof(FileHeader) + uint64_t(header.sectionCount) * sizeof(SectionEntry);
+        if (tableEnd > file.size()) {
+            fail("section table is truncated");
+        }
+        
+        entries_.resize(header.sectionCount);
+        std::memcpy(entries_.data(), file.data() + sizeof(FileHeader),
+                    entries_.size() * sizeof(SectionEntry));
+    }
+    
+    template <typename T>
+    const T* require(SectionId id, uint64_t count) const {
+        const T* data = find<T>(id, count);
+        if (!data) {
+            fail("missing section " + std::to_string(static_cast<uint32_t>(id)));
+        }
+        return data;
+    }
+    
+    template <typename T>
+    const T* find(SectionId id, uint64_t count) const {
+        for (const auto& entry : entries_) {
+            if (entry.id != static_cast<uint32_t>(id)) {
+                continue;
+            }
+            
+            if (entry.elementSize != sizeof(T) || entry.length / sizeof(T) < count ||
+                entry.length > file_.size() || entry.offset > file_.size() - entry.length ||
+                entry.offset % alignof(T) != 0) {
+                fail("section " + std::to_string(entry.id) + " is malformed");
+            }
+            return reinterpret_cast<const T*>(file_.data() + entry.offset);
+        }
+        return nullptr;
+    }
+    
+    [[noreturn]] void fail(const std::string& reason) const {
+        throw std::runtime_error("Invalid binary graph file " + file_.getPath() + ": " + reason);
+    }
+
+private:
+    const MappedFile& file_;
+    std::vector<SectionEntry> entries_;
+};
+
+graph::CompactGraph::StringColumn readStrings(const SectionReader& reader,
+                                              SectionId offsetsId, SectionId charsId, uint64_t count) {
+    graph::CompactGraph::StringColumn column;
+    column.offsets = reader.require<uint64_t>(offsetsId, count + 1);
+    column.chars = reader.require<char>(charsId, column.offsets[count]);
+    for (uint64_t i = 0; i < count; ++i) {
+        if (column.offsets[i] > column.offsets[i + 1]) {
+            reader.fail("section " + std::to_string(static_cast<uint32_t>(offsetsId)) + " is not in order");
+        }
+    }
+    return column;
+}
+
+/**
+ * @brief Map a binary graph file and check its header.
+ */
+std::shared_ptr<MappedFile> openGraphFile(const std::string& filePath, FileHeader& header) {
+    auto file = std::make_shared<MappedFile>(filePath);
+    
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("Invalid binary graph file " + filePath + ": file is truncated");
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    
+    if (std::memcmp(header.magic, binary::GRAPH_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Invalid binary graph file " + filePath + ": bad magic number");
+    }
+    if (header.endianTag != binary::ENDIAN_TAG) {
+        throw std::runtime_error("Invalid binary graph file " + filePath +
+                                 ": written with a different byte order");
+    }
+    if (header.versionMajor != binary::GRAPH_FORMAT_MAJOR) {
+        throw std::runtime_error("Unsupported binary graph file " + filePath + ": format version " +
+                                 std::to_string(header.versionMajor) + "." +
+                                 std::to_string(header.versionMinor));
+    }
+    if (header.fileSize > file->size()) {
+        throw std::runtime_error("Invalid binary graph file " + filePath + ": file is truncated");
+    }
+    if (header.nodeCount >= graph::CompactGraph::INVALID_INDEX) {
+        throw std::runtime_error("Invalid binary graph file " + filePath + ": too many nodes");
+    }
+    
+    return file;
+}
+
+/**
+ * @brief View a mapped binary graph file as a compact graph.
+ * 
+ * Everything a search indexes with is checked once here, so a corrupt file
+ * is rejected instead of being read out of bounds when it is queried.
+ */
+graph::CompactGraph viewGraph(std::shared_ptr<MappedFile> file, const FileHeader& header) {
+    SectionReader reader(*file, header);
+    const uint64_t nodeCount = header.nodeCount;
+    const uint64_t edgeCount = header.edgeCount;
+    
+    graph::CompactGraph::Columns columns;
+    columns.nodeCount = static_cast<size_t>(nodeCount);
+    columns.edgeCount = static_cast<size_t>(edgeCount);
+    columns.offsets = reader.require<graph::CompactGraph::EdgeIndex>(SectionId::OFFSETS, nodeCount + 1);
+    columns.targets = reader.require<graph::CompactGraph::Index>(SectionId::TARGETS, edgeCount);
+    columns.distances = reader.require<double>(SectionId::DISTANCES, edgeCount);
+    columns.times = reader.require<double>(SectionId::TIMES, edgeCount);
+    columns.costs = reader.require<double>(SectionId::COSTS, edgeCount);
+    columns.modes = reader.find<uint8_t>(SectionId::MODES, edgeCount);
+    columns.latitudes = reader.find<double>(SectionId::LATITUDES, nodeCount);
+    columns.longitudes = reader.find<double>(SectionId::LONGITUDES, nodeCount);
+    columns.idOrder = reader.require<graph::CompactGraph::Index>(SectionId::ID_ORDER, nodeCount);
+    columns.nodeIds = readStrings(reader, SectionId::NODE_ID_OFFSETS, SectionId::NODE_ID_CHARS, nodeCount);
+    columns.nodeNames = readStrings(reader, SectionId::NODE_NAME_OFFSETS, SectionId::NODE_NAME_CHARS, nodeCount);
+    columns.edgeIds = readStrings(reader, SectionId::EDGE_ID_OFFSETS, SectionId::EDGE_ID_CHARS, edgeCount);
+    
+    if (columns.offsets[nodeCount] != edgeCount) {
+        reader.fail("edge offsets do not match the edge count");
+    }
+    for (uint64_t node = 0; node < nodeCount; ++node) {
+        if (columns.offsets[node] > columns.offsets[node + 1]) {
+            reader.fail("edge offsets are not in order");
+        }
+        if (columns.idOrder[node] >= nodeCount) {
+            reader.fail("node ID order refers to a missing node");
+        }
+    }
+    for (uint64_t edge = 0; edge < edgeCount; ++edge) {
+        if (columns.targets[edge] >= nodeCount) {
+            reader.fail("edge " + std::to_string(edge) + " targets a missing node");
+        }
+    }
+    if (!columns.latitudes || !columns.longitudes) {
+        columns.latitudes = nullptr;
+        columns.longitudes = nullptr;
+    }
+    
+    return graph::CompactGraph(columns, std::move(file));
+}
+
+uint64_t hashSections(const std::vector<SectionPayload>& sections) {
+    ContentHasher hasher;
+    for (const auto& section : sections) {
+        uint32_t id = static_cast<uint32_t>(section.id);
+        hasher.update(&id, sizeof(id));
+        hasher.update(section.data, section.length);
+    }
+    return hasher.finish();
+}
+
+} // namespace
+
+bool BinaryGraphHandler::writeBinaryGraph(const graph::CompactGraph& graph, const std::string& filePath) {
+    auto sections = collectSections(graph);
+    const uint64_t contentHash = hashSections(sections);
+    sections.push_back(makeSection(SectionId::CONTENT_HASH, &contentHash, 1));
+    
+    // Lay out the sections after the header and section table
+    std::vector<SectionEntry> entries;
+    entries.reserve(sections.size());
+    uint64_t offset = binary::alignOffset(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry));
+    for (const auto& section : sections) {
+        entries.push_back({static_cast<uint32_t>(section.id), section.elementSize, offset, section.length});
+        offset = binary::alignOffset(offset + section.length);
+    }
+    
+    FileHeader header = {};
+    std::memcpy(header.magic, binary::GRAPH_MAGIC, sizeof(header.magic));
+    header.endianTag = binary::ENDIAN_TAG;
+    header.versionMajor = binary::GRAPH_FORMAT_MAJOR;
+    header.versionMinor = binary::GRAPH_FORMAT_MINOR;
+    header.fileSize = offset;
+    header.nodeCount = graph.getNodeCount();
+    header.edgeCount = graph.getEdgeCount();
+    header.sectionCount = static_cast<uint32_t>(entries.size());
+    
+    // Replaced as a whole, so processes that still map the previous version
+    // keep a consistent view of it
+    AtomicFile file(filePath);
+    if (!file.isOpen()) {
+        return false;
+    }
+    
+    file.write(&header, sizeof(header));
+    file.write(entries.data(), entries.size() * sizeof(SectionEntry));
+    
+    static const char padding[binary::SECTION_ALIGNMENT] = {};
+    uint64_t position = sizeof(FileHeader) + entries.size() * sizeof(SectionEntry);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        file.write(padding, entries[i].offset - position);
+        if (sections[i].length > 0) {
+            file.write(sections[i].data, sections[i].length);
+        }
+        position = entries[i].offset + sections[i].length;
+    }
+    file.write(padding, header.fileSize - position);
+    return file.commit();
+}
+
+graph::CompactGraph BinaryGraphHandler::mapBinaryGraph(const std::string& filePath) {
+    FileHeader header;
+    std::shared_ptr<MappedFile> file = openGraphFile(filePath, header);
+    return viewGraph(std::move(file), header);
+}
+
+uint64_t BinaryGraphHandler::computeContentHash(const graph::CompactGraph& graph) {
+    return hashSections(collectSections(graph));
+}
+
+uint64_t BinaryGraphHandler::readContentHash(const std::string& filePath) {
+    FileHeader header;
+    std::shared_ptr<MappedFile> file = openGraphFile(filePath, header);
+    if (header.versionMinor >= 1) {
+        SectionReader reader(*file, header);
+        if (const uint64_t* hash = reader.find<uint64_t>(SectionId::CONTENT_HASH, 1)) {
+            return *hash;
+        }
+    }
+    
+    return computeContentHash(viewGraph(std::move(file), header));
+}
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include "../graph/CompactGraph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class BinaryGraphHandler
+ * @brief Reads and writes the memory-mappable binary graph format.
+ * 
+ * The format (see BinaryGraphFormat.hpp) stores the CompactGraph columns
+ * verbatim, so mapping a file costs a handful of header checks regardless of
+ * graph size. Pages are faulted in on first use and shared between all
+ * processes mapping the same file.
+ */
+class BinaryGraphHandler {
+public:
+    /**
+     * @brief Write a compact graph to a binary graph file.
+     * @param graph The graph to write
+     * @param filePath Path to the output file
+     * @return true if successful, false otherwise
+     */
+    static bool writeBinaryGraph(const graph::CompactGraph& graph, const std::string& filePath);
+    
+    /**
+     * @brief Map a binary graph file read-only and view it as a compact graph.
+     * 
+     * The returned graph keeps the mapping alive for as long as it (or any copy
+     * of it) exists. Offsets, edge targets and string offsets are checked once,
+     * in time linear in the graph's size, so a corrupt file is never read out
+     * of bounds later.
+     * 
+     * @param filePath Path to the binary graph file
+     * @return Graph backed by the file mapping
+     * @throws std::runtime_error if the file is missing, truncated, inconsistent,
+     *         or has an incompatible version or byte order
+     */
+    static graph::CompactGraph mapBinaryGraph(const std::string& filePath);
+    
+    /**
+     * @brief Compute the content hash of a graph.
+     * 
+     * The hash covers every column written to a binary graph file, so two files
+     * have the same hash exactly when they describe the same graph.
+     * 
+     * @param graph The graph to hash
+     * @return 64-bit content hash
+     */
+    static uint64_t computeContentHash(const graph::CompactGraph& graph);
+    
+    /**
+     * @brief Read the content hash stored in a binary graph file.
+     * 
+     * Files written before the hash was recorded (format 1.0) are hashed on the fly.
+     * 
+     * @param filePath Path to the binary graph file
+     * @return 64-bit content hash
+     */
+    static uint64_t readContentHash(const std::string& filePath);
+};
+
+} // namespace data
+} // namespace dijkstra
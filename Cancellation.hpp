@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dijkstra {
+namespace util {
+
+/**
+ * @class CancellationToken
+ * @brief A flag one thread raises to ask work running on other threads to stop.
+ */
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @class StopCondition
+ * @brief Decides when a long-running query should give up.
+ * 
+ * A query may be bounded by an absolute deadline, by a timeout counted from
+ * its own start, and by a cancellation token. The query calls begin() once
+ * and shouldStop() once per unit of work (a settled node); the clock and the
+ * token are only consulted every CHECK_INTERVAL calls, plus on the first
+ * call, so that an already expired deadline stops a query at once.
+ */
+class StopCondition {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    enum class Reason {
+        NONE,      ///< The query ran to completion
+        DEADLINE,  ///< The deadline or timeout passed
+        CANCELLED  ///< The cancellation token was raised
+    };
+    
+    static constexpr uint32_t CHECK_INTERVAL = 1024; ///< shouldStop() calls between checks
+    
+    /**
+     * @brief Stop queries that are still running at a point in time.
+     * @param deadline Deadline (Clock::time_point::max() for none)
+     */
+    void setDeadline(Clock::time_point deadline) { deadline_ = deadline; }
+    
+    /**
+     * @brief Stop each query that runs for longer than a duration.
+     * @param timeout Time allowed per query (zero for no limit)
+     */
+    void setTimeout(Clock::duration timeout) { timeout_ = timeout; }
+    
+    /**
+     * @brief Stop queries once a token is cancelled.
+     * @param token Token that outlives the queries (nullptr for none)
+     */
+    void setCancellationToken(const CancellationToken* token) { token_ = token; }
+    
+    /**
+     * @brief Start a query.
+     */
+    void begin() {
+        countdown_ = 1;
+        reason_ = Reason::NONE;
+        effectiveDeadline_ = deadline_;
+        if (timeout_ > Clock::duration::zero()) {
+            effectiveDeadline_ = std::min(effectiveDeadline_, Clock::now() + timeout_);
+        }
+    }
+    
+    /**
+     * @brief Account for one unit of work.
+     * @return true if the query should stop; getReason() then says why
+     */
+    bool shouldStop() {
+        if (--countdown_ != 0) {
+            return false;
+        }
+        countdown_ = CHECK_INTERVAL;
+        if (token_ && token_->isCancelled()) {
+            reason_ = Reason::CANCELLED;
+        } else if (effectiveDeadline_ != Clock::time_point::max() && Clock::now() >= effectiveDeadline_) {
+            reason_ = Reason::DEADLINE;
+        }
+        return reason_ != Reason::NONE;
+    }
+    
+    /**
+     * @brief Get why the last query stopped early.
+     * @return Reason::NONE if it ran to completion
+     */
+    Reason getReason() const { return reason_; }
+
+private:
+    Clock::time_point deadline_ = Clock::time_point::max();
+    Clock::duration timeout_ = Clock::duration::zero();
+    const CancellationToken* token_ = nullptr;
+    
+    Clock::time_point effectiveDeadline_ = Clock::time_point::max();
+    uint32_t countdown_ = 1;
+    Reason reason_ = Reason::NONE;
+};
+
+} // namespace util
+} // namespace dijkstra
@@ -0,0 +1,350 @@
+#include "CompactGraph.hpp"
+#include "CompoundEdge.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+/**
+ * @brief Heap-allocated arrays behind a CompactGraph produced by the builder.
+ */
+struct OwnedStorage {
+    std::vector<CompactGraph::EdgeIndex> offsets;
+    std::vector<CompactGraph::Index> targets;
+    std::vector<double> distances;
+    std::vector<double> times;
+    std::vector<double> costs;
+    std::vector<uint8_t> modes;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<CompactGraph::Index> idOrder;
+    std::vector<uint64_t> nodeIdOffsets;
+    std::string nodeIdChars;
+    std::vector<uint64_t> nodeNameOffsets;
+    std::string nodeNameChars;
+    std::vector<uint64_t> edgeIdOffsets;
+    std::string edgeIdChars;
+};
+
+const CompactGraph::EdgeIndex EMPTY_OFFSETS[1] = {0};
+const uint64_t EMPTY_STRING_OFFSETS[1] = {0};
+
+void packStrings(const std::vector<std::string>& strings,
+                 std::vector<uint64_t>& offsets, std::string& chars) {
+    size_t totalLength = 0;
+    for (const auto& str : strings) {
+        totalLength += str.size();
+    }
+    
+    offsets.reserve(strings.size() + 1);
+    offsets.push_back(0);
+    chars.reserve(totalLength);
+    for (const auto& str : strings) {
+        chars += str;
+        offsets.push_back(chars.size());
+    }
+}
+
+} // namespace
+
+CompactGraph::CompactGraph() {
+    columns_.offsets = EMPTY_OFFSETS;
+    columns_.nodeIds.offsets = EMPTY_STRING_OFFSETS;
+    columns_.nodeNames.offsets = EMPTY_STRING_OFFSETS;
+    columns_.edgeIds.offsets = EMPTY_STRING_OFFSETS;
+}
+
+CompactGraph::CompactGraph(const Columns& columns, std::shared_ptr<const void> storage)
+    : columns_(columns), storage_(std::move(storage)) {
+}
+
+CompactGraph::Index CompactGraph::findNode(std::string_view nodeId) const {
+    const Index* first = columns_.idOrder;
+    const Index* last = columns_.idOrder + columns_.nodeCount;
+    
+    auto it = std::lower_bound(first, last, nodeId,
+        [this](Index node, std::string_view id) {
+            return getNodeId(node) < id;
+        });
+    
+    return (it != last && getNodeId(*it) == nodeId) ? *it : INVALID_INDEX;
+}
+
+CompactGraph::Index CompactGraph::getSource(EdgeIndex edge) const {
+    const EdgeIndex* first = columns_.offsets;
+    const EdgeIndex* last = columns_.offsets + columns_.nodeCount + 1;
+    return static_cast<Index>(std::upper_bound(first, last, edge) - first - 1);
+}
+
+Graph CompactGraph::toGraph() const {
+    Graph graph;
+    graph.reserve(getNodeCount(), getEdgeCount());
+    
+    std::vector<NodePtr> nodes;
+    nodes.reserve(getNodeCount());
+    for (Index node = 0; node < getNodeCount(); ++node) {
+        nodes.push_back(std::make_shared<Node>(std::string(getNodeId(node)),
+                                               std::string(getNodeName(node))));
+        graph.addNode(nodes.back());
+    }
+    
+    for (Index node = 0; node < getNodeCount(); ++node) {
+        for (EdgeIndex edge = getFirstEdge(node); edge < getLastEdge(node); ++edge) {
+            auto edgeId = getEdgeId(edge);
+            auto graphEdge = std::make_shared<Edge>(
+                edgeId.empty() ? "e" + std::to_string(edge) : std::string(edgeId),
+                nodes[node], nodes[getTarget(edge)], getDistance(edge));
+            graphEdge->setTimeWeight(getTime(edge));
+            graphEdge->setCostWeight(getCost(edge));
+            graph.addEdge(graphEdge);
+        }
+    }
+    
+    return graph;
+}
+
+CompactGraph CompactGraph::fromGraph(const Graph& graph) {
+    CompactGraphBuilder builder;
+    builder.reserve(graph.getNodeCount(), graph.getEdgeCount());
+    
+    auto nodes = graph.getAllNodes();
+    for (const auto& node : nodes) {
+        builder.addNode(node->getId(), node->getName());
+    }
+    
+    for (const auto& node : nodes) {
+        Index source = builder.findNode(node->getId());
+        for (const auto& edge : graph.getOutgoingEdges(node->getId())) {
+            if (dynamic_cast<const CompoundEdge*>(edge.get())) {
+                throw std::invalid_argument("Failed to convert edge " + edge->getId() +
+                                            ": a CompactGraph cannot keep the nodes inside a CompoundEdge");
+            }
+            builder.addEdge(edge->getId(), source,
+                            builder.findNode(edge->getDestination()->getId()),
+                            edge->getWeight(), edge->getTimeWeight(), edge->getCostWeight());
+        }
+    }
+    
+    return builder.build();
+}
+
+void EdgeBatch::reserve(size_t edgeCount) {
+    sources.reserve(edgeCount);
+    targets.reserve(edgeCount);
+    distances.reserve(edgeCount);
+    times.reserve(edgeCount);
+    costs.reserve(edgeCount);
+    modes.reserve(edgeCount);
+    idOffsets.reserve(edgeCount + 1);
+}
+
+void CompactGraphBuilder::reserve(size_t nodeCount, size_t edgeCount) {
+    nodeIds_.reserve(nodeCount);
+    nodeNames_.reserve(nodeCount);
+    latitudes_.reserve(nodeCount);
+    longitudes_.reserve(nodeCount);
+    nodeIndex_.reserve(nodeCount);
+    edges_.reserve(edgeCount);
+}
+
+CompactGraphBuilder::Index CompactGraphBuilder::addNode(std::string_view nodeId, std::string_view name) {
+    auto index = static_cast<Index>(nodeIds_.size());
+    if (!nodeIndex_.emplace(std::string(nodeId), index).second) {
+        return CompactGraph::INVALID_INDEX; // Node already exists
+    }
+    
+    nodeIds_.emplace_back(nodeId);
+    nodeNames_.emplace_back(name);
+    latitudes_.push_back(std::nan(""));
+    longitudes_.push_back(std::nan(""));
+    return index;
+}
+
+void CompactGraphBuilder::setCoordinate(Index node, double latitude, double longitude) {
+    latitudes_[node] = latitude;
+    longitudes_[node] = longitude;
+    hasCoordinates_ = true;
+}
+
+CompactGraphBuilder::Index CompactGraphBuilder::findNode(const std::string& nodeId) const {
+    auto it = nodeIndex_.find(nodeId);
+    return (it != nodeIndex_.end()) ? it->second : CompactGraph::INVALID_INDEX;
+}
+
+bool CompactGraphBuilder::addEdge(std::string_view edgeId, Index source, Index target,
+                                  double distance, double time, double cost, uint8_t mode) {
+    if (source >= nodeIds_.size() || target >= nodeIds_.size()) {
+        return false;
+    }
+    
+    edges_.add(edgeId, source, target, distance, time, cost, mode);
+    hasModes_ = hasModes_ || mode != CompactGraph::NO_MODE;
+    return true;
+}
+
+void CompactGraphBuilder::appendEdges(const std::vector<EdgeBatch>& batches, unsigned threads) {
+    const size_t nodeCount = nodeIds_.size();
+    std::vector<size_t> edgeStarts(batches.size() + 1, edges_.size());
+    std::vector<size_t> charStarts(batches.size() + 1, edges_.idChars.size());
+    for (size_t b = 0; b < batches.size(); ++b) {
+        edgeStarts[b + 1] = edgeStarts[b] + batches[b].size();
+        charStarts[b + 1] = charStarts[b] + batches[b].idChars.size();
+    }
+    
+    // Validate everything before touching the builder
+    std::vector<uint8_t> batchHasModes(batches.size(), 0);
+    util::parallelForEach(batches.size(), threads, [&](size_t b, unsigned) {
+        const auto& batch = batches[b];
+        for (size_t edge = 0; edge < batch.size(); ++edge) {
+            if (batch.sources[edge] >= nodeCount || batch.targets[edge] >= nodeCount) {
+                throw std::invalid_argument("Edge endpoint out of range in appended batch");
+            }
+            if (batch.modes[edge] != CompactGraph::NO_MODE) {
+                batchHasModes[b] = 1;
+            }
+        }
+    });
+    
+    const size_t edgeCount = edgeStarts.back();
+    edges_.sources.resize(edgeCount);
+    edges_.targets.resize(edgeCount);
+    edges_.distances.resize(edgeCount);
+    edges_.times.resize(edgeCount);
+    edges_.costs.resize(edgeCount);
+    edges_.modes.resize(edgeCount);
+    edges_.idOffsets.resize(edgeCount + 1);
+    edges_.idChars.resize(charStarts.back());
+    
+    util::parallelForEach(batches.size(), threads, [&](size_t b, unsigned) {
+        const auto& batch = batches[b];
+        const size_t first = edgeStarts[b];
+        std::copy(batch.sources.begin(), batch.sources.end(), edges_.sources.begin() + first);
+        std::copy(batch.targets.begin(), batch.targets.end(), edges_.targets.begin() + first);
+        std::copy(batch.distances.begin(), batch.distances.end(), edges_.distances.begin() + first);
+        std::copy(batch.times.begin(), batch.times.end(), edges_.times.begin() + first);
+        std::copy(batch.costs.begin(), batch.costs.end(), edges_.costs.begin() + first);
+        std::copy(batch.modes.begin(), batch.modes.end(), edges_.modes.begin() + first);
+        for (size_t edge = 0; edge < batch.size(); ++edge) {
+            edges_.idOffsets[first + edge + 1] = charStarts[b] + batch.idOffsets[edge + 1];
+        }
+        std::copy(batch.idChars.begin(), batch.idChars.end(), edges_.idChars.begin() + charStarts[b]);
+    });
+    
+    hasModes_ = hasModes_ || std::find(batchHasModes.begin(), batchHasModes.end(), 1) != batchHasModes.end();
+}
+
+CompactGraph CompactGraphBuilder::build(unsigned threads) {
+    auto storage = std::make_shared<OwnedStorage>();
+    const size_t nodeCount = nodeIds_.size();
+    const size_t edgeCount = edges_.size();
+    
+    // Group the edges by source node: count degrees, then scatter edge
+    // indices through per-node cursors
+    auto cursors = std::unique_ptr<std::atomic<uint64_t>[]>(new std::atomic<uint64_t>[nodeCount + 1]());
+    util::parallelForRange(edgeCount, threads, [&](size_t begin, size_t end) {
+        for (size_t edge = begin; edge < end; ++edge) {
+            cursors[edges_.sources[edge] + 1].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    
+    storage->offsets.resize(nodeCount + 1);
+    storage->offsets[0] = 0;
+    for (size_t node = 0; node < nodeCount; ++node) {
+        storage->offsets[node + 1] = storage->offsets[node] + cursors[node + 1].load(std::memory_order_relaxed);
+        cursors[node].store(storage->offsets[node], std::memory_order_relaxed);
+    }
+    
+    std::vector<CompactGraph::EdgeIndex> origin(edgeCount);
+    util::parallelForRange(edgeCount, threads, [&](size_t begin, size_t end) {
+        for (size_t edge = begin; edge < end; ++edge) {
+            origin[cursors[edges_.sources[edge]].fetch_add(1, std::memory_order_relaxed)] = edge;
+        }
+    });
+    cursors.reset();
+    
+    // Concurrent scatter leaves each node's edges in arbitrary order; restore
+    // insertion order so the result is the same for any thread count
+    util::parallelForRange(nodeCount, threads, [&](size_t begin, size_t end) {
+        for (size_t node = begin; node < end; ++node) {
+            std::sort(origin.begin() + storage->offsets[node], origin.begin() + storage->offsets[node + 1]);
+        }
+    });
+    
+    storage->targets.resize(edgeCount);
+    storage->distances.resize(edgeCount);
+    storage->times.resize(edgeCount);
+    storage->costs.resize(edgeCount);
+    if (hasModes_) {
+        storage->modes.resize(edgeCount);
+    }
+    storage->edgeIdOffsets.resize(edgeCount + 1);
+    storage->edgeIdOffsets[0] = 0;
+    util::parallelForRange(edgeCount, threads, [&](size_t begin, size_t end) {
+        for (size_t pos = begin; pos < end; ++pos) {
+            auto edge = origin[pos];
+            storage->targets[pos] = edges_.targets[edge];
+            storage->distances[pos] = edges_.distances[edge];
+            storage->times[pos] = edges_.times[edge];
+            storage->costs[pos] = edges_.costs[edge];
+            if (hasModes_) {
+                storage->modes[pos] = edges_.modes[edge];
+            }
+            storage->edgeIdOffsets[pos + 1] = edges_.idOffsets[edge + 1] - edges_.idOffsets[edge];
+        }
+    });
+    
+    std::partial_sum(storage->edgeIdOffsets.begin(), storage->edgeIdOffsets.end(), storage->edgeIdOffsets.begin());
+    storage->edgeIdChars.resize(edges_.idChars.size());
+    util::parallelForRange(edgeCount, threads, [&](size_t begin, size_t end) {
+        for (size_t pos = begin; pos < end; ++pos) {
+            auto edge = origin[pos];
+            std::copy(edges_.idChars.begin() + edges_.idOffsets[edge],
+                      edges_.idChars.begin() + edges_.idOffsets[edge + 1],
+                      storage->edgeIdChars.begin() + storage->edgeIdOffsets[pos]);
+        }
+    });
+    
+    // Node columns
+    packStrings(nodeIds_, storage->nodeIdOffsets, storage->nodeIdChars);
+    packStrings(nodeNames_, storage->nodeNameOffsets, storage->nodeNameChars);
+    if (hasCoordinates_) {
+        storage->latitudes = std::move(latitudes_);
+        storage->longitudes = std::move(longitudes_);
+    }
+    
+    storage->idOrder.resize(nodeCount);
+    std::iota(storage->idOrder.begin(), storage->idOrder.end(), 0);
+    util::parallelSort(storage->idOrder, threads,
+        [this](Index a, Index b) {
+            return nodeIds_[a] < nodeIds_[b];
+        });
+    
+    CompactGraph::Columns columns;
+    columns.nodeCount = nodeCount;
+    columns.edgeCount = edgeCount;
+    columns.offsets = storage->offsets.data();
+    columns.targets = storage->targets.data();
+    columns.distances = storage->distances.data();
+    columns.times = storage->times.data();
+    columns.costs = storage->costs.data();
+    columns.modes = hasModes_ ? storage->modes.data() : nullptr;
+    columns.latitudes = hasCoordinates_ ? storage->latitudes.data() : nullptr;
+    columns.longitudes = hasCoordinates_ ? storage->longitudes.data() : nullptr;
+    columns.idOrder = storage->idOrder.data();
+    columns.nodeIds = {storage->nodeIdOffsets.data(), storage->nodeIdChars.data()};
+    columns.nodeNames = {storage->nodeNameOffsets.data(), storage->nodeNameChars.data()};
+    columns.edgeIds = {storage->edgeIdOffsets.data(), storage->edgeIdChars.data()};
+    
+    *this = CompactGraphBuilder();
+    return CompactGraph(columns, std::move(storage));
+}
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Graph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class CompactGraph
+ * @brief Immutable compressed-sparse-row (CSR) representation of a directed graph.
+ * 
+ * Nodes are addressed by dense integer indices and every per-node or per-edge
+ * attribute lives in its own flat column (structure of arrays). Edges leaving
+ * node `u` occupy the index range [getFirstEdge(u), getLastEdge(u)).
+ * 
+ * The columns are plain pointers into storage kept alive by a shared owner, so a
+ * CompactGraph can either own its arrays (see CompactGraphBuilder) or view
+ * memory that lives elsewhere, such as a read-only file mapping. Copies are
+ * cheap and share the same storage.
+ */
+class CompactGraph {
+public:
+    using Index = uint32_t;
+    using EdgeIndex = uint64_t;
+    
+    static constexpr Index INVALID_INDEX = std::numeric_limits<Index>::max();
+    static constexpr uint8_t NO_MODE = 0xFF; ///< Mode tag for edges without a transport mode
+    
+    /**
+     * @struct StringColumn
+     * @brief A column of strings packed into one character buffer.
+     * 
+     * String `i` is the byte range [offsets[i], offsets[i + 1]) of `chars`.
+     */
+    struct StringColumn {
+        const uint64_t* offsets = nullptr;
+        const char* chars = nullptr;
+        
+        std::string_view get(size_t i) const {
+            return std::string_view(chars + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    };
+    
+    /**
+     * @struct Columns
+     * @brief Raw column pointers making up a CompactGraph.
+     * 
+     * Optional columns (coordinates, modes) are null when absent.
+     */
+    struct Columns {
+        size_t nodeCount = 0;
+        size_t edgeCount = 0;
+        const EdgeIndex* offsets = nullptr;   ///< nodeCount + 1 CSR row offsets
+        const Index* targets = nullptr;       ///< Destination node of each edge
+        const double* distances = nullptr;    ///< Primary weight of each edge
+        const double* times = nullptr;        ///< Time weight of each edge
+        const double* costs = nullptr;        ///< Cost weight of each edge
+        const uint8_t* modes = nullptr;       ///< Transport mode tag of each edge (optional)
+        const double* latitudes = nullptr;    ///< Latitude of each node (optional)
+        const double* longitudes = nullptr;   ///< Longitude of each node (optional)
+        const Index* idOrder = nullptr;       ///< Node indices sorted by node ID
+        StringColumn nodeIds;
+        StringColumn nodeNames;
+        StringColumn edgeIds;
+    };
+    
+    /**
+     * @brief Constructs an empty graph.
+     */
+    CompactGraph();
+    
+    /**
+     * @brief Constructs a graph over existing columns.
+     * @param columns Column pointers
+     * @param storage Owner keeping the memory behind the columns alive
+     */
+    CompactGraph(const Columns& columns, std::shared_ptr<const void> storage);
+    
+    size_t getNodeCount() const { return columns_.nodeCount; }
+    size_t getEdgeCount() const { return columns_.edgeCount; }
+    bool isEmpty() const { return columns_.nodeCount == 0; }
+    
+    /**
+     * @brief Look up a node index by its ID.
+     * @param nodeId ID of the node
+     * @return Node index, or INVALID_INDEX if not found
+     */
+    Index findNode(std::string_view nodeId) const;
+    
+    std::string_view getNodeId(Index node) const { return columns_.nodeIds.get(node); }
+    std::string_view getNodeName(Index node) const { return columns_.nodeNames.get(node); }
+    
+    bool hasCoordinates() const { return columns_.latitudes != nullptr; }
+    double getLatitude(Index node) const { return columns_.latitudes[node]; }
+    double getLongitude(Index node) const { return columns_.longitudes[node]; }
+    
+    EdgeIndex getFirstEdge(Index node) const { return columns_.offsets[node]; }
+    EdgeIndex getLastEdge(Index node) const { return columns_.offsets[node + 1]; }
+    size_t getOutDegree(Index node) const { return getLastEdge(node) - getFirstEdge(node); }
+    
+    Index getTarget(EdgeIndex edge) const { return columns_.targets[edge]; }
+    double getDistance(EdgeIndex edge) const { return columns_.distances[edge]; }
+    double getTime(EdgeIndex edge) const { return columns_.times[edge]; }
+    double getCost(EdgeIndex edge) const { return columns_.costs[edge]; }
+    uint8_t getMode(EdgeIndex edge) const { return columns_.modes ? columns_.modes[edge] : NO_MODE; }
+    std::string_view getEdgeId(EdgeIndex edge) const { return columns_.edgeIds.get(edge); }
+    
+    /**
+     * @brief Find the source node of an edge.
+     * @param edge Edge index
+     * @return Index of the node the edge leaves from
+     */
+    Index getSource(EdgeIndex edge) const;
+    
+    /**
+     * @brief Access the raw columns, e.g. for serialization.
+     * @return Column pointers
+     */
+    const Columns& getColumns() const { return columns_; }
+    
+    /**
+     * @brief Materialize the graph as a pointer-based Graph.
+     * 
+     * Edges without an ID are given one derived from their index.
+     * 
+     * @return Equivalent Graph
+     */
+    Graph toGraph() const;
+    
+    /**
+     * @brief Build a compact copy of a pointer-based Graph.
+     * 
+     * A CompactGraph has nowhere to keep the intermediate nodes of a
+     * CompoundEdge, so graphs from GraphSimplifier::contractChains are
+     * refused rather than flattened into plain edges.
+     * 
+     * @param graph Source graph
+     * @return Equivalent CompactGraph
+     * @throws std::invalid_argument if the graph has a CompoundEdge
+     */
+    static CompactGraph fromGraph(const Graph& graph);
+
+private:
+    Columns columns_;
+    std::shared_ptr<const void> storage_;
+};
+
+/**
+ * @struct EdgeBatch
+ * @brief Edges collected in insertion order, column by column.
+ * 
+ * Used by CompactGraphBuilder for its own edge list and by parallel loaders as
+ * a thread-local buffer that is later appended to a builder in one step.
+ */
+struct EdgeBatch {
+    std::vector<CompactGraph::Index> sources;
+    std::vector<CompactGraph::Index> targets;
+    std::vector<double> distances;
+    std::vector<double> times;
+    std::vector<double> costs;
+    std::vector<uint8_t> modes;
+    std::vector<uint64_t> idOffsets{0};  ///< size() + 1 offsets into idChars
+    std::string idChars;
+    
+    size_t size() const { return targets.size(); }
+    bool empty() const { return targets.empty(); }
+    
+    void reserve(size_t edgeCount);
+    
+    void add(std::string_view edgeId, CompactGraph::Index source, CompactGraph::Index target,
+             double distance, double time, double cost, uint8_t mode = CompactGraph::NO_MODE) {
+        sources.push_back(source);
+        targets.push_back(target);
+        distances.push_back(distance);
+        times.push_back(time);
+        costs.push_back(cost);
+        modes.push_back(mode);
+        idChars.append(edgeId.data(), edgeId.size());
+        idOffsets.push_back(idChars.size());
+    }
+};
+
+/**
+ * @class CompactGraphBuilder
+ * @brief Accumulates nodes and edges and packs them into a CompactGraph.
+ * 
+ * Edges may be added in any order; build() groups them by source node while
+ * keeping edges leaving the same node in insertion order, so the result does
+ * not depend on the number of threads used to build it.
+ */
+class CompactGraphBuilder {
+public:
+    using Index = CompactGraph::Index;
+    
+    /**
+     * @brief Pre-allocate storage.
+     * @param nodeCount Expected number of nodes
+     * @param edgeCount Expected number of edges
+     */
+    void reserve(size_t nodeCount, size_t edgeCount);
+    
+    /**
+     * @brief Add a node.
+     * @param nodeId Unique node ID
+     * @param name Human-readable name
+     * @return Index of the new node, or INVALID_INDEX if the ID already exists
+     */
+    Index addNode(std::string_view nodeId, std::string_view name = {});
+    
+    /**
+     * @brief Attach a coordinate to a node.
+     * @param node Node index
+     * @param latitude Latitude in degrees
+     * @param longitude Longitude in degrees
+     */
+    void setCoordinate(Index node, double latitude, double longitude);
+    
+    /**
+     * @brief Look up a node index by its ID.
+     * 
+     * Safe to call from several threads at once while no nodes are being added.
+     * 
+     * @param nodeId ID of the node
+     * @return Node index, or INVALID_INDEX if not found
+     */
+    Index findNode(const std::string& nodeId) const;
+    
+    /**
+     * @brief Add a directed edge between two existing nodes.
+     * @param edgeId Edge ID (may be empty)
+     * @param source Source node index
+     * @param target Destination node index
+     * @param distance Primary weight
+     * @param time Time weight
+     * @param cost Cost weight
+     * @param mode Transport mode tag
+     * @return true if the edge was added, false if an endpoint is out of range
+     */
+    bool addEdge(std::string_view edgeId, Index source, Index target,
+                 double distance, double time, double cost,
+                 uint8_t mode = CompactGraph::NO_MODE);
+    
+    /**
+     * @brief Append batches of edges, copying them in parallel.
+     * 
+     * Batches are appended in order, as if their edges had been added one by one.
+     * 
+     * @param batches Edge batches whose endpoints all refer to existing nodes
+     * @param threads Number of threads to copy with
+     * @throws std::invalid_argument if an endpoint is out of range
+     */
+    void appendEdges(const std::vector<EdgeBatch>& batches, unsigned threads = 1);
+    
+    size_t getNodeCount() const { return nodeIds_.size(); }
+    size_t getEdgeCount() const { return edges_.size(); }
+    
+    /**
+     * @brief Pack everything added so far into a CompactGraph.
+     * 
+     * The builder is left empty afterwards.
+     * 
+     * @param threads Number of threads for the CSR construction
+     * @return The built graph
+     */
+    CompactGraph build(unsigned threads = 1);
+
+private:
+    std::vector<std::string> nodeIds_;
+    std::vector<std::string> nodeNames_;
+    std::vector<double> latitudes_;
+    std::vector<double> longitudes_;
+    bool hasCoordinates_ = false;
+    std::unordered_map<std::string, Index> nodeIndex_;
+    
+    EdgeBatch edges_;
+    bool hasModes_ = false;
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,247 @@
+#include "CompactPathFinder.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace dijkstra {
+namespace graph {
+
+CompactPathFinder::CompactPathFinder(const CompactGraph& graph)
+    : graph_(graph)
+    , workspace_(graph.getNodeCount()) {
+}
+
+PathResult CompactPathFinder::findShortestPath(
+    const Node::NodeId& source,
+    const Node::NodeId& destination,
+    OptimizationMode mode) {
+    
+    Index sourceIndex = graph_.findNode(source);
+    Index destIndex = graph_.findNode(destination);
+    
+    if (sourceIndex == CompactGraph::INVALID_INDEX || destIndex == CompactGraph::INVALID_INDEX) {
+        beginQuery();
+        stats_.end();
+        return PathResult(); // Source or destination not found
+    }
+    
+    return findShortestPath(sourceIndex, destIndex, mode);
+}
+
+PathResult CompactPathFinder::findShortestPath(Index source, Index destination, OptimizationMode mode) {
+    std::vector<Index> nodes;
+    PathResult result = findShortestPath(source, destination, mode, nodes);
+    
+    PathResult::Path path;
+    path.reserve(nodes.size());
+    for (Index node : nodes) {
+        path.emplace_back(graph_.getNodeId(node));
+    }
+    result.setPath(path);
+    return result;
+}
+
+PathResult CompactPathFinder::findShortestPath(Index source, Index destination, OptimizationMode mode,
+                                               std::vector<Index>& path) {
+    PathResult result;
+    path.clear();
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (source >= graph_.getNodeCount() || destination >= graph_.getNodeCount()) {
+        return result;
+    }
+    
+    if (!components_.mayReach(source, destination)) {
+        return result; // Different weakly connected components
+    }
+    
+    search(source, destination, mode);
+    return tracePath(destination, path);
+}
+
+PathResult CompactPathFinder::findShortestPath(const std::vector<std::pair<Index, double>>& sources,
+                                               Index destination, OptimizationMode mode,
+                                               std::vector<Index>& path) {
+    path.clear();
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (destination >= graph_.getNodeCount()) {
+        return PathResult();
+    }
+    
+    workspace_.clear();
+    for (const auto& [source, cost] : sources) {
+        if (source < graph_.getNodeCount() && components_.mayReach(source, destination) &&
+            (!workspace_.isReached(source) || cost < workspace_.getDistance(source))) {
+            reach(source, cost, NO_EDGE);
+        }
+    }
+    expand(mode, [destination](Index node, double) { return node == destination; });
+    return tracePath(destination, path);
+}
+
+PathResult CompactPathFinder::tracePath(Index destination, std::vector<Index>& path) {
+    PathResult result;
+    stats_.end();
+    result.setStats(stats_);
+    if (stop_.getReason() != util::StopCondition::Reason::NONE) {
+        result.setStatus(PathFinder::stoppedStatus(stop_.getReason()));
+        return result;
+    }
+    if (!workspace_.isReached(destination)) {
+        return result; // No path found
+    }
+    
+    // Walk the parent edges back from the destination
+    double totalDistance = 0.0;
+    double totalTime = 0.0;
+    double totalCost = 0.0;
+    
+    for (Index at = destination; ; ) {
+        path.push_back(at);
+        EdgeIndex edge = workspace_.getParent(at);
+        if (edge == NO_EDGE) {
+            break;
+        }
+        
+        totalDistance += graph_.getDistance(edge);
+        totalTime += graph_.getTime(edge);
+        totalCost += graph_.getCost(edge);
+        at = graph_.getSource(edge);
+    }
+    std::reverse(path.begin(), path.end());
+    
+    result.setFound(true);
+    result.setTotalDistance(totalDistance);
+    result.setTotalTime(totalTime);
+    result.setTotalCost(totalCost);
+    return result;
+}
+
+std::vector<double> CompactPathFinder::findShortestPaths(Index source, OptimizationMode mode) {
+    std::vector<double> result(graph_.getNodeCount(), std::numeric_limits<double>::infinity());
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (source >= graph_.getNodeCount()) {
+        return result;
+    }
+    
+    search(source, CompactGraph::INVALID_INDEX, mode);
+    for (Index node = 0; node < graph_.getNodeCount(); ++node) {
+        result[node] = workspace_.distanceOf(node);
+    }
+    return result;
+}
+
+std::vector<double> CompactPathFinder::findCosts(Index source, const std::vector<Index>& targets,
+                                                 OptimizationMode mode) {
+    std::vector<double> result(targets.size(), std::numeric_limits<double>::infinity());
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (source >= graph_.getNodeCount()) {
+        return result;
+    }
+    
+    std::vector<Index> pending;
+    for (Index target : targets) {
+        if (target < graph_.getNodeCount() && components_.mayReach(source, target)) {
+            pending.push_back(target);
+        }
+    }
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+    if (pending.empty()) {
+        return result;
+    }
+    
+    size_t remaining = pending.size();
+    searchUntil(source, mode, [&](Index node, double) {
+        return std::binary_search(pending.begin(), pending.end(), node) && --remaining == 0;
+    });
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (targets[i] < graph_.getNodeCount()) {
+            result[i] = workspace_.distanceOf(targets[i]);
+        }
+    }
+    return result;
+}
+
+std::vector<std::pair<CompactPathFinder::Index, double>> CompactPathFinder::findWithin(
+    Index source, double limit, OptimizationMode mode) {
+    
+    std::vector<std::pair<Index, double>> result;
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (source >= graph_.getNodeCount()) {
+        return result;
+    }
+    
+    searchUntil(source, mode, [&](Index node, double distance) {
+        if (distance > limit) {
+            return true;
+        }
+        result.emplace_back(node, distance);
+        return false;
+    });
+    return result;
+}
+
+void CompactPathFinder::beginQuery() {
+    stop_.begin();
+    stats_.begin("dijkstra-compact");
+}
+
+void CompactPathFinder::reach(Index node, double distance, EdgeIndex parentEdge) {
+    if (workspace_.isReached(node)) {
+        stats_.countDecreaseKey();
+    }
+    workspace_.reach(node, distance, parentEdge);
+    stats_.countPush(workspace_.getHeapSize());
+}
+
+template <typename OnSettle>
+void CompactPathFinder::searchUntil(Index source, OptimizationMode mode, OnSettle onSettle) {
+    workspace_.clear();
+    reach(source, 0.0, NO_EDGE);
+    expand(mode, onSettle);
+}
+
+template <typename OnSettle>
+void CompactPathFinder::expand(OptimizationMode mode, OnSettle onSettle) {
+    while (!workspace_.isHeapEmpty()) {
+        auto current = workspace_.pop();
+        stats_.countPop();
+        
+        // Skip if we've found a better path already
+        if (current.distance > workspace_.getDistance(current.node)) {
+            continue;
+        }
+        
+        // Give up if the deadline has passed or the query was cancelled
+        if (stop_.shouldStop()) {
+            break;
+        }
+        stats_.countSettled();
+        
+        if (onSettle(current.node, current.distance)) {
+            break;
+        }
+        
+        for (EdgeIndex edge = graph_.getFirstEdge(current.node); edge < graph_.getLastEdge(current.node); ++edge) {
+            Index neighbor = graph_.getTarget(edge);
+            double dist = current.distance + edgeCost(edge, mode);
+            stats_.countRelaxed();
+            
+            if (!workspace_.isReached(neighbor) || dist < workspace_.getDistance(neighbor)) {
+                reach(neighbor, dist, edge);
+            }
+        }
+    }
+}
+
+void CompactPathFinder::search(Index source, Index destination, OptimizationMode mode) {
+    // If we've reached the destination, we can stop
+    searchUntil(source, mode, [destination](Index node, double) { return node == destination; });
+}
+
+} // namespace graph
+} // namespace dijkstra
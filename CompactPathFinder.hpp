@@ -0,0 +1,170 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "CompactGraph.hpp"
+#include "ComponentIndex.hpp"
+#include "PathFinder.hpp"
+#include "SearchWorkspace.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class CompactPathFinder
+ * @brief Dijkstra's algorithm over a CompactGraph.
+ * 
+ * Works on dense node indices and flat weight columns, so a graph mapped from
+ * a binary file can be queried immediately. The search workspace is reused
+ * across queries and reset lazily with a generation stamp, so the per-query
+ * cost is proportional to the part of the graph actually explored. An instance
+ * is not thread-safe; use one per thread.
+ */
+class CompactPathFinder {
+public:
+    using Index = CompactGraph::Index;
+    using EdgeIndex = CompactGraph::EdgeIndex;
+    using OptimizationMode = PathFinder::OptimizationMode;
+    
+    /**
+     * @brief Constructs a path finder for a graph.
+     * @param graph Graph to search; the finder keeps its own (shared) view of it
+     */
+    explicit CompactPathFinder(const CompactGraph& graph);
+    
+    /**
+     * @brief Find the shortest path between two nodes.
+     * @param source Source node ID
+     * @param destination Destination node ID
+     * @param mode Optimization mode
+     * @return PathResult containing the path and metrics
+     */
+    PathResult findShortestPath(const Node::NodeId& source,
+                               const Node::NodeId& destination,
+                               OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    /**
+     * @brief Find the shortest path between two node indices.
+     * @param source Source node index
+     * @param destination Destination node index
+     * @param mode Optimization mode
+     * @return PathResult containing the path and metrics
+     */
+    PathResult findShortestPath(Index source, Index destination,
+                               OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    /**
+     * @brief Find the shortest path between two node indices without resolving node IDs.
+     * @param source Source node index
+     * @param destination Destination node index
+     * @param mode Optimization mode
+     * @param path Receives the node indices from source to destination (empty if none)
+     * @return PathResult with the totals; its path of node IDs is left empty
+     */
+    PathResult findShortestPath(Index source, Index destination, OptimizationMode mode,
+                               std::vector<Index>& path);
+    
+    /**
+     * @brief Find the shortest path to a node from whichever of several sources is best.
+     * 
+     * Every source starts at its own initial cost, e.g. the cost of reaching it
+     * from outside the graph, and the path starts at the source with the
+     * lowest initial cost plus path cost. Totals cover only the returned path.
+     * 
+     * @param sources (node index, non-negative initial cost) pairs
+     * @param destination Destination node index
+     * @param mode Optimization mode
+     * @param path Receives the node indices from the chosen source to destination (empty if none)
+     * @return PathResult with the totals; its path of node IDs is left empty
+     */
+    PathResult findShortestPath(const std::vector<std::pair<Index, double>>& sources, Index destination,
+                                OptimizationMode mode, std::vector<Index>& path);
+    
+    /**
+     * @brief Find shortest path costs from a source to every node.
+     * @param source Source node index
+     * @param mode Optimization mode
+     * @return Cost per node index; infinity for unreachable nodes (and for
+     *         unsettled ones if getStopReason() reports an early stop)
+     */
+    std::vector<double> findShortestPaths(Index source,
+                                          OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    /**
+     * @brief Find shortest path costs from a source to a set of targets.
+     * 
+     * The search stops as soon as every target has been settled.
+     * 
+     * @param source Source node index
+     * @param targets Target node indices
+     * @param mode Optimization mode
+     * @return Cost per target; infinity for unreachable or invalid targets (and
+     *         for unsettled ones if getStopReason() reports an early stop)
+     */
+    std::vector<double> findCosts(Index source, const std::vector<Index>& targets,
+                                  OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    /**
+     * @brief Find every node whose shortest path cost from a source is within a limit.
+     * @param source Source node index
+     * @param limit Largest path cost to include
+     * @param mode Optimization mode
+     * @return (node, cost) pairs in increasing order of cost, starting with the
+     *         source; a prefix of them if getStopReason() reports an early stop
+     */
+    std::vector<std::pair<Index, double>> findWithin(Index source, double limit,
+                                                     OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    const CompactGraph& getGraph() const { return graph_; }
+    
+    /**
+     * @brief Use component labels to reject unreachable queries without searching.
+     * @param components Component index of the same graph (empty to disable)
+     */
+    void setComponentIndex(const ComponentIndex& components) { components_ = components; }
+    
+    /**
+     * @brief Bound later queries by a deadline, timeout and/or cancellation token.
+     * 
+     * A path query that has to stop returns a TIMED_OUT or CANCELLED result.
+     * 
+     * @param stop Stop condition to copy
+     */
+    void setStopCondition(const util::StopCondition& stop) { stop_ = stop; }
+    
+    /**
+     * @brief Get why the last query stopped early.
+     * @return Reason::NONE if it ran to completion
+     */
+    util::StopCondition::Reason getStopReason() const { return stop_.getReason(); }
+    
+    /**
+     * @brief Get the work done by the last query.
+     */
+    const SearchStats& getLastStats() const { return stats_; }
+
+private:
+    static constexpr EdgeIndex NO_EDGE = ~EdgeIndex(0);
+    
+    CompactGraph graph_;
+    ComponentIndex components_;
+    util::StopCondition stop_;
+    SearchStats stats_;
+    SearchWorkspace<EdgeIndex> workspace_; ///< Parent edge of every reached node
+    
+    void beginQuery();
+    void reach(Index node, double distance, EdgeIndex parentEdge);
+    void search(Index source, Index destination, OptimizationMode mode);
+    template <typename OnSettle>
+    void searchUntil(Index source, OptimizationMode mode, OnSettle onSettle);
+    template <typename OnSettle>
+    void expand(OptimizationMode mode, OnSettle onSettle);
+    PathResult tracePath(Index destination, std::vector<Index>& path);
+    double edgeCost(EdgeIndex edge, OptimizationMode mode) const {
+        return PathFinder::combineWeights(graph_.getDistance(edge), graph_.getTime(edge),
+                                          graph_.getCost(edge), mode);
+    }
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,145 @@
+#include "ComponentIndex.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+using Index = CompactGraph::Index;
+using EdgeIndex = CompactGraph::EdgeIndex;
+
+struct Labels {
+    std::vector<uint32_t> strong;
+    std::vector<uint32_t> weak;
+};
+
+/**
+ * @brief Iterative Tarjan's algorithm, so deep graphs cannot overflow the call stack.
+ */
+void labelStrongComponents(const CompactGraph& graph, std::vector<uint32_t>& labels) {
+    constexpr uint32_t UNVISITED = std::numeric_limits<uint32_t>::max();
+    const size_t nodeCount = graph.getNodeCount();
+    
+    struct Frame {
+        Index node;
+        EdgeIndex nextEdge;
+    };
+    
+    std::vector<uint32_t> order(nodeCount, UNVISITED);
+    std::vector<uint32_t> lowLink(nodeCount, 0);
+    std::vector<bool> onStack(nodeCount, false);
+    std::vector<Index> stack;
+    std::vector<Frame> callStack;
+    uint32_t nextOrder = 0;
+    uint32_t nextLabel = 0;
+    
+    labels.assign(nodeCount, UNVISITED);
+    
+    for (Index root = 0; root < nodeCount; ++root) {
+        if (order[root] != UNVISITED) {
+            continue;
+        }
+        
+        order[root] = lowLink[root] = nextOrder++;
+        stack.push_back(root);
+        onStack[root] = true;
+        callStack.push_back({root, graph.getFirstEdge(root)});
+        
+        while (!callStack.empty()) {
+            Frame& frame = callStack.back();
+            Index node = frame.node;
+            
+            if (frame.nextEdge < graph.getLastEdge(node)) {
+                Index neighbor = graph.getTarget(frame.nextEdge++);
+                if (order[neighbor] == UNVISITED) {
+                    order[neighbor] = lowLink[neighbor] = nextOrder++;
+                    stack.push_back(neighbor);
+                    onStack[neighbor] = true;
+                    callStack.push_back({neighbor, graph.getFirstEdge(neighbor)});
+                } else if (onStack[neighbor]) {
+                    lowLink[node] = std::min(lowLink[node], order[neighbor]);
+                }
+                continue;
+            }
+            
+            // All edges explored: close the component if this node is its root
+            if (lowLink[node] == order[node]) {
+                Index member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    labels[member] = nextLabel;
+                } while (member != node);
+                ++nextLabel;
+            }
+            
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                Index parent = callStack.back().node;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+        }
+    }
+}
+
+Index findRoot(std::vector<Index>& parents, Index node) {
+    while (parents[node] != node) {
+        parents[node] = parents[parents[node]]; // Path halving
+        node = parents[node];
+    }
+    return node;
+}
+
+void labelWeakComponents(const CompactGraph& graph, std::vector<uint32_t>& labels) {
+    const size_t nodeCount = graph.getNodeCount();
+    std::vector<Index> parents(nodeCount);
+    std::iota(parents.begin(), parents.end(), 0);
+    
+    for (Index node = 0; node < nodeCount; ++node) {
+        for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+            Index a = findRoot(parents, node);
+            Index b = findRoot(parents, graph.getTarget(edge));
+            if (a != b) {
+                parents[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+    
+    // Renumber roots densely in order of first appearance
+    constexpr uint32_t UNLABELLED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> rootLabels(nodeCount, UNLABELLED);
+    uint32_t nextLabel = 0;
+    labels.resize(nodeCount);
+    for (Index node = 0; node < nodeCount; ++node) {
+        Index root = findRoot(parents, node);
+        if (rootLabels[root] == UNLABELLED) {
+            rootLabels[root] = nextLabel++;
+        }
+        labels[node] = rootLabels[root];
+    }
+}
+
+} // namespace
+
+ComponentIndex::ComponentIndex(const uint32_t* strong, const uint32_t* weak, size_t nodeCount,
+                               std::shared_ptr<const void> storage)
+    : strong_(strong), weak_(weak), nodeCount_(nodeCount), storage_(std::move(storage)) {
+}
+
+ComponentIndex ComponentIndex::build(const CompactGraph& graph) {
+    auto labels = std::make_shared<Labels>();
+    labelStrongComponents(graph, labels->strong);
+    labelWeakComponents(graph, labels->weak);
+    
+    const uint32_t* strong = labels->strong.data();
+    const uint32_t* weak = labels->weak.data();
+    return ComponentIndex(strong, weak, graph.getNodeCount(), std::move(labels));
+}
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "CompactGraph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class ComponentIndex
+ * @brief Strongly and weakly connected component labels for every node.
+ * 
+ * Two nodes in different weakly connected components can never reach each
+ * other, which lets a search reject such queries without exploring anything.
+ * Nodes in the same strongly connected component can always reach each other.
+ * Like CompactGraph, the label arrays may be owned or borrowed from a mapping.
+ */
+class ComponentIndex {
+public:
+    static constexpr uint32_t VERSION = 1; ///< Bump when the labelling scheme changes
+    
+    /**
+     * @brief Constructs an empty index (every query is treated as possibly reachable).
+     */
+    ComponentIndex() = default;
+    
+    /**
+     * @brief Constructs an index over existing label arrays.
+     * @param strong Strongly connected component label per node
+     * @param weak Weakly connected component label per node
+     * @param nodeCount Number of nodes
+     * @param storage Owner keeping the arrays alive
+     */
+    ComponentIndex(const uint32_t* strong, const uint32_t* weak, size_t nodeCount,
+                   std::shared_ptr<const void> storage);
+    
+    /**
+     * @brief Compute the component labels of a graph.
+     * @param graph Graph to label
+     * @return The computed index
+     */
+    static ComponentIndex build(const CompactGraph& graph);
+    
+    size_t getNodeCount() const { return nodeCount_; }
+    bool isEmpty() const { return nodeCount_ == 0; }
+    
+    uint32_t getStrongComponent(CompactGraph::Index node) const { return strong_[node]; }
+    uint32_t getWeakComponent(CompactGraph::Index node) const { return weak_[node]; }
+    
+    /**
+     * @brief Check whether a path from source to destination can exist.
+     * @param source Source node index
+     * @param destination Destination node index
+     * @return false only if the destination is certainly unreachable
+     */
+    bool mayReach(CompactGraph::Index source, CompactGraph::Index destination) const {
+        return nodeCount_ == 0 || weak_[source] == weak_[destination];
+    }
+    
+    const uint32_t* getStrongLabels() const { return strong_; }
+    const uint32_t* getWeakLabels() const { return weak_; }
+
+private:
+    const uint32_t* strong_ = nullptr;
+    const uint32_t* weak_ = nullptr;
+    size_t nodeCount_ = 0;
+    std::shared_ptr<const void> storage_;
+};
+
+} // namespace graph
+} // namespace dijkstra
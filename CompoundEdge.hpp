@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "Edge.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class CompoundEdge
+ * @brief An edge standing in for a chain of edges through degree-2 nodes.
+ * 
+ * Its weights are the sums of the chain's weights. The original edges are kept,
+ * so the nodes the chain passed through can be restored when a path using the
+ * edge is reported.
+ */
+class CompoundEdge : public Edge {
+public:
+    /**
+     * @brief Constructs a compound edge from a chain.
+     * @param id Unique identifier for the edge
+     * @param parts Consecutive edges from the chain's source to its destination (at least one)
+     */
+    CompoundEdge(const EdgeId& id, std::vector<EdgePtr> parts)
+        : Edge(id, parts.front()->getSource(), parts.back()->getDestination(), 0.0), parts_(std::move(parts)) {
+        Weight distance = 0.0;
+        Weight time = 0.0;
+        Weight cost = 0.0;
+        for (const auto& part : parts_) {
+            distance += part->getWeight();
+            time += part->getTimeWeight();
+            cost += part->getCostWeight();
+        }
+        setWeight(distance);
+        setTimeWeight(time);
+        setCostWeight(cost);
+    }
+    
+    /**
+     * @brief Get the edges the compound edge replaces.
+     * @return Chain edges in travel order
+     */
+    const std::vector<EdgePtr>& getParts() const { return parts_; }
+    
+    /**
+     * @brief Get the nodes between the source and the destination.
+     * @return Intermediate nodes in travel order
+     */
+    std::vector<NodePtr> getVia() const {
+        std::vector<NodePtr> via;
+        via.reserve(parts_.size() - 1);
+        for (size_t i = 0; i + 1 < parts_.size(); ++i) {
+            via.push_back(parts_[i]->getDestination());
+        }
+        return via;
+    }
+
+private:
+    std::vector<EdgePtr> parts_; ///< Original chain edges
+};
+
+} // namespace graph
+} // namespace dijkstra
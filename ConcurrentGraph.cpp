@@ -0,0 +1,358 @@
+#include "ConcurrentGraph.hpp"
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+/**
+ * @brief Get a power-of-two block count giving about `perBlock` items per block.
+ */
+size_t blockCountFor(size_t expectedItems, size_t perBlock) {
+    size_t count = 16;
+    while (count * perBlock < expectedItems) {
+        count *= 2;
+    }
+    return count;
+}
+
+/**
+ * @brief Split the entries of some blocks into `count` new blocks by hash.
+ */
+template <typename Block>
+std::vector<std::shared_ptr<const Block>> reblock(const std::vector<std::shared_ptr<const Block>>& blocks,
+                                                  size_t count) {
+    std::vector<std::shared_ptr<Block>> rebuilt(count);
+    for (auto& block : rebuilt) {
+        block = std::make_shared<Block>();
+    }
+    for (const auto& block : blocks) {
+        for (const auto& pair : *block) {
+            rebuilt[std::hash<typename Block::key_type>()(pair.first) & (count - 1)]->insert(pair);
+        }
+    }
+    return {rebuilt.begin(), rebuilt.end()};
+}
+
+} // namespace
+
+// GraphSnapshot
+
+const GraphSnapshot::NodeEntry* GraphSnapshot::findNode(const Node::NodeId& nodeId) const {
+    const NodeBlock& block = *nodeBlocks_[nodeBlockOf(nodeId)];
+    auto it = block.find(nodeId);
+    return it != block.end() ? &it->second : nullptr;
+}
+
+NodePtr GraphSnapshot::getNode(const Node::NodeId& nodeId) const {
+    const NodeEntry* entry = findNode(nodeId);
+    return entry ? entry->node : nullptr;
+}
+
+EdgePtr GraphSnapshot::getEdge(const Edge::EdgeId& edgeId) const {
+    const EdgeBlock& block = *edgeBlocks_[edgeBlockOf(edgeId)];
+    auto it = block.find(edgeId);
+    return it != block.end() ? it->second : nullptr;
+}
+
+GraphSnapshot::EdgeList GraphSnapshot::getOutgoingEdges(const Node::NodeId& nodeId) const {
+    const NodeEntry* entry = findNode(nodeId);
+    return entry ? entry->outgoing : EdgeList();
+}
+
+std::vector<NodePtr> GraphSnapshot::getAllNodes() const {
+    std::vector<NodePtr> result;
+    result.reserve(nodeCount_);
+    for (const auto& block : nodeBlocks_) {
+        for (const auto& pair : *block) {
+            result.push_back(pair.second.node);
+        }
+    }
+    return result;
+}
+
+std::vector<EdgePtr> GraphSnapshot::getAllEdges() const {
+    std::vector<EdgePtr> result;
+    result.reserve(edgeCount_);
+    for (const auto& block : edgeBlocks_) {
+        for (const auto& pair : *block) {
+            result.push_back(pair.second);
+        }
+    }
+    return result;
+}
+
+// ConcurrentGraph
+
+ConcurrentGraph::ConcurrentGraph(size_t expectedNodes, size_t expectedEdges) {
+    auto snapshot = std::make_unique<GraphSnapshot>();
+    // Every block starts as the same empty block; the first edit of each copies it
+    snapshot->nodeBlocks_.assign(blockCountFor(expectedNodes, NODES_PER_BLOCK),
+                                 std::make_shared<const GraphSnapshot::NodeBlock>());
+    snapshot->edgeBlocks_.assign(blockCountFor(expectedEdges, NODES_PER_BLOCK),
+                                 std::make_shared<const GraphSnapshot::EdgeBlock>());
+    current_.store(snapshot.release());
+}
+
+ConcurrentGraph::ConcurrentGraph(const Graph& graph) : ConcurrentGraph(graph.getNodeCount(), graph.getEdgeCount()) {
+    update([&graph](Batch& batch) {
+        for (const auto& node : graph.getAllNodes()) {
+            batch.addNode(node);
+        }
+        for (const auto& edge : graph.getAllEdges()) {
+            batch.addEdge(edge);
+        }
+    });
+}
+
+ConcurrentGraph::~ConcurrentGraph() {
+    delete current_.load();
+}
+
+ConcurrentGraph::ReadGuard::~ReadGuard() {
+    if (slot_) {
+        slot_->store(0, std::memory_order_release);
+    }
+}
+
+ConcurrentGraph::ReadGuard ConcurrentGraph::read() const {
+    // Threads start probing at different slots, so they rarely compete for one
+    const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (size_t probe = 0; ; ++probe) {
+        std::atomic<uint64_t>& slot = readers_[(start + probe) % MAX_READERS].epoch;
+        uint64_t free = 0;
+        if (slot.load(std::memory_order_relaxed) == 0 && slot.compare_exchange_strong(free, epoch_.load())) {
+            // The announcement precedes this load, so a writer that replaces the
+            // snapshot afterwards sees the announcement and keeps the snapshot
+            return ReadGuard(&slot, current_.load());
+        }
+        if (probe % MAX_READERS == MAX_READERS - 1) {
+            std::this_thread::yield(); // Every slot is taken
+        }
+    }
+}
+
+bool ConcurrentGraph::addNode(NodePtr node) {
+    bool added = false;
+    update([&](Batch& batch) { added = batch.addNode(std::move(node)); });
+    return added;
+}
+
+bool ConcurrentGraph::removeNode(const Node::NodeId& nodeId) {
+    bool removed = false;
+    update([&](Batch& batch) { removed = batch.removeNode(nodeId); });
+    return removed;
+}
+
+bool ConcurrentGraph::addEdge(EdgePtr edge) {
+    bool added = false;
+    update([&](Batch& batch) { added = batch.addEdge(std::move(edge)); });
+    return added;
+}
+
+bool ConcurrentGraph::removeEdge(const Edge::EdgeId& edgeId) {
+    bool removed = false;
+    update([&](Batch& batch) { removed = batch.removeEdge(edgeId); });
+    return removed;
+}
+
+bool ConcurrentGraph::replaceEdge(EdgePtr edge) {
+    bool replaced = false;
+    update([&](Batch& batch) { replaced = batch.replaceEdge(std::move(edge)); });
+    return replaced;
+}
+
+size_t ConcurrentGraph::getRetiredCount() const {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return retired_.size();
+}
+
+void ConcurrentGraph::reclaim() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    reclaimLocked();
+}
+
+uint64_t ConcurrentGraph::publish(Batch& batch) {
+    uint64_t version = version_.load(std::memory_order_relaxed);
+    if (!batch.changed_) {
+        return version;
+    }
+    
+    batch.growBlocks();
+    batch.next_->version_ = ++version;
+    const GraphSnapshot* replaced = current_.exchange(batch.next_.release());
+    version_.store(version, std::memory_order_release);
+    
+    // Readers that announced an epoch before this one may still use the old version
+    retired_.push_back({epoch_.fetch_add(1) + 1, std::unique_ptr<const GraphSnapshot>(replaced)});
+    reclaimLocked();
+    return version;
+}
+
+void ConcurrentGraph::reclaimLocked() {
+    uint64_t oldestReader = std::numeric_limits<uint64_t>::max();
+    for (const auto& reader : readers_) {
+        uint64_t epoch = reader.epoch.load();
+        if (epoch != 0) {
+            oldestReader = std::min(oldestReader, epoch);
+        }
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [oldestReader](const Retired& retired) { return retired.epoch <= oldestReader; }),
+                   retired_.end());
+}
+
+// ConcurrentGraph::Batch
+
+ConcurrentGraph::Batch::Batch(const GraphSnapshot& base)
+    : next_(std::make_unique<GraphSnapshot>(base))
+    , writableNodes_(base.nodeBlocks_.size(), nullptr)
+    , writableEdges_(base.edgeBlocks_.size(), nullptr) {
+}
+
+GraphSnapshot::NodeBlock& ConcurrentGraph::Batch::writableNodeBlock(size_t block) {
+    if (!writableNodes_[block]) {
+        auto copy = std::make_shared<GraphSnapshot::NodeBlock>(*next_->nodeBlocks_[block]);
+        writableNodes_[block] = copy.get();
+        next_->nodeBlocks_[block] = std::move(copy);
+    }
+    return *writableNodes_[block];
+}
+
+GraphSnapshot::EdgeBlock& ConcurrentGraph::Batch::writableEdgeBlock(size_t block) {
+    if (!writableEdges_[block]) {
+        auto copy = std::make_shared<GraphSnapshot::EdgeBlock>(*next_->edgeBlocks_[block]);
+        writableEdges_[block] = copy.get();
+        next_->edgeBlocks_[block] = std::move(copy);
+    }
+    return *writableEdges_[block];
+}
+
+void ConcurrentGraph::Batch::growBlocks() {
+    // Growing only once blocks hold twice their target keeps the copying amortized
+    GraphSnapshot& next = *next_;
+    if (next.nodeCount_ > 2 * NODES_PER_BLOCK * next.nodeBlocks_.size()) {
+        next.nodeBlocks_ = reblock(next.nodeBlocks_, blockCountFor(next.nodeCount_, NODES_PER_BLOCK));
+        writableNodes_.assign(next.nodeBlocks_.size(), nullptr);
+    }
+    if (next.edgeCount_ > 2 * NODES_PER_BLOCK * next.edgeBlocks_.size()) {
+        next.edgeBlocks_ = reblock(next.edgeBlocks_, blockCountFor(next.edgeCount_, NODES_PER_BLOCK));
+        writableEdges_.assign(next.edgeBlocks_.size(), nullptr);
+    }
+}
+
+void ConcurrentGraph::Batch::eraseFromIndex(const Edge::EdgeId& edgeId) {
+    if (writableEdgeBlock(next_->edgeBlockOf(edgeId)).erase(edgeId) > 0) {
+        --next_->edgeCount_;
+    }
+}
+
+bool ConcurrentGraph::Batch::addNode(NodePtr node) {
+    if (!node || hasNode(node->getId())) {
+        return false; // Node is null or already exists
+    }
+    
+    const Node::NodeId& nodeId = node->getId();
+    writableNodeBlock(next_->nodeBlockOf(nodeId)).emplace(nodeId, GraphSnapshot::NodeEntry{node, {}});
+    ++next_->nodeCount_;
+    changed_ = true;
+    return true;
+}
+
+bool ConcurrentGraph::Batch::removeNode(const Node::NodeId& nodeId) {
+    const GraphSnapshot::NodeEntry* entry = next_->findNode(nodeId);
+    if (!entry) {
+        return false; // Node doesn't exist
+    }
+    
+    // Remove the node and its outgoing edges
+    for (const auto& edge : entry->outgoing) {
+        eraseFromIndex(edge->getId());
+    }
+    writableNodeBlock(next_->nodeBlockOf(nodeId)).erase(nodeId);
+    --next_->nodeCount_;
+    
+    // Remove the edges leading to it, copying only the blocks that hold some
+    auto leadsToNode = [&nodeId](const EdgePtr& edge) { return edge->getDestination()->getId() == nodeId; };
+    for (size_t block = 0; block < next_->nodeBlocks_.size(); ++block) {
+        const auto& entries = *next_->nodeBlocks_[block];
+        bool affected = std::any_of(entries.begin(), entries.end(), [&](const auto& pair) {
+            return std::any_of(pair.second.outgoing.begin(), pair.second.outgoing.end(), leadsToNode);
+        });
+        if (!affected) {
+            continue;
+        }
+        for (auto& pair : writableNodeBlock(block)) {
+            auto& outgoing = pair.second.outgoing;
+            auto removed = std::stable_partition(outgoing.begin(), outgoing.end(),
+                                                 [&](const EdgePtr& edge) { return !leadsToNode(edge); });
+            for (auto it = removed; it != outgoing.end(); ++it) {
+                eraseFromIndex((*it)->getId());
+            }
+            outgoing.erase(removed, outgoing.end());
+        }
+    }
+    changed_ = true;
+    return true;
+}
+
+bool ConcurrentGraph::Batch::addEdge(EdgePtr edge) {
+    if (!edge || !edge->getSource() || !edge->getDestination()) {
+        return false; // Invalid edge
+    }
+    
+    const auto& sourceId = edge->getSource()->getId();
+    if (!hasNode(sourceId) || !hasNode(edge->getDestination()->getId()) || hasEdge(edge->getId())) {
+        return false; // Missing endpoint or edge already exists
+    }
+    
+    writableEdgeBlock(next_->edgeBlockOf(edge->getId())).emplace(edge->getId(), edge);
+    ++next_->edgeCount_;
+    writableNodeBlock(next_->nodeBlockOf(sourceId)).at(sourceId).outgoing.push_back(std::move(edge));
+    changed_ = true;
+    return true;
+}
+
+bool ConcurrentGraph::Batch::removeEdge(const Edge::EdgeId& edgeId) {
+    EdgePtr edge = next_->getEdge(edgeId);
+    if (!edge) {
+        return false; // Edge doesn't exist
+    }
+    
+    eraseFromIndex(edgeId);
+    const auto& sourceId = edge->getSource()->getId();
+    auto& outgoing = writableNodeBlock(next_->nodeBlockOf(sourceId)).at(sourceId).outgoing;
+    outgoing.erase(std::remove_if(outgoing.begin(), outgoing.end(),
+                                  [&edgeId](const EdgePtr& e) { return e->getId() == edgeId; }),
+                   outgoing.end());
+    changed_ = true;
+    return true;
+}
+
+bool ConcurrentGraph::Batch::replaceEdge(EdgePtr edge) {
+    if (!edge || !edge->getSource() || !edge->getDestination()) {
+        return false; // Invalid edge
+    }
+    
+    EdgePtr old = next_->getEdge(edge->getId());
+    const auto& sourceId = edge->getSource()->getId();
+    if (!old || old->getSource()->getId() != sourceId ||
+        old->getDestination()->getId() != edge->getDestination()->getId()) {
+        return false; // No such edge between these nodes
+    }
+    
+    writableEdgeBlock(next_->edgeBlockOf(edge->getId()))[edge->getId()] = edge;
+    for (auto& slot : writableNodeBlock(next_->nodeBlockOf(sourceId)).at(sourceId).outgoing) {
+        if (slot == old) {
+            slot = edge;
+        }
+    }
+    changed_ = true;
+    return true;
+}
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Graph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class GraphSnapshot
+ * @brief One immutable version of a ConcurrentGraph.
+ * 
+ * Nodes (with their outgoing edges) and the edge index are split by ID hash
+ * into blocks. A new version shares every block it did not change with the
+ * version before it, so publishing an edit copies only the blocks it touched
+ * and the block pointer tables. Nodes and edges are likewise shared between
+ * versions and must not be modified once added; replace an edge instead.
+ * 
+ * When the nodes or edges average more than twice
+ * ConcurrentGraph::NODES_PER_BLOCK per block, the update that grows them past
+ * that splits them into more blocks, copying all of them once; so the copy
+ * per edit stays bounded however large the graph grows. Blocks are never
+ * merged when the graph shrinks.
+ * 
+ * Node and edge lists come in no particular order.
+ */
+class GraphSnapshot : public GraphView {
+public:
+    NodePtr getNode(const Node::NodeId& nodeId) const override;
+    EdgePtr getEdge(const Edge::EdgeId& edgeId) const override;
+    EdgeList getOutgoingEdges(const Node::NodeId& nodeId) const override;
+    std::vector<NodePtr> getAllNodes() const override;
+    std::vector<EdgePtr> getAllEdges() const override;
+    size_t getNodeCount() const override { return nodeCount_; }
+    size_t getEdgeCount() const override { return edgeCount_; }
+    
+    /**
+     * @brief Get the version number; each published update adds one.
+     */
+    uint64_t getVersion() const { return version_; }
+
+private:
+    friend class ConcurrentGraph;
+    
+    struct NodeEntry {
+        NodePtr node;
+        EdgeList outgoing;
+    };
+    
+    using NodeBlock = std::unordered_map<Node::NodeId, NodeEntry>;
+    using EdgeBlock = std::unordered_map<Edge::EdgeId, EdgePtr>;
+    
+    std::vector<std::shared_ptr<const NodeBlock>> nodeBlocks_; ///< Power-of-two count
+    std::vector<std::shared_ptr<const EdgeBlock>> edgeBlocks_; ///< Power-of-two count
+    size_t nodeCount_ = 0;
+    size_t edgeCount_ = 0;
+    uint64_t version_ = 0;
+    
+    size_t nodeBlockOf(const Node::NodeId& nodeId) const {
+        return std::hash<Node::NodeId>()(nodeId) & (nodeBlocks_.size() - 1);
+    }
+    
+    size_t edgeBlockOf(const Edge::EdgeId& edgeId) const {
+        return std::hash<Edge::EdgeId>()(edgeId) & (edgeBlocks_.size() - 1);
+    }
+    
+    const NodeEntry* findNode(const Node::NodeId& nodeId) const;
+};
+
+/**
+ * @class ConcurrentGraph
+ * @brief A graph that is queried by many threads while it is being edited.
+ * 
+ * Readers pin the current GraphSnapshot with read() and search it like any
+ * other GraphView; it does not change while pinned. Pinning takes no lock:
+ * the reader announces the epoch it started in, in a slot of its own, and
+ * loads the snapshot pointer.
+ * 
+ * Writers are serialized by a mutex. Each update is built on the current
+ * version by copying only the blocks it changes, then published with one
+ * atomic pointer swap, so later reads see it at once. The replaced version
+ * is retired and freed once no reader that started before the swap still
+ * pins it (epoch-based reclamation).
+ * 
+ * The edits behave like those of Graph. update() groups several edits into
+ * one version; if it throws, nothing is published.
+ */
+class ConcurrentGraph {
+public:
+    static constexpr size_t MAX_READERS = 256;    ///< Snapshots that can be pinned at once
+    static constexpr size_t NODES_PER_BLOCK = 64; ///< Target block size, which bounds the copy per edit
+    
+    class Batch;
+    
+    /**
+     * @class ReadGuard
+     * @brief Keeps a snapshot alive while a reader uses it.
+     * 
+     * Keep guards short-lived (one query): a pinned snapshot delays the
+     * freeing of every version retired after it.
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : slot_(std::exchange(other.slot_, nullptr)), snapshot_(other.snapshot_) {}
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard();
+        
+        const GraphSnapshot& operator*() const { return *snapshot_; }
+        const GraphSnapshot* operator->() const { return snapshot_; }
+    
+    private:
+        friend class ConcurrentGraph;
+        
+        ReadGuard(std::atomic<uint64_t>* slot, const GraphSnapshot* snapshot) : slot_(slot), snapshot_(snapshot) {}
+        
+        std::atomic<uint64_t>* slot_;
+        const GraphSnapshot* snapshot_;
+    };
+    
+    /**
+     * @brief Constructs an empty graph.
+     * @param expectedNodes Expected number of nodes, which sizes the first blocks
+     * @param expectedEdges Expected number of edges, which sizes the first blocks
+     */
+    explicit ConcurrentGraph(size_t expectedNodes = 0, size_t expectedEdges = 0);
+    
+    /**
+     * @brief Constructs a graph with the nodes and edges of a Graph.
+     * @param graph Initial contents (its nodes and edges are shared, not copied)
+     */
+    explicit ConcurrentGraph(const Graph& graph);
+    
+    /**
+     * @brief Frees every version; no ReadGuard may outlive the graph.
+     */
+    ~ConcurrentGraph();
+    
+    ConcurrentGraph(const ConcurrentGraph&) = delete;
+    ConcurrentGraph& operator=(const ConcurrentGraph&) = delete;
+    
+    /**
+     * @brief Pin the current version.
+     * 
+     * Spins if MAX_READERS guards are already alive.
+     * 
+     * @return Guard giving access to the snapshot
+     */
+    ReadGuard read() const;
+    
+    bool addNode(NodePtr node);
+    bool removeNode(const Node::NodeId& nodeId);
+    bool addEdge(EdgePtr edge);
+    bool removeEdge(const Edge::EdgeId& edgeId);
+    
+    /**
+     * @brief Replace an edge by one with the same ID and endpoints, e.g. with new weights.
+     * @param edge Replacement edge
+     * @return true if an edge with that ID and those endpoints was replaced
+     */
+    bool replaceEdge(EdgePtr edge);
+    
+    /**
+     * @brief Apply several edits and publish them as one version.
+     * @param edits Callable taking a Batch&
+     * @return The version number after the update (unchanged if no edit succeeded)
+     */
+    template <typename Edits>
+    uint64_t update(Edits&& edits);
+    
+    /**
+     * @brief Get the number of the latest published version.
+     */
+    uint64_t getVersion() const { return version_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief Get the number of replaced versions still waiting for readers to finish.
+     */
+    size_t getRetiredCount() const;
+    
+    /**
+     * @brief Free the replaced versions no reader pins any more.
+     * 
+     * Updates do this themselves; call it to release memory when updates stop.
+     */
+    void reclaim();
+
+private:
+    /**
+     * @brief A reader's announced epoch, on a cache line of its own; 0 when free.
+     */
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};
+    };
+    
+    struct Retired {
+        uint64_t epoch; ///< Epoch that began after the snapshot was replaced
+        std::unique_ptr<const GraphSnapshot> snapshot;
+    };
+    
+    std::atomic<const GraphSnapshot*> current_;
+    std::atomic<uint64_t> epoch_{1};
+    std::atomic<uint64_t> version_{0};
+    mutable std::array<ReaderSlot, MAX_READERS> readers_;
+    
+    mutable std::mutex writeMutex_;
+    std::vector<Retired> retired_; ///< Guarded by writeMutex_
+    
+    uint64_t publish(Batch& batch);
+    void reclaimLocked();
+};
+
+/**
+ * @class ConcurrentGraph::Batch
+ * @brief Edits being prepared for the next version of a ConcurrentGraph.
+ * 
+ * Each block is copied the first time an edit touches it; later edits in
+ * the same batch change the copy in place.
+ */
+class ConcurrentGraph::Batch {
+public:
+    bool addNode(NodePtr node);
+    bool removeNode(const Node::NodeId& nodeId);
+    bool addEdge(EdgePtr edge);
+    bool removeEdge(const Edge::EdgeId& edgeId);
+    bool replaceEdge(EdgePtr edge);
+    
+    bool hasNode(const Node::NodeId& nodeId) const { return next_->findNode(nodeId) != nullptr; }
+    bool hasEdge(const Edge::EdgeId& edgeId) const { return next_->getEdge(edgeId) != nullptr; }
+
+private:
+    friend class ConcurrentGraph;
+    
+    explicit Batch(const GraphSnapshot& base);
+    
+    std::unique_ptr<GraphSnapshot> next_;
+    std::vector<GraphSnapshot::NodeBlock*> writableNodes_; ///< Copied blocks; nullptr if still shared
+    std::vector<GraphSnapshot::EdgeBlock*> writableEdges_;
+    bool changed_ = false;
+    
+    GraphSnapshot::NodeBlock& writableNodeBlock(size_t block);
+    GraphSnapshot::EdgeBlock& writableEdgeBlock(size_t block);
+    void eraseFromIndex(const Edge::EdgeId& edgeId);
+    
+    /**
+     * @brief Split the nodes or edges into more blocks if they have outgrown them.
+     * 
+     * Copies every block it splits, so the version being built shares none of them.
+     */
+    void growBlocks();
+};
+
+template <typename Edits>
+uint64_t ConcurrentGraph::update(Edits&& edits) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    Batch batch(*current_.load(std::memory_order_relaxed));
+    edits(batch);
+    return publish(batch);
+}
+
+} // namespace graph
+} // namespace dijkstra
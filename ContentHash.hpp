@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class ContentHasher
+ * @brief Fast, non-cryptographic 64-bit hash over a sequence of byte ranges.
+ * 
+ * Consumes eight bytes per step, so hashing a multi-gigabyte graph runs at
+ * memory bandwidth. Meant for detecting stale or mismatched files, not for
+ * protecting against deliberate tampering.
+ */
+class ContentHasher {
+public:
+    /**
+     * @brief Mix a byte range into the hash.
+     * @param data Start of the range
+     * @param length Length in bytes
+     */
+    void update(const void* data, size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t h = SEED ^ (length * MULTIPLIER);
+        
+        while (length >= 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            h = (h ^ mix(word)) * MULTIPLIER;
+            bytes += 8;
+            length -= 8;
+        }
+        
+        uint64_t tail = 0;
+        std::memcpy(&tail, bytes, length);
+        h = (h ^ mix(tail)) * MULTIPLIER;
+        
+        state_ = mix(state_ ^ h) + MULTIPLIER;
+    }
+    
+    /**
+     * @brief Get the hash of everything consumed so far.
+     * @return 64-bit hash value
+     */
+    uint64_t finish() const { return mix(state_); }
+
+private:
+    static constexpr uint64_t SEED = 0x9E3779B97F4A7C15ULL;
+    static constexpr uint64_t MULTIPLIER = 0xFF51AFD7ED558CCDULL;
+    
+    uint64_t state_ = SEED;
+    
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ULL;
+        value ^= value >> 29;
+        value *= 0xFF51AFD7ED558CCDULL;
+        value ^= value >> 32;
+        return value;
+    }
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,320 @@
+#include "CsvEdgeLoader.hpp"
+#include "MappedFile.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+
+/**
+ * @class InternTable
+ * @brief Concurrent string-to-code table split into independently locked shards.
+ * 
+ * Each shard is an open-addressing table whose entries carry the full hash and
+ * the first bytes of the key, so a lookup normally touches one cache line and
+ * never the mapped file. Keys are views into the mapping and are not copied
+ * beyond that prefix. A code packs the shard in its low bits and the key's
+ * slot within the shard above them. Each key remembers its earliest
+ * occurrence, i.e. the lowest address it was interned from.
+ */
+class InternTable {
+public:
+    static constexpr unsigned SHARD_BITS = 6;
+    static constexpr size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+    static constexpr size_t MAX_SLOTS = size_t(1) << (32 - SHARD_BITS);
+    
+    /**
+     * @brief A key and the code it was given.
+     */
+    struct Key {
+        std::string_view text; ///< Earliest occurrence in the mapping
+        uint32_t code;
+    };
+    
+    InternTable() : shards_(SHARD_COUNT) {}
+    
+    uint32_t intern(std::string_view key) {
+        const uint64_t hash = std::hash<std::string_view>()(key);
+        const auto shardIndex = static_cast<uint32_t>(hash >> (64 - SHARD_BITS));
+        Shard& shard = shards_[shardIndex];
+        
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if ((shard.count + 1) * 2 > shard.entries.size()) {
+            shard.grow();
+        }
+        const size_t mask = shard.entries.size() - 1;
+        for (size_t position = hash & mask;; position = (position + 1) & mask) {
+            Entry& entry = shard.entries[position];
+            if (!entry.key) {
+                if (shard.count >= MAX_SLOTS) {
+                    throw std::runtime_error("Too many distinct node IDs");
+                }
+                entry.hash = hash;
+                entry.key = key.data();
+                entry.length = static_cast<uint32_t>(key.size());
+                entry.slot = static_cast<uint32_t>(shard.count++);
+                std::memcpy(entry.prefix, key.data(), std::min(key.size(), sizeof(entry.prefix)));
+                return (entry.slot << SHARD_BITS) | shardIndex;
+            }
+            if (entry.hash == hash && entry.matches(key)) {
+                if (std::less<const char*>()(key.data(), entry.key)) {
+                    entry.key = key.data();
+                }
+                return (entry.slot << SHARD_BITS) | shardIndex;
+            }
+        }
+    }
+    
+    static uint32_t shardOf(uint32_t code) { return code & (SHARD_COUNT - 1); }
+    static uint32_t slotOf(uint32_t code) { return code >> SHARD_BITS; }
+    
+    size_t shardSize(uint32_t shard) const { return shards_[shard].count; }
+    
+    /**
+     * @brief List every key, in no particular order. Not thread-safe.
+     */
+    std::vector<Key> keys() const {
+        std::vector<Key> result;
+        for (uint32_t shardIndex = 0; shardIndex < SHARD_COUNT; ++shardIndex) {
+            for (const Entry& entry : shards_[shardIndex].entries) {
+                if (entry.key) {
+                    result.push_back({std::string_view(entry.key, entry.length),
+                                      (entry.slot << SHARD_BITS) | shardIndex});
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        uint64_t hash = 0;
+        const char* key = nullptr; ///< nullptr marks a free entry
+        uint32_t length = 0;
+        uint32_t slot = 0;
+        char prefix[16] = {};
+        
+        bool matches(std::string_view other) const {
+            if (other.size() != length) {
+                return false;
+            }
+            if (length <= sizeof(prefix)) {
+                return std::memcmp(prefix, other.data(), length) == 0;
+            }
+            return std::memcmp(prefix, other.data(), sizeof(prefix)) == 0 &&
+                   std::memcmp(key + sizeof(prefix), other.data() + sizeof(prefix), length - sizeof(prefix)) == 0;
+        }
+    };
+    
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        size_t count = 0;
+        
+        void grow() {
+            std::vector<Entry> old(std::max<size_t>(entries.size() * 2, 1024));
+            old.swap(entries);
+            const size_t mask = entries.size() - 1;
+            for (const Entry& entry : old) {
+                if (entry.key) {
+                    size_t position = entry.hash & mask;
+                    while (entries[position].key) {
+                        position = (position + 1) & mask;
+                    }
+                    entries[position] = entry;
+                }
+            }
+        }
+    };
+    
+    std::vector<Shard> shards_;
+};
+
+/**
+ * @brief A run of whole lines.
+ */
+struct Chunk {
+    size_t begin;
+    size_t end;
+};
+
+std::string_view trim(std::string_view field) {
+    while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) {
+        field.remove_prefix(1);
+    }
+    while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+        field.remove_suffix(1);
+    }
+    return field;
+}
+
+std::string_view unquote(std::string_view field) {
+    field = trim(field);
+    if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+        field = field.substr(1, field.size() - 2);
+    }
+    return field;
+}
+
+bool parseNumber(std::string_view field, double& value) {
+    field = trim(field);
+    if (field.empty()) {
+        value = 0.0;
+        return true;
+    }
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+/**
+ * @brief Cut the next comma-separated field off the front of a line.
+ */
+std::string_view nextField(std::string_view& line) {
+    const void* comma = line.empty() ? nullptr : std::memchr(line.data(), ',', line.size());
+    if (!comma) {
+        std::string_view field = line;
+        line = std::string_view();
+        return field;
+    }
+    size_t length = static_cast<size_t>(static_cast<const char*>(comma) - line.data());
+    std::string_view field = line.substr(0, length);
+    line.remove_prefix(length + 1);
+    return field;
+}
+
+[[noreturn]] void malformedLine(const char* data, size_t offset, const std::string& filePath,
+                                const std::string& reason) {
+    size_t line = 1 + static_cast<size_t>(std::count(data, data + offset, '\n'));
+    throw std::runtime_error("Malformed edge on line " + std::to_string(line) + " of " + filePath + ": " + reason);
+}
+
+/**
+ * @brief Parse the lines of one chunk into a batch whose endpoints are intern codes.
+ */
+void parseChunk(const char* data, const Chunk& chunk, const std::string& filePath,
+                InternTable& table, graph::EdgeBatch& batch) {
+    batch.reserve((chunk.end - chunk.begin) / 24);
+    size_t position = chunk.begin;
+    
+    while (position < chunk.end) {
+        const void* lineBreak = std::memchr(data + position, '\n', chunk.end - position);
+        size_t lineEnd = lineBreak ? static_cast<size_t>(static_cast<const char*>(lineBreak) - data) : chunk.end;
+        std::string_view line(data + position, lineEnd - position);
+        size_t lineBegin = position;
+        position = lineEnd + 1;
+        if (trim(line).empty()) {
+            continue;
+        }
+        
+        std::string_view source = unquote(nextField(line));
+        std::string_view destination = unquote(nextField(line));
+        std::string_view distanceField = nextField(line);
+        if (source.empty() || destination.empty() || trim(distanceField).empty()) {
+            malformedLine(data, lineBegin, filePath, "expected source,destination,distance");
+        }
+        
+        double distance = 0.0;
+        double time = 0.0;
+        double cost = 0.0;
+        if (!parseNumber(distanceField, distance) || !parseNumber(nextField(line), time) ||
+            !parseNumber(nextField(line), cost)) {
+            malformedLine(data, lineBegin, filePath, "invalid number");
+        }
+        
+        batch.add(std::string_view(), table.intern(source), table.intern(destination), distance, time, cost);
+    }
+}
+
+} // namespace
+
+CsvEdgeLoader::CsvEdgeLoader(unsigned threads, size_t chunkBytes)
+    : threads_(util::resolveThreadCount(threads)), chunkBytes_(std::max<size_t>(chunkBytes, 1)) {
+}
+
+graph::CompactGraph CsvEdgeLoader::load(const std::string& filePath) {
+    MappedFile file(filePath);
+    file.adviseSequential();
+    const char* data = file.data();
+    const size_t size = file.size();
+    bytesRead_ = size;
+    
+    // Skip a UTF-8 byte order mark and a header line
+    size_t begin = (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+    if (begin < size) {
+        const void* lineBreak = std::memchr(data + begin, '\n', size - begin);
+        size_t firstEnd = lineBreak ? static_cast<size_t>(static_cast<const char*>(lineBreak) - data) : size;
+        std::string_view line(data + begin, firstEnd - begin);
+        nextField(line);
+        nextField(line);
+        double distance = 0.0;
+        auto distanceField = trim(nextField(line));
+        if (!distanceField.empty() && !parseNumber(distanceField, distance)) {
+            begin = std::min(firstEnd + 1, size);
+        }
+    }
+    
+    std::vector<Chunk> chunks;
+    for (size_t chunkBegin = begin; chunkBegin < size;) {
+        size_t chunkEnd = std::min(chunkBegin + chunkBytes_, size);
+        const void* lineBreak = std::memchr(data + chunkEnd - 1, '\n', size - chunkEnd + 1);
+        chunkEnd = lineBreak ? static_cast<size_t>(static_cast<const char*>(lineBreak) - data) + 1 : size;
+        chunks.push_back({chunkBegin, chunkEnd});
+        chunkBegin = chunkEnd;
+    }
+    chunkCount_ = chunks.size();
+    
+    // Parse and intern in parallel
+    InternTable table;
+    std::vector<graph::EdgeBatch> batches(chunks.size());
+    util::parallelForEach(chunks.size(), threads_, [&](size_t item, unsigned) {
+        parseChunk(data, chunks[item], filePath, table, batches[item]);
+    });
+    
+    // Number the nodes by first appearance
+    std::vector<InternTable::Key> keys = table.keys();
+    util::parallelSort(keys, threads_, [](const InternTable::Key& a, const InternTable::Key& b) {
+        return std::less<const char*>()(a.text.data(), b.text.data());
+    });
+    
+    std::vector<std::vector<Index>> remap(InternTable::SHARD_COUNT);
+    for (uint32_t shard = 0; shard < InternTable::SHARD_COUNT; ++shard) {
+        remap[shard].resize(table.shardSize(shard));
+    }
+    graph::CompactGraphBuilder builder;
+    builder.reserve(keys.size(), 0);
+    for (const auto& key : keys) {
+        remap[InternTable::shardOf(key.code)][InternTable::slotOf(key.code)] = builder.addNode(key.text);
+    }
+    nodesLoaded_ = builder.getNodeCount();
+    
+    // Swap intern codes for node indices, then pack in parallel
+    util::parallelForEach(batches.size(), threads_, [&](size_t item, unsigned) {
+        auto& batch = batches[item];
+        for (auto* endpoints : {&batch.sources, &batch.targets}) {
+            for (auto& code : *endpoints) {
+                code = remap[InternTable::shardOf(code)][InternTable::slotOf(code)];
+            }
+        }
+    });
+    builder.appendEdges(batches, threads_);
+    edgesLoaded_ = builder.getEdgeCount();
+    batches.clear();
+    
+    return builder.build(threads_);
+}
+
+} // namespace data
+} // namespace dijkstra
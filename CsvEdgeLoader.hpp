@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "../graph/CompactGraph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class CsvEdgeLoader
+ * @brief Loads a plain `source,destination,distance[,time[,cost]]` edge list into a CompactGraph.
+ * 
+ * Nodes are implied by the edges. The file is memory-mapped and cut into
+ * chunks at line breaks, and each chunk is parsed on a worker thread, with
+ * numbers read by std::from_chars. Node IDs are interned straight from the
+ * mapping into a hash table split into independently locked shards, so
+ * threads rarely wait on each other. Nodes are numbered in order of first
+ * appearance in the file, which makes the graph identical for every thread
+ * count.
+ * 
+ * An optional header line is recognized by a non-numeric distance. IDs may
+ * be wrapped in double quotes but cannot contain commas or line breaks.
+ * Empty time or cost fields count as zero.
+ */
+class CsvEdgeLoader {
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 4 << 20; ///< Target bytes per parse chunk
+    
+    /**
+     * @brief Constructs a loader.
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @param chunkBytes Target size of each parse chunk
+     */
+    explicit CsvEdgeLoader(unsigned threads = 0, size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+    
+    /**
+     * @brief Load an edge list.
+     * @param filePath Path to the CSV file
+     * @return The loaded graph
+     * @throws std::runtime_error if the file cannot be read or a line is malformed
+     */
+    graph::CompactGraph load(const std::string& filePath);
+    
+    size_t getBytesRead() const { return bytesRead_; }
+    size_t getNodesLoaded() const { return nodesLoaded_; }
+    size_t getEdgesLoaded() const { return edgesLoaded_; }
+    size_t getChunkCount() const { return chunkCount_; }
+    unsigned getThreadCount() const { return threads_; }
+
+private:
+    unsigned threads_;
+    size_t chunkBytes_;
+    
+    size_t bytesRead_ = 0;
+    size_t nodesLoaded_ = 0;
+    size_t edgesLoaded_ = 0;
+    size_t chunkCount_ = 0;
+};
+
+} // namespace data
+} // namespace dijkstra
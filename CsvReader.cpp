@@ -0,0 +1,215 @@
+#include "CsvReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+constexpr size_t MIN_BUFFER_BYTES = 4096;
+
+std::string_view trim(std::string_view text) {
+    const char* whitespace = " \t";
+    size_t first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace
+
+CsvReader::CsvReader(const std::string& filePath, uint64_t begin, uint64_t end, size_t bufferBytes)
+    : path_(filePath), file_(filePath, std::ios::binary), end_(end),
+      buffer_(std::max(bufferBytes, MIN_BUFFER_BYTES)) {
+    if (!file_.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+    
+    if (begin == 0) {
+        refill();
+        if (filled_ >= 3 && std::memcmp(buffer_.data(), "\xEF\xBB\xBF", 3) == 0) {
+            position_ = 3; // UTF-8 byte order mark
+        }
+        return;
+    }
+    
+    // Rows belong to the range they start in. Starting one byte early means a
+    // row beginning exactly at `begin` is preceded by the line break skipped here.
+    file_.seekg(static_cast<std::streamoff>(begin - 1));
+    bufferOffset_ = begin - 1;
+    while (position_ < filled_ || refill()) {
+        const void* lineBreak = std::memchr(buffer_.data() + position_, '\n', filled_ - position_);
+        if (lineBreak) {
+            position_ = static_cast<size_t>(static_cast<const char*>(lineBreak) - buffer_.data()) + 1;
+            break;
+        }
+        position_ = filled_;
+    }
+}
+
+bool CsvReader::readHeader() {
+    if (!next()) {
+        return false;
+    }
+    header_.clear();
+    for (auto field : fields_) {
+        header_.emplace_back(trim(field));
+    }
+    return true;
+}
+
+bool CsvReader::next() {
+    fields_.clear();
+    
+    while (true) {
+        if (position_ == filled_ && !refill()) {
+            return false;
+        }
+        if (bufferOffset_ + position_ >= end_) {
+            return false;
+        }
+        
+        bool quoted = false;
+        size_t rowEnd = findRowEnd(position_, quoted);
+        while (rowEnd == NOT_FOUND) {
+            // refill() moves the partial row to the front of the buffer
+            if (!refill()) {
+                rowEnd = filled_; // Last row without a trailing line break
+                break;
+            }
+            quoted = false;
+            rowEnd = findRowEnd(position_, quoted);
+        }
+        
+        size_t rowBegin = position_;
+        position_ = (rowEnd < filled_) ? rowEnd + 1 : filled_;
+        if (rowEnd > rowBegin && buffer_[rowEnd - 1] == '\r') {
+            --rowEnd;
+        }
+        if (rowEnd == rowBegin) {
+            continue; // Blank line
+        }
+        
+        splitRow(rowBegin, rowEnd, quoted);
+        ++rowsRead_;
+        return true;
+    }
+}
+
+size_t CsvReader::findColumn(std::string_view name) const {
+    for (size_t i = 0; i < header_.size(); ++i) {
+        if (header_[i] == name) {
+            return i;
+        }
+    }
+    return NO_COLUMN;
+}
+
+bool CsvReader::refill() {
+    if (eof_) {
+        return false;
+    }
+    
+    // Keep the unread tail, and grow only if it already fills the whole buffer
+    size_t unread = filled_ - position_;
+    if (position_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + position_, unread);
+        bufferOffset_ += position_;
+        position_ = 0;
+        filled_ = unread;
+    }
+    if (filled_ == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+    
+    file_.read(buffer_.data() + filled_, static_cast<std::streamsize>(buffer_.size() - filled_));
+    size_t count = static_cast<size_t>(file_.gcount());
+    if (file_.bad()) {
+        throw std::runtime_error("Failed to read file: " + path_);
+    }
+    if (count == 0) {
+        eof_ = true;
+        return false;
+    }
+    filled_ += count;
+    return true;
+}
+
+size_t CsvReader::findRowEnd(size_t from, bool& quoted) {
+    const char* data = buffer_.data();
+    size_t i = from;
+    
+    while (i < filled_) {
+        // Outside quotes the row ends at the next line break, unless a quote comes first
+        const void* lineBreak = std::memchr(data + i, '\n', filled_ - i);
+        size_t limit = lineBreak ? static_cast<size_t>(static_cast<const char*>(lineBreak) - data) : filled_;
+        const void* quote = std::memchr(data + i, '"', limit - i);
+        if (!quote) {
+            return lineBreak ? limit : NOT_FOUND;
+        }
+        quoted = true;
+        i = static_cast<size_t>(static_cast<const char*>(quote) - data) + 1;
+        
+        // Inside quotes only another quote matters; a doubled quote simply
+        // closes and reopens the field
+        const void* closing = std::memchr(data + i, '"', filled_ - i);
+        if (!closing) {
+            return NOT_FOUND;
+        }
+        size_t closingIndex = static_cast<size_t>(static_cast<const char*>(closing) - data);
+        if (std::memchr(data + i, '\n', closingIndex - i)) {
+            quotedLineBreak_ = true;
+        }
+        i = closingIndex + 1;
+    }
+    return NOT_FOUND;
+}
+
+void CsvReader::splitRow(size_t begin, size_t end, bool quoted) {
+    char* data = buffer_.data();
+    size_t i = begin;
+    
+    while (true) {
+        if (quoted && i < end && data[i] == '"') {
+            // Unescape in place; the result is never longer than the input
+            size_t fieldBegin = i;
+            size_t out = i;
+            ++i;
+            while (i < end) {
+                if (data[i] == '"') {
+                    if (i + 1 < end && data[i + 1] == '"') {
+                        data[out++] = '"';
+                        i += 2;
+                        continue;
+                    }
+                    ++i;
+                    break;
+                }
+                data[out++] = data[i++];
+            }
+            // Be lenient about text between the closing quote and the comma
+            while (i < end && data[i] != ',') {
+                data[out++] = data[i++];
+            }
+            fields_.emplace_back(data + fieldBegin, out - fieldBegin);
+        } else {
+            const void* comma = std::memchr(data + i, ',', end - i);
+            size_t fieldEnd = comma ? static_cast<size_t>(static_cast<const char*>(comma) - data) : end;
+            fields_.emplace_back(data + i, fieldEnd - i);
+            i = fieldEnd;
+        }
+        
+        if (i >= end) {
+            break;
+        }
+        ++i; // Skip the comma; a trailing one yields an empty last field
+    }
+}
+
+} // namespace data
+} // namespace dijkstra
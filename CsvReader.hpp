@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class CsvReader
+ * @brief Streaming reader for RFC 4180 comma-separated files.
+ * 
+ * The file is read through a fixed-size buffer that only grows if a single row
+ * does not fit, so memory use does not depend on the file size. Quoted fields
+ * may contain commas, doubled quotes and line breaks; CRLF line endings, a
+ * UTF-8 byte order mark and blank lines are accepted.
+ * 
+ * A reader can be limited to the rows that start inside a byte range, which
+ * lets several readers split one file between them. Range boundaries are
+ * aligned to line breaks, which is only safe if no quoted field contains one;
+ * hasQuotedLineBreak() reports whether a reader came across such a field.
+ * 
+ * Field views returned by operator[] stay valid until the next call to next().
+ */
+class CsvReader {
+public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 1 << 20; ///< Initial read buffer size
+    static constexpr uint64_t END_OF_FILE = std::numeric_limits<uint64_t>::max();
+    static constexpr size_t NO_COLUMN = std::numeric_limits<size_t>::max();
+    
+    /**
+     * @brief Open a file for reading.
+     * @param filePath Path to the CSV file
+     * @param begin Offset of the first byte of the range to read
+     * @param end Offset just past the range; rows starting before it are read whole
+     * @param bufferBytes Initial size of the read buffer
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    explicit CsvReader(const std::string& filePath, uint64_t begin = 0, uint64_t end = END_OF_FILE,
+                       size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+    
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+    
+    /**
+     * @brief Read the next row as the header, for use with findColumn().
+     * @return true if a header row was read, false if the range is empty
+     */
+    bool readHeader();
+    
+    /**
+     * @brief Advance to the next row.
+     * @return true if a row was read, false at the end of the range
+     * @throws std::runtime_error if reading the file fails
+     */
+    bool next();
+    
+    size_t size() const { return fields_.size(); }
+    
+    /**
+     * @brief Get a field of the current row.
+     * @param column Column index
+     * @return Field contents, or an empty view if the row is shorter
+     */
+    std::string_view operator[](size_t column) const {
+        return column < fields_.size() ? fields_[column] : std::string_view();
+    }
+    
+    /**
+     * @brief Look up a column by its header name.
+     * @param name Column name
+     * @return Column index, or NO_COLUMN if the header does not have it
+     */
+    size_t findColumn(std::string_view name) const;
+    
+    const std::vector<std::string>& getHeader() const { return header_; }
+    
+    /**
+     * @brief Get the file offset just past the last row read.
+     * @return Offset in bytes
+     */
+    uint64_t getOffset() const { return bufferOffset_ + position_; }
+    
+    uint64_t getRowsRead() const { return rowsRead_; }
+    bool hasQuotedLineBreak() const { return quotedLineBreak_; }
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    std::ifstream file_;
+    uint64_t end_;
+    
+    std::vector<char> buffer_;
+    uint64_t bufferOffset_ = 0; ///< File offset of buffer_[0]
+    size_t position_ = 0;       ///< Start of the unread part of the buffer
+    size_t filled_ = 0;         ///< Number of valid bytes in the buffer
+    bool eof_ = false;
+    
+    std::vector<std::string_view> fields_;
+    std::vector<std::string> header_;
+    uint64_t rowsRead_ = 0;
+    bool quotedLineBreak_ = false;
+    
+    bool refill();
+    size_t findRowEnd(size_t from, bool& quoted);
+    void splitRow(size_t begin, size_t end, bool quoted);
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -23,12 +23,19 @@ bool Graph::removeNode(const Node::NodeId& nodeId) {
     // Remove all edges connected to this node
     edges_.erase(
         std::remove_if(edges_.begin(), edges_.end(),
-            [&nodeId](const EdgePtr& edge) {
-                return edge->getSource()->getId() == nodeId || 
-                       edge->getDestination()->getId() == nodeId;
+            [this, &nodeId](const EdgePtr& edge) {
+                if (edge->getSource()->getId() == nodeId || 
+                    edge->getDestination()->getId() == nodeId) {
+                    edgeIndex_.erase(edge->getId());
+                    return true;
+                }
+                return false;
             }),
         edges_.end()
     );
+    for (size_t position = 0; position < edges_.size(); ++position) {
+        edgeIndex_[edges_[position]->getId()] = position;
+    }
     
     // Remove from adjacency list
     adjacencyList_.erase(nodeId);
@@ -65,12 +72,7 @@ bool Graph::addEdge(EdgePtr edge) {
     }
     
     // Check if edge already exists
-    auto it = std::find_if(edges_.begin(), edges_.end(),
-        [&edge](const EdgePtr& existingEdge) {
-            return existingEdge->getId() == edge->getId();
-        });
-    
-    if (it != edges_.end()) {
+    if (!edgeIndex_.emplace(edge->getId(), edges_.size()).second) {
         return false; // Edge already exists
     }
     
@@ -80,30 +82,26 @@ bool Graph::addEdge(EdgePtr edge) {
 }
 
 bool Graph::removeEdge(const Edge::EdgeId& edgeId) {
-    auto it = std::find_if(edges_.begin(), edges_.end(),
-        [&edgeId](const EdgePtr& edge) {
-            return edge->getId() == edgeId;
-        });
-    
-    if (it == edges_.end()) {
+    auto indexIt = edgeIndex_.find(edgeId);
+    if (indexIt == edgeIndex_.end()) {
         return false; // Edge doesn't exist
     }
     
-    EdgePtr edge = *it;
+    size_t position = indexIt->second;
+    edgeIndex_.erase(indexIt);
+    EdgePtr edge = edges_[position];
     const auto& sourceId = edge->getSource()->getId();
     
     // Remove from adjacency list
     auto& edgeList = adjacencyList_[sourceId];
-    edgeList.erase(
-        std::remove_if(edgeList.begin(), edgeList.end(),
-            [&edgeId](const EdgePtr& e) {
-                return e->getId() == edgeId;
-            }),
-        edgeList.end()
-    );
+    edgeList.erase(std::find(edgeList.begin(), edgeList.end(), edge));
     
-    // Remove from edges list
-    edges_.erase(it);
+    // Move the last edge into the hole instead of shifting the whole list
+    if (position + 1 != edges_.size()) {
+        edges_[position] = std::move(edges_.back());
+        edgeIndex_[edges_[position]->getId()] = position;
+    }
+    edges_.pop_back();
     return true;
 }
 
@@ -112,6 +110,11 @@ NodePtr Graph::getNode(const Node::NodeId& nodeId) const {
     return (it != nodes_.end()) ? it->second : nullptr;
 }
 
+EdgePtr Graph::getEdge(const Edge::EdgeId& edgeId) const {
+    auto it = edgeIndex_.find(edgeId);
+    return (it != edgeIndex_.end()) ? edges_[it->second] : nullptr;
+}
+
 Graph::EdgeList Graph::getOutgoingEdges(const Node::NodeId& nodeId) const {
     auto it = adjacencyList_.find(nodeId);
     return (it != adjacencyList_.end()) ? it->second : EdgeList();
@@ -136,6 +139,14 @@ void Graph::clear() {
     nodes_.clear();
     adjacencyList_.clear();
     edges_.clear();
+    edgeIndex_.clear();
+}
+
+void Graph::reserve(size_t nodeCount, size_t edgeCount) {
+    nodes_.reserve(nodeCount);
+    adjacencyList_.reserve(nodeCount);
+    edges_.reserve(edgeCount);
+    edgeIndex_.reserve(edgeCount);
 }
 
 } // namespace graph
@@ -4,8 +4,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
-#include "Node.hpp"
-#include "Edge.hpp"
+#include "GraphView.hpp"
 
 namespace dijkstra {
 namespace graph {
@@ -16,23 +15,21 @@ namespace graph {
  * 
  * This graph supports nodes and edges with multiple weight criteria,
  * making it suitable for complex travel planning scenarios.
+ * 
+ * Not thread-safe: reads must not overlap edits. ConcurrentGraph offers
+ * lock-free reads of snapshots while edits are published.
  */
-class Graph {
+class Graph : public GraphView {
 public:
     using NodeMap = std::unordered_map<Node::NodeId, NodePtr>;
-    using EdgeList = std::vector<EdgePtr>;
     using AdjacencyList = std::unordered_map<Node::NodeId, EdgeList>;
+    using EdgeIndex = std::unordered_map<Edge::EdgeId, size_t>;
     
     /**
      * @brief Default constructor.
      */
     Graph() = default;
     
-    /**
-     * @brief Virtual destructor.
-     */
-    virtual ~Graph() = default;
-    
     /**
      * @brief Add a node to the graph.
      * @param node Shared pointer to the node to add
@@ -55,7 +52,10 @@ public:
     bool addEdge(EdgePtr edge);
     
     /**
-     * @brief Remove an edge from the graph.
+     * @brief Remove an edge from the graph in time proportional to its source's degree.
+     * 
+     * The last edge of getAllEdges() takes the removed edge's place.
+     * 
      * @param edgeId ID of the edge to remove
      * @return true if the edge was removed successfully, false if it doesn't exist
      */
@@ -66,38 +66,45 @@ public:
      * @param nodeId ID of the node to retrieve
      * @return Shared pointer to the node, or nullptr if not found
      */
-    NodePtr getNode(const Node::NodeId& nodeId) const;
+    NodePtr getNode(const Node::NodeId& nodeId) const override;
+    
+    /**
+     * @brief Get an edge by its ID.
+     * @param edgeId ID of the edge to retrieve
+     * @return Shared pointer to the edge, or nullptr if not found
+     */
+    EdgePtr getEdge(const Edge::EdgeId& edgeId) const override;
     
     /**
      * @brief Get all edges originating from a specific node.
      * @param nodeId ID of the source node
      * @return Vector of edges originating from the node
      */
-    EdgeList getOutgoingEdges(const Node::NodeId& nodeId) const;
+    EdgeList getOutgoingEdges(const Node::NodeId& nodeId) const override;
     
     /**
      * @brief Get all nodes in the graph.
      * @return Vector of all nodes
      */
-    std::vector<NodePtr> getAllNodes() const;
+    std::vector<NodePtr> getAllNodes() const override;
     
     /**
      * @brief Get all edges in the graph.
      * @return Vector of all edges
      */
-    std::vector<EdgePtr> getAllEdges() const;
+    std::vector<EdgePtr> getAllEdges() const override;
     
     /**
      * @brief Get the number of nodes in the graph.
      * @return Number of nodes
      */
-    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getNodeCount() const override { return nodes_.size(); }
     
     /**
      * @brief Get the number of edges in the graph.
      * @return Number of edges
      */
-    size_t getEdgeCount() const { return edges_.size(); }
+    size_t getEdgeCount() const override { return edges_.size(); }
     
     /**
      * @brief Check if the graph is empty.
@@ -109,11 +116,19 @@ public:
      * @brief Clear all nodes and edges from the graph.
      */
     void clear();
+    
+    /**
+     * @brief Pre-allocate storage for bulk loading.
+     * @param nodeCount Expected number of nodes
+     * @param edgeCount Expected number of edges
+     */
+    void reserve(size_t nodeCount, size_t edgeCount);
 
 private:
     NodeMap nodes_;                  ///< Map of node IDs to node objects
     AdjacencyList adjacencyList_;    ///< Adjacency list representation
     std::vector<EdgePtr> edges_;     ///< List of all edges in the graph
+    EdgeIndex edgeIndex_;            ///< Map of edge IDs to their positions in edges_
 };
 
 } // namespace graph
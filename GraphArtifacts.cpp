@@ -0,0 +1,144 @@
+#include "GraphArtifacts.hpp"
+#include "ArtifactStore.hpp"
+#include <cmath>
+#include <limits>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+const char* const STRONG_COMPONENTS = "components.strong";
+const char* const WEAK_COMPONENTS = "components.weak";
+const char* const SPATIAL_PARAMETERS = "spatial.parameters";
+const char* const SPATIAL_OFFSETS = "spatial.offsets";
+const char* const SPATIAL_NODES = "spatial.nodes";
+
+static_assert(sizeof(graph::SpatialIndex::GridParameters) == 48,
+              "GridParameters is stored verbatim and must not change size");
+
+bool loadComponents(const ArtifactReader& reader, const std::shared_ptr<const ArtifactReader>& owner,
+                    size_t nodeCount, graph::ComponentIndex& components) {
+    const uint32_t version = graph::ComponentIndex::VERSION;
+    const uint32_t* strong = reader.find<uint32_t>(STRONG_COMPONENTS, version, nodeCount);
+    const uint32_t* weak = reader.find<uint32_t>(WEAK_COMPONENTS, version, nodeCount);
+    if (!strong || !weak) {
+        return false;
+    }
+    
+    components = graph::ComponentIndex(strong, weak, nodeCount, owner);
+    return true;
+}
+
+bool isPositiveFinite(double value) {
+    return std::isfinite(value) && value > 0.0;
+}
+
+bool loadSpatialIndex(const ArtifactReader& reader, const std::shared_ptr<const ArtifactReader>& owner,
+                      size_t nodeCount, graph::SpatialIndex& spatialIndex) {
+    using GridParameters = graph::SpatialIndex::GridParameters;
+    const uint32_t version = graph::SpatialIndex::VERSION;
+    
+    const GridParameters* params = reader.find<GridParameters>(SPATIAL_PARAMETERS, version, 1);
+    if (!params) {
+        return false;
+    }
+    if (params->rows == 0) {
+        spatialIndex = graph::SpatialIndex(); // Graph without coordinates
+        return true;
+    }
+    
+    // Sections carry no checksum of their own, so check everything the grid is indexed with
+    const size_t cellCount = size_t(params->rows) * params->columns;
+    if (params->columns == 0 || cellCount >= std::numeric_limits<size_t>::max() / sizeof(uint64_t) ||
+        !isPositiveFinite(params->cellSizeLatitude) || !isPositiveFinite(params->cellSizeLongitude) ||
+        !std::isfinite(params->minLatitude) || !std::isfinite(params->minLongitude) ||
+        !std::isfinite(params->maxAbsLatitude)) {
+        return false;
+    }
+    
+    const uint64_t* offsets = reader.find<uint64_t>(SPATIAL_OFFSETS, version, cellCount + 1);
+    if (!offsets || offsets[0] != 0 || offsets[cellCount] > nodeCount) {
+        return false;
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        if (offsets[cell] > offsets[cell + 1]) {
+            return false;
+        }
+    }
+    const graph::CompactGraph::Index* nodes =
+        reader.find<graph::CompactGraph::Index>(SPATIAL_NODES, version, offsets[cellCount]);
+    if (!nodes) {
+        return false;
+    }
+    for (uint64_t i = 0; i < offsets[cellCount]; ++i) {
+        if (nodes[i] >= nodeCount) {
+            return false;
+        }
+    }
+    
+    spatialIndex = graph::SpatialIndex(*params, offsets, nodes, owner);
+    return true;
+}
+
+} // namespace
+
+GraphArtifacts GraphArtifacts::build(const graph::CompactGraph& graph) {
+    GraphArtifacts artifacts;
+    artifacts.components_ = graph::ComponentIndex::build(graph);
+    artifacts.spatialIndex_ = graph::SpatialIndex::build(graph);
+    artifacts.builtCount_ = 2;
+    return artifacts;
+}
+
+GraphArtifacts GraphArtifacts::loadOrBuild(const graph::CompactGraph& graph, uint64_t graphHash,
+                                           const std::string& artifactPath) {
+    GraphArtifacts artifacts;
+    auto reader = ArtifactReader::open(artifactPath, graphHash);
+    const size_t nodeCount = graph.getNodeCount();
+    
+    if (reader && loadComponents(*reader, reader, nodeCount, artifacts.components_)) {
+        ++artifacts.loadedCount_;
+    } else {
+        artifacts.components_ = graph::ComponentIndex::build(graph);
+        ++artifacts.builtCount_;
+    }
+    
+    if (reader && loadSpatialIndex(*reader, reader, nodeCount, artifacts.spatialIndex_)) {
+        ++artifacts.loadedCount_;
+    } else {
+        artifacts.spatialIndex_ = graph::SpatialIndex::build(graph);
+        ++artifacts.builtCount_;
+    }
+    
+    if (artifacts.builtCount_ > 0) {
+        // Best effort: a read-only deployment still works, it just rebuilds next time
+        artifacts.save(graphHash, artifactPath);
+    }
+    
+    return artifacts;
+}
+
+bool GraphArtifacts::save(uint64_t graphHash, const std::string& artifactPath) const {
+    ArtifactWriter writer(graphHash);
+    
+    writer.add(STRONG_COMPONENTS, graph::ComponentIndex::VERSION,
+               components_.getStrongLabels(), components_.getNodeCount());
+    writer.add(WEAK_COMPONENTS, graph::ComponentIndex::VERSION,
+               components_.getWeakLabels(), components_.getNodeCount());
+    
+    const auto& params = spatialIndex_.getParameters();
+    writer.add(SPATIAL_PARAMETERS, graph::SpatialIndex::VERSION, &params, 1);
+    if (!spatialIndex_.isEmpty()) {
+        size_t cellCount = spatialIndex_.getCellCount();
+        writer.add(SPATIAL_OFFSETS, graph::SpatialIndex::VERSION,
+                   spatialIndex_.getCellOffsets(), cellCount + 1);
+        writer.add(SPATIAL_NODES, graph::SpatialIndex::VERSION,
+                   spatialIndex_.getCellNodes(), spatialIndex_.getCellOffsets()[cellCount]);
+    }
+    
+    return writer.write(artifactPath);
+}
+
+} // namespace data
+} // namespace dijkstra
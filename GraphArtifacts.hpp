@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include "../graph/CompactGraph.hpp"
+#include "../graph/ComponentIndex.hpp"
+#include "../graph/SpatialIndex.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class GraphArtifacts
+ * @brief Preprocessing indexes of a graph, persisted next to its binary file.
+ * 
+ * Holds the component labels and the spatial grid of a CompactGraph. They are
+ * loaded from `<graph file>.artifacts` when that file was built from the same
+ * graph content and by the same index versions, and rebuilt otherwise.
+ */
+class GraphArtifacts {
+public:
+    /**
+     * @brief Get the conventional artifact path for a binary graph file.
+     * @param graphPath Path to the binary graph file
+     * @return Path of the artifact container
+     */
+    static std::string defaultPath(const std::string& graphPath) { return graphPath + ".artifacts"; }
+    
+    /**
+     * @brief Build all artifacts from scratch.
+     * @param graph Graph to preprocess
+     * @return The artifacts
+     */
+    static GraphArtifacts build(const graph::CompactGraph& graph);
+    
+    /**
+     * @brief Load the artifacts of a graph, rebuilding any that are missing or stale.
+     * 
+     * Valid artifacts are mapped read-only straight from the container. If
+     * anything had to be rebuilt, the container is rewritten (atomically) so
+     * the next start can map everything.
+     * 
+     * @param graph Graph the artifacts belong to
+     * @param graphHash Content hash of the graph (see BinaryGraphHandler)
+     * @param artifactPath Path of the artifact container
+     * @return The artifacts
+     */
+    static GraphArtifacts loadOrBuild(const graph::CompactGraph& graph, uint64_t graphHash,
+                                      const std::string& artifactPath);
+    
+    /**
+     * @brief Write artifacts to a container file.
+     * @param graphHash Content hash of the graph they were built from
+     * @param artifactPath Path of the artifact container
+     * @return true if successful, false otherwise
+     */
+    bool save(uint64_t graphHash, const std::string& artifactPath) const;
+    
+    const graph::ComponentIndex& getComponents() const { return components_; }
+    const graph::SpatialIndex& getSpatialIndex() const { return spatialIndex_; }
+    
+    size_t getLoadedCount() const { return loadedCount_; }
+    size_t getBuiltCount() const { return builtCount_; }
+
+private:
+    graph::ComponentIndex components_;
+    graph::SpatialIndex spatialIndex_;
+    size_t loadedCount_ = 0;   ///< Artifacts mapped from the container
+    size_t builtCount_ = 0;    ///< Artifacts that had to be rebuilt
+};
+
+} // namespace data
+} // namespace dijkstra
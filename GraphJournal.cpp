@@ -0,0 +1,413 @@
+#include "GraphJournal.hpp"
+#include "BinaryGraphFormat.hpp"
+#include "ContentHash.hpp"
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using journal::JournalFileHeader;
+using journal::JournalRecordHeader;
+
+constexpr uint32_t MAX_RECORD_LENGTH = 1u << 30; ///< Anything larger is treated as corruption
+
+void putString(std::string& out, const std::string& value) {
+    auto length = static_cast<uint32_t>(value.size());
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.append(value);
+}
+
+void putDouble(std::string& out, double value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * @brief Bounds-checked decoder for one record payload.
+ */
+class PayloadReader {
+public:
+    PayloadReader(const char* data, size_t length) : position_(data), end_(data + length) {}
+    
+    std::string string() {
+        uint32_t length = 0;
+        if (!take(&length, sizeof(length)) || length > static_cast<size_t>(end_ - position_)) {
+            ok_ = false;
+            return {};
+        }
+        std::string value(position_, length);
+        position_ += length;
+        return value;
+    }
+    
+    double number() {
+        double value = 0.0;
+        take(&value, sizeof(value));
+        return value;
+    }
+    
+    /**
+     * @brief Check that every field was present and nothing is left over.
+     */
+    bool complete() const { return ok_ && position_ == end_; }
+
+private:
+    const char* position_;
+    const char* end_;
+    bool ok_ = true;
+    
+    bool take(void* out, size_t length) {
+        if (!ok_ || static_cast<size_t>(end_ - position_) < length) {
+            ok_ = false;
+            return false;
+        }
+        std::memcpy(out, position_, length);
+        position_ += length;
+        return true;
+    }
+};
+
+uint64_t recordChecksum(uint8_t type, const char* payload, size_t length) {
+    ContentHasher hasher;
+    hasher.update(&type, sizeof(type));
+    hasher.update(payload, length);
+    return hasher.finish();
+}
+
+std::string encodePayload(const JournalEntry& entry) {
+    std::string payload;
+    putString(payload, entry.id);
+    switch (entry.type) {
+        case JournalEntry::Type::ADD_NODE:
+            putString(payload, entry.name);
+            break;
+        case JournalEntry::Type::ADD_EDGE:
+            putString(payload, entry.source);
+            putString(payload, entry.destination);
+            putDouble(payload, entry.weight);
+            putDouble(payload, entry.timeWeight);
+            putDouble(payload, entry.costWeight);
+            break;
+        case JournalEntry::Type::SET_WEIGHTS:
+            putDouble(payload, entry.weight);
+            putDouble(payload, entry.timeWeight);
+            putDouble(payload, entry.costWeight);
+            break;
+        case JournalEntry::Type::REMOVE_EDGE:
+            break;
+    }
+    return payload;
+}
+
+bool decodePayload(uint8_t type, const char* data, size_t length, JournalEntry& entry) {
+    PayloadReader reader(data, length);
+    entry = JournalEntry();
+    entry.type = static_cast<JournalEntry::Type>(type);
+    entry.id = reader.string();
+    switch (entry.type) {
+        case JournalEntry::Type::ADD_NODE:
+            entry.name = reader.string();
+            break;
+        case JournalEntry::Type::ADD_EDGE:
+            entry.source = reader.string();
+            entry.destination = reader.string();
+            entry.weight = reader.number();
+            entry.timeWeight = reader.number();
+            entry.costWeight = reader.number();
+            break;
+        case JournalEntry::Type::SET_WEIGHTS:
+            entry.weight = reader.number();
+            entry.timeWeight = reader.number();
+            entry.costWeight = reader.number();
+            break;
+        case JournalEntry::Type::REMOVE_EDGE:
+            break;
+        default:
+            return false; // Unknown record type
+    }
+    return reader.complete();
+}
+
+JournalFileHeader makeHeader(uint64_t sequence) {
+    JournalFileHeader header{};
+    std::memcpy(header.magic, journal::JOURNAL_MAGIC, sizeof(header.magic));
+    header.endianTag = binary::ENDIAN_TAG;
+    header.versionMajor = journal::JOURNAL_FORMAT_MAJOR;
+    header.versionMinor = journal::JOURNAL_FORMAT_MINOR;
+    header.sequence = sequence;
+    return header;
+}
+
+/**
+ * @brief Check a segment header; throws if the file is not a usable journal.
+ */
+void validateHeader(const JournalFileHeader& header, const std::string& filePath) {
+    if (std::memcmp(header.magic, journal::JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a journal segment: " + filePath);
+    }
+    if (header.endianTag != binary::ENDIAN_TAG) {
+        throw std::runtime_error("Journal segment was written on a machine with a different byte order: " + filePath);
+    }
+    if (header.versionMajor != journal::JOURNAL_FORMAT_MAJOR) {
+        throw std::runtime_error("Unsupported journal version " + std::to_string(header.versionMajor) +
+                                 " in " + filePath);
+    }
+}
+
+} // namespace
+
+JournalEntry JournalEntry::addNode(const std::string& id, const std::string& name) {
+    JournalEntry entry;
+    entry.type = Type::ADD_NODE;
+    entry.id = id;
+    entry.name = name;
+    return entry;
+}
+
+JournalEntry JournalEntry::addEdge(const std::string& id, const std::string& source, const std::string& destination,
+                                   double weight, double timeWeight, double costWeight) {
+    JournalEntry entry;
+    entry.type = Type::ADD_EDGE;
+    entry.id = id;
+    entry.source = source;
+    entry.destination = destination;
+    entry.weight = weight;
+    entry.timeWeight = timeWeight;
+    entry.costWeight = costWeight;
+    return entry;
+}
+
+JournalEntry JournalEntry::removeEdge(const std::string& id) {
+    JournalEntry entry;
+    entry.type = Type::REMOVE_EDGE;
+    entry.id = id;
+    return entry;
+}
+
+JournalEntry JournalEntry::setWeights(const std::string& id, double weight, double timeWeight, double costWeight) {
+    JournalEntry entry;
+    entry.type = Type::SET_WEIGHTS;
+    entry.id = id;
+    entry.weight = weight;
+    entry.timeWeight = timeWeight;
+    entry.costWeight = costWeight;
+    return entry;
+}
+
+bool JournalEntry::applyTo(graph::Graph& graph) const {
+    switch (type) {
+        case Type::ADD_NODE:
+            return graph.addNode(std::make_shared<graph::Node>(id, name));
+        case Type::ADD_EDGE: {
+            auto sourceNode = graph.getNode(source);
+            auto destNode = graph.getNode(destination);
+            if (!sourceNode || !destNode) {
+                return false;
+            }
+            auto edge = std::make_shared<graph::Edge>(id, sourceNode, destNode, weight);
+            edge->setTimeWeight(timeWeight);
+            edge->setCostWeight(costWeight);
+            return graph.addEdge(edge);
+        }
+        case Type::REMOVE_EDGE:
+            return graph.removeEdge(id);
+        case Type::SET_WEIGHTS: {
+            auto edge = graph.getEdge(id);
+            if (!edge) {
+                return false;
+            }
+            edge->setWeight(weight);
+            edge->setTimeWeight(timeWeight);
+            edge->setCostWeight(costWeight);
+            return true;
+        }
+    }
+    return false;
+}
+
+ReplayStats JournalReader::scan(const std::string& filePath,
+                                const std::function<void(const JournalEntry&)>& visitor) {
+    ReplayStats stats;
+    std::error_code ec;
+    auto fileSize = std::filesystem::file_size(filePath, ec);
+    if (ec || fileSize < sizeof(JournalFileHeader)) {
+        // Missing, or torn before its header was complete: nothing to replay
+        stats.truncated = !ec && fileSize > 0;
+        return stats;
+    }
+    
+    MappedFile file(filePath);
+    file.adviseSequential();
+    JournalFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    validateHeader(header, filePath);
+    
+    uint64_t position = sizeof(JournalFileHeader);
+    JournalEntry entry;
+    while (position + sizeof(JournalRecordHeader) <= file.size()) {
+        JournalRecordHeader record;
+        std::memcpy(&record, file.data() + position, sizeof(record));
+        const char* payload = file.data() + position + sizeof(record);
+        
+        if (record.length > MAX_RECORD_LENGTH ||
+            record.length > file.size() - position - sizeof(record) ||
+            record.checksum != recordChecksum(record.type, payload, record.length) ||
+            !decodePayload(record.type, payload, record.length, entry)) {
+            break;
+        }
+        
+        visitor(entry);
+        ++stats.recordsRead;
+        position += sizeof(record) + record.length;
+    }
+    
+    stats.validBytes = position;
+    stats.truncated = position != file.size();
+    return stats;
+}
+
+ReplayStats JournalReader::replay(const std::string& filePath, graph::Graph& graph) {
+    size_t applied = 0;
+    size_t rejected = 0;
+    auto stats = scan(filePath, [&](const JournalEntry& entry) {
+        if (entry.applyTo(graph)) {
+            ++applied;
+        } else {
+            ++rejected;
+        }
+    });
+    
+    stats.recordsApplied = applied;
+    stats.recordsRejected = rejected;
+    return stats;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+JournalWriter::JournalWriter(const std::string& filePath, uint64_t sequence)
+    : path_(filePath), sequence_(sequence) {
+    // Cut off whatever a crash left half-written, so new records follow the
+    // last intact one
+    auto stats = JournalReader::scan(filePath, [](const JournalEntry&) {});
+    std::error_code ec;
+    bool exists = std::filesystem::exists(filePath, ec);
+    if (exists && stats.truncated) {
+        std::filesystem::resize_file(filePath, stats.validBytes, ec);
+        if (ec) {
+            throw std::runtime_error("Failed to truncate journal segment " + filePath + ": " + ec.message());
+        }
+    }
+    if (stats.validBytes >= sizeof(JournalFileHeader)) {
+        MappedFile file(filePath);
+        JournalFileHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.sequence != sequence) {
+            throw std::runtime_error("Journal segment " + filePath + " has sequence " +
+                                     std::to_string(header.sequence) + ", expected " + std::to_string(sequence));
+        }
+    }
+    
+    fd_ = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open journal segment " + filePath + ": " + std::strerror(errno));
+    }
+    
+    size_ = stats.validBytes;
+    if (size_ == 0) {
+        auto header = makeHeader(sequence);
+        buffer_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (!flush()) {
+            ::close(fd_);
+            throw std::runtime_error("Failed to write journal header to " + filePath);
+        }
+    }
+}
+
+JournalWriter::~JournalWriter() {
+    flush();
+    ::close(fd_);
+}
+
+bool JournalWriter::flush() {
+    const char* data = buffer_.data();
+    size_t remaining = good_ ? buffer_.size() : 0;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            good_ = false;
+            break;
+        }
+        data += written;
+        size_ += static_cast<uint64_t>(written);
+        remaining -= static_cast<size_t>(written);
+    }
+    
+    buffer_.clear();
+    return good_;
+}
+
+bool JournalWriter::sync() {
+    if (!flush()) {
+        return false;
+    }
+#if defined(__APPLE__)
+    good_ = ::fsync(fd_) == 0;
+#else
+    good_ = ::fdatasync(fd_) == 0;
+#endif
+    return good_;
+}
+
+#else
+
+JournalWriter::JournalWriter(const std::string& filePath, uint64_t sequence)
+    : path_(filePath), sequence_(sequence) {
+    throw std::runtime_error("Journals are not supported on this platform: " + filePath);
+}
+
+JournalWriter::~JournalWriter() = default;
+
+bool JournalWriter::flush() {
+    return false;
+}
+
+bool JournalWriter::sync() {
+    return false;
+}
+
+#endif
+
+bool JournalWriter::append(const JournalEntry& entry) {
+    if (!good_) {
+        return false;
+    }
+    
+    std::string payload = encodePayload(entry);
+    JournalRecordHeader record{};
+    record.length = static_cast<uint32_t>(payload.size());
+    record.type = static_cast<uint8_t>(entry.type);
+    record.checksum = recordChecksum(record.type, payload.data(), payload.size());
+    
+    buffer_.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    buffer_.append(payload);
+    if (buffer_.size() >= FLUSH_THRESHOLD) {
+        return flush();
+    }
+    return true;
+}
+
+} // namespace data
+} // namespace dijkstra
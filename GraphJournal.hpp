@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "../graph/Graph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * Append-only journal of graph edits.
+ * 
+ * Layout (native byte order, identified by the endian tag):
+ * 
+ *   JournalFileHeader   magic, version, segment sequence number
+ *   records, each a JournalRecordHeader followed by `length` payload bytes
+ * 
+ * Strings in a payload are a uint32_t length followed by the bytes; weights
+ * are raw doubles. Every record carries a checksum of its type and payload,
+ * so a record torn by a crash mid-append is detected and dropped together
+ * with everything after it.
+ */
+namespace journal {
+
+constexpr char JOURNAL_MAGIC[8] = {'D', 'J', 'K', 'J', 'R', 'N', 'L', '1'};
+constexpr uint16_t JOURNAL_FORMAT_MAJOR = 1;
+constexpr uint16_t JOURNAL_FORMAT_MINOR = 0;
+
+struct JournalFileHeader {
+    char magic[8];
+    uint32_t endianTag;
+    uint16_t versionMajor;
+    uint16_t versionMinor;
+    uint64_t sequence;  ///< Position of this segment in the journal
+};
+
+struct JournalRecordHeader {
+    uint32_t length;    ///< Payload length in bytes
+    uint8_t type;       ///< JournalEntry::Type
+    uint8_t reserved[3];
+    uint64_t checksum;  ///< ContentHasher over type and payload
+};
+
+static_assert(sizeof(JournalFileHeader) == 24, "JournalFileHeader layout must not depend on the compiler");
+static_assert(sizeof(JournalRecordHeader) == 16, "JournalRecordHeader layout must not depend on the compiler");
+
+} // namespace journal
+
+/**
+ * @struct JournalEntry
+ * @brief One graph edit as recorded in the journal.
+ */
+struct JournalEntry {
+    enum class Type : uint8_t {
+        ADD_NODE = 1,     ///< id, name
+        ADD_EDGE = 2,     ///< id, source, destination, weights
+        REMOVE_EDGE = 3,  ///< id
+        SET_WEIGHTS = 4   ///< id, weights
+    };
+    
+    Type type = Type::ADD_NODE;
+    std::string id;
+    std::string name;         ///< ADD_NODE only
+    std::string source;       ///< ADD_EDGE only
+    std::string destination;  ///< ADD_EDGE only
+    double weight = 0.0;
+    double timeWeight = 0.0;
+    double costWeight = 0.0;
+    
+    static JournalEntry addNode(const std::string& id, const std::string& name);
+    static JournalEntry addEdge(const std::string& id, const std::string& source, const std::string& destination,
+                                double weight, double timeWeight, double costWeight);
+    static JournalEntry removeEdge(const std::string& id);
+    static JournalEntry setWeights(const std::string& id, double weight, double timeWeight, double costWeight);
+    
+    /**
+     * @brief Apply the edit to a graph.
+     * @param graph Graph to modify
+     * @return true if the graph accepted the edit
+     */
+    bool applyTo(graph::Graph& graph) const;
+};
+
+/**
+ * @struct ReplayStats
+ * @brief Outcome of reading one journal segment.
+ */
+struct ReplayStats {
+    size_t recordsRead = 0;
+    size_t recordsApplied = 0;   ///< Records the graph accepted
+    size_t recordsRejected = 0;  ///< Records the graph refused (e.g. duplicate IDs)
+    uint64_t validBytes = 0;     ///< Length of the intact prefix of the file
+    bool truncated = false;      ///< A torn or corrupt record ended the scan early
+};
+
+/**
+ * @class JournalWriter
+ * @brief Appends edits to one journal segment.
+ * 
+ * Records are buffered in memory and handed to the operating system by
+ * flush(); sync() additionally waits until they are on stable storage.
+ */
+class JournalWriter {
+public:
+    /**
+     * @brief Open a segment for appending, creating it if necessary.
+     * 
+     * A torn record at the end of an existing segment is cut off first.
+     * 
+     * @param filePath Path to the segment
+     * @param sequence Sequence number written into a new segment's header
+     * @throws std::runtime_error if the file cannot be opened or is not a journal
+     */
+    JournalWriter(const std::string& filePath, uint64_t sequence);
+    
+    /**
+     * @brief Flushes and closes the segment.
+     */
+    ~JournalWriter();
+    
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+    
+    /**
+     * @brief Append an edit.
+     * @param entry Edit to record
+     * @return true if successful, false if an earlier write failed
+     */
+    bool append(const JournalEntry& entry);
+    
+    /**
+     * @brief Hand buffered records to the operating system.
+     * @return true if successful, false otherwise
+     */
+    bool flush();
+    
+    /**
+     * @brief Flush and wait until the records are durable.
+     * @return true if successful, false otherwise
+     */
+    bool sync();
+    
+    const std::string& getPath() const { return path_; }
+    uint64_t getSequence() const { return sequence_; }
+    uint64_t getSize() const { return size_ + buffer_.size(); }
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD = 1 << 16;
+    
+    std::string path_;
+    uint64_t sequence_;
+    int fd_ = -1;
+    uint64_t size_ = 0;
+    std::string buffer_;
+    bool good_ = true;
+};
+
+/**
+ * @class JournalReader
+ * @brief Reads journal segments back.
+ */
+class JournalReader {
+public:
+    /**
+     * @brief Visit every intact record of a segment in order.
+     * @param filePath Path to the segment
+     * @param visitor Called once per record
+     * @return Read statistics (recordsApplied/recordsRejected are left at zero)
+     * @throws std::runtime_error if the file exists but is not a journal
+     */
+    static ReplayStats scan(const std::string& filePath,
+                            const std::function<void(const JournalEntry&)>& visitor);
+    
+    /**
+     * @brief Apply every intact record of a segment to a graph.
+     * @param filePath Path to the segment
+     * @param graph Graph to modify
+     * @return Replay statistics
+     * @throws std::runtime_error if the file exists but is not a journal
+     */
+    static ReplayStats replay(const std::string& filePath, graph::Graph& graph);
+
+};
+
+} // namespace data
+} // namespace dijkstra
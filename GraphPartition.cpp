@@ -0,0 +1,394 @@
+#include "GraphPartition.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+using Index = CompactGraph::Index;
+using EdgeIndex = CompactGraph::EdgeIndex;
+
+constexpr double TERMINAL_SHARE = 0.25; ///< Share of the order at each end used as flow source and sink
+
+constexpr uint8_t INNER = 0;
+constexpr uint8_t SOURCE = 1;
+constexpr uint8_t SINK = 2;
+
+/**
+ * @brief Undirected graph induced by a set of nodes, on positions in that set.
+ * 
+ * Every edge between two members becomes a pair of twin arcs, each of
+ * capacity one.
+ */
+struct CellGraph {
+    std::vector<size_t> offsets; ///< Arcs leaving each node
+    std::vector<uint32_t> heads;
+    std::vector<uint32_t> twins;
+    
+    size_t getNodeCount() const { return offsets.size() - 1; }
+};
+
+struct Cut {
+    size_t size = 0;            ///< Number of edges cut
+    std::vector<uint8_t> first; ///< Whether each node lies on the source side
+    size_t firstCount = 0;
+};
+
+/**
+ * @brief Order a set by breadth-first search, appending nodes the search cannot reach.
+ * @return The order, and the position after the last reached node
+ */
+std::pair<std::vector<uint32_t>, size_t> breadthFirstOrder(const CellGraph& cell, uint32_t start) {
+    const size_t nodeCount = cell.getNodeCount();
+    std::vector<uint8_t> seen(nodeCount, 0);
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+    order.push_back(start);
+    seen[start] = 1;
+    for (size_t i = 0; i < order.size(); ++i) {
+        uint32_t node = order[i];
+        for (size_t arc = cell.offsets[node]; arc < cell.offsets[node + 1]; ++arc) {
+            if (!seen[cell.heads[arc]]) {
+                seen[cell.heads[arc]] = 1;
+                order.push_back(cell.heads[arc]);
+            }
+        }
+    }
+    
+    const size_t reached = order.size();
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        if (!seen[node]) {
+            order.push_back(node);
+        }
+    }
+    return {std::move(order), reached};
+}
+
+/**
+ * @brief Find a minimum edge cut between both ends of an order with Dinic's algorithm.
+ */
+Cut minimumCut(const CellGraph& cell, const std::vector<uint32_t>& order) {
+    const size_t nodeCount = cell.getNodeCount();
+    const size_t terminals = std::max<size_t>(1, static_cast<size_t>(nodeCount * TERMINAL_SHARE));
+    
+    std::vector<uint8_t> role(nodeCount, INNER);
+    for (size_t i = 0; i < terminals; ++i) {
+        role[order[i]] = SOURCE;
+        role[order[nodeCount - 1 - i]] = SINK;
+    }
+    
+    // flow[arc] is -1, 0 or 1; the residual capacity of an arc is 1 - flow[arc]
+    std::vector<int8_t> flow(cell.heads.size(), 0);
+    std::vector<int32_t> level(nodeCount);
+    std::vector<size_t> nextArc(nodeCount);
+    std::vector<uint32_t> queue;
+    std::vector<size_t> path;
+    queue.reserve(nodeCount);
+    
+    auto levelFromSources = [&]() {
+        std::fill(level.begin(), level.end(), -1);
+        queue.clear();
+        for (size_t i = 0; i < terminals; ++i) {
+            level[order[i]] = 0;
+            queue.push_back(order[i]);
+        }
+        bool sinkReached = false;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            uint32_t node = queue[i];
+            if (role[node] == SINK) {
+                sinkReached = true;
+                continue;
+            }
+            for (size_t arc = cell.offsets[node]; arc < cell.offsets[node + 1]; ++arc) {
+                uint32_t head = cell.heads[arc];
+                if (level[head] < 0 && flow[arc] < 1) {
+                    level[head] = level[node] + 1;
+                    queue.push_back(head);
+                }
+            }
+        }
+        return sinkReached;
+    };
+    
+    Cut cut;
+    while (levelFromSources()) {
+        // Blocking flow: augment along level-increasing paths until none is left
+        std::copy(cell.offsets.begin(), cell.offsets.end() - 1, nextArc.begin());
+        for (size_t i = 0; i < terminals; ++i) {
+            const uint32_t source = order[i];
+            while (true) {
+                path.clear();
+                uint32_t node = source;
+                while (role[node] != SINK) {
+                    size_t& arc = nextArc[node];
+                    while (arc < cell.offsets[node + 1] &&
+                           (flow[arc] >= 1 || level[cell.heads[arc]] != level[node] + 1)) {
+                        ++arc;
+                    }
+                    if (arc < cell.offsets[node + 1]) {
+                        path.push_back(arc);
+                        node = cell.heads[arc];
+                    } else if (path.empty()) {
+                        break; // Nothing more from this source
+                    } else {
+                        level[node] = -1; // Dead end: keep later paths out
+                        node = cell.heads[cell.twins[path.back()]];
+                        path.pop_back();
+                    }
+                }
+                if (role[node] != SINK) {
+                    break;
+                }
+                for (size_t arc : path) {
+                    ++flow[arc];
+                    --flow[cell.twins[arc]];
+                }
+                ++cut.size;
+            }
+        }
+    }
+    
+    // The source side is what the sources still reach in the residual graph
+    cut.first.assign(nodeCount, 0);
+    queue.clear();
+    for (size_t i = 0; i < terminals; ++i) {
+        cut.first[order[i]] = 1;
+        queue.push_back(order[i]);
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+        uint32_t node = queue[i];
+        for (size_t arc = cell.offsets[node]; arc < cell.offsets[node + 1]; ++arc) {
+            if (!cut.first[cell.heads[arc]] && flow[arc] < 1) {
+                cut.first[cell.heads[arc]] = 1;
+                queue.push_back(cell.heads[arc]);
+            }
+        }
+    }
+    cut.firstCount = queue.size();
+    return cut;
+}
+
+/**
+ * @brief Splits node sets in two along a minimum cut (inertial flow).
+ * 
+ * Several sets may be bisected at once on different threads, as long as they
+ * are disjoint.
+ */
+class Bisector {
+public:
+    explicit Bisector(const CompactGraph& graph)
+        : graph_(graph), owner_(graph.getNodeCount()), position_(graph.getNodeCount()) {}
+    
+    /**
+     * @brief Bisect a set of at least two nodes into two non-empty halves.
+     * @param nodes Nodes of the set
+     * @param threads Number of threads to try directions on
+     * @param first Receives one side, in the order of `nodes`
+     * @param second Receives the other side, in the order of `nodes`
+     */
+    void bisect(const std::vector<Index>& nodes, unsigned threads,
+                std::vector<Index>& first, std::vector<Index>& second) {
+        CellGraph cell = induce(nodes);
+        std::vector<std::vector<uint32_t>> orders = directions(nodes, cell);
+        
+        std::vector<Cut> cuts(orders.size());
+        util::parallelForEach(orders.size(), threads, [&](size_t direction, unsigned) {
+            cuts[direction] = minimumCut(cell, orders[direction]);
+        });
+        
+        // Smallest cut first, then the most balanced one
+        auto imbalance = [&nodes](const Cut& cut) {
+            return std::abs(2 * static_cast<double>(cut.firstCount) - static_cast<double>(nodes.size()));
+        };
+        const Cut* best = &cuts[0];
+        for (const Cut& cut : cuts) {
+            if (cut.size < best->size || (cut.size == best->size && imbalance(cut) < imbalance(*best))) {
+                best = &cut;
+            }
+        }
+        
+        first.clear();
+        second.clear();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            (best->first[i] ? first : second).push_back(nodes[i]);
+        }
+    }
+
+private:
+    const CompactGraph& graph_;
+    std::vector<std::atomic<uint32_t>> owner_; ///< Set each node was last seen in; sets are numbered from 1
+    std::vector<uint32_t> position_;           ///< Position of each node in that set
+    std::atomic<uint32_t> nextSet_{1};
+    
+    CellGraph induce(const std::vector<Index>& nodes) {
+        const uint32_t set = nextSet_.fetch_add(1);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            owner_[nodes[i]].store(set, std::memory_order_relaxed);
+            position_[nodes[i]] = static_cast<uint32_t>(i);
+        }
+        
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (EdgeIndex edge = graph_.getFirstEdge(nodes[i]); edge < graph_.getLastEdge(nodes[i]); ++edge) {
+                Index target = graph_.getTarget(edge);
+                if (target != nodes[i] && owner_[target].load(std::memory_order_relaxed) == set) {
+                    pairs.emplace_back(static_cast<uint32_t>(i), position_[target]);
+                }
+            }
+        }
+        
+        CellGraph cell;
+        cell.offsets.assign(nodes.size() + 1, 0);
+        for (const auto& pair : pairs) {
+            ++cell.offsets[pair.first + 1];
+            ++cell.offsets[pair.second + 1];
+        }
+        std::partial_sum(cell.offsets.begin(), cell.offsets.end(), cell.offsets.begin());
+        cell.heads.resize(2 * pairs.size());
+        cell.twins.resize(2 * pairs.size());
+        std::vector<size_t> fill(cell.offsets.begin(), cell.offsets.end() - 1);
+        for (const auto& pair : pairs) {
+            size_t forward = fill[pair.first]++;
+            size_t backward = fill[pair.second]++;
+            cell.heads[forward] = pair.second;
+            cell.heads[backward] = pair.first;
+            cell.twins[forward] = static_cast<uint32_t>(backward);
+            cell.twins[backward] = static_cast<uint32_t>(forward);
+        }
+        return cell;
+    }
+    
+    /**
+     * @brief Order the set along four directions in the plane, or by breadth-first search.
+     */
+    std::vector<std::vector<uint32_t>> directions(const std::vector<Index>& nodes, const CellGraph& cell) const {
+        std::vector<std::vector<uint32_t>> orders;
+        if (!graph_.hasCoordinates()) {
+            // Search twice to start from a node on the periphery
+            auto probe = breadthFirstOrder(cell, 0);
+            auto order = breadthFirstOrder(cell, probe.first[probe.second - 1]);
+            auto reverse = breadthFirstOrder(cell, order.first[order.second - 1]);
+            orders.push_back(std::move(order.first));
+            orders.push_back(std::move(reverse.first));
+            return orders;
+        }
+        
+        double meanLatitude = 0.0;
+        for (Index node : nodes) {
+            meanLatitude += graph_.getLatitude(node);
+        }
+        const double scale = std::cos(meanLatitude / nodes.size() * M_PI / 180.0);
+        
+        const double weights[][2] = {{1.0, 0.0}, {0.0, 1.0}, {1.0, 1.0}, {1.0, -1.0}};
+        std::vector<std::pair<double, uint32_t>> keys(nodes.size());
+        for (const auto& weight : weights) {
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                double x = graph_.getLongitude(nodes[i]) * scale;
+                double y = graph_.getLatitude(nodes[i]);
+                keys[i] = {weight[0] * x + weight[1] * y, static_cast<uint32_t>(i)};
+            }
+            std::sort(keys.begin(), keys.end());
+            std::vector<uint32_t> order(nodes.size());
+            for (size_t i = 0; i < keys.size(); ++i) {
+                order[i] = keys[i].second;
+            }
+            orders.push_back(std::move(order));
+        }
+        return orders;
+    }
+};
+
+/**
+ * @brief Bisect a set recursively until every part fits in a cell.
+ */
+void split(Bisector& bisector, const std::vector<Index>& nodes, size_t maxCellSize, unsigned threads,
+           std::vector<std::vector<Index>>& cells) {
+    std::vector<std::vector<Index>> pending{nodes};
+    std::vector<Index> first;
+    std::vector<Index> second;
+    while (!pending.empty()) {
+        std::vector<Index> part = std::move(pending.back());
+        pending.pop_back();
+        if (part.size() <= maxCellSize) {
+            cells.push_back(std::move(part));
+            continue;
+        }
+        bisector.bisect(part, threads, first, second);
+        pending.push_back(second);
+        pending.push_back(first);
+    }
+}
+
+} // namespace
+
+GraphPartition GraphPartition::build(const CompactGraph& graph, const std::vector<size_t>& maxCellSizes,
+                                     unsigned threads) {
+    for (size_t level = 0; level < maxCellSizes.size(); ++level) {
+        if (maxCellSizes[level] < 2 || (level > 0 && maxCellSizes[level] <= maxCellSizes[level - 1])) {
+            throw std::invalid_argument("Cell sizes must be at least 2 and increase from level to level");
+        }
+    }
+    
+    const size_t nodeCount = graph.getNodeCount();
+    const size_t levelCount = std::count_if(maxCellSizes.begin(), maxCellSizes.end(),
+                                            [nodeCount](size_t size) { return size < nodeCount; });
+    threads = util::resolveThreadCount(threads);
+    
+    auto labels = std::make_shared<std::vector<std::vector<uint32_t>>>(levelCount,
+                                                                       std::vector<uint32_t>(nodeCount));
+    GraphPartition partition;
+    partition.cellCounts_.assign(levelCount, 0);
+    partition.nodeCount_ = nodeCount;
+    
+    // Split the cells of each level, coarsest first, into the cells of the level below
+    Bisector bisector(graph);
+    std::vector<std::vector<Index>> cells(1, std::vector<Index>(nodeCount));
+    std::iota(cells[0].begin(), cells[0].end(), 0);
+    for (size_t level = levelCount; level-- > 0;) {
+        std::vector<std::vector<std::vector<Index>>> parts(cells.size());
+        // Few large cells: use the spare threads on the directions of each bisection
+        const unsigned directionThreads = cells.size() < threads ? threads : 1;
+        util::parallelForEach(cells.size(), threads, [&](size_t cell, unsigned) {
+            split(bisector, cells[cell], maxCellSizes[level], directionThreads, parts[cell]);
+        });
+        
+        cells.clear();
+        for (auto& cellParts : parts) {
+            for (auto& part : cellParts) {
+                for (Index node : part) {
+                    (*labels)[level][node] = static_cast<uint32_t>(cells.size());
+                }
+                cells.push_back(std::move(part));
+            }
+        }
+        partition.cellCounts_[level] = cells.size();
+    }
+    
+    for (const auto& levelLabels : *labels) {
+        partition.cells_.push_back(levelLabels.data());
+    }
+    partition.storage_ = std::move(labels);
+    return partition;
+}
+
+size_t GraphPartition::countCutEdges(const CompactGraph& graph, size_t level) const {
+    size_t count = 0;
+    for (Index node = 0; node < graph.getNodeCount(); ++node) {
+        for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+            if (cells_[level][node] != cells_[level][graph.getTarget(edge)]) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "CompactGraph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class GraphPartition
+ * @brief Nested partition of a CompactGraph's nodes into cells on several levels.
+ * 
+ * Level 0 has the smallest cells; every cell of a level lies entirely inside
+ * one cell of the level above. Cells are found by recursive bisection with
+ * inertial flow: the nodes of a cell are ordered along a few directions in
+ * the plane, and the edges are cut by a minimum cut separating the first
+ * quarter of that order from the last. The direction giving the smallest cut
+ * wins. Graphs without coordinates are ordered by breadth-first search from a
+ * peripheral node instead.
+ * 
+ * The result depends only on the graph and the cell sizes, not on the number
+ * of threads used to build it. Copies are cheap and share the same labels.
+ */
+class GraphPartition {
+public:
+    using Index = CompactGraph::Index;
+    
+    /**
+     * @brief Constructs an empty partition with no levels.
+     */
+    GraphPartition() = default;
+    
+    /**
+     * @brief Partition a graph.
+     * 
+     * Levels whose cell size would hold the whole graph are left out.
+     * 
+     * @param graph Graph to partition
+     * @param maxCellSizes Largest cell size of each level, finest first and increasing
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @return The partition
+     * @throws std::invalid_argument if the cell sizes are not increasing or are below 2
+     */
+    static GraphPartition build(const CompactGraph& graph,
+                                const std::vector<size_t>& maxCellSizes = {256, 4096, 65536},
+                                unsigned threads = 0);
+    
+    size_t getLevelCount() const { return cells_.size(); }
+    size_t getNodeCount() const { return nodeCount_; }
+    size_t getCellCount(size_t level) const { return cellCounts_[level]; }
+    
+    /**
+     * @brief Get the cell of a node on a level.
+     * @param level Level, 0 being the finest
+     * @param node Node index
+     * @return Cell number, dense per level
+     */
+    uint32_t getCell(size_t level, Index node) const { return cells_[level][node]; }
+    
+    /**
+     * @brief Count the edges whose endpoints lie in different cells of a level.
+     * @param graph The partitioned graph
+     * @param level Level, 0 being the finest
+     * @return Number of cut edges
+     */
+    size_t countCutEdges(const CompactGraph& graph, size_t level) const;
+
+private:
+    std::vector<const uint32_t*> cells_; ///< Cell of every node, per level
+    std::vector<size_t> cellCounts_;
+    size_t nodeCount_ = 0;
+    std::shared_ptr<const void> storage_;
+};
+
+} // namespace graph
+} // namespace dijkstra
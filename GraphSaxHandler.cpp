@@ -0,0 +1,269 @@
+#include "GraphSaxHandler.hpp"
+#include <stdexcept>
+
+namespace dijkstra {
+namespace data {
+
+GraphSaxHandler::GraphSaxHandler(RecordSink& sink) : sink_(sink) {
+}
+
+bool GraphSaxHandler::null() {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::boolean(bool /*value*/) {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::number_integer(json::number_integer_t value) {
+    return onNumber(static_cast<double>(value));
+}
+
+bool GraphSaxHandler::number_unsigned(json::number_unsigned_t value) {
+    return onNumber(static_cast<double>(value));
+}
+
+bool GraphSaxHandler::number_float(json::number_float_t value, const json::string_t& /*raw*/) {
+    return onNumber(value);
+}
+
+bool GraphSaxHandler::string(json::string_t& value) {
+    if (depth_ == RECORD_DEPTH) {
+        switch (field_) {
+            case Field::ID:
+                if (section_ == Section::NODES) {
+                    node_.id = std::move(value);
+                    hasNodeId_ = true;
+                } else {
+                    edge_.id = std::move(value);
+                }
+                break;
+            case Field::NAME:
+                node_.name = std::move(value);
+                break;
+            case Field::SOURCE:
+                edge_.source = std::move(value);
+                break;
+            case Field::DESTINATION:
+                edge_.destination = std::move(value);
+                break;
+            default:
+                break;
+        }
+    }
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::binary(json::binary_t& /*value*/) {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::start_object(std::size_t /*elements*/) {
+    ++depth_;
+    
+    if (depth_ == RECORD_DEPTH) {
+        if (section_ == Section::NODES) {
+            node_ = NodeRecord();
+            hasNodeId_ = false;
+        } else if (section_ == Section::EDGES) {
+            edge_ = EdgeRecord();
+        }
+    }
+    
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::key(json::string_t& value) {
+    if (depth_ == ROOT_DEPTH) {
+        if (value == "nodes") {
+            pendingSection_ = Section::NODES;
+        } else if (value == "edges") {
+            pendingSection_ = Section::EDGES;
+        } else {
+            pendingSection_ = Section::NONE;
+        }
+        return true;
+    }
+    
+    field_ = Field::NONE;
+    if (depth_ != RECORD_DEPTH) {
+        return true;
+    }
+    
+    if (value == "id") {
+        field_ = Field::ID;
+    } else if (section_ == Section::NODES) {
+        if (value == "name") {
+            field_ = Field::NAME;
+        }
+    } else if (section_ == Section::EDGES) {
+        if (value == "source") {
+            field_ = Field::SOURCE;
+        } else if (value == "destination") {
+            field_ = Field::DESTINATION;
+        } else if (value == "weight") {
+            field_ = Field::WEIGHT;
+        } else if (value == "time_weight") {
+            field_ = Field::TIME_WEIGHT;
+        } else if (value == "cost_weight") {
+            field_ = Field::COST_WEIGHT;
+        }
+    }
+    return true;
+}
+
+bool GraphSaxHandler::end_object() {
+    if (depth_ == RECORD_DEPTH) {
+        if (section_ == Section::NODES) {
+            finishNode();
+        } else if (section_ == Section::EDGES) {
+            finishEdge();
+        }
+    } else if (depth_ == ROOT_DEPTH) {
+        sink_.onDocumentComplete();
+    }
+    
+    --depth_;
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::start_array(std::size_t /*elements*/) {
+    ++depth_;
+    
+    if (depth_ == SECTION_DEPTH) {
+        section_ = pendingSection_;
+    }
+    
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::end_array() {
+    if (depth_ == SECTION_DEPTH) {
+        if (section_ == Section::NODES) {
+            sink_.onNodesComplete();
+        }
+        section_ = Section::NONE;
+    }
+    
+    --depth_;
+    field_ = Field::NONE;
+    return true;
+}
+
+bool GraphSaxHandler::parse_error(std::size_t /*position*/, const std::string& /*lastToken*/,
+                                  const nlohmann::detail::exception& ex) {
+    errorMessage_ = ex.what();
+    return false;
+}
+
+bool GraphSaxHandler::onNumber(double value) {
+    if (depth_ == RECORD_DEPTH && section_ == Section::EDGES) {
+        switch (field_) {
+            case Field::WEIGHT:
+                edge_.weight = value;
+                edge_.hasWeight = true;
+                break;
+            case Field::TIME_WEIGHT:
+                edge_.timeWeight = value;
+                edge_.hasTimeWeight = true;
+                break;
+            case Field::COST_WEIGHT:
+                edge_.costWeight = value;
+                edge_.hasCostWeight = true;
+                break;
+            default:
+                break;
+        }
+    }
+    field_ = Field::NONE;
+    return true;
+}
+
+void GraphSaxHandler::finishNode() {
+    if (!hasNodeId_) {
+        throw std::runtime_error("Node record is missing required field 'id'");
+    }
+    sink_.onNode(node_);
+}
+
+void GraphSaxHandler::finishEdge() {
+    if (edge_.id.empty() || edge_.source.empty() || edge_.destination.empty() || !edge_.hasWeight) {
+        throw std::runtime_error("Edge record '" + edge_.id +
+                                 "' is missing one of the required fields "
+                                 "'id', 'source', 'destination', 'weight'");
+    }
+    sink_.onEdge(edge_);
+}
+
+GraphRecordBuilder::GraphRecordBuilder(graph::Graph& graph) : graph_(graph) {
+}
+
+void GraphRecordBuilder::onNode(GraphSaxHandler::NodeRecord& record) {
+    auto node = std::make_shared<graph::Node>(std::move(record.id), std::move(record.name));
+    if (graph_.addNode(node)) {
+        ++nodesLoaded_;
+    }
+}
+
+void GraphRecordBuilder::onEdge(GraphSaxHandler::EdgeRecord& record) {
+    if (addEdge(record)) {
+        return;
+    }
+    
+    // The endpoints may simply not have been seen yet if `edges` precedes `nodes`
+    if (!nodesSeen_) {
+        deferredEdges_.push_back(std::move(record));
+        return;
+    }
+    
+    ++edgesSkipped_;
+}
+
+void GraphRecordBuilder::onNodesComplete() {
+    nodesSeen_ = true;
+}
+
+void GraphRecordBuilder::onDocumentComplete() {
+    for (const auto& record : deferredEdges_) {
+        if (!addEdge(record)) {
+            ++edgesSkipped_;
+        }
+    }
+    
+    deferredEdges_.clear();
+    deferredEdges_.shrink_to_fit();
+}
+
+bool GraphRecordBuilder::addEdge(const GraphSaxHandler::EdgeRecord& record) {
+    auto sourceNode = graph_.getNode(record.source);
+    auto destNode = graph_.getNode(record.destination);
+    if (!sourceNode || !destNode) {
+        return false;
+    }
+    
+    auto edge = std::make_shared<graph::Edge>(record.id, sourceNode, destNode, record.weight);
+    if (record.hasTimeWeight) {
+        edge->setTimeWeight(record.timeWeight);
+    }
+    if (record.hasCostWeight) {
+        edge->setCostWeight(record.costWeight);
+    }
+    
+    if (!graph_.addEdge(edge)) {
+        ++edgesSkipped_; // Duplicate edge ID
+        return true;
+    }
+    
+    ++edgesLoaded_;
+    return true;
+}
+
+} // namespace data
+} // namespace dijkstra
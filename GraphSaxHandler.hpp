@@ -0,0 +1,153 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../graph/Graph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class GraphSaxHandler
+ * @brief SAX event handler that extracts node and edge records while the JSON input is being parsed.
+ * 
+ * Understands the same `nodes`/`edges` schema as JsonHandler::jsonToGraph, but
+ * never materializes a DOM: each node or edge record is passed to a RecordSink
+ * as soon as its closing brace is seen, so only the record currently being
+ * parsed is held in memory.
+ */
+class GraphSaxHandler {
+public:
+    using json = nlohmann::json;
+    
+    /**
+     * @struct NodeRecord
+     * @brief Fields of one element of the `nodes` array.
+     */
+    struct NodeRecord {
+        std::string id;
+        std::string name;
+    };
+    
+    /**
+     * @struct EdgeRecord
+     * @brief Fields of one element of the `edges` array.
+     */
+    struct EdgeRecord {
+        std::string id;
+        std::string source;
+        std::string destination;
+        double weight = 0.0;
+        double timeWeight = 0.0;
+        double costWeight = 0.0;
+        bool hasWeight = false;
+        bool hasTimeWeight = false;
+        bool hasCostWeight = false;
+    };
+    
+    /**
+     * @class RecordSink
+     * @brief Receives the records extracted by the handler.
+     * 
+     * Records are passed by non-const reference so sinks can move strings out.
+     */
+    class RecordSink {
+    public:
+        virtual ~RecordSink() = default;
+        virtual void onNode(NodeRecord& record) = 0;
+        virtual void onEdge(EdgeRecord& record) = 0;
+        virtual void onNodesComplete() {}
+        virtual void onDocumentComplete() {}
+    };
+    
+    /**
+     * @brief Constructs a handler that forwards records to a sink.
+     * @param sink Receiver of the parsed records
+     */
+    explicit GraphSaxHandler(RecordSink& sink);
+    
+    // nlohmann::json SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(json::number_integer_t value);
+    bool number_unsigned(json::number_unsigned_t value);
+    bool number_float(json::number_float_t value, const json::string_t& raw);
+    bool string(json::string_t& value);
+    bool binary(json::binary_t& value);
+    bool start_object(std::size_t elements);
+    bool key(json::string_t& value);
+    bool end_object();
+    bool start_array(std::size_t elements);
+    bool end_array();
+    bool parse_error(std::size_t position, const std::string& lastToken,
+                     const nlohmann::detail::exception& ex);
+    
+    /**
+     * @brief Get the parser error message, if parsing failed.
+     * @return Error message, or an empty string on success
+     */
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    enum class Section { NONE, NODES, EDGES };
+    enum class Field { NONE, ID, NAME, SOURCE, DESTINATION, WEIGHT, TIME_WEIGHT, COST_WEIGHT };
+    
+    static constexpr size_t ROOT_DEPTH = 1;    ///< Depth inside the top-level object
+    static constexpr size_t SECTION_DEPTH = 2; ///< Depth inside a `nodes`/`edges` array
+    static constexpr size_t RECORD_DEPTH = 3;  ///< Depth inside a single node/edge object
+    
+    RecordSink& sink_;
+    size_t depth_ = 0;
+    Section pendingSection_ = Section::NONE;
+    Section section_ = Section::NONE;
+    Field field_ = Field::NONE;
+    
+    NodeRecord node_;
+    bool hasNodeId_ = false;
+    EdgeRecord edge_;
+    std::string errorMessage_;
+    
+    bool onNumber(double value);
+    void finishNode();
+    void finishEdge();
+};
+
+/**
+ * @class GraphRecordBuilder
+ * @brief RecordSink that adds the parsed records to a Graph.
+ * 
+ * Edges that appear before the nodes they reference are held back and
+ * resolved once the whole document has been read.
+ */
+class GraphRecordBuilder : public GraphSaxHandler::RecordSink {
+public:
+    /**
+     * @brief Constructs a sink that populates the given graph.
+     * @param graph Graph to add nodes and edges to
+     */
+    explicit GraphRecordBuilder(graph::Graph& graph);
+    
+    void onNode(GraphSaxHandler::NodeRecord& record) override;
+    void onEdge(GraphSaxHandler::EdgeRecord& record) override;
+    void onNodesComplete() override;
+    void onDocumentComplete() override;
+    
+    size_t getNodesLoaded() const { return nodesLoaded_; }
+    size_t getEdgesLoaded() const { return edgesLoaded_; }
+    size_t getEdgesSkipped() const { return edgesSkipped_; }
+
+private:
+    graph::Graph& graph_;
+    std::vector<GraphSaxHandler::EdgeRecord> deferredEdges_;
+    bool nodesSeen_ = false;
+    
+    size_t nodesLoaded_ = 0;
+    size_t edgesLoaded_ = 0;
+    size_t edgesSkipped_ = 0;
+    
+    bool addEdge(const GraphSaxHandler::EdgeRecord& record);
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,397 @@
+#include "GraphShards.hpp"
+#include "AtomicFile.hpp"
+#include "BinaryGraphHandler.hpp"
+#include "../graph/GraphPartition.hpp"
+#include "../graph/PathFinder.hpp"
+#include "../graph/SearchWorkspace.hpp"
+#include "../util/Parallel.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+using EdgeIndex = graph::CompactGraph::EdgeIndex;
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+const char* const MANIFEST_FILE = "shards.json";
+const char* const OVERLAY_FILE = "overlay.bin";
+const char* const NODE_INDEX_FILE = "nodes.bin";
+
+constexpr OptimizationMode MODES[] = {OptimizationMode::DISTANCE, OptimizationMode::TIME,
+                                      OptimizationMode::COST, OptimizationMode::BALANCED};
+
+/**
+ * @brief Distance, time and cost of a shortest path inside a shard.
+ */
+struct Totals {
+    double distance = 0.0;
+    double time = 0.0;
+    double cost = 0.0;
+};
+
+/**
+ * @brief A shortest path inside a shard from an entry to one of its exits.
+ */
+struct Shortcut {
+    Index exit; ///< Node index in the shard
+    Totals totals;
+    
+    bool operator<(const Shortcut& other) const {
+        return std::tie(exit, totals.distance, totals.time, totals.cost) <
+               std::tie(other.exit, other.totals.distance, other.totals.time, other.totals.cost);
+    }
+    
+    bool operator==(const Shortcut& other) const {
+        return exit == other.exit && totals.distance == other.totals.distance &&
+               totals.time == other.totals.time && totals.cost == other.totals.cost;
+    }
+};
+
+/**
+ * @brief Dijkstra inside a shard that also sums the totals along each shortest path.
+ */
+class TotalsSearch {
+public:
+    explicit TotalsSearch(const graph::CompactGraph& graph)
+        : graph_(graph)
+        , workspace_(graph.getNodeCount())
+        , totals_(graph.getNodeCount()) {
+    }
+    
+    /**
+     * @brief Search from a source until `targetCount` marked nodes are settled.
+     * @param onTarget Called with every settled marked node and the totals of its path
+     */
+    void run(Index source, OptimizationMode mode, const std::vector<uint8_t>& isTarget, size_t targetCount,
+             const std::function<void(Index, const Totals&)>& onTarget) {
+        workspace_.clear();
+        workspace_.reach(source, 0.0, {source, NO_EDGE});
+        
+        while (!workspace_.isHeapEmpty() && targetCount > 0) {
+            auto current = workspace_.pop();
+            if (current.distance > workspace_.getDistance(current.node)) {
+                continue;
+            }
+            
+            // The parent was settled first, so its totals are final
+            const Index node = current.node;
+            const Parent& parent = workspace_.getParent(node);
+            if (parent.edge == NO_EDGE) {
+                totals_[node] = Totals();
+            } else {
+                const Totals& before = totals_[parent.node];
+                totals_[node] = {before.distance + graph_.getDistance(parent.edge),
+                                 before.time + graph_.getTime(parent.edge),
+                                 before.cost + graph_.getCost(parent.edge)};
+            }
+            if (isTarget[node]) {
+                onTarget(node, totals_[node]);
+                --targetCount;
+            }
+            
+            for (EdgeIndex edge = graph_.getFirstEdge(node); edge < graph_.getLastEdge(node); ++edge) {
+                Index neighbor = graph_.getTarget(edge);
+                double cost = current.distance + graph::PathFinder::combineWeights(
+                    graph_.getDistance(edge), graph_.getTime(edge), graph_.getCost(edge), mode);
+                if (!workspace_.isReached(neighbor) || cost < workspace_.getDistance(neighbor)) {
+                    workspace_.reach(neighbor, cost, {node, edge});
+                }
+            }
+        }
+    }
+
+private:
+    struct Parent {
+        Index node;
+        EdgeIndex edge;
+    };
+    
+    static constexpr EdgeIndex NO_EDGE = ~EdgeIndex(0);
+    
+    const graph::CompactGraph& graph_;
+    graph::SearchWorkspace<Parent> workspace_;
+    std::vector<Totals> totals_; ///< Valid for the nodes settled in the current search
+};
+
+std::string joinPath(const std::string& directory, const std::string& fileName) {
+    return (std::filesystem::path(directory) / fileName).string();
+}
+
+} // namespace
+
+GraphShards GraphShards::split(const graph::CompactGraph& graph, const std::string& directory,
+                               size_t maxShardNodes, unsigned threads) {
+    if (maxShardNodes < 2) {
+        throw std::invalid_argument("Shards must be allowed at least 2 nodes");
+    }
+    threads = util::resolveThreadCount(threads);
+    const size_t nodeCount = graph.getNodeCount();
+    
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        throw std::runtime_error("Failed to create " + directory + ": " + ec.message());
+    }
+    
+    // The shards are the cells of a one-level partition
+    std::vector<uint32_t> shardOf(nodeCount, 0);
+    size_t shardCount = 1;
+    if (nodeCount > maxShardNodes) {
+        graph::GraphPartition partition = graph::GraphPartition::build(graph, {maxShardNodes}, threads);
+        shardCount = partition.getCellCount(0);
+        for (Index node = 0; node < nodeCount; ++node) {
+            shardOf[node] = partition.getCell(0, node);
+        }
+    }
+    
+    // Shards number their nodes in the graph's order
+    std::vector<std::vector<Index>> members(shardCount);
+    std::vector<Index> localIndex(nodeCount);
+    for (Index node = 0; node < nodeCount; ++node) {
+        localIndex[node] = static_cast<Index>(members[shardOf[node]].size());
+        members[shardOf[node]].push_back(node);
+    }
+    
+    // Cut edges leave their shard at an exit and arrive at an entry of another
+    std::vector<uint8_t> isEntry(nodeCount, 0);
+    std::vector<uint8_t> isExit(nodeCount, 0);
+    size_t cutEdgeCount = 0;
+    for (Index node = 0; node < nodeCount; ++node) {
+        for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+            Index target = graph.getTarget(edge);
+            if (shardOf[node] != shardOf[target]) {
+                isExit[node] = 1;
+                isEntry[target] = 1;
+                ++cutEdgeCount;
+            }
+        }
+    }
+    
+    graph::CompactGraphBuilder overlay;
+    graph::CompactGraphBuilder nodeIndex;
+    std::vector<Index> overlayIndex(nodeCount, graph::CompactGraph::INVALID_INDEX);
+    nlohmann::json manifestShards = nlohmann::json::array();
+    for (size_t shard = 0; shard < shardCount; ++shard) {
+        const std::vector<Index>& nodes = members[shard];
+        const Index firstBoundary = static_cast<Index>(overlay.getNodeCount());
+        graph::CompactGraphBuilder builder;
+        for (Index node : nodes) {
+            nodeIndex.addNode(graph.getNodeId(node));
+            Index local = builder.addNode(graph.getNodeId(node), graph.getNodeName(node));
+            if (graph.hasCoordinates()) {
+                builder.setCoordinate(local, graph.getLatitude(node), graph.getLongitude(node));
+            }
+            if (isEntry[node] || isExit[node]) {
+                overlayIndex[node] = overlay.addNode(graph.getNodeId(node), graph.getNodeName(node));
+                if (graph.hasCoordinates()) {
+                    overlay.setCoordinate(overlayIndex[node], graph.getLatitude(node), graph.getLongitude(node));
+                }
+            }
+        }
+        for (Index node : nodes) {
+            for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+                Index target = graph.getTarget(edge);
+                if (shardOf[target] == shard) {
+                    builder.addEdge(graph.getEdgeId(edge), localIndex[node], localIndex[target],
+                                    graph.getDistance(edge), graph.getTime(edge), graph.getCost(edge),
+                                    graph.getMode(edge));
+                }
+            }
+        }
+        graph::CompactGraph shardGraph = builder.build(threads);
+        const std::string fileName = "shard-" + std::to_string(shard) + ".bin";
+        if (!BinaryGraphHandler::writeBinaryGraph(shardGraph, joinPath(directory, fileName))) {
+            throw std::runtime_error("Failed to write " + joinPath(directory, fileName));
+        }
+        
+        // Shortest paths inside the shard from every entry to the exits, in every mode
+        std::vector<Index> entries;
+        std::vector<uint8_t> isShardExit(nodes.size(), 0);
+        size_t exitCount = 0;
+        for (Index node : nodes) {
+            if (isEntry[node]) {
+                entries.push_back(localIndex[node]);
+            }
+            if (isExit[node]) {
+                isShardExit[localIndex[node]] = 1;
+                ++exitCount;
+            }
+        }
+        std::vector<std::vector<Shortcut>> shortcuts(exitCount > 0 ? entries.size() : 0);
+        std::vector<std::unique_ptr<TotalsSearch>> searches(threads);
+        util::parallelForEach(shortcuts.size(), threads, [&](size_t item, unsigned threadIndex) {
+            if (!searches[threadIndex]) {
+                searches[threadIndex] = std::make_unique<TotalsSearch>(shardGraph);
+            }
+            std::vector<Shortcut>& found = shortcuts[item];
+            for (OptimizationMode mode : MODES) {
+                searches[threadIndex]->run(entries[item], mode, isShardExit, exitCount,
+                                           [&](Index exit, const Totals& totals) {
+                    if (exit != entries[item]) {
+                        found.push_back({exit, totals});
+                    }
+                });
+            }
+            // Modes often agree on the path; one edge per distinct path is enough
+            std::sort(found.begin(), found.end());
+            found.erase(std::unique(found.begin(), found.end()), found.end());
+        });
+        for (size_t item = 0; item < shortcuts.size(); ++item) {
+            Index entry = overlayIndex[nodes[entries[item]]];
+            for (const Shortcut& shortcut : shortcuts[item]) {
+                overlay.addEdge({}, entry, overlayIndex[nodes[shortcut.exit]], shortcut.totals.distance,
+                                shortcut.totals.time, shortcut.totals.cost);
+            }
+        }
+        
+        manifestShards.push_back({{"graph", fileName},
+                                  {"nodes", nodes.size()},
+                                  {"edges", shardGraph.getEdgeCount()},
+                                  {"boundary", {firstBoundary, overlay.getNodeCount()}}});
+    }
+    
+    for (Index node = 0; node < nodeCount; ++node) {
+        for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+            Index target = graph.getTarget(edge);
+            if (shardOf[node] != shardOf[target]) {
+                overlay.addEdge(graph.getEdgeId(edge), overlayIndex[node], overlayIndex[target],
+                                graph.getDistance(edge), graph.getTime(edge), graph.getCost(edge),
+                                graph.getMode(edge));
+            }
+        }
+    }
+    if (!BinaryGraphHandler::writeBinaryGraph(overlay.build(threads), joinPath(directory, OVERLAY_FILE))) {
+        throw std::runtime_error("Failed to write " + joinPath(directory, OVERLAY_FILE));
+    }
+    if (!BinaryGraphHandler::writeBinaryGraph(nodeIndex.build(threads), joinPath(directory, NODE_INDEX_FILE))) {
+        throw std::runtime_error("Failed to write " + joinPath(directory, NODE_INDEX_FILE));
+    }
+    
+    // The manifest goes last, so a directory with one is complete
+    nlohmann::json manifest = {{"format", FORMAT_VERSION},
+                               {"overlay", OVERLAY_FILE},
+                               {"node_index", NODE_INDEX_FILE},
+                               {"cut_edges", cutEdgeCount},
+                               {"shards", manifestShards}};
+    const std::string path = manifestPath(directory);
+    const std::string text = manifest.dump(2) + "\n";
+    AtomicFile file(path);
+    if (file.isOpen()) {
+        file.write(text.data(), text.size());
+    }
+    if (!file.commit()) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+    return open(directory);
+}
+
+GraphShards GraphShards::open(const std::string& directory) {
+    const std::string path = manifestPath(directory);
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    
+    GraphShards shards;
+    shards.directory_ = directory;
+    std::string overlayFile;
+    std::string nodeIndexFile;
+    try {
+        const nlohmann::json manifest = nlohmann::json::parse(in);
+        if (manifest.at("format").get<uint32_t>() != FORMAT_VERSION) {
+            throw std::runtime_error("unsupported format " + manifest.at("format").dump());
+        }
+        overlayFile = manifest.at("overlay").get<std::string>();
+        nodeIndexFile = manifest.at("node_index").get<std::string>();
+        shards.cutEdgeCount_ = manifest.at("cut_edges").get<size_t>();
+        for (const auto& entry : manifest.at("shards")) {
+            const auto& boundary = entry.at("boundary");
+            shards.shards_.push_back({entry.at("graph").get<std::string>(), entry.at("nodes").get<size_t>(),
+                                      entry.at("edges").get<size_t>(), boundary.at(0).get<Index>(),
+                                      boundary.at(1).get<Index>()});
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Malformed shard manifest " + path + ": " + e.what());
+    }
+    
+    shards.overlay_ = BinaryGraphHandler::mapBinaryGraph(joinPath(directory, overlayFile));
+    Index expectedFirst = 0;
+    for (const Shard& shard : shards.shards_) {
+        if (shard.firstBoundary != expectedFirst || shard.lastBoundary < shard.firstBoundary) {
+            throw std::runtime_error("Malformed shard manifest " + path + ": boundary ranges do not tile");
+        }
+        expectedFirst = shard.lastBoundary;
+        shards.boundaryEnds_.push_back(shard.lastBoundary);
+    }
+    if (expectedFirst != shards.overlay_.getNodeCount()) {
+        throw std::runtime_error("Overlay " + joinPath(directory, overlayFile) + " does not match its manifest");
+    }
+    
+    shards.nodeIndex_ = BinaryGraphHandler::mapBinaryGraph(joinPath(directory, nodeIndexFile));
+    size_t nodeEnd = 0;
+    for (const Shard& shard : shards.shards_) {
+        nodeEnd += shard.nodeCount;
+        shards.nodeEnds_.push_back(static_cast<Index>(nodeEnd));
+    }
+    if (nodeEnd != shards.nodeIndex_.getNodeCount()) {
+        throw std::runtime_error("Node index " + joinPath(directory, nodeIndexFile) + " does not match its manifest");
+    }
+    
+    const graph::CompactGraph& overlay = shards.overlay_;
+    std::vector<uint8_t> isEntry(overlay.getNodeCount(), 0);
+    std::vector<uint8_t> isExit(overlay.getNodeCount(), 0);
+    for (Index node = 0; node < overlay.getNodeCount(); ++node) {
+        for (EdgeIndex edge = overlay.getFirstEdge(node); edge < overlay.getLastEdge(node); ++edge) {
+            Index target = overlay.getTarget(edge);
+            if (shards.getShardOf(node) != shards.getShardOf(target)) {
+                isExit[node] = 1;
+                isEntry[target] = 1;
+            }
+        }
+    }
+    shards.entries_.resize(shards.shards_.size());
+    shards.exits_.resize(shards.shards_.size());
+    for (Index node = 0; node < overlay.getNodeCount(); ++node) {
+        if (isEntry[node]) {
+            shards.entries_[shards.getShardOf(node)].push_back(node);
+        }
+        if (isExit[node]) {
+            shards.exits_[shards.getShardOf(node)].push_back(node);
+        }
+    }
+    return shards;
+}
+
+std::string GraphShards::manifestPath(const std::string& directory) {
+    return joinPath(directory, MANIFEST_FILE);
+}
+
+std::string GraphShards::getShardPath(size_t shard) const {
+    return joinPath(directory_, shards_[shard].graphFile);
+}
+
+uint32_t GraphShards::getShardOf(Index boundaryNode) const {
+    return static_cast<uint32_t>(std::upper_bound(boundaryEnds_.begin(), boundaryEnds_.end(), boundaryNode) -
+                                 boundaryEnds_.begin());
+}
+
+uint32_t GraphShards::findShard(std::string_view nodeId) const {
+    Index node = nodeIndex_.findNode(nodeId);
+    if (node == graph::CompactGraph::INVALID_INDEX) {
+        return NO_SHARD;
+    }
+    return static_cast<uint32_t>(std::upper_bound(nodeEnds_.begin(), nodeEnds_.end(), node) - nodeEnds_.begin());
+}
+
+} // namespace data
+} // namespace dijkstra
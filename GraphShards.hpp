@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../graph/CompactGraph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class GraphShards
+ * @brief A graph split by region into shard files, joined by a boundary overlay.
+ * 
+ * The shard directory holds:
+ * - `shard-<K>.bin`: the nodes of shard K and the edges between them;
+ * - `overlay.bin`: the boundary nodes of every shard, grouped by shard. Its
+ *   edges are the cut edges between shards and, inside each shard, edges
+ *   from every entry to every exit it reaches. Such an edge carries the
+ *   distance, time and cost of a shortest path inside the shard in one of
+ *   the optimization modes, one edge per distinct path, so searching the
+ *   overlay in any mode sees the exact in-shard cost of that mode;
+ * - `nodes.bin`: the node index, a graph without edges holding the IDs of
+ *   every node, grouped by shard in shard order, which tells the shard of
+ *   any node without asking the shards;
+ * - `shards.json`: the manifest naming the files and the overlay nodes of
+ *   each shard.
+ * 
+ * The sources of cut edges are the exits of their shard, the targets the
+ * entries of theirs. Shards are the cells of a single-level GraphPartition,
+ * so they follow the geography when the graph has coordinates. Node and
+ * edge IDs are kept, so every file can be queried by the original IDs.
+ */
+class GraphShards {
+public:
+    using Index = graph::CompactGraph::Index;
+    
+    static constexpr uint32_t FORMAT_VERSION = 2; ///< Version of the manifest, overlay and node index layout
+    static constexpr uint32_t NO_SHARD = ~uint32_t(0);
+    
+    /**
+     * @brief One shard as listed in the manifest.
+     */
+    struct Shard {
+        std::string graphFile; ///< Shard graph file name, relative to the directory
+        size_t nodeCount;
+        size_t edgeCount;
+        Index firstBoundary;   ///< First overlay node of the shard
+        Index lastBoundary;    ///< One past the last overlay node of the shard
+    };
+    
+    /**
+     * @brief Split a graph into shards and write them, with the overlay, to a directory.
+     * @param graph Graph to split
+     * @param directory Output directory (created if missing; existing shard files are replaced)
+     * @param maxShardNodes Largest number of nodes in one shard
+     * @param threads Number of threads for partitioning and the overlay (0 = one per hardware thread)
+     * @return The written shards, opened
+     * @throws std::invalid_argument if maxShardNodes is below 2
+     * @throws std::runtime_error if a file cannot be written
+     */
+    static GraphShards split(const graph::CompactGraph& graph, const std::string& directory,
+                             size_t maxShardNodes, unsigned threads = 0);
+    
+    /**
+     * @brief Read the manifest of a shard directory and map its overlay and node index.
+     * 
+     * The shard graphs themselves are not opened.
+     * 
+     * @param directory Shard directory
+     * @return The shards
+     * @throws std::runtime_error if the manifest, overlay or node index is missing or malformed
+     */
+    static GraphShards open(const std::string& directory);
+    
+    /**
+     * @brief Get the manifest path of a shard directory.
+     */
+    static std::string manifestPath(const std::string& directory);
+    
+    const std::string& getDirectory() const { return directory_; }
+    size_t getShardCount() const { return shards_.size(); }
+    const Shard& getShard(size_t shard) const { return shards_[shard]; }
+    
+    /**
+     * @brief Get the path of a shard's graph file.
+     */
+    std::string getShardPath(size_t shard) const;
+    
+    const graph::CompactGraph& getOverlay() const { return overlay_; }
+    size_t getCutEdgeCount() const { return cutEdgeCount_; }
+    
+    /**
+     * @brief Get the shard an overlay node belongs to.
+     */
+    uint32_t getShardOf(Index boundaryNode) const;
+    
+    /**
+     * @brief Find the shard holding a node of the original graph.
+     * @return The shard, or NO_SHARD if no shard holds the node
+     */
+    uint32_t findShard(std::string_view nodeId) const;
+    
+    /**
+     * @brief Get the overlay nodes of a shard that are targets of cut edges.
+     */
+    const std::vector<Index>& getEntries(size_t shard) const { return entries_[shard]; }
+    
+    /**
+     * @brief Get the overlay nodes of a shard that are sources of cut edges.
+     */
+    const std::vector<Index>& getExits(size_t shard) const { return exits_[shard]; }
+
+private:
+    std::string directory_;
+    std::vector<Shard> shards_;
+    graph::CompactGraph overlay_;
+    size_t cutEdgeCount_ = 0;
+    std::vector<Index> boundaryEnds_; ///< lastBoundary of each shard, for getShardOf()
+    graph::CompactGraph nodeIndex_;
+    std::vector<Index> nodeEnds_;     ///< One past the last node index entry of each shard, for findShard()
+    std::vector<std::vector<Index>> entries_;
+    std::vector<std::vector<Index>> exits_;
+};
+
+} // namespace data
+} // namespace dijkstra
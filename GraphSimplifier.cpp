@@ -0,0 +1,147 @@
+#include "GraphSimplifier.hpp"
+#include "CompoundEdge.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+/**
+ * @brief Node indices and in/out edge lists of a Graph, in edge insertion order.
+ */
+struct Adjacency {
+    std::vector<NodePtr> nodes;
+    std::unordered_map<Node::NodeId, size_t> indices;
+    std::vector<std::vector<EdgePtr>> outgoing;
+    std::vector<std::vector<EdgePtr>> incoming;
+    
+    explicit Adjacency(const Graph& graph) : nodes(graph.getAllNodes()) {
+        indices.reserve(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            indices.emplace(nodes[i]->getId(), i);
+        }
+        outgoing.resize(nodes.size());
+        incoming.resize(nodes.size());
+        for (const auto& edge : graph.getAllEdges()) {
+            outgoing[indexOf(edge->getSource())].push_back(edge);
+            incoming[indexOf(edge->getDestination())].push_back(edge);
+        }
+    }
+    
+    size_t indexOf(const NodePtr& node) const { return indices.at(node->getId()); }
+};
+
+/**
+ * @brief Check whether a node only passes traffic between two distinct neighbours.
+ */
+bool isPassThrough(const Adjacency& adjacency, size_t node) {
+    const auto& in = adjacency.incoming[node];
+    const auto& out = adjacency.outgoing[node];
+    if (in.size() != out.size() || in.empty() || in.size() > 2) {
+        return false;
+    }
+    
+    std::vector<size_t> sources;
+    std::vector<size_t> targets;
+    for (size_t i = 0; i < in.size(); ++i) {
+        sources.push_back(adjacency.indexOf(in[i]->getSource()));
+        targets.push_back(adjacency.indexOf(out[i]->getDestination()));
+    }
+    for (size_t neighbour : sources) {
+        if (neighbour == node) {
+            return false;
+        }
+    }
+    if (in.size() == 1) {
+        return sources[0] != targets[0];
+    }
+    // Two-way: in from {u, w} and out to {u, w} with u != w
+    return sources[0] != sources[1] &&
+           ((sources[0] == targets[0] && sources[1] == targets[1]) ||
+            (sources[0] == targets[1] && sources[1] == targets[0]));
+}
+
+} // namespace
+
+Graph GraphSimplifier::contractChains(const Graph& graph) {
+    Adjacency adjacency(graph);
+    const size_t nodeCount = adjacency.nodes.size();
+    
+    std::vector<bool> contractible(nodeCount);
+    for (size_t node = 0; node < nodeCount; ++node) {
+        contractible[node] = !keep_.count(adjacency.nodes[node]->getId()) && isPassThrough(adjacency, node);
+    }
+    
+    // Follow an edge through contractible nodes up to the next junction
+    std::vector<bool> onChain(nodeCount, false);
+    auto walk = [&](const EdgePtr& first) {
+        std::vector<EdgePtr> parts{first};
+        size_t previous = adjacency.indexOf(first->getSource());
+        size_t current = adjacency.indexOf(first->getDestination());
+        while (contractible[current]) {
+            onChain[current] = true;
+            for (const auto& edge : adjacency.outgoing[current]) {
+                if (adjacency.indexOf(edge->getDestination()) != previous) {
+                    parts.push_back(edge);
+                    break;
+                }
+            }
+            previous = current;
+            current = adjacency.indexOf(parts.back()->getDestination());
+        }
+        return parts;
+    };
+    
+    for (size_t node = 0; node < nodeCount; ++node) {
+        if (!contractible[node]) {
+            for (const auto& edge : adjacency.outgoing[node]) {
+                walk(edge);
+            }
+        }
+    }
+    
+    // Rings without a junction are never reached; keep one node of each
+    for (size_t node = 0; node < nodeCount; ++node) {
+        if (contractible[node] && !onChain[node]) {
+            contractible[node] = false;
+            for (const auto& edge : adjacency.outgoing[node]) {
+                walk(edge);
+            }
+        }
+    }
+    
+    nodesRemoved_ = static_cast<size_t>(std::count(contractible.begin(), contractible.end(), true));
+    chainsContracted_ = 0;
+    Graph simplified;
+    simplified.reserve(nodeCount - nodesRemoved_, graph.getEdgeCount());
+    for (size_t node = 0; node < nodeCount; ++node) {
+        if (!contractible[node]) {
+            simplified.addNode(adjacency.nodes[node]);
+        }
+    }
+    
+    for (const auto& edge : graph.getAllEdges()) {
+        if (contractible[adjacency.indexOf(edge->getSource())]) {
+            continue;
+        }
+        auto parts = walk(edge);
+        if (parts.size() == 1) {
+            simplified.addEdge(edge);
+        } else {
+            Edge::EdgeId id = parts.front()->getId() + ".." + parts.back()->getId();
+            while (graph.getEdge(id) || simplified.getEdge(id)) {
+                id += "'";
+            }
+            simplified.addEdge(std::make_shared<CompoundEdge>(id, std::move(parts)));
+            ++chainsContracted_;
+        }
+    }
+    
+    return simplified;
+}
+
+} // namespace graph
+} // namespace dijkstra
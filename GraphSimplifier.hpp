@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include "Graph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class GraphSimplifier
+ * @brief Contracts chains of degree-2 nodes into CompoundEdge objects.
+ * 
+ * Imported street and rail networks have many nodes that only carry geometry:
+ * a node entered from one neighbour and left towards another, in one direction
+ * (one edge in, one edge out) or in both (two in, two out, same two
+ * neighbours). Every maximal chain of such nodes is replaced by one compound
+ * edge per direction, so a search settles only the junctions. PathFinder
+ * reports paths through compound edges with the removed nodes restored.
+ * 
+ * Removed nodes can no longer be used as query endpoints; mark nodes that must
+ * stay, e.g. named stops, with keepNode(). A ring made only of degree-2 nodes
+ * keeps one of its nodes. The simplified graph shares its node and edge
+ * objects with the input. Converting it to a CompactGraph or writing it out
+ * turns compound edges into plain edges.
+ */
+class GraphSimplifier {
+public:
+    GraphSimplifier() = default;
+    
+    /**
+     * @brief Prevent a node from being contracted.
+     * @param nodeId ID of the node to keep
+     */
+    void keepNode(const Node::NodeId& nodeId) { keep_.insert(nodeId); }
+    
+    /**
+     * @brief Build a copy of a graph with its degree-2 chains contracted.
+     * @param graph Graph to simplify
+     * @return The simplified graph
+     */
+    Graph contractChains(const Graph& graph);
+    
+    size_t getNodesRemoved() const { return nodesRemoved_; }
+    size_t getChainsContracted() const { return chainsContracted_; }
+
+private:
+    std::unordered_set<Node::NodeId> keep_;
+    
+    size_t nodesRemoved_ = 0;
+    size_t chainsContracted_ = 0;
+};
+
+} // namespace graph
+} // namespace dijkstra
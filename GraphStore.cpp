@@ -0,0 +1,295 @@
+#include "GraphStore.hpp"
+#include "AtomicFile.hpp"
+#include "BinaryGraphHandler.hpp"
+#include "../graph/CompactGraph.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+constexpr char SNAPSHOT_PREFIX[] = "snapshot-";
+constexpr char SNAPSHOT_SUFFIX[] = ".bin";
+constexpr char JOURNAL_PREFIX[] = "journal-";
+constexpr char JOURNAL_SUFFIX[] = ".log";
+
+std::string sequenceFileName(const char* prefix, uint64_t sequence, const char* suffix) {
+    // Zero-padded so that directory listings sort in sequence order
+    char digits[21];
+    std::snprintf(digits, sizeof(digits), "%016llu", static_cast<unsigned long long>(sequence));
+    return std::string(prefix) + digits + suffix;
+}
+
+bool parseSequence(const std::string& fileName, const std::string& prefix, const std::string& suffix,
+                   uint64_t& sequence) {
+    if (fileName.size() <= prefix.size() + suffix.size() ||
+        fileName.compare(0, prefix.size(), prefix) != 0 ||
+        fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    const char* first = fileName.data() + prefix.size();
+    const char* last = fileName.data() + fileName.size() - suffix.size();
+    auto result = std::from_chars(first, last, sequence);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+/**
+ * @brief Sequence numbers of the snapshots and journal segments in a directory, ascending.
+ */
+struct DirectoryListing {
+    std::vector<uint64_t> snapshots;
+    std::vector<uint64_t> journals;
+};
+
+DirectoryListing listDirectory(const std::string& directory) {
+    DirectoryListing listing;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string fileName = entry.path().filename().string();
+        uint64_t sequence = 0;
+        if (parseSequence(fileName, SNAPSHOT_PREFIX, SNAPSHOT_SUFFIX, sequence)) {
+            listing.snapshots.push_back(sequence);
+        } else if (parseSequence(fileName, JOURNAL_PREFIX, JOURNAL_SUFFIX, sequence)) {
+            listing.journals.push_back(sequence);
+        }
+    }
+    std::sort(listing.snapshots.begin(), listing.snapshots.end());
+    std::sort(listing.journals.begin(), listing.journals.end());
+    return listing;
+}
+
+graph::Graph loadSnapshot(const std::string& filePath) {
+    return BinaryGraphHandler::mapBinaryGraph(filePath).toGraph();
+}
+
+/**
+ * @brief Write a snapshot durably: true only once the file and its directory entry are synced.
+ */
+bool writeSnapshot(const graph::CompactGraph& graph, const std::string& filePath) {
+    return BinaryGraphHandler::writeBinaryGraph(graph, filePath);
+}
+
+void accumulate(ReplayStats& total, const ReplayStats& segment) {
+    total.recordsRead += segment.recordsRead;
+    total.recordsApplied += segment.recordsApplied;
+    total.recordsRejected += segment.recordsRejected;
+    total.validBytes += segment.validBytes;
+    total.truncated = total.truncated || segment.truncated;
+}
+
+} // namespace
+
+GraphStore::GraphStore(const std::string& directory) : directory_(directory) {
+}
+
+GraphStore::~GraphStore() {
+    waitForCompaction();
+    journal_.reset();
+}
+
+std::string GraphStore::snapshotPath(uint64_t sequence) const {
+    return (std::filesystem::path(directory_) / sequenceFileName(SNAPSHOT_PREFIX, sequence, SNAPSHOT_SUFFIX)).string();
+}
+
+std::string GraphStore::journalPath(uint64_t sequence) const {
+    return (std::filesystem::path(directory_) / sequenceFileName(JOURNAL_PREFIX, sequence, JOURNAL_SUFFIX)).string();
+}
+
+void GraphStore::open() {
+    waitForCompaction();
+    journal_.reset();
+    
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        throw std::runtime_error("Failed to create store directory " + directory_ + ": " + ec.message());
+    }
+    
+    // Leftovers of an interrupted snapshot write
+    for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+        if (entry.path().extension() == ".tmp") {
+            std::filesystem::remove(entry.path(), ec);
+        }
+    }
+    
+    auto listing = listDirectory(directory_);
+    uint64_t snapshotSequence = 0;
+    graph_ = graph::Graph();
+    if (!listing.snapshots.empty()) {
+        snapshotSequence = listing.snapshots.back();
+        graph_ = loadSnapshot(snapshotPath(snapshotSequence));
+    }
+    snapshotSequence_ = snapshotSequence;
+    
+    replayStats_ = ReplayStats();
+    uint64_t activeSequence = snapshotSequence;
+    for (uint64_t sequence : listing.journals) {
+        if (sequence >= snapshotSequence) {
+            accumulate(replayStats_, JournalReader::replay(journalPath(sequence), graph_));
+            activeSequence = sequence;
+        }
+    }
+    
+    journal_ = std::make_unique<JournalWriter>(journalPath(activeSequence), activeSequence);
+    AtomicFile::syncDirectory(directory_);
+    removeObsoleteFiles(snapshotSequence);
+}
+
+bool GraphStore::importGraph(const graph::Graph& graph) {
+    waitForCompaction();
+    if (!journal_) {
+        return false;
+    }
+    
+    // Convert first: a graph fromGraph refuses must leave the store untouched
+    graph::CompactGraph snapshot = graph::CompactGraph::fromGraph(graph);
+    rotateJournal();
+    uint64_t sequence = journal_->getSequence();
+    if (!writeSnapshot(snapshot, snapshotPath(sequence))) {
+        return false;
+    }
+    
+    // Reload rather than copy, so the live graph shares no nodes or edges
+    // with the caller's
+    graph_ = loadSnapshot(snapshotPath(sequence));
+    snapshotSequence_ = sequence;
+    removeObsoleteFiles(sequence);
+    return true;
+}
+
+bool GraphStore::addNode(const std::string& nodeId, const std::string& name) {
+    if (graph_.getNode(nodeId)) {
+        return false; // Node already exists
+    }
+    return record(JournalEntry::addNode(nodeId, name));
+}
+
+bool GraphStore::addEdge(const std::string& edgeId, const std::string& sourceId, const std::string& destinationId,
+                         double weight, double timeWeight, double costWeight) {
+    if (!graph_.getNode(sourceId) || !graph_.getNode(destinationId) || graph_.getEdge(edgeId)) {
+        return false; // Unknown endpoint or duplicate edge ID
+    }
+    return record(JournalEntry::addEdge(edgeId, sourceId, destinationId, weight, timeWeight, costWeight));
+}
+
+bool GraphStore::removeEdge(const std::string& edgeId) {
+    if (!graph_.getEdge(edgeId)) {
+        return false;
+    }
+    return record(JournalEntry::removeEdge(edgeId));
+}
+
+bool GraphStore::setEdgeWeights(const std::string& edgeId, double weight, double timeWeight, double costWeight) {
+    if (!graph_.getEdge(edgeId)) {
+        return false;
+    }
+    return record(JournalEntry::setWeights(edgeId, weight, timeWeight, costWeight));
+}
+
+bool GraphStore::sync() {
+    return journal_ && journal_->sync();
+}
+
+bool GraphStore::startCompaction() {
+    if (!journal_ || compacting_.exchange(true)) {
+        return false;
+    }
+    if (compactionThread_.joinable()) {
+        compactionThread_.join();
+    }
+    
+    uint64_t baseSequence = snapshotSequence_.load();
+    rotateJournal();
+    uint64_t targetSequence = journal_->getSequence();
+    compactionThread_ = std::thread(&GraphStore::compact, this, baseSequence, targetSequence);
+    return true;
+}
+
+bool GraphStore::waitForCompaction() {
+    if (compactionThread_.joinable()) {
+        compactionThread_.join();
+    }
+    return getCompactionError().empty();
+}
+
+std::string GraphStore::getCompactionError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return compactionError_;
+}
+
+bool GraphStore::record(const JournalEntry& entry) {
+    // Journal first: an edit that is not on disk must not be visible
+    if (!journal_ || !journal_->append(entry) || !journal_->flush()) {
+        return false;
+    }
+    entry.applyTo(graph_);
+    
+    if (compactionThreshold_ > 0 && journal_->getSize() >= compactionThreshold_ && !compacting_.load()) {
+        startCompaction();
+    }
+    return true;
+}
+
+void GraphStore::rotateJournal() {
+    uint64_t nextSequence = journal_->getSequence() + 1;
+    journal_->sync();
+    journal_ = std::make_unique<JournalWriter>(journalPath(nextSequence), nextSequence);
+    
+    // Edits synced to the new segment must not be lost with its directory entry
+    AtomicFile::syncDirectory(directory_);
+}
+
+void GraphStore::compact(uint64_t baseSequence, uint64_t targetSequence) {
+    std::string error;
+    try {
+        graph::Graph graph;
+        std::error_code ec;
+        if (std::filesystem::exists(snapshotPath(baseSequence), ec)) {
+            graph = loadSnapshot(snapshotPath(baseSequence));
+        }
+        for (uint64_t sequence = baseSequence; sequence < targetSequence; ++sequence) {
+            JournalReader::replay(journalPath(sequence), graph);
+        }
+        
+        // The journals are deleted only after the snapshot replacing them is on disk
+        if (!writeSnapshot(graph::CompactGraph::fromGraph(graph), snapshotPath(targetSequence))) {
+            throw std::runtime_error("Failed to write snapshot " + snapshotPath(targetSequence));
+        }
+        snapshotSequence_ = targetSequence;
+        removeObsoleteFiles(targetSequence);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        compactionError_ = error;
+    }
+    compacting_ = false;
+}
+
+void GraphStore::removeObsoleteFiles(uint64_t snapshotSequence) const {
+    auto listing = listDirectory(directory_);
+    std::error_code ec;
+    for (uint64_t sequence : listing.snapshots) {
+        if (sequence < snapshotSequence) {
+            std::filesystem::remove(snapshotPath(sequence), ec);
+        }
+    }
+    for (uint64_t sequence : listing.journals) {
+        if (sequence < snapshotSequence) {
+            std::filesystem::remove(journalPath(sequence), ec);
+        }
+    }
+}
+
+} // namespace data
+} // namespace dijkstra
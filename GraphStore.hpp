@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../graph/Graph.hpp"
+#include "GraphJournal.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class GraphStore
+ * @brief Durable, editable graph kept as a binary snapshot plus a journal of edits.
+ * 
+ * The store directory holds `snapshot-<S>.bin` files (binary graph format)
+ * and `journal-<N>.log` segments. A snapshot with sequence S contains the
+ * effect of every segment numbered below S. open() loads the newest
+ * snapshot and replays the newer segments on top of it.
+ * 
+ * Edits are checked against the in-memory graph and then journaled before
+ * they are applied, so rejected edits never reach the disk. Compaction
+ * rotates to a fresh segment and then, on a background thread, rebuilds
+ * the newest snapshot from the older snapshot and closed segments, and
+ * deletes what it superseded. The snapshot and its directory entry are
+ * synced to disk before anything is deleted, so a crash at any point leaves
+ * either the old history or the new snapshot. Compaction works only on
+ * files, so edits and queries against the live graph continue while it runs.
+ * 
+ * Not thread-safe: edits and reads of getGraph() must be serialized by the
+ * caller. The background compaction never touches the live graph.
+ */
+class GraphStore {
+public:
+    static constexpr uint64_t DEFAULT_COMPACTION_BYTES = 64ull << 20; ///< Journal size that triggers compaction
+    
+    /**
+     * @brief Constructs a store over a directory; nothing is read until open().
+     * @param directory Store directory (created if missing)
+     */
+    explicit GraphStore(const std::string& directory);
+    
+    /**
+     * @brief Waits for a running compaction and closes the journal.
+     */
+    ~GraphStore();
+    
+    GraphStore(const GraphStore&) = delete;
+    GraphStore& operator=(const GraphStore&) = delete;
+    
+    /**
+     * @brief Load the newest snapshot, replay the journal and start appending.
+     * @throws std::runtime_error if the directory or its files cannot be read
+     */
+    void open();
+    
+    /**
+     * @brief Replace the whole graph, e.g. after importing it from JSON.
+     * 
+     * Writes the graph as a new snapshot and drops all older history.
+     * 
+     * @param graph The new contents
+     * @return true if successful, false otherwise
+     * @throws std::invalid_argument if the graph has a CompoundEdge (see CompactGraph::fromGraph)
+     */
+    bool importGraph(const graph::Graph& graph);
+    
+    const graph::Graph& getGraph() const { return graph_; }
+    
+    bool addNode(const std::string& nodeId, const std::string& name);
+    bool addEdge(const std::string& edgeId, const std::string& sourceId, const std::string& destinationId,
+                 double weight, double timeWeight = 0.0, double costWeight = 0.0);
+    bool removeEdge(const std::string& edgeId);
+    bool setEdgeWeights(const std::string& edgeId, double weight, double timeWeight, double costWeight);
+    
+    /**
+     * @brief Wait until every edit so far is on stable storage.
+     * @return true if successful, false otherwise
+     */
+    bool sync();
+    
+    /**
+     * @brief Rotate the journal and compact the closed segments in the background.
+     * @return true if a compaction was started, false if one is already running
+     */
+    bool startCompaction();
+    
+    /**
+     * @brief Block until a running compaction (if any) has finished.
+     * @return true if the last compaction succeeded
+     */
+    bool waitForCompaction();
+    
+    bool isCompacting() const { return compacting_.load(); }
+    
+    /**
+     * @brief Set the active segment size at which compaction starts automatically.
+     * @param bytes Threshold in bytes (0 = never compact automatically)
+     */
+    void setCompactionThreshold(uint64_t bytes) { compactionThreshold_ = bytes; }
+    
+    uint64_t getSnapshotSequence() const { return snapshotSequence_.load(); }
+    uint64_t getJournalSequence() const { return journal_ ? journal_->getSequence() : 0; }
+    const ReplayStats& getReplayStats() const { return replayStats_; }
+    
+    /**
+     * @brief Get the error of the last failed compaction.
+     * @return Error message, or an empty string if it succeeded
+     */
+    std::string getCompactionError() const;
+    
+    std::string snapshotPath(uint64_t sequence) const;
+    std::string journalPath(uint64_t sequence) const;
+
+private:
+    std::string directory_;
+    graph::Graph graph_;
+    std::unique_ptr<JournalWriter> journal_;
+    ReplayStats replayStats_;
+    uint64_t compactionThreshold_ = DEFAULT_COMPACTION_BYTES;
+    
+    std::atomic<uint64_t> snapshotSequence_{0};
+    std::atomic<bool> compacting_{false};
+    std::thread compactionThread_;
+    mutable std::mutex errorMutex_;
+    std::string compactionError_;
+    
+    bool record(const JournalEntry& entry);
+    void rotateJournal();
+    void compact(uint64_t baseSequence, uint64_t targetSequence);
+    void removeObsoleteFiles(uint64_t snapshotSequence) const;
+};
+
+} // namespace data
+} // namespace dijkstra
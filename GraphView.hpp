@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include "Node.hpp"
+#include "Edge.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class GraphView
+ * @brief Read-only access to a directed weighted graph.
+ * 
+ * Implemented by the mutable Graph and by the immutable GraphSnapshot
+ * versions of a ConcurrentGraph, so PathFinder can search either.
+ */
+class GraphView {
+public:
+    using EdgeList = std::vector<EdgePtr>;
+    
+    virtual ~GraphView() = default;
+    
+    /**
+     * @brief Get a node by its ID.
+     * @param nodeId ID of the node to retrieve
+     * @return Shared pointer to the node, or nullptr if not found
+     */
+    virtual NodePtr getNode(const Node::NodeId& nodeId) const = 0;
+    
+    /**
+     * @brief Get an edge by its ID.
+     * @param edgeId ID of the edge to retrieve
+     * @return Shared pointer to the edge, or nullptr if not found
+     */
+    virtual EdgePtr getEdge(const Edge::EdgeId& edgeId) const = 0;
+    
+    /**
+     * @brief Get all edges originating from a specific node.
+     * @param nodeId ID of the source node
+     * @return Vector of edges originating from the node
+     */
+    virtual EdgeList getOutgoingEdges(const Node::NodeId& nodeId) const = 0;
+    
+    /**
+     * @brief Get all nodes in the graph.
+     * @return Vector of all nodes
+     */
+    virtual std::vector<NodePtr> getAllNodes() const = 0;
+    
+    /**
+     * @brief Get all edges in the graph.
+     * @return Vector of all edges
+     */
+    virtual std::vector<EdgePtr> getAllEdges() const = 0;
+    
+    virtual size_t getNodeCount() const = 0;
+    virtual size_t getEdgeCount() const = 0;
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,334 @@
+// Grisu2 double-to-decimal conversion, following the formatter of
+// nlohmann/json 3.11 (include/nlohmann/detail/conversions/to_chars.hpp).
+//
+// Copyright (c) 2009 Florian Loitsch <https://florian.loitsch.com/>
+// Copyright (c) 2013-2022 Niels Lohmann <https://nlohmann.me>
+// SPDX-License-Identifier: MIT
+//
+// See Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+// Integers", PLDI 2010.
+
+#include "Grisu2.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+/**
+ * @brief Unnormalized binary floating point: f * 2^e.
+ */
+struct DiyFp {
+    uint64_t f;
+    int e;
+    
+    DiyFp(uint64_t significand, int exponent) : f(significand), e(exponent) {}
+    
+    /**
+     * @brief x - y; both must have the same exponent and x.f >= y.f.
+     */
+    static DiyFp sub(const DiyFp& x, const DiyFp& y) {
+        return {x.f - y.f, x.e};
+    }
+    
+    /**
+     * @brief x * y, rounded to the upper 64 bits of the product.
+     */
+    static DiyFp mul(const DiyFp& x, const DiyFp& y) {
+        const uint64_t uLo = x.f & 0xFFFFFFFFu;
+        const uint64_t uHi = x.f >> 32u;
+        const uint64_t vLo = y.f & 0xFFFFFFFFu;
+        const uint64_t vHi = y.f >> 32u;
+        
+        const uint64_t p0 = uLo * vLo;
+        const uint64_t p1 = uLo * vHi;
+        const uint64_t p2 = uHi * vLo;
+        const uint64_t p3 = uHi * vHi;
+        
+        uint64_t middle = (p0 >> 32u) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+        middle += uint64_t{1} << 31u; // Round, ties up
+        return {p3 + (p2 >> 32u) + (p1 >> 32u) + (middle >> 32u), x.e + y.e + 64};
+    }
+    
+    /**
+     * @brief Shift so the significand's top bit is set; f must not be 0.
+     */
+    static DiyFp normalize(DiyFp x) {
+        while ((x.f >> 63u) == 0) {
+            x.f <<= 1u;
+            --x.e;
+        }
+        return x;
+    }
+    
+    /**
+     * @brief Shift to the given (smaller or equal) exponent without losing bits.
+     */
+    static DiyFp normalizeTo(const DiyFp& x, int exponent) {
+        return {x.f << (x.e - exponent), exponent};
+    }
+};
+
+/**
+ * @brief A value and the boundaries of the interval of reals that round to it.
+ */
+struct Boundaries {
+    DiyFp w;
+    DiyFp minus;
+    DiyFp plus;
+};
+
+/**
+ * @brief Compute the normalized value and boundaries of a finite positive double.
+ */
+Boundaries computeBoundaries(double value) {
+    constexpr int PRECISION = std::numeric_limits<double>::digits; // Including the hidden bit
+    constexpr int BIAS = std::numeric_limits<double>::max_exponent - 1 + (PRECISION - 1);
+    constexpr int MIN_EXPONENT = 1 - BIAS;
+    constexpr uint64_t HIDDEN_BIT = uint64_t{1} << (PRECISION - 1);
+    
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint64_t biasedExponent = bits >> (PRECISION - 1);
+    const uint64_t fraction = bits & (HIDDEN_BIT - 1);
+    
+    const DiyFp v = biasedExponent == 0 ? DiyFp(fraction, MIN_EXPONENT)
+                                        : DiyFp(fraction + HIDDEN_BIT, static_cast<int>(biasedExponent) - BIAS);
+    
+    // At a power of two the next smaller double is half as far away as the next larger one
+    const bool lowerBoundaryIsCloser = fraction == 0 && biasedExponent > 1;
+    const DiyFp plus(2 * v.f + 1, v.e - 1);
+    const DiyFp minus = lowerBoundaryIsCloser ? DiyFp(4 * v.f - 1, v.e - 2) : DiyFp(2 * v.f - 1, v.e - 1);
+    
+    const DiyFp wPlus = DiyFp::normalize(plus);
+    return {DiyFp::normalize(v), DiyFp::normalizeTo(minus, wPlus.e), wPlus};
+}
+
+// Scaled values get a binary exponent in [ALPHA, -32], so digit generation fits in 64 bits
+constexpr int ALPHA = -60;
+
+/**
+ * @brief A cached power of ten: f * 2^e ~= 10^k.
+ */
+struct CachedPower {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+/**
+ * @brief Find a cached power of ten c with ALPHA <= c.e + e + 64 <= -32.
+ */
+CachedPower cachedPowerFor(int e) {
+    constexpr int MIN_DECIMAL_EXPONENT = -300;
+    constexpr int DECIMAL_STEP = 8;
+    static constexpr CachedPower POWERS[] = {
+        {0xAB70FE17C79AC6CA, -1060, -300}, {0xFF77B1FCBEBCDC4F, -1034, -292}, {0xBE5691EF416BD60C, -1007, -284},
+        {0x8DD01FAD907FFC3C, -980, -276},  {0xD3515C2831559A83, -954, -268},  {0x9D71AC8FADA6C9B5, -927, -260},
+        {0xEA9C227723EE8BCB, -901, -252},  {0xAECC49914078536D, -874, -244},  {0x823C12795DB6CE57, -847, -236},
+        {0xC21094364DFB5637, -821, -228},  {0x9096EA6F3848984F, -794, -220},  {0xD77485CB25823AC7, -768, -212},
+        {0xA086CFCD97BF97F4, -741, -204},  {0xEF340A98172AACE5, -715, -196},  {0xB23867FB2A35B28E, -688, -188},
+        {0x84C8D4DFD2C63F3B, -661, -180},  {0xC5DD44271AD3CDBA, -635, -172},  {0x936B9FCEBB25C996, -608, -164},
+        {0xDBAC6C247D62A584, -582, -156},  {0xA3AB66580D5FDAF6, -555, -148},  {0xF3E2F893DEC3F126, -529, -140},
+        {0xB5B5ADA8AAFF80B8, -502, -132},  {0x87625F056C7C4A8B, -475, -124},  {0xC9BCFF6034C13053, -449, -116},
+        {0x964E858C91BA2655, -422, -108},  {0xDFF9772470297EBD, -396, -100},  {0xA6DFBD9FB8E5B88F, -369, -92},
+        {0xF8A95FCF88747D94, -343, -84},   {0xB94470938FA89BCF, -316, -76},   {0x8A08F0F8BF0F156B, -289, -68},
+        {0xCDB02555653131B6, -263, -60},   {0x993FE2C6D07B7FAC, -236, -52},   {0xE45C10C42A2B3B06, -210, -44},
+        {0xAA242499697392D3, -183, -36},   {0xFD87B5F28300CA0E, -157, -28},   {0xBCE5086492111AEB, -130, -20},
+        {0x8CBCCC096F5088CC, -103, -12},   {0xD1B71758E219652C, -77, -4},     {0x9C40000000000000, -50, 4},
+        {0xE8D4A51000000000, -24, 12},     {0xAD78EBC5AC620000, 3, 20},       {0x813F3978F8940984, 30, 28},
+        {0xC097CE7BC90715B3, 56, 36},      {0x8F7E32CE7BEA5C70, 83, 44},      {0xD5D238A4ABE98068, 109, 52},
+        {0x9F4F2726179A2245, 136, 60},     {0xED63A231D4C4FB27, 162, 68},     {0xB0DE65388CC8ADA8, 189, 76},
+        {0x83C7088E1AAB65DB, 216, 84},     {0xC45D1DF942711D9A, 242, 92},     {0x924D692CA61BE758, 269, 100},
+        {0xDA01EE641A708DEA, 295, 108},    {0xA26DA3999AEF774A, 322, 116},    {0xF209787BB47D6B85, 348, 124},
+        {0xB454E4A179DD1877, 375, 132},    {0x865B86925B9BC5C2, 402, 140},    {0xC83553C5C8965D3D, 428, 148},
+        {0x952AB45CFA97A0B3, 455, 156},    {0xDE469FBD99A05FE3, 481, 164},    {0xA59BC234DB398C25, 508, 172},
+        {0xF6C69A72A3989F5C, 534, 180},    {0xB7DCBF5354E9BECE, 561, 188},    {0x88FCF317F22241E2, 588, 196},
+        {0xCC20CE9BD35C78A5, 614, 204},    {0x98165AF37B2153DF, 641, 212},    {0xE2A0B5DC971F303A, 667, 220},
+        {0xA8D9D1535CE3B396, 694, 228},    {0xFB9B7CD9A4A7443C, 720, 236},    {0xBB764C4CA7A44410, 747, 244},
+        {0x8BAB8EEFB6409C1A, 774, 252},    {0xD01FEF10A657842C, 800, 260},    {0x9B10A4E5E9913129, 827, 268},
+        {0xE7109BFBA19C0C9D, 853, 276},    {0xAC2820D9623BF429, 880, 284},    {0x80444B5E7AA7CF85, 907, 292},
+        {0xBF21E44003ACDD2D, 933, 300},    {0x8E679C2F5E44FF8F, 960, 308},    {0xD433179D9C8CB841, 986, 316},
+        {0x9E19DB92B4E31BA9, 1013, 324},
+    };
+    
+    // k = ceil((ALPHA - e - 1) * log10(2)), with log10(2) ~= 78913 / 2^18
+    const int f = ALPHA - e - 1;
+    const int k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+    const int index = (-MIN_DECIMAL_EXPONENT + k + (DECIMAL_STEP - 1)) / DECIMAL_STEP;
+    return POWERS[index];
+}
+
+/**
+ * @brief For n != 0, return k with 10^(k-1) <= n < 10^k and set pow10 to 10^(k-1).
+ */
+int findLargestPow10(uint32_t n, uint32_t& pow10) {
+    int digits = 1;
+    pow10 = 1;
+    while (digits < 10 && n / 10 >= pow10) {
+        pow10 *= 10;
+        ++digits;
+    }
+    return digits;
+}
+
+/**
+ * @brief Move the last digit towards the value while it stays inside the interval.
+ */
+void roundDigits(char* buffer, int length, uint64_t distance, uint64_t delta, uint64_t rest, uint64_t tenK) {
+    while (rest < distance && delta - rest >= tenK &&
+           (rest + tenK < distance || distance - rest > rest + tenK - distance)) {
+        --buffer[length - 1];
+        rest += tenK;
+    }
+}
+
+/**
+ * @brief Generate the digits of a value between M- and M+ into buffer * 10^decimalExponent.
+ */
+void generateDigits(char* buffer, int& length, int& decimalExponent, DiyFp mMinus, DiyFp w, DiyFp mPlus) {
+    uint64_t delta = DiyFp::sub(mPlus, mMinus).f;
+    uint64_t distance = DiyFp::sub(mPlus, w).f;
+    
+    // Split M+ into an integral part (at most 32 bits) and a fraction
+    const DiyFp one(uint64_t{1} << -mPlus.e, mPlus.e);
+    uint32_t integral = static_cast<uint32_t>(mPlus.f >> -one.e);
+    uint64_t fractional = mPlus.f & (one.f - 1);
+    
+    uint32_t pow10 = 0;
+    int remaining = findLargestPow10(integral, pow10);
+    while (remaining > 0) {
+        const uint32_t digit = integral / pow10;
+        integral %= pow10;
+        buffer[length++] = static_cast<char>('0' + digit);
+        --remaining;
+        
+        const uint64_t rest = (uint64_t{integral} << -one.e) + fractional;
+        if (rest <= delta) {
+            decimalExponent += remaining;
+            roundDigits(buffer, length, distance, delta, rest, uint64_t{pow10} << -one.e);
+            return;
+        }
+        pow10 /= 10;
+    }
+    
+    int fractionDigits = 0;
+    for (;;) {
+        fractional *= 10;
+        const uint64_t digit = fractional >> -one.e;
+        fractional &= one.f - 1;
+        buffer[length++] = static_cast<char>('0' + digit);
+        ++fractionDigits;
+        delta *= 10;
+        distance *= 10;
+        if (fractional <= delta) {
+            break;
+        }
+    }
+    decimalExponent -= fractionDigits;
+    roundDigits(buffer, length, distance, delta, fractional, one.f);
+}
+
+/**
+ * @brief Write the digits of a finite positive double: value = buffer * 10^decimalExponent.
+ */
+void grisu2(char* buffer, int& length, int& decimalExponent, double value) {
+    const Boundaries boundaries = computeBoundaries(value);
+    const CachedPower cached = cachedPowerFor(boundaries.plus.e);
+    const DiyFp power(cached.f, cached.e); // ~= 10^-k
+    
+    const DiyFp w = DiyFp::mul(boundaries.w, power);
+    const DiyFp wMinus = DiyFp::mul(boundaries.minus, power);
+    const DiyFp wPlus = DiyFp::mul(boundaries.plus, power);
+    
+    // Shrink the interval by one unit on each side to allow for the rounding of mul()
+    const DiyFp mMinus(wMinus.f + 1, wMinus.e);
+    const DiyFp mPlus(wPlus.f - 1, wPlus.e);
+    
+    decimalExponent = -cached.k;
+    generateDigits(buffer, length, decimalExponent, mMinus, w, mPlus);
+}
+
+/**
+ * @brief Append an exponent as a sign and at least two digits.
+ */
+char* appendExponent(char* out, int exponent) {
+    *out++ = exponent < 0 ? '-' : '+';
+    uint32_t magnitude = static_cast<uint32_t>(exponent < 0 ? -exponent : exponent);
+    if (magnitude >= 100) {
+        *out++ = static_cast<char>('0' + magnitude / 100);
+        magnitude %= 100;
+    }
+    *out++ = static_cast<char>('0' + magnitude / 10);
+    *out++ = static_cast<char>('0' + magnitude % 10);
+    return out;
+}
+
+/**
+ * @brief Lay out buffer * 10^decimalExponent in fixed-point or exponential notation.
+ */
+char* formatDigits(char* buffer, int length, int decimalExponent) {
+    constexpr int MIN_EXPONENT = -4;
+    constexpr int MAX_EXPONENT = std::numeric_limits<double>::digits10;
+    
+    const int k = length;
+    const int n = length + decimalExponent; // value = 0.digits * 10^n
+    
+    if (k <= n && n <= MAX_EXPONENT) {
+        // digits[000].0
+        std::memset(buffer + k, '0', static_cast<size_t>(n - k));
+        buffer[n] = '.';
+        buffer[n + 1] = '0';
+        return buffer + n + 2;
+    }
+    if (0 < n && n <= MAX_EXPONENT) {
+        // dig.its
+        std::memmove(buffer + n + 1, buffer + n, static_cast<size_t>(k - n));
+        buffer[n] = '.';
+        return buffer + k + 1;
+    }
+    if (MIN_EXPONENT < n && n <= 0) {
+        // 0.[000]digits
+        std::memmove(buffer + 2 - n, buffer, static_cast<size_t>(k));
+        buffer[0] = '0';
+        buffer[1] = '.';
+        std::memset(buffer + 2, '0', static_cast<size_t>(-n));
+        return buffer + 2 - n + k;
+    }
+    
+    // d[.igits]e+XX
+    if (k == 1) {
+        buffer += 1;
+    } else {
+        std::memmove(buffer + 2, buffer + 1, static_cast<size_t>(k - 1));
+        buffer[1] = '.';
+        buffer += 1 + k;
+    }
+    *buffer++ = 'e';
+    return appendExponent(buffer, n - 1);
+}
+
+} // namespace
+
+char* formatGrisu2(char* first, double value) {
+    if (std::signbit(value)) {
+        value = -value;
+        *first++ = '-';
+    }
+    if (value == 0.0) {
+        std::memcpy(first, "0.0", 3);
+        return first + 3;
+    }
+    
+    int length = 0;
+    int decimalExponent = 0;
+    grisu2(first, length, decimalExponent, value);
+    return formatDigits(first, length, decimalExponent);
+}
+
+} // namespace data
+} // namespace dijkstra
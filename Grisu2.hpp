@@ -0,0 +1,26 @@
+#pragma once
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @brief Format a finite double exactly as nlohmann::json::dump() does.
+ *
+ * A local copy of the Grisu2 conversion that nlohmann/json uses, so the
+ * streaming JsonWriter stays byte-compatible with dump() without relying on
+ * the library's internal namespace. Grisu2 always round-trips but is not
+ * always the shortest representation, so a standard shortest conversion
+ * (std::to_chars) would differ in the last digits of about one value in a
+ * thousand.
+ *
+ * Values in [1e-4, 1e15) are written in fixed-point notation, with ".0"
+ * appended to integers; others as d.ddde+XX.
+ *
+ * @param first Output buffer with room for at least 32 characters
+ * @param value Finite value to format
+ * @return Pointer one past the last character written (not NUL-terminated)
+ */
+char* formatGrisu2(char* first, double value);
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,679 @@
+#include "GtfsImporter.hpp"
+#include "CsvReader.hpp"
+#include "../geo/GeoCoordinate.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+
+constexpr int32_t NO_TIME = std::numeric_limits<int32_t>::min();
+constexpr uint32_t NO_TRIP = std::numeric_limits<uint32_t>::max();
+constexpr size_t NOT_TIMED = std::numeric_limits<size_t>::max();
+constexpr uint64_t MIN_RANGE_BYTES = 1 << 20; ///< Smallest range worth a thread of its own
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+template <typename T>
+bool parseInteger(std::string_view text, T& value) {
+    text = trim(text);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseDouble(std::string_view text, double& value) {
+    // strtod needs a terminated string; coordinates are short
+    char digits[64];
+    text = trim(text);
+    if (text.empty() || text.size() >= sizeof(digits)) {
+        return false;
+    }
+    std::copy(text.begin(), text.end(), digits);
+    digits[text.size()] = '\0';
+    char* end = nullptr;
+    value = std::strtod(digits, &end);
+    return end == digits + text.size();
+}
+
+/**
+ * @brief Parse a GTFS time (H:MM:SS, hours may exceed 23) into seconds after midnight.
+ */
+int32_t parseTime(std::string_view text) {
+    text = trim(text);
+    int32_t parts[3] = {0, 0, 0};
+    size_t part = 0;
+    bool digits = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            if (parts[part] > 100000) {
+                return NO_TIME;
+            }
+            parts[part] = parts[part] * 10 + (c - '0');
+            digits = true;
+        } else if (c == ':' && digits && part < 2) {
+            ++part;
+            digits = false;
+        } else {
+            return NO_TIME;
+        }
+    }
+    if (part != 2 || !digits || parts[1] > 59 || parts[2] > 59) {
+        return NO_TIME;
+    }
+    return parts[0] * 3600 + parts[1] * 60 + parts[2];
+}
+
+/**
+ * @brief Day of the week of a YYYYMMDD date, 0 being Monday.
+ */
+int weekday(uint32_t date) {
+    // Days since 1970-01-01 (a Thursday) by the civil-from-days algorithm
+    int64_t year = date / 10000;
+    int64_t month = (date / 100) % 100;
+    int64_t day = date % 100;
+    year -= (month <= 2) ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = era * 146097 + dayOfEra - 719468;
+    return static_cast<int>(((days + 3) % 7 + 7) % 7);
+}
+
+size_t requireColumn(const CsvReader& reader, std::string_view name) {
+    size_t column = reader.findColumn(name);
+    if (column == CsvReader::NO_COLUMN) {
+        throw std::runtime_error("GTFS file " + reader.getPath() + " has no '" + std::string(name) + "' column");
+    }
+    return column;
+}
+
+struct StopRecord {
+    std::string id;
+    std::string name;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    bool hasCoordinate = false;
+};
+
+struct TripRecord {
+    std::string id;
+    std::string routeId;
+    std::string serviceId;
+};
+
+/**
+ * @brief Contents of the small feed files, each filled by its own thread.
+ */
+struct FeedTables {
+    std::vector<StopRecord> stops;
+    std::unordered_map<std::string, int> routeTypes;
+    std::vector<TripRecord> trips;
+    std::unordered_set<std::string> calendarServices;        ///< Running on the service date per calendar.txt
+    std::unordered_map<std::string, int> serviceExceptions;  ///< calendar_dates.txt exception_type on that date
+    size_t stopsSkipped = 0;
+    size_t routesSkipped = 0;
+    size_t tripsSkipped = 0;
+};
+
+void readStops(const std::string& filePath, FeedTables& tables) {
+    CsvReader reader(filePath);
+    reader.readHeader();
+    size_t idColumn = requireColumn(reader, "stop_id");
+    size_t nameColumn = reader.findColumn("stop_name");
+    size_t latColumn = reader.findColumn("stop_lat");
+    size_t lonColumn = reader.findColumn("stop_lon");
+    size_t typeColumn = reader.findColumn("location_type");
+    
+    while (reader.next()) {
+        int locationType = 0;
+        auto type = trim(reader[typeColumn]);
+        if (!type.empty() && !parseInteger(type, locationType)) {
+            ++tables.stopsSkipped;
+            continue;
+        }
+        if (locationType != 0) {
+            continue; // Stations, entrances and the like are not served by trips
+        }
+        
+        StopRecord stop;
+        stop.id = std::string(trim(reader[idColumn]));
+        if (stop.id.empty()) {
+            ++tables.stopsSkipped;
+            continue;
+        }
+        stop.name = std::string(reader[nameColumn]);
+        stop.hasCoordinate = parseDouble(reader[latColumn], stop.latitude) &&
+                             parseDouble(reader[lonColumn], stop.longitude);
+        tables.stops.push_back(std::move(stop));
+    }
+}
+
+void readRoutes(const std::string& filePath, FeedTables& tables) {
+    CsvReader reader(filePath);
+    reader.readHeader();
+    size_t idColumn = requireColumn(reader, "route_id");
+    size_t typeColumn = requireColumn(reader, "route_type");
+    
+    while (reader.next()) {
+        int routeType = 0;
+        if (!parseInteger(reader[typeColumn], routeType)) {
+            ++tables.routesSkipped;
+            continue;
+        }
+        tables.routeTypes[std::string(trim(reader[idColumn]))] = routeType;
+    }
+}
+
+void readTrips(const std::string& filePath, FeedTables& tables) {
+    CsvReader reader(filePath);
+    reader.readHeader();
+    size_t idColumn = requireColumn(reader, "trip_id");
+    size_t routeColumn = requireColumn(reader, "route_id");
+    size_t serviceColumn = requireColumn(reader, "service_id");
+    
+    while (reader.next()) {
+        TripRecord trip;
+        trip.id = std::string(trim(reader[idColumn]));
+        if (trip.id.empty()) {
+            ++tables.tripsSkipped;
+            continue;
+        }
+        trip.routeId = std::string(trim(reader[routeColumn]));
+        trip.serviceId = std::string(trim(reader[serviceColumn]));
+        tables.trips.push_back(std::move(trip));
+    }
+}
+
+void readCalendar(const std::string& filePath, uint32_t date, FeedTables& tables) {
+    static const char* const DAY_COLUMNS[7] = {
+        "monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"
+    };
+    
+    CsvReader reader(filePath);
+    reader.readHeader();
+    size_t idColumn = requireColumn(reader, "service_id");
+    size_t dayColumn = requireColumn(reader, DAY_COLUMNS[weekday(date)]);
+    size_t startColumn = requireColumn(reader, "start_date");
+    size_t endColumn = requireColumn(reader, "end_date");
+    
+    while (reader.next()) {
+        uint32_t startDate = 0;
+        uint32_t endDate = 0;
+        if (trim(reader[dayColumn]) == "1" && parseInteger(reader[startColumn], startDate) &&
+            parseInteger(reader[endColumn], endDate) && startDate <= date && date <= endDate) {
+            tables.calendarServices.insert(std::string(trim(reader[idColumn])));
+        }
+    }
+}
+
+void readCalendarDates(const std::string& filePath, uint32_t date, FeedTables& tables) {
+    CsvReader reader(filePath);
+    reader.readHeader();
+    size_t idColumn = requireColumn(reader, "service_id");
+    size_t dateColumn = requireColumn(reader, "date");
+    size_t typeColumn = requireColumn(reader, "exception_type");
+    
+    while (reader.next()) {
+        uint32_t exceptionDate = 0;
+        int exceptionType = 0;
+        if (parseInteger(reader[dateColumn], exceptionDate) && exceptionDate == date &&
+            parseInteger(reader[typeColumn], exceptionType)) {
+            tables.serviceExceptions[std::string(trim(reader[idColumn]))] = exceptionType;
+        }
+    }
+}
+
+struct ConnectionKey {
+    Index from;
+    Index to;
+    uint8_t mode;
+    
+    bool operator==(const ConnectionKey& other) const {
+        return from == other.from && to == other.to && mode == other.mode;
+    }
+    bool operator<(const ConnectionKey& other) const {
+        if (from != other.from) {
+            return from < other.from;
+        }
+        if (to != other.to) {
+            return to < other.to;
+        }
+        return mode < other.mode;
+    }
+};
+
+struct ConnectionKeyHash {
+    size_t operator()(const ConnectionKey& key) const {
+        uint64_t packed = (static_cast<uint64_t>(key.from) << 32) ^ (static_cast<uint64_t>(key.to) << 3) ^ key.mode;
+        return std::hash<uint64_t>()(packed * 0x9E3779B97F4A7C15ull);
+    }
+};
+
+struct ConnectionTotals {
+    uint64_t count = 0;
+    int64_t seconds = 0; ///< Sum of scheduled ride times
+};
+
+using ConnectionMap = std::unordered_map<ConnectionKey, ConnectionTotals, ConnectionKeyHash>;
+
+struct StopTime {
+    uint32_t sequence;
+    Index stop;
+    int32_t arrival;
+    int32_t departure;
+};
+
+/**
+ * @brief Consecutive stop_times rows of one trip.
+ */
+struct TripRun {
+    uint32_t trip = NO_TRIP;
+    std::vector<StopTime> stopTimes;
+};
+
+/**
+ * @brief Trip lookup shared read-only by the stop_times workers.
+ */
+struct TripTable {
+    std::unordered_map<std::string_view, uint32_t> index;
+    std::vector<uint8_t> modes; ///< NO_MODE for trips that do not run
+};
+
+struct StopTimeColumns {
+    size_t trip;
+    size_t stop;
+    size_t sequence;
+    size_t arrival;
+    size_t departure;
+};
+
+/**
+ * @brief Everything one stop_times.txt range produced.
+ * 
+ * Connections of runs that lie wholly inside the range are already merged;
+ * the first and last run may continue in the neighbouring ranges and are
+ * kept for stitching.
+ */
+struct RangeResult {
+    ConnectionMap connections;
+    TripRun head;
+    TripRun tail;
+    bool hasHead = false;
+    bool hasTail = false;
+    size_t rowsRead = 0;
+    size_t rowsSkipped = 0;
+    size_t connectionsBuilt = 0;
+    bool quotedLineBreak = false;
+};
+
+/**
+ * @brief Turn a run into connections between consecutive stops.
+ * 
+ * Stops without times are timed by linear interpolation between the nearest
+ * timed stops, as the GTFS reference recommends.
+ */
+size_t emitRun(TripRun& run, const TripTable& trips, ConnectionMap& connections) {
+    auto& stopTimes = run.stopTimes;
+    if (run.trip == NO_TRIP || stopTimes.size() < 2) {
+        return 0;
+    }
+    uint8_t mode = trips.modes[run.trip];
+    
+    std::stable_sort(stopTimes.begin(), stopTimes.end(),
+                     [](const StopTime& a, const StopTime& b) { return a.sequence < b.sequence; });
+    
+    size_t previousTimed = NOT_TIMED;
+    for (size_t i = 0; i < stopTimes.size(); ++i) {
+        auto& stopTime = stopTimes[i];
+        if (stopTime.arrival == NO_TIME) {
+            stopTime.arrival = stopTime.departure;
+        } else if (stopTime.departure == NO_TIME) {
+            stopTime.departure = stopTime.arrival;
+        }
+        if (stopTime.arrival == NO_TIME) {
+            continue;
+        }
+        if (previousTimed != NOT_TIMED && previousTimed + 1 < i) {
+            int64_t from = stopTimes[previousTimed].departure;
+            int64_t span = stopTime.arrival - from;
+            size_t steps = i - previousTimed;
+            for (size_t k = previousTimed + 1; k < i; ++k) {
+                auto time = static_cast<int32_t>(from + span * static_cast<int64_t>(k - previousTimed) /
+                                                            static_cast<int64_t>(steps));
+                stopTimes[k].arrival = time;
+                stopTimes[k].departure = time;
+            }
+        }
+        previousTimed = i;
+    }
+    
+    size_t built = 0;
+    for (size_t i = 0; i + 1 < stopTimes.size(); ++i) {
+        const auto& from = stopTimes[i];
+        const auto& to = stopTimes[i + 1];
+        if (from.departure == NO_TIME || to.arrival == NO_TIME || from.stop == to.stop ||
+            to.arrival < from.departure) {
+            continue; // Untimed ends of the trip, repeated stop or inconsistent times
+        }
+        auto& totals = connections[ConnectionKey{from.stop, to.stop, mode}];
+        ++totals.count;
+        totals.seconds += to.arrival - from.departure;
+        ++built;
+    }
+    return built;
+}
+
+RangeResult readStopTimes(const std::string& filePath, uint64_t begin, uint64_t end,
+                          const StopTimeColumns& columns, const TripTable& trips,
+                          const std::unordered_map<std::string_view, Index>& stopIndex) {
+    RangeResult result;
+    CsvReader reader(filePath, begin, end, std::min<uint64_t>(CsvReader::DEFAULT_BUFFER_BYTES, end - begin));
+    TripRun run;
+    std::string runTripId;
+    bool inRun = false;
+    bool tripKnown = false;
+    
+    auto finishRun = [&]() {
+        if (!result.hasHead) {
+            result.head = std::move(run);
+            result.hasHead = true;
+        } else {
+            result.connectionsBuilt += emitRun(run, trips, result.connections);
+        }
+        run = TripRun();
+    };
+    
+    while (reader.next()) {
+        ++result.rowsRead;
+        auto tripId = trim(reader[columns.trip]);
+        if (!inRun || tripId != runTripId) {
+            if (inRun) {
+                finishRun();
+            }
+            inRun = true;
+            runTripId.assign(tripId.data(), tripId.size());
+            auto it = trips.index.find(tripId);
+            tripKnown = it != trips.index.end();
+            if (tripKnown && trips.modes[it->second] != graph::CompactGraph::NO_MODE) {
+                run.trip = it->second;
+            }
+        }
+        if (run.trip == NO_TRIP) {
+            if (!tripKnown) {
+                ++result.rowsSkipped;
+            }
+            continue; // Unknown trip, or one that does not run on the service date
+        }
+        
+        auto stop = stopIndex.find(trim(reader[columns.stop]));
+        StopTime stopTime;
+        if (stop == stopIndex.end() || !parseInteger(reader[columns.sequence], stopTime.sequence)) {
+            ++result.rowsSkipped;
+            continue;
+        }
+        stopTime.stop = stop->second;
+        stopTime.arrival = parseTime(reader[columns.arrival]);
+        stopTime.departure = parseTime(reader[columns.departure]);
+        run.stopTimes.push_back(stopTime);
+    }
+    
+    if (inRun) {
+        if (!result.hasHead) {
+            result.head = std::move(run);
+            result.hasHead = true;
+        } else {
+            result.tail = std::move(run);
+            result.hasTail = true;
+        }
+    }
+    result.quotedLineBreak = reader.hasQuotedLineBreak();
+    return result;
+}
+
+} // namespace
+
+GtfsImporter::GtfsImporter(unsigned threads, size_t splitBytes)
+    : threads_(util::resolveThreadCount(threads)), splitBytes_(std::max<size_t>(splitBytes, 1)) {
+}
+
+travel::TransportMode GtfsImporter::routeTypeToMode(int routeType) {
+    // Basic route types, then the extended (Google Transit) ranges
+    switch (routeType) {
+        case 0:  // Tram, light rail
+        case 1:  // Subway, metro
+        case 12: // Monorail
+            return travel::TransportMode::SUBWAY;
+        case 2:  // Rail
+            return travel::TransportMode::TRAIN;
+        default:
+            break;
+    }
+    if (routeType >= 100 && routeType < 200) {
+        return travel::TransportMode::TRAIN;
+    }
+    if ((routeType >= 400 && routeType < 500) || (routeType >= 900 && routeType < 1000)) {
+        return travel::TransportMode::SUBWAY;
+    }
+    return travel::TransportMode::PUBLIC_BUS;
+}
+
+graph::CompactGraph GtfsImporter::load(const std::string& directory) {
+    namespace fs = std::filesystem;
+    auto filePath = [&](const char* name) { return (fs::path(directory) / name).string(); };
+    
+    bytesRead_ = 0;
+    stopsLoaded_ = 0;
+    tripsLoaded_ = 0;
+    stopTimesRead_ = 0;
+    connectionsBuilt_ = 0;
+    edgesBuilt_ = 0;
+    rowsSkipped_ = 0;
+    rangeCount_ = 0;
+    
+    // The small files are independent of each other
+    FeedTables tables;
+    std::vector<std::function<void()>> readers = {
+        [&] { readStops(filePath("stops.txt"), tables); },
+        [&] { readRoutes(filePath("routes.txt"), tables); },
+        [&] { readTrips(filePath("trips.txt"), tables); }
+    };
+    std::vector<std::string> filesRead = {filePath("stops.txt"), filePath("routes.txt"), filePath("trips.txt"),
+                                          filePath("stop_times.txt")};
+    if (serviceDate_ != 0) {
+        std::error_code ec;
+        if (fs::exists(filePath("calendar.txt"), ec)) {
+            readers.push_back([&] { readCalendar(filePath("calendar.txt"), serviceDate_, tables); });
+            filesRead.push_back(filePath("calendar.txt"));
+        }
+        if (fs::exists(filePath("calendar_dates.txt"), ec)) {
+            readers.push_back([&] { readCalendarDates(filePath("calendar_dates.txt"), serviceDate_, tables); });
+            filesRead.push_back(filePath("calendar_dates.txt"));
+        }
+    }
+    util::parallelForEach(readers.size(), threads_, [&](size_t item, unsigned) { readers[item](); });
+    rowsSkipped_ = tables.stopsSkipped + tables.routesSkipped + tables.tripsSkipped;
+    
+    graph::CompactGraphBuilder builder;
+    std::unordered_map<std::string_view, Index> stopIndex;
+    std::vector<const StopRecord*> stopByNode;
+    stopIndex.reserve(tables.stops.size());
+    stopByNode.reserve(tables.stops.size());
+    for (const auto& stop : tables.stops) {
+        Index node = builder.addNode(stop.id, stop.name);
+        if (node == graph::CompactGraph::INVALID_INDEX) {
+            ++rowsSkipped_; // Duplicate stop_id
+            continue;
+        }
+        if (stop.hasCoordinate) {
+            builder.setCoordinate(node, stop.latitude, stop.longitude);
+        }
+        stopIndex.emplace(stop.id, node);
+        stopByNode.push_back(&stop);
+    }
+    stopsLoaded_ = builder.getNodeCount();
+    
+    TripTable trips;
+    trips.index.reserve(tables.trips.size());
+    trips.modes.reserve(tables.trips.size());
+    for (const auto& trip : tables.trips) {
+        auto route = tables.routeTypes.find(trip.routeId);
+        bool runs = route != tables.routeTypes.end();
+        if (runs && serviceDate_ != 0) {
+            auto exception = tables.serviceExceptions.find(trip.serviceId);
+            if (exception != tables.serviceExceptions.end()) {
+                runs = exception->second == 1;
+            } else {
+                runs = tables.calendarServices.count(trip.serviceId) > 0;
+            }
+        }
+        auto mode = runs ? static_cast<uint8_t>(routeTypeToMode(route->second)) : graph::CompactGraph::NO_MODE;
+        if (trips.index.emplace(trip.id, static_cast<uint32_t>(trips.modes.size())).second) {
+            trips.modes.push_back(mode);
+            tripsLoaded_ += runs ? 1 : 0;
+        } else {
+            ++rowsSkipped_; // Duplicate trip_id
+        }
+    }
+    
+    // stop_times.txt: read the header once, then split the rows into ranges
+    const std::string stopTimesPath = filePath("stop_times.txt");
+    StopTimeColumns columns;
+    uint64_t dataBegin = 0;
+    {
+        CsvReader header(stopTimesPath);
+        header.readHeader();
+        columns.trip = requireColumn(header, "trip_id");
+        columns.stop = requireColumn(header, "stop_id");
+        columns.sequence = requireColumn(header, "stop_sequence");
+        columns.arrival = requireColumn(header, "arrival_time");
+        columns.departure = requireColumn(header, "departure_time");
+        dataBegin = header.getOffset();
+    }
+    uint64_t fileSize = fs::file_size(stopTimesPath);
+    uint64_t dataBytes = fileSize - std::min(dataBegin, fileSize);
+    size_t ranges = std::max<uint64_t>({(dataBytes + splitBytes_ - 1) / splitBytes_,
+                                        std::min<uint64_t>(threads_, dataBytes / MIN_RANGE_BYTES), 1});
+    
+    std::vector<RangeResult> results(ranges);
+    auto readRanges = [&]() {
+        util::parallelForEach(ranges, threads_, [&](size_t range, unsigned) {
+            uint64_t begin = dataBegin + dataBytes * range / ranges;
+            uint64_t end = dataBegin + dataBytes * (range + 1) / ranges;
+            results[range] = readStopTimes(stopTimesPath, begin, end, columns, trips, stopIndex);
+        });
+    };
+    readRanges();
+    bool quotedLineBreak = std::any_of(results.begin(), results.end(),
+                                       [](const RangeResult& result) { return result.quotedLineBreak; });
+    if (ranges > 1 && quotedLineBreak) {
+        // A line break inside quotes may have been taken for a row boundary
+        ranges = 1;
+        results.assign(1, RangeResult());
+        readRanges();
+    }
+    rangeCount_ = ranges;
+    
+    // Merge the ranges and stitch together the trips cut by range boundaries
+    ConnectionMap connections = std::move(results.front().connections);
+    for (size_t range = 1; range < results.size(); ++range) {
+        for (const auto& [key, totals] : results[range].connections) {
+            auto& merged = connections[key];
+            merged.count += totals.count;
+            merged.seconds += totals.seconds;
+        }
+    }
+    TripRun pending;
+    bool hasPending = false;
+    auto stitch = [&](TripRun& piece) {
+        if (hasPending && piece.trip == pending.trip) {
+            pending.stopTimes.insert(pending.stopTimes.end(), piece.stopTimes.begin(), piece.stopTimes.end());
+            return;
+        }
+        if (hasPending) {
+            connectionsBuilt_ += emitRun(pending, trips, connections);
+        }
+        pending = std::move(piece);
+        hasPending = true;
+    };
+    for (auto& result : results) {
+        stopTimesRead_ += result.rowsRead;
+        rowsSkipped_ += result.rowsSkipped;
+        connectionsBuilt_ += result.connectionsBuilt;
+        if (result.hasHead) {
+            stitch(result.head);
+        }
+        if (result.hasTail) {
+            stitch(result.tail);
+        }
+    }
+    if (hasPending) {
+        connectionsBuilt_ += emitRun(pending, trips, connections);
+    }
+    
+    // One edge per stop pair and mode, in a thread-independent order
+    std::vector<ConnectionKey> keys;
+    keys.reserve(connections.size());
+    for (const auto& entry : connections) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    builder.reserve(stopsLoaded_, keys.size());
+    std::unordered_map<uint8_t, travel::TransportPtr> transports;
+    for (const auto& key : keys) {
+        const auto& totals = connections[key];
+        const StopRecord& from = *stopByNode[key.from];
+        const StopRecord& to = *stopByNode[key.to];
+        
+        double distance = 0.0;
+        if (from.hasCoordinate && to.hasCoordinate) {
+            distance = geo::GeoCoordinate(from.latitude, from.longitude)
+                           .distanceTo(geo::GeoCoordinate(to.latitude, to.longitude));
+        }
+        auto& transport = transports[key.mode];
+        if (!transport) {
+            transport = travel::TransportFactory::createTransport(static_cast<travel::TransportMode>(key.mode));
+        }
+        double hours = static_cast<double>(totals.seconds) / static_cast<double>(totals.count) / 3600.0;
+        std::string edgeId = from.id + "->" + to.id + ":" +
+                             travel::TransportFactory::transportModeToString(transport->getMode());
+        
+        builder.addEdge(edgeId, key.from, key.to, distance, hours, transport->calculateTravelCost(distance),
+                        key.mode);
+    }
+    edgesBuilt_ = keys.size();
+    
+    for (const auto& path : filesRead) {
+        std::error_code ec;
+        auto size = fs::file_size(path, ec);
+        bytesRead_ += ec ? 0 : static_cast<size_t>(size);
+    }
+    
+    return builder.build(threads_);
+}
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../graph/CompactGraph.hpp"
+#include "../travel/Transport.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class GtfsImporter
+ * @brief Builds a transit graph from a GTFS feed directory.
+ * 
+ * Reads stops.txt, routes.txt, trips.txt, stop_times.txt and, if present,
+ * calendar.txt and calendar_dates.txt. Every stop (location_type 0) becomes a
+ * node with its coordinates. Every pair of consecutive stops on a trip is a
+ * timetable connection; connections between the same two stops by the same
+ * mode are merged into one edge whose time weight is the mean scheduled ride
+ * time, whose distance is the great-circle distance between the stops and
+ * whose cost comes from the mode's TransportFactory tariff.
+ * 
+ * The small files are parsed concurrently. stop_times.txt, usually by far the
+ * largest, is split into byte ranges that are streamed through CsvReader on
+ * separate threads, so memory use depends on the number of stops, trips and
+ * distinct connections but not on the number of stop_times rows. Trips cut
+ * by a range boundary are stitched back together afterwards. If the file has
+ * quoted fields spanning lines, which makes byte-range splitting unsafe, it
+ * is read again on one thread.
+ * 
+ * The resulting graph is identical for every thread count.
+ */
+class GtfsImporter {
+public:
+    static constexpr size_t DEFAULT_SPLIT_BYTES = 64 << 20; ///< Target bytes of stop_times.txt per range
+    
+    /**
+     * @brief Constructs an importer.
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @param splitBytes Target size of each stop_times.txt range
+     */
+    explicit GtfsImporter(unsigned threads = 0, size_t splitBytes = DEFAULT_SPLIT_BYTES);
+    
+    /**
+     * @brief Only import trips that run on the given day.
+     * @param date Service date as YYYYMMDD (0 = every trip regardless of its calendar)
+     */
+    void setServiceDate(uint32_t date) { serviceDate_ = date; }
+    
+    /**
+     * @brief Import a feed.
+     * @param directory Directory holding the unzipped GTFS files
+     * @return The transit graph
+     * @throws std::runtime_error if a required file is missing or lacks a required column
+     */
+    graph::CompactGraph load(const std::string& directory);
+    
+    /**
+     * @brief Map a GTFS route_type (basic or extended) to a transport mode.
+     * 
+     * Metro, tram and light rail map to SUBWAY, rail to TRAIN, and buses as
+     * well as every other vehicle type to PUBLIC_BUS.
+     * 
+     * @param routeType Value of routes.txt route_type
+     * @return Transport mode
+     */
+    static travel::TransportMode routeTypeToMode(int routeType);
+    
+    size_t getBytesRead() const { return bytesRead_; }
+    size_t getStopsLoaded() const { return stopsLoaded_; }
+    size_t getTripsLoaded() const { return tripsLoaded_; }
+    size_t getStopTimesRead() const { return stopTimesRead_; }
+    size_t getConnectionsBuilt() const { return connectionsBuilt_; }
+    size_t getEdgesBuilt() const { return edgesBuilt_; }
+    size_t getRowsSkipped() const { return rowsSkipped_; }
+    size_t getRangeCount() const { return rangeCount_; }
+    unsigned getThreadCount() const { return threads_; }
+
+private:
+    unsigned threads_;
+    size_t splitBytes_;
+    uint32_t serviceDate_ = 0;
+    
+    size_t bytesRead_ = 0;
+    size_t stopsLoaded_ = 0;
+    size_t tripsLoaded_ = 0;
+    size_t stopTimesRead_ = 0;
+    size_t connectionsBuilt_ = 0;
+    size_t edgesBuilt_ = 0;
+    size_t rowsSkipped_ = 0;
+    size_t rangeCount_ = 0;
+};
+
+} // namespace data
+} // namespace dijkstra
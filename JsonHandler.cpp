@@ -1,10 +1,138 @@
 #include "JsonHandler.hpp"
+#include "GraphSaxHandler.hpp"
+#include "LocationSaxHandler.hpp"
+#include "MappedFile.hpp"
+#include "ParallelJsonLoader.hpp"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <stdexcept>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
 
 namespace dijkstra {
 namespace data {
 
+namespace {
+
+constexpr size_t STREAM_BUFFER_SIZE = 1 << 20; ///< Read buffer for streaming loads
+
+/**
+ * @brief Stream a JSON file through a SAX handler.
+ * @param filePath Path to the JSON file
+ * @param handler SAX handler receiving the events
+ * @param stats Optional output; only bytesRead is filled in here
+ */
+template <typename SaxHandler>
+void streamJsonFile(const std::string& filePath, SaxHandler& handler, LoadStats* stats) {
+    // A large stream buffer keeps the per-character SAX reads out of the kernel
+    std::vector<char> buffer(STREAM_BUFFER_SIZE);
+    std::ifstream file;
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filePath);
+    }
+    
+    if (!nlohmann::json::sax_parse(file, &handler)) {
+        throw std::runtime_error("Failed to parse JSON file " + filePath + ": " + handler.getErrorMessage());
+    }
+    
+    if (stats) {
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(filePath, ec);
+        stats->bytesRead = ec ? 0 : static_cast<size_t>(fileSize);
+    }
+}
+
+/**
+ * @brief Fill in the record counters and timing of a finished load.
+ */
+template <typename Counters>
+void finishLoadStats(const Counters& counters,
+                     std::chrono::steady_clock::time_point startTime, LoadStats* stats) {
+    if (!stats) {
+        return;
+    }
+    
+    stats->nodesLoaded = counters.getNodesLoaded();
+    stats->edgesLoaded = counters.getEdgesLoaded();
+    stats->edgesSkipped = counters.getEdgesSkipped();
+    stats->elapsedSeconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - startTime).count();
+    stats->peakRssBytes = LoadStats::queryPeakRssBytes();
+    stats->threadsUsed = 1;
+}
+
+/**
+ * @brief Name of an itinerary item type as stored in JSON.
+ */
+const char* itemTypeToString(travel::ItineraryItem::ItemType type) {
+    switch (type) {
+        case travel::ItineraryItem::ItemType::TRAVEL: return "travel";
+        case travel::ItineraryItem::ItemType::ACCOMMODATION: return "accommodation";
+        case travel::ItineraryItem::ItemType::ACTIVITY: return "activity";
+        case travel::ItineraryItem::ItemType::MEAL: return "meal";
+        case travel::ItineraryItem::ItemType::BREAK: return "break";
+        default: return "activity";
+    }
+}
+
+travel::ItineraryItem::ItemType stringToItemType(const std::string& type) {
+    if (type == "travel") return travel::ItineraryItem::ItemType::TRAVEL;
+    if (type == "accommodation") return travel::ItineraryItem::ItemType::ACCOMMODATION;
+    if (type == "meal") return travel::ItineraryItem::ItemType::MEAL;
+    if (type == "break") return travel::ItineraryItem::ItemType::BREAK;
+    return travel::ItineraryItem::ItemType::ACTIVITY;
+}
+
+/**
+ * @brief Name of a path result status as stored in JSON.
+ */
+const char* pathStatusToString(graph::PathResult::Status status) {
+    switch (status) {
+        case graph::PathResult::Status::FOUND: return "found";
+        case graph::PathResult::Status::TIMED_OUT: return "timed_out";
+        case graph::PathResult::Status::CANCELLED: return "cancelled";
+        default: return "not_found";
+    }
+}
+
+graph::PathResult::Status stringToPathStatus(const std::string& status) {
+    if (status == "found") return graph::PathResult::Status::FOUND;
+    if (status == "timed_out") return graph::PathResult::Status::TIMED_OUT;
+    if (status == "cancelled") return graph::PathResult::Status::CANCELLED;
+    return graph::PathResult::Status::NOT_FOUND;
+}
+
+/**
+ * @brief Write a coordinate object; keys in the order nlohmann::json sorts them.
+ */
+void writeCoordinate(JsonWriter& writer, const geo::GeoCoordinate& coordinate) {
+    writer.beginObject()
+        .member("latitude", coordinate.getLatitude())
+        .member("longitude", coordinate.getLongitude())
+        .endObject();
+}
+
+/**
+ * @brief Write one edge object; keys in the order nlohmann::json sorts them.
+ */
+void writeEdge(JsonWriter& writer, std::string_view id, std::string_view source, std::string_view destination,
+               double weight, double timeWeight, double costWeight) {
+    writer.beginObject()
+        .member("cost_weight", costWeight)
+        .member("destination", destination)
+        .member("id", id)
+        .member("source", source)
+        .member("time_weight", timeWeight)
+        .member("weight", weight)
+        .endObject();
+}
+
+} // namespace
+
 nlohmann::json JsonHandler::graphToJson(const graph::Graph& graph) {
     nlohmann::json result;
     
@@ -153,6 +281,286 @@ travel::TravelRoute JsonHandler::jsonToRoute(const nlohmann::json& json) {
     return route;
 }
 
+nlohmann::json JsonHandler::itineraryToJson(const travel::Itinerary& itinerary) {
+    nlohmann::json result;
+    
+    result["title"] = itinerary.getTitle();
+    result["description"] = itinerary.getDescription();
+    result["total_cost"] = itinerary.getTotalCost();
+    result["total_duration"] = itinerary.getTotalDuration();
+    
+    // Serialize items
+    nlohmann::json itemsArray = nlohmann::json::array();
+    for (const auto& item : itinerary.getItems()) {
+        nlohmann::json itemJson;
+        itemJson["type"] = itemTypeToString(item->getType());
+        itemJson["title"] = item->getTitle();
+        itemJson["description"] = item->getDescription();
+        itemJson["location"] = item->getLocation();
+        itemJson["duration"] = item->getDuration();
+        itemJson["cost"] = item->getCost();
+        itemsArray.push_back(itemJson);
+    }
+    result["items"] = itemsArray;
+    
+    // Serialize routes
+    nlohmann::json routesArray = nlohmann::json::array();
+    for (const auto& route : itinerary.getRoutes()) {
+        routesArray.push_back(routeToJson(*route));
+    }
+    result["routes"] = routesArray;
+    
+    return result;
+}
+
+travel::Itinerary JsonHandler::jsonToItinerary(const nlohmann::json& json) {
+    travel::Itinerary itinerary(json.value("title", ""));
+    itinerary.setDescription(json.value("description", ""));
+    
+    if (json.contains("items") && json["items"].is_array()) {
+        for (const auto& itemJson : json["items"]) {
+            auto item = std::make_shared<travel::ItineraryItem>(
+                stringToItemType(itemJson.value("type", "")),
+                itemJson.value("title", ""),
+                itemJson.value("description", "")
+            );
+            item->setLocation(itemJson.value("location", ""));
+            item->setDuration(itemJson.value("duration", 0.0));
+            item->setCost(itemJson.value("cost", 0.0));
+            itinerary.addItem(item);
+        }
+    }
+    
+    if (json.contains("routes") && json["routes"].is_array()) {
+        for (const auto& routeJson : json["routes"]) {
+            itinerary.addRoute(std::make_shared<travel::TravelRoute>(jsonToRoute(routeJson)));
+        }
+    }
+    
+    return itinerary;
+}
+
+nlohmann::json JsonHandler::pathResultToJson(const graph::PathResult& result) {
+    nlohmann::json json;
+    
+    json["found"] = result.isFound();
+    json["path"] = result.getPath();
+    json["status"] = pathStatusToString(result.getStatus());
+    json["total_distance"] = result.getTotalDistance();
+    json["total_time"] = result.getTotalTime();
+    json["total_cost"] = result.getTotalCost();
+    
+    return json;
+}
+
+graph::PathResult JsonHandler::jsonToPathResult(const nlohmann::json& json) {
+    graph::PathResult result;
+    
+    result.setFound(json.value("found", false));
+    if (json.contains("status") && json["status"].is_string()) {
+        result.setStatus(stringToPathStatus(json["status"].get<std::string>()));
+    }
+    if (json.contains("path") && json["path"].is_array()) {
+        result.setPath(json["path"].get<graph::PathResult::Path>());
+    }
+    result.setTotalDistance(json.value("total_distance", 0.0));
+    result.setTotalTime(json.value("total_time", 0.0));
+    result.setTotalCost(json.value("total_cost", 0.0));
+    
+    return result;
+}
+
+std::vector<uint8_t> JsonHandler::encode(const nlohmann::json& json, Format format) {
+    switch (format) {
+        case Format::CBOR:
+            return nlohmann::json::to_cbor(json);
+        case Format::MESSAGEPACK:
+            return nlohmann::json::to_msgpack(json);
+        case Format::JSON_PRETTY:
+        case Format::JSON_COMPACT:
+        default: {
+            std::string text = serializeJson(json, format == Format::JSON_PRETTY);
+            return std::vector<uint8_t>(text.begin(), text.end());
+        }
+    }
+}
+
+nlohmann::json JsonHandler::decode(const std::vector<uint8_t>& bytes, Format format) {
+    try {
+        switch (format) {
+            case Format::CBOR:
+                return nlohmann::json::from_cbor(bytes);
+            case Format::MESSAGEPACK:
+                return nlohmann::json::from_msgpack(bytes);
+            case Format::JSON_PRETTY:
+            case Format::JSON_COMPACT:
+            default:
+                return nlohmann::json::parse(bytes.begin(), bytes.end());
+        }
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Failed to decode " + formatToString(format) + ": " + std::string(e.what()));
+    }
+}
+
+std::string JsonHandler::formatToString(Format format) {
+    switch (format) {
+        case Format::JSON_PRETTY: return "json";
+        case Format::JSON_COMPACT: return "json-compact";
+        case Format::CBOR: return "cbor";
+        case Format::MESSAGEPACK: return "msgpack";
+        default: return "unknown";
+    }
+}
+
+JsonHandler::Format JsonHandler::stringToFormat(const std::string& str) {
+    std::string lowerStr = str;
+    std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    
+    if (lowerStr == "json") return Format::JSON_PRETTY;
+    if (lowerStr == "json-compact") return Format::JSON_COMPACT;
+    if (lowerStr == "cbor") return Format::CBOR;
+    if (lowerStr == "msgpack" || lowerStr == "messagepack") return Format::MESSAGEPACK;
+    
+    throw std::invalid_argument("Unsupported serialization format: " + str);
+}
+
+void JsonHandler::writeGraph(JsonWriter& writer, const graph::Graph& graph) {
+    writer.beginObject();
+    
+    writer.key("edges").beginArray();
+    for (const auto& edge : graph.getAllEdges()) {
+        writeEdge(writer, edge->getId(), edge->getSource()->getId(), edge->getDestination()->getId(),
+                  edge->getWeight(), edge->getTimeWeight(), edge->getCostWeight());
+    }
+    writer.endArray();
+    
+    writer.key("nodes").beginArray();
+    for (const auto& node : graph.getAllNodes()) {
+        writer.beginObject()
+            .member("id", node->getId())
+            .member("name", node->getName())
+            .endObject();
+    }
+    writer.endArray();
+    
+    writer.endObject();
+}
+
+void JsonHandler::writeGraph(JsonWriter& writer, const graph::CompactGraph& graph) {
+    using Index = graph::CompactGraph::Index;
+    writer.beginObject();
+    
+    writer.key("edges").beginArray();
+    for (Index node = 0; node < graph.getNodeCount(); ++node) {
+        auto sourceId = graph.getNodeId(node);
+        for (auto edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+            writeEdge(writer, graph.getEdgeId(edge), sourceId, graph.getNodeId(graph.getTarget(edge)),
+                      graph.getDistance(edge), graph.getTime(edge), graph.getCost(edge));
+        }
+    }
+    writer.endArray();
+    
+    writer.key("nodes").beginArray();
+    for (Index node = 0; node < graph.getNodeCount(); ++node) {
+        writer.beginObject()
+            .member("id", graph.getNodeId(node))
+            .member("name", graph.getNodeName(node))
+            .endObject();
+    }
+    writer.endArray();
+    
+    writer.endObject();
+}
+
+void JsonHandler::writeRoute(JsonWriter& writer, const travel::TravelRoute& route) {
+    writer.beginObject();
+    writer.member("description", route.getDescription());
+    writer.member("route_id", route.getRouteId());
+    
+    writer.key("segments").beginArray();
+    for (const auto& segment : route.getSegments()) {
+        writer.beginObject();
+        writer.member("cost", segment->getCost());
+        writer.member("distance", segment->getDistance());
+        writer.key("from_coordinate");
+        writeCoordinate(writer, segment->getFromCoordinate());
+        writer.member("from_location", segment->getFromLocation());
+        writer.member("notes", segment->getNotes());
+        writer.key("to_coordinate");
+        writeCoordinate(writer, segment->getToCoordinate());
+        writer.member("to_location", segment->getToLocation());
+        writer.member("transport_mode", travel::TransportFactory::transportModeToString(
+            segment->getTransport()->getMode()));
+        writer.member("travel_time", segment->getTravelTime());
+        writer.endObject();
+    }
+    writer.endArray();
+    
+    writer.member("total_cost", route.getTotalCost());
+    writer.member("total_distance", route.getTotalDistance());
+    writer.member("total_time", route.getTotalTime());
+    writer.endObject();
+}
+
+void JsonHandler::writeItinerary(JsonWriter& writer, const travel::Itinerary& itinerary) {
+    writer.beginObject();
+    writer.member("description", itinerary.getDescription());
+    
+    writer.key("items").beginArray();
+    for (const auto& item : itinerary.getItems()) {
+        writer.beginObject()
+            .member("cost", item->getCost())
+            .member("description", item->getDescription())
+            .member("duration", item->getDuration())
+            .member("location", item->getLocation())
+            .member("title", item->getTitle())
+            .member("type", itemTypeToString(item->getType()))
+            .endObject();
+    }
+    writer.endArray();
+    
+    writer.key("routes").beginArray();
+    for (const auto& route : itinerary.getRoutes()) {
+        writeRoute(writer, *route);
+    }
+    writer.endArray();
+    
+    writer.member("title", itinerary.getTitle());
+    writer.member("total_cost", itinerary.getTotalCost());
+    writer.member("total_duration", itinerary.getTotalDuration());
+    writer.endObject();
+}
+
+void JsonHandler::writePathResult(JsonWriter& writer, const graph::PathResult& result) {
+    writer.beginObject();
+    writer.member("found", result.isFound());
+    writer.key("path").beginArray();
+    for (const auto& nodeId : result.getPath()) {
+        writer.value(nodeId);
+    }
+    writer.endArray();
+    writer.member("status", pathStatusToString(result.getStatus()));
+    writer.member("total_cost", result.getTotalCost());
+    writer.member("total_distance", result.getTotalDistance());
+    writer.member("total_time", result.getTotalTime());
+    writer.endObject();
+}
+
+void JsonHandler::writeSearchStats(JsonWriter& writer, const graph::SearchStats& stats) {
+    writer.beginObject();
+    writer.member("algorithm", stats.algorithm);
+    writer.member("decrease_keys", stats.decreaseKeys);
+    writer.member("edges_relaxed", stats.edgesRelaxed);
+    writer.member("elapsed_ns", stats.elapsedNanoseconds);
+    writer.member("heap_pops", stats.heapPops);
+    writer.member("heap_pushes", stats.heapPushes);
+    writer.member("nodes_settled", stats.nodesSettled);
+    writer.member("peak_heap_size", stats.peakHeapSize);
+    writer.member("searches", stats.searches);
+    writer.endObject();
+}
+
 nlohmann::json JsonHandler::parseJson(const std::string& jsonStr) {
     try {
         return nlohmann::json::parse(jsonStr);
@@ -195,5 +603,117 @@ bool JsonHandler::writeJsonFile(const nlohmann::json& json, const std::string& f
     }
 }
 
+bool JsonHandler::writeGraphFile(const graph::Graph& graph, const std::string& filePath) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    JsonWriter writer(file);
+    writeGraph(writer, graph);
+    if (!writer.flush()) {
+        return false;
+    }
+    
+    file.close();
+    return !file.fail();
+}
+
+bool JsonHandler::writeGraphFile(const graph::CompactGraph& graph, const std::string& filePath) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    JsonWriter writer(file);
+    writeGraph(writer, graph);
+    if (!writer.flush()) {
+        return false;
+    }
+    
+    file.close();
+    return !file.fail();
+}
+
+graph::Graph JsonHandler::loadGraphFile(const std::string& filePath, LoadStats* stats) {
+    auto startTime = std::chrono::steady_clock::now();
+    
+    graph::Graph graph;
+    GraphRecordBuilder builder(graph);
+    GraphSaxHandler handler(builder);
+    streamJsonFile(filePath, handler, stats);
+    finishLoadStats(builder, startTime, stats);
+    
+    return graph;
+}
+
+graph::CompactGraph JsonHandler::loadLocationsFile(const std::string& filePath, LoadStats* stats) {
+    auto startTime = std::chrono::steady_clock::now();
+    
+    graph::CompactGraphBuilder builder;
+    LocationSaxHandler handler(builder);
+    streamJsonFile(filePath, handler, stats);
+    auto graph = builder.build();
+    finishLoadStats(handler, startTime, stats);
+    
+    return graph;
+}
+
+bool JsonHandler::isLocationsFile(const std::string& filePath) {
+    MappedFile file(filePath);
+    const char* data = file.data();
+    size_t depth = 0;
+    bool inString = false;
+    size_t keyBegin = 0;
+    size_t keyEnd = 0;
+    
+    // Track strings and nesting only, as ParallelJsonLoader's structural scan does
+    for (size_t i = 0; i < file.size(); ++i) {
+        char c = data[i];
+        if (inString) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                inString = false;
+                keyEnd = i;
+            }
+            continue;
+        }
+        
+        if (c == '"') {
+            inString = true;
+            keyBegin = i + 1;
+        } else if (c == ':' && depth == 1) {
+            std::string_view key(data + keyBegin, keyEnd - keyBegin);
+            if (key == "locations" || key == "transportation_routes") {
+                return true;
+            }
+            if (key == "nodes" || key == "edges") {
+                return false;
+            }
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if ((c == '}' || c == ']') && depth > 0) {
+            --depth;
+        }
+    }
+    return false;
+}
+
+graph::CompactGraph JsonHandler::loadCompactGraphFile(const std::string& filePath, unsigned threads,
+                                                      LoadStats* stats) {
+    auto startTime = std::chrono::steady_clock::now();
+    
+    ParallelJsonLoader loader(threads);
+    auto graph = loader.load(filePath);
+    finishLoadStats(loader, startTime, stats);
+    if (stats) {
+        stats->bytesRead = loader.getBytesRead();
+        stats->threadsUsed = loader.getThreadCount();
+    }
+    
+    return graph;
+}
+
 } // namespace data
 } // namespace dijkstra
\ No newline at end of file
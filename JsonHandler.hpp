@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "../graph/Graph.hpp"
+#include "../graph/PathFinder.hpp"
+#include "../graph/CompactGraph.hpp"
 #include "../travel/TravelRoute.hpp"
 #include "../travel/Itinerary.hpp"
+#include "LoadStats.hpp"
+#include "JsonWriter.hpp"
 
 namespace dijkstra {
 namespace data {
@@ -15,6 +21,16 @@ namespace data {
  */
 class JsonHandler {
 public:
+    /**
+     * @brief Wire formats a document can be encoded in.
+     */
+    enum class Format {
+        JSON_PRETTY,  ///< Indented JSON text
+        JSON_COMPACT, ///< JSON text without whitespace
+        CBOR,         ///< RFC 8949 Concise Binary Object Representation
+        MESSAGEPACK   ///< MessagePack
+    };
+    
     /**
      * @brief Convert a graph to JSON.
      * @param graph The graph to convert
@@ -57,6 +73,52 @@ public:
      */
     static travel::Itinerary jsonToItinerary(const nlohmann::json& json);
     
+    /**
+     * @brief Convert a path finding result to JSON.
+     * @param result The result to convert
+     * @return JSON representation
+     */
+    static nlohmann::json pathResultToJson(const graph::PathResult& result);
+    
+    /**
+     * @brief Convert JSON to a path finding result.
+     * @param json JSON representation
+     * @return Constructed result
+     */
+    static graph::PathResult jsonToPathResult(const nlohmann::json& json);
+    
+    /**
+     * @brief Encode a document in the given format.
+     * @param json Document to encode
+     * @param format Output format
+     * @return Encoded bytes (UTF-8 text for the JSON formats)
+     */
+    static std::vector<uint8_t> encode(const nlohmann::json& json, Format format);
+    
+    /**
+     * @brief Decode a document from the given format.
+     * @param bytes Encoded bytes
+     * @param format Format the bytes are in
+     * @return Decoded document
+     * @throws std::runtime_error if the bytes are not valid in that format
+     */
+    static nlohmann::json decode(const std::vector<uint8_t>& bytes, Format format);
+    
+    /**
+     * @brief Get string representation of a format ("json", "json-compact", "cbor", "msgpack").
+     * @param format The format
+     * @return Format name
+     */
+    static std::string formatToString(Format format);
+    
+    /**
+     * @brief Parse a format name as produced by formatToString().
+     * @param str Format name (case-insensitive)
+     * @return The format
+     * @throws std::invalid_argument if the name is unknown
+     */
+    static Format stringToFormat(const std::string& str);
+    
     /**
      * @brief Parse a JSON string.
      * @param jsonStr JSON string
@@ -87,6 +149,123 @@ public:
      * @return true if successful, false otherwise
      */
     static bool writeJsonFile(const nlohmann::json& json, const std::string& filePath, bool pretty = true);
+    
+    /**
+     * @brief Stream a graph as JSON without building a DOM.
+     * 
+     * Writes the same bytes as graphToJson(graph).dump().
+     * 
+     * @param writer Destination
+     * @param graph The graph to write
+     */
+    static void writeGraph(JsonWriter& writer, const graph::Graph& graph);
+    
+    /**
+     * @brief Stream a compact graph as JSON in the `nodes`/`edges` schema.
+     * 
+     * Nodes are written in index order and edges grouped by source node.
+     * 
+     * @param writer Destination
+     * @param graph The graph to write
+     */
+    static void writeGraph(JsonWriter& writer, const graph::CompactGraph& graph);
+    
+    /**
+     * @brief Stream a travel route as JSON; same bytes as routeToJson(route).dump().
+     * @param writer Destination
+     * @param route The route to write
+     */
+    static void writeRoute(JsonWriter& writer, const travel::TravelRoute& route);
+    
+    /**
+     * @brief Stream an itinerary as JSON; same bytes as itineraryToJson(itinerary).dump().
+     * @param writer Destination
+     * @param itinerary The itinerary to write
+     */
+    static void writeItinerary(JsonWriter& writer, const travel::Itinerary& itinerary);
+    
+    /**
+     * @brief Stream a path finding result as JSON; same bytes as pathResultToJson(result).dump().
+     * @param writer Destination
+     * @param result The result to write
+     */
+    static void writePathResult(JsonWriter& writer, const graph::PathResult& result);
+    
+    /**
+     * @brief Stream search statistics as a JSON object.
+     * @param writer Destination
+     * @param stats Statistics of one search or a sum of searches
+     */
+    static void writeSearchStats(JsonWriter& writer, const graph::SearchStats& stats);
+    
+    /**
+     * @brief Write a graph to a compact JSON file without building a DOM.
+     * @param graph The graph to write
+     * @param filePath Path to the output file
+     * @return true if successful, false otherwise
+     */
+    static bool writeGraphFile(const graph::Graph& graph, const std::string& filePath);
+    
+    /**
+     * @brief Write a compact graph to a JSON file without building a DOM.
+     * @param graph The graph to write
+     * @param filePath Path to the output file
+     * @return true if successful, false otherwise
+     */
+    static bool writeGraphFile(const graph::CompactGraph& graph, const std::string& filePath);
+    
+    /**
+     * @brief Load a graph from a `nodes`/`edges` JSON file without building a DOM.
+     * 
+     * Equivalent to jsonToGraph(readJsonFile(filePath)), but the file is streamed
+     * through a SAX parser so peak memory stays proportional to the resulting
+     * graph rather than to the size of the document.
+     * 
+     * @param filePath Path to the JSON file
+     * @param stats Optional output for throughput and memory statistics
+     * @return Constructed graph
+     */
+    static graph::Graph loadGraphFile(const std::string& filePath, LoadStats* stats = nullptr);
+    
+    /**
+     * @brief Load a `locations`/`transportation_routes` JSON file into a compact graph.
+     * 
+     * This is the schema used by sample_data.json. The file is read in a single
+     * streaming pass; coordinates, transport modes and the distance/time/cost
+     * weights go straight into the graph's columns.
+     * 
+     * @param filePath Path to the JSON file
+     * @param stats Optional output for throughput and memory statistics
+     * @return Constructed compact graph
+     */
+    static graph::CompactGraph loadLocationsFile(const std::string& filePath, LoadStats* stats = nullptr);
+    
+    /**
+     * @brief Tell which of the two JSON graph schemas a file uses.
+     * 
+     * Only the top-level keys are looked at, and the scan stops at the first
+     * key that names an array of either schema.
+     * 
+     * @param filePath Path to the JSON file
+     * @return true for `locations`/`transportation_routes` (loadLocationsFile),
+     *         false for `nodes`/`edges` or neither (loadCompactGraphFile)
+     * @throws std::runtime_error if the file cannot be read
+     */
+    static bool isLocationsFile(const std::string& filePath);
+    
+    /**
+     * @brief Load a `nodes`/`edges` JSON file into a compact graph using several threads.
+     * 
+     * Intended for edge lists too large to parse on one core; see
+     * ParallelJsonLoader. The result does not depend on the thread count.
+     * 
+     * @param filePath Path to the JSON file
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @param stats Optional output for throughput and memory statistics
+     * @return Constructed compact graph
+     */
+    static graph::CompactGraph loadCompactGraphFile(const std::string& filePath, unsigned threads = 0,
+                                                    LoadStats* stats = nullptr);
 };
 
 } // namespace data
@@ -0,0 +1,184 @@
+#include "JsonWriter.hpp"
+#include "Grisu2.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+} // namespace
+
+JsonWriter::JsonWriter(std::ostream& out) : stream_(&out) {
+    buffer_.reserve(BUFFER_SIZE);
+}
+
+JsonWriter::JsonWriter(int fd) : fd_(fd) {
+    buffer_.reserve(BUFFER_SIZE);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    beginValue();
+    put('{');
+    hasElements_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    hasElements_.pop_back();
+    put('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    beginValue();
+    put('[');
+    hasElements_.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    hasElements_.pop_back();
+    put(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    beginValue();
+    writeString(name);
+    put(':');
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    beginValue();
+    writeString(text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    char digits[32];
+    beginValue();
+    write(digits, static_cast<size_t>(formatDouble(digits, number) - digits));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    beginValue();
+    if (flag) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    beginValue();
+    write("null", 4);
+    return *this;
+}
+
+bool JsonWriter::flush() {
+    if (buffer_.empty() || !good_) {
+        buffer_.clear();
+        return good_;
+    }
+    
+    if (stream_) {
+        stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        good_ = static_cast<bool>(*stream_);
+    } else {
+#if defined(__unix__) || defined(__APPLE__)
+        const char* data = buffer_.data();
+        size_t remaining = buffer_.size();
+        while (remaining > 0) {
+            ssize_t written = ::write(fd_, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                good_ = false;
+                break;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+#else
+        good_ = false; // File descriptors are only supported on POSIX systems
+#endif
+    }
+    
+    buffer_.clear();
+    return good_;
+}
+
+char* JsonWriter::formatDouble(char* first, double number) {
+    if (!std::isfinite(number)) {
+        std::memcpy(first, "null", 4);
+        return first + 4;
+    }
+    
+    // Grisu2, as in dump(); a shortest round-trip conversion differs in rare last digits
+    return formatGrisu2(first, number);
+}
+
+void JsonWriter::beginValue() {
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (!hasElements_.empty()) {
+        if (hasElements_.back()) {
+            put(',');
+        }
+        hasElements_.back() = true;
+    }
+}
+
+void JsonWriter::writeString(std::string_view text) {
+    put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        
+        write(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"':  write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\b': write("\\b", 2); break;
+            case '\f': write("\\f", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                write(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+    write(text.data() + runStart, text.size() - runStart);
+    put('"');
+}
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <charconv>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class JsonWriter
+ * @brief Writes JSON text straight to an output stream or file descriptor.
+ * 
+ * Nothing is materialized beyond a fixed-size output buffer, so documents of
+ * any size can be written in constant memory. Output matches
+ * nlohmann::json::dump() without indentation: the same string escaping, the
+ * same number layout (shortest round-trip digits, "1.0" for integral
+ * doubles, "null" for NaN and infinity). Callers are responsible for emitting
+ * object keys in sorted order where they want identical bytes, since
+ * nlohmann::json objects are sorted by key. Strings are assumed to be UTF-8.
+ */
+class JsonWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 16; ///< Bytes buffered between writes
+    
+    /**
+     * @brief Constructs a writer that appends to a stream.
+     * @param out Output stream
+     */
+    explicit JsonWriter(std::ostream& out);
+    
+    /**
+     * @brief Constructs a writer that appends to an open file descriptor.
+     * 
+     * The descriptor is not closed by the writer.
+     * 
+     * @param fd Writable file descriptor
+     */
+    explicit JsonWriter(int fd);
+    
+    /**
+     * @brief Flushes any buffered output.
+     */
+    ~JsonWriter();
+    
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+    
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    
+    /**
+     * @brief Write an object key; the next call must write its value.
+     * @param name Key
+     */
+    JsonWriter& key(std::string_view name);
+    
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(double number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+    
+    /**
+     * @brief Write a line break, e.g. between the top-level values of a JSON-lines stream.
+     */
+    JsonWriter& newline() {
+        put('\n');
+        return *this;
+    }
+    
+    template <typename Integer,
+              typename = std::enable_if_t<std::is_integral_v<Integer> && !std::is_same_v<Integer, bool>>>
+    JsonWriter& value(Integer number) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), number);
+        beginValue();
+        write(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+    
+    /**
+     * @brief Write a key and its value.
+     */
+    template <typename T>
+    JsonWriter& member(std::string_view name, const T& content) {
+        key(name);
+        return value(content);
+    }
+    
+    /**
+     * @brief Push buffered output to the stream or descriptor.
+     * @return true if every write so far has succeeded
+     */
+    bool flush();
+    
+    /**
+     * @brief Check whether every write so far has succeeded.
+     */
+    bool good() const { return good_; }
+    
+    /**
+     * @brief Format a double the way nlohmann::json::dump() does.
+     * @param first Output buffer with room for at least 32 characters
+     * @param number Value to format
+     * @return Pointer one past the last character written
+     */
+    static char* formatDouble(char* first, double number);
+
+private:
+    std::ostream* stream_ = nullptr;
+    int fd_ = -1;
+    std::string buffer_;
+    bool good_ = true;
+    
+    std::vector<bool> hasElements_; ///< One entry per open object/array
+    bool afterKey_ = false;
+    
+    void beginValue();
+    void writeString(std::string_view text);
+    
+    void write(const char* data, size_t length) {
+        if (buffer_.size() + length > BUFFER_SIZE) {
+            flush();
+        }
+        buffer_.append(data, length);
+    }
+    void put(char c) {
+        if (buffer_.size() == BUFFER_SIZE) {
+            flush();
+        }
+        buffer_.push_back(c);
+    }
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,43 @@
+#include "LoadStats.hpp"
+#include <sstream>
+#include <iomanip>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace dijkstra {
+namespace data {
+
+std::string LoadStats::toString() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "loaded " << nodesLoaded << " nodes, " << edgesLoaded << " edges";
+    if (edgesSkipped > 0) {
+        oss << " (" << edgesSkipped << " skipped)";
+    }
+    oss << " from " << (bytesRead / 1e6) << " MB in " << elapsedSeconds << " s"
+        << " [" << getThroughputMBps() << " MB/s, peak RSS "
+        << (peakRssBytes / (1024.0 * 1024.0)) << " MiB, "
+        << threadsUsed << (threadsUsed == 1 ? " thread]" : " threads]");
+    return oss.str();
+}
+
+size_t LoadStats::queryPeakRssBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);         // bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // kilobytes on Linux
+#endif
+#else
+    return 0;
+#endif
+}
+
+} // namespace data
+} // namespace dijkstra
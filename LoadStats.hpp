@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @struct LoadStats
+ * @brief Resource usage and throughput figures collected while loading a graph.
+ */
+struct LoadStats {
+    size_t bytesRead = 0;        ///< Size of the input consumed, in bytes
+    size_t nodesLoaded = 0;      ///< Number of nodes added to the graph
+    size_t edgesLoaded = 0;      ///< Number of edges added to the graph
+    size_t edgesSkipped = 0;     ///< Edges dropped because an endpoint was missing or duplicated
+    double elapsedSeconds = 0.0; ///< Wall-clock time spent loading
+    size_t peakRssBytes = 0;     ///< Peak resident set size of the process after loading
+    unsigned threadsUsed = 1;    ///< Number of threads that took part in the load
+    
+    /**
+     * @brief Get the load throughput.
+     * @return Throughput in megabytes (10^6 bytes) per second
+     */
+    double getThroughputMBps() const {
+        return elapsedSeconds > 0.0 ? (bytesRead / 1e6) / elapsedSeconds : 0.0;
+    }
+    
+    /**
+     * @brief Format the statistics as a single human-readable line.
+     * @return Summary string
+     */
+    std::string toString() const;
+    
+    /**
+     * @brief Query the peak resident set size of the current process.
+     * 
+     * This is the high-water mark for the whole process lifetime, not just
+     * for the most recent load.
+     * 
+     * @return Peak RSS in bytes, or 0 if the platform does not report it
+     */
+    static size_t queryPeakRssBytes();
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,266 @@
+#include "LocationSaxHandler.hpp"
+#include "../travel/Transport.hpp"
+#include <stdexcept>
+
+namespace dijkstra {
+namespace data {
+
+LocationSaxHandler::LocationSaxHandler(graph::CompactGraphBuilder& builder) : builder_(builder) {
+}
+
+bool LocationSaxHandler::null() {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::boolean(bool /*value*/) {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::number_integer(json::number_integer_t value) {
+    return onNumber(static_cast<double>(value));
+}
+
+bool LocationSaxHandler::number_unsigned(json::number_unsigned_t value) {
+    return onNumber(static_cast<double>(value));
+}
+
+bool LocationSaxHandler::number_float(json::number_float_t value, const json::string_t& /*raw*/) {
+    return onNumber(value);
+}
+
+bool LocationSaxHandler::string(json::string_t& value) {
+    if (depth_ == RECORD_DEPTH) {
+        switch (field_) {
+            case Field::ID:
+                if (section_ == Section::LOCATIONS) {
+                    location_.id = std::move(value);
+                } else {
+                    route_.id = std::move(value);
+                }
+                break;
+            case Field::NAME:
+                location_.name = std::move(value);
+                break;
+            case Field::FROM:
+                route_.from = std::move(value);
+                break;
+            case Field::TO:
+                route_.to = std::move(value);
+                break;
+            case Field::MODE:
+                try {
+                    route_.mode = static_cast<uint8_t>(
+                        travel::TransportFactory::stringToTransportMode(value));
+                } catch (const std::invalid_argument&) {
+                    route_.mode = graph::CompactGraph::NO_MODE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::binary(json::binary_t& /*value*/) {
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::start_object(std::size_t /*elements*/) {
+    ++depth_;
+    
+    if (depth_ == RECORD_DEPTH) {
+        if (section_ == Section::LOCATIONS) {
+            location_ = LocationRecord();
+        } else if (section_ == Section::ROUTES) {
+            route_ = RouteRecord();
+        }
+    }
+    
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::key(json::string_t& value) {
+    if (depth_ == ROOT_DEPTH) {
+        if (value == "locations") {
+            pendingSection_ = Section::LOCATIONS;
+        } else if (value == "transportation_routes") {
+            pendingSection_ = Section::ROUTES;
+        } else {
+            pendingSection_ = Section::NONE;
+        }
+        return true;
+    }
+    
+    field_ = Field::NONE;
+    if (depth_ != RECORD_DEPTH) {
+        return true;
+    }
+    
+    if (value == "id") {
+        field_ = Field::ID;
+    } else if (section_ == Section::LOCATIONS) {
+        if (value == "name") {
+            field_ = Field::NAME;
+        } else if (value == "latitude") {
+            field_ = Field::LATITUDE;
+        } else if (value == "longitude") {
+            field_ = Field::LONGITUDE;
+        }
+    } else if (section_ == Section::ROUTES) {
+        if (value == "from") {
+            field_ = Field::FROM;
+        } else if (value == "to") {
+            field_ = Field::TO;
+        } else if (value == "mode") {
+            field_ = Field::MODE;
+        } else if (value == "distance_km") {
+            field_ = Field::DISTANCE;
+        } else if (value == "travel_time_hours") {
+            field_ = Field::TIME;
+        } else if (value == "cost_usd") {
+            field_ = Field::COST;
+        }
+    }
+    return true;
+}
+
+bool LocationSaxHandler::end_object() {
+    if (depth_ == RECORD_DEPTH) {
+        if (section_ == Section::LOCATIONS) {
+            finishLocation();
+        } else if (section_ == Section::ROUTES) {
+            finishRoute();
+        }
+    } else if (depth_ == ROOT_DEPTH) {
+        resolveDeferredRoutes();
+    }
+    
+    --depth_;
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::start_array(std::size_t /*elements*/) {
+    ++depth_;
+    
+    if (depth_ == SECTION_DEPTH) {
+        section_ = pendingSection_;
+    }
+    
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::end_array() {
+    if (depth_ == SECTION_DEPTH) {
+        if (section_ == Section::LOCATIONS) {
+            locationsSeen_ = true;
+        }
+        section_ = Section::NONE;
+    }
+    
+    --depth_;
+    field_ = Field::NONE;
+    return true;
+}
+
+bool LocationSaxHandler::parse_error(std::size_t /*position*/, const std::string& /*lastToken*/,
+                                     const nlohmann::detail::exception& ex) {
+    errorMessage_ = ex.what();
+    return false;
+}
+
+bool LocationSaxHandler::onNumber(double value) {
+    if (depth_ == RECORD_DEPTH) {
+        switch (field_) {
+            case Field::LATITUDE:
+                location_.latitude = value;
+                location_.hasLatitude = true;
+                break;
+            case Field::LONGITUDE:
+                location_.longitude = value;
+                location_.hasLongitude = true;
+                break;
+            case Field::DISTANCE:
+                route_.distance = value;
+                break;
+            case Field::TIME:
+                route_.time = value;
+                break;
+            case Field::COST:
+                route_.cost = value;
+                break;
+            default:
+                break;
+        }
+    }
+    field_ = Field::NONE;
+    return true;
+}
+
+void LocationSaxHandler::finishLocation() {
+    if (location_.id.empty()) {
+        throw std::runtime_error("Location record is missing required field 'id'");
+    }
+    
+    auto node = builder_.addNode(location_.id, location_.name);
+    if (node == graph::CompactGraph::INVALID_INDEX) {
+        return; // Duplicate location
+    }
+    
+    if (location_.hasLatitude && location_.hasLongitude) {
+        builder_.setCoordinate(node, location_.latitude, location_.longitude);
+    }
+    ++nodesLoaded_;
+}
+
+void LocationSaxHandler::finishRoute() {
+    if (route_.from.empty() || route_.to.empty()) {
+        throw std::runtime_error("Transportation route '" + route_.id +
+                                 "' is missing required field 'from' or 'to'");
+    }
+    
+    if (addRoute(route_)) {
+        return;
+    }
+    
+    // The endpoints may simply not have been seen yet if routes precede locations
+    if (!locationsSeen_) {
+        deferredRoutes_.push_back(std::move(route_));
+        return;
+    }
+    
+    ++edgesSkipped_;
+}
+
+bool LocationSaxHandler::addRoute(const RouteRecord& record) {
+    auto source = builder_.findNode(record.from);
+    auto target = builder_.findNode(record.to);
+    if (source == graph::CompactGraph::INVALID_INDEX || target == graph::CompactGraph::INVALID_INDEX) {
+        return false;
+    }
+    
+    builder_.addEdge(record.id, source, target, record.distance, record.time, record.cost, record.mode);
+    ++edgesLoaded_;
+    return true;
+}
+
+void LocationSaxHandler::resolveDeferredRoutes() {
+    for (const auto& record : deferredRoutes_) {
+        if (!addRoute(record)) {
+            ++edgesSkipped_;
+        }
+    }
+    
+    deferredRoutes_.clear();
+    deferredRoutes_.shrink_to_fit();
+}
+
+} // namespace data
+} // namespace dijkstra
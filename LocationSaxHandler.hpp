@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../graph/CompactGraph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class LocationSaxHandler
+ * @brief SAX event handler for the `locations`/`transportation_routes` schema.
+ * 
+ * This is the format of sample_data.json. Each location becomes a node with its
+ * latitude/longitude, and each transportation route becomes an edge weighted by
+ * `distance_km`, `travel_time_hours` and `cost_usd` and tagged with its transport
+ * mode. Descriptive fields (type, amenities, description, ratings) are skipped.
+ * Records are written straight into a CompactGraphBuilder as they are parsed.
+ */
+class LocationSaxHandler {
+public:
+    using json = nlohmann::json;
+    
+    /**
+     * @brief Constructs a handler that populates the given builder.
+     * @param builder Builder to add nodes and edges to
+     */
+    explicit LocationSaxHandler(graph::CompactGraphBuilder& builder);
+    
+    // nlohmann::json SAX interface
+    bool null();
+    bool boolean(bool value);
+    bool number_integer(json::number_integer_t value);
+    bool number_unsigned(json::number_unsigned_t value);
+    bool number_float(json::number_float_t value, const json::string_t& raw);
+    bool string(json::string_t& value);
+    bool binary(json::binary_t& value);
+    bool start_object(std::size_t elements);
+    bool key(json::string_t& value);
+    bool end_object();
+    bool start_array(std::size_t elements);
+    bool end_array();
+    bool parse_error(std::size_t position, const std::string& lastToken,
+                     const nlohmann::detail::exception& ex);
+    
+    size_t getNodesLoaded() const { return nodesLoaded_; }
+    size_t getEdgesLoaded() const { return edgesLoaded_; }
+    size_t getEdgesSkipped() const { return edgesSkipped_; }
+    
+    /**
+     * @brief Get the parser error message, if parsing failed.
+     * @return Error message, or an empty string on success
+     */
+    const std::string& getErrorMessage() const { return errorMessage_; }
+
+private:
+    enum class Section { NONE, LOCATIONS, ROUTES };
+    enum class Field { NONE, ID, NAME, LATITUDE, LONGITUDE, FROM, TO, MODE, DISTANCE, TIME, COST };
+    
+    struct LocationRecord {
+        std::string id;
+        std::string name;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        bool hasLatitude = false;
+        bool hasLongitude = false;
+    };
+    
+    struct RouteRecord {
+        std::string id;
+        std::string from;
+        std::string to;
+        uint8_t mode = graph::CompactGraph::NO_MODE;
+        double distance = 0.0;
+        double time = 0.0;
+        double cost = 0.0;
+    };
+    
+    static constexpr size_t ROOT_DEPTH = 1;    ///< Depth inside the top-level object
+    static constexpr size_t SECTION_DEPTH = 2; ///< Depth inside a section array
+    static constexpr size_t RECORD_DEPTH = 3;  ///< Depth inside a single record
+    
+    graph::CompactGraphBuilder& builder_;
+    size_t depth_ = 0;
+    Section pendingSection_ = Section::NONE;
+    Section section_ = Section::NONE;
+    Field field_ = Field::NONE;
+    
+    LocationRecord location_;
+    RouteRecord route_;
+    std::vector<RouteRecord> deferredRoutes_;
+    bool locationsSeen_ = false;
+    
+    size_t nodesLoaded_ = 0;
+    size_t edgesLoaded_ = 0;
+    size_t edgesSkipped_ = 0;
+    std::string errorMessage_;
+    
+    bool onNumber(double value);
+    void finishLocation();
+    void finishRoute();
+    bool addRoute(const RouteRecord& record);
+    void resolveDeferredRoutes();
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,72 @@
+#include "MappedFile.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dijkstra {
+namespace data {
+
+#if defined(__unix__) || defined(__APPLE__)
+
+MappedFile::MappedFile(const std::string& filePath) : path_(filePath) {
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + filePath + ": " + std::strerror(errno));
+    }
+    
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + filePath + ": " + std::strerror(err));
+    }
+    
+    size_ = static_cast<size_t>(fileStat.st_size);
+    if (size_ > 0) {
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + filePath + ": " + std::strerror(err));
+        }
+        data_ = static_cast<const char*>(mapping);
+    }
+    
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+void MappedFile::adviseSequential() const {
+    if (data_) {
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filePath) : path_(filePath) {
+    throw std::runtime_error("Memory-mapped files are not supported on this platform: " + filePath);
+}
+
+MappedFile::~MappedFile() = default;
+
+void MappedFile::adviseSequential() const {
+}
+
+#endif
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ * 
+ * The mapping is shared, so every process mapping the same file is served from
+ * the same page cache pages. Not copyable; hold it through a shared_ptr when
+ * several objects view the mapped bytes.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file into memory.
+     * @param filePath Path to the file
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& filePath);
+    
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& getPath() const { return path_; }
+    
+    /**
+     * @brief Hint that the mapping will be read front to back.
+     */
+    void adviseSequential() const;
+
+private:
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dijkstra {
+namespace util {
+
+/**
+ * @class Counter
+ * @brief A counter written by one thread and read by any.
+ * 
+ * The owner adds with a plain load and store instead of a locked
+ * read-modify-write, so counting costs about as much as on a plain integer.
+ */
+class Counter {
+public:
+    void add(uint64_t amount = 1) {
+        value_.store(value_.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    
+    uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @struct HistogramSnapshot
+ * @brief Plain copy of one or more LatencyHistograms, for merging and reporting.
+ */
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    
+    HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+    
+    /**
+     * @brief Estimate a quantile.
+     * @param quantile Quantile in [0, 1]
+     * @return Upper bound of the bucket holding the quantile (at most max), or 0 if empty
+     */
+    uint64_t valueAt(double quantile) const;
+    
+    double mean() const { return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Log-linear (HDR-style) histogram written by one thread and read by any.
+ * 
+ * Values below 64 get a bucket each; above that every power of two is split
+ * into 32 buckets, so a reported value is within 1/32 (about 3%) of the
+ * recorded one. Values up to 2^44 (about 4.9 hours in nanoseconds) are
+ * distinguished; larger ones share the last bucket. Recording touches three
+ * counters and a maximum, all owned by the writing thread, so it needs no
+ * atomic read-modify-write; snapshot() may run concurrently on another thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned MAX_VALUE_BITS = 44;
+    static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+    
+    /**
+     * @brief Get the bucket a value falls into.
+     */
+    static size_t bucketIndex(uint64_t value) {
+        value = std::min<uint64_t>(value, (uint64_t(1) << MAX_VALUE_BITS) - 1);
+        unsigned shift = 0;
+        if (value >> (SUB_BUCKET_BITS + 1)) {
+            unsigned highestBit = 63 - static_cast<unsigned>(__builtin_clzll(value));
+            shift = highestBit - SUB_BUCKET_BITS;
+        }
+        return (static_cast<size_t>(shift) << SUB_BUCKET_BITS) + static_cast<size_t>(value >> shift);
+    }
+    
+    /**
+     * @brief Get the largest value that falls into a bucket.
+     */
+    static uint64_t bucketUpperBound(size_t index) {
+        if (index < (size_t(2) << SUB_BUCKET_BITS)) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index >> SUB_BUCKET_BITS) - 1;
+        uint64_t subBucket = (index & ((size_t(1) << SUB_BUCKET_BITS) - 1)) | (uint64_t(1) << SUB_BUCKET_BITS);
+        return ((subBucket + 1) << shift) - 1;
+    }
+    
+    void record(uint64_t value) {
+        auto& bucket = buckets_[bucketIndex(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        count_.add();
+        sum_.add(value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+    
+    uint64_t getCount() const { return count_.get(); }
+    
+    /**
+     * @brief Copy the current counts.
+     * 
+     * Taken while the owner records, the copy may be off by the values
+     * recorded during the copy, but every bucket is a value it really held.
+     */
+    HistogramSnapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    Counter count_;
+    Counter sum_;
+    std::atomic<uint64_t> max_{0};
+};
+
+inline HistogramSnapshot& HistogramSnapshot::operator+=(const HistogramSnapshot& other) {
+    if (buckets.size() < other.buckets.size()) {
+        buckets.resize(other.buckets.size(), 0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    max = std::max(max, other.max);
+    return *this;
+}
+
+inline uint64_t HistogramSnapshot::valueAt(double quantile) const {
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // Smallest value with at least quantile * total values at or below it
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(LatencyHistogram::bucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+inline HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot copy;
+    copy.buckets.resize(BUCKET_COUNT);
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        copy.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    copy.count = count_.get();
+    copy.sum = sum_.get();
+    copy.max = max_.load(std::memory_order_relaxed);
+    return copy;
+}
+
+} // namespace util
+} // namespace dijkstra
@@ -0,0 +1,666 @@
+#include "OsmImporter.hpp"
+#include "../geo/GeoCoordinate.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+
+constexpr int32_t NO_COORDINATE = std::numeric_limits<int32_t>::min();
+constexpr double COORDINATE_SCALE = 1e7; ///< OSM's own fixed-point precision
+constexpr size_t READ_BUFFER_BYTES = 1 << 20;
+
+/**
+ * @class XmlReader
+ * @brief Minimal streaming, non-validating XML tokenizer for OSM files.
+ * 
+ * Reports start and end tags with their attributes and skips text, comments,
+ * processing instructions and declarations. A self-closing element is
+ * reported as a start tag followed by an end tag. Entity and character
+ * references in attribute values are decoded in place.
+ */
+class XmlReader {
+public:
+    explicit XmlReader(const std::string& filePath) : path_(filePath), file_(filePath, std::ios::binary),
+                                                      buffer_(READ_BUFFER_BYTES) {
+        if (!file_.is_open()) {
+            throw std::runtime_error("Failed to open file: " + filePath);
+        }
+    }
+    
+    /**
+     * @brief Advance to the next start or end tag.
+     * @return true if a tag was read, false at the end of the file
+     */
+    bool next() {
+        if (pendingEnd_) {
+            pendingEnd_ = false;
+            isEnd_ = true;
+            attributes_.clear();
+            return true;
+        }
+        
+        while (true) {
+            const void* open = std::memchr(buffer_.data() + position_, '<', filled_ - position_);
+            if (!open) {
+                position_ = filled_;
+                if (!refill()) {
+                    return false;
+                }
+                continue;
+            }
+            position_ = static_cast<size_t>(static_cast<const char*>(open) - buffer_.data());
+            
+            // refill() moves the partial tag to the front of the buffer
+            size_t tagEnd = findTagEnd();
+            while (tagEnd == NOT_FOUND) {
+                bool more = refill();
+                tagEnd = findTagEnd();
+                if (!more && tagEnd == NOT_FOUND) {
+                    throw std::runtime_error("Unexpected end of XML file " + path_);
+                }
+            }
+            size_t tagBegin = position_;
+            position_ = tagEnd;
+            
+            char kind = buffer_[tagBegin + 1];
+            if (kind == '?' || kind == '!') {
+                continue; // Declaration, comment, CDATA or DOCTYPE
+            }
+            parseTag(tagBegin, tagEnd);
+            return true;
+        }
+    }
+    
+    bool isStart() const { return !isEnd_; }
+    bool isEnd() const { return isEnd_; }
+    std::string_view name() const { return name_; }
+    
+    std::string_view attribute(std::string_view attributeName) const {
+        for (const auto& [key, value] : attributes_) {
+            if (key == attributeName) {
+                return value;
+            }
+        }
+        return std::string_view();
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    
+    std::string path_;
+    std::ifstream file_;
+    std::vector<char> buffer_;
+    size_t position_ = 0;
+    size_t filled_ = 0;
+    bool eof_ = false;
+    
+    std::string_view name_;
+    std::vector<std::pair<std::string_view, std::string_view>> attributes_;
+    bool isEnd_ = false;
+    bool pendingEnd_ = false;
+    
+    bool refill() {
+        if (eof_) {
+            return false;
+        }
+        size_t unread = filled_ - position_;
+        std::memmove(buffer_.data(), buffer_.data() + position_, unread);
+        position_ = 0;
+        filled_ = unread;
+        if (filled_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        
+        file_.read(buffer_.data() + filled_, static_cast<std::streamsize>(buffer_.size() - filled_));
+        size_t count = static_cast<size_t>(file_.gcount());
+        if (file_.bad()) {
+            throw std::runtime_error("Failed to read file: " + path_);
+        }
+        if (count == 0) {
+            eof_ = true;
+            return false;
+        }
+        filled_ += count;
+        return true;
+    }
+    
+    size_t find(size_t from, std::string_view terminator) const {
+        std::string_view text(buffer_.data(), filled_);
+        size_t at = text.find(terminator, from);
+        return at == std::string_view::npos ? NOT_FOUND : at + terminator.size();
+    }
+    
+    /**
+     * @brief Find the end of the markup starting at position_ (which is a '<').
+     * @return Offset just past it, or NOT_FOUND if it is not all in the buffer yet
+     */
+    size_t findTagEnd() const {
+        std::string_view text(buffer_.data() + position_, filled_ - position_);
+        if (text.size() < 2 || (text.size() < 9 && !eof_)) {
+            return NOT_FOUND; // Too short to tell a comment or CDATA section from a tag
+        }
+        if (text.compare(0, 4, "<!--") == 0) {
+            return find(position_ + 4, "-->");
+        }
+        if (text.compare(0, 9, "<![CDATA[") == 0) {
+            return find(position_ + 9, "]]>");
+        }
+        if (text[1] == '?') {
+            return find(position_ + 2, "?>");
+        }
+        
+        // Attribute values may contain '>'
+        char quote = 0;
+        for (size_t i = position_ + 1; i < filled_; ++i) {
+            char c = buffer_[i];
+            if (quote) {
+                quote = (c == quote) ? 0 : quote;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                return i + 1;
+            }
+        }
+        return NOT_FOUND;
+    }
+    
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+    
+    void parseTag(size_t begin, size_t end) {
+        char* data = buffer_.data();
+        size_t i = begin + 1;
+        isEnd_ = data[i] == '/';
+        if (isEnd_) {
+            ++i;
+        }
+        attributes_.clear();
+        
+        size_t nameBegin = i;
+        while (i < end && !isSpace(data[i]) && data[i] != '/' && data[i] != '>') {
+            ++i;
+        }
+        name_ = std::string_view(data + nameBegin, i - nameBegin);
+        
+        while (i < end) {
+            while (i < end && isSpace(data[i])) {
+                ++i;
+            }
+            if (i >= end || data[i] == '>') {
+                break;
+            }
+            if (data[i] == '/') {
+                pendingEnd_ = !isEnd_;
+                ++i;
+                continue;
+            }
+            
+            size_t keyBegin = i;
+            while (i < end && data[i] != '=' && !isSpace(data[i]) && data[i] != '>') {
+                ++i;
+            }
+            std::string_view key(data + keyBegin, i - keyBegin);
+            while (i < end && (isSpace(data[i]) || data[i] == '=')) {
+                ++i;
+            }
+            if (i >= end || (data[i] != '"' && data[i] != '\'')) {
+                throw std::runtime_error("Malformed XML attribute in " + path_);
+            }
+            char quote = data[i++];
+            size_t valueBegin = i;
+            while (i < end && data[i] != quote) {
+                ++i;
+            }
+            size_t valueLength = decode(data + valueBegin, i - valueBegin);
+            attributes_.emplace_back(key, std::string_view(data + valueBegin, valueLength));
+            ++i;
+        }
+    }
+    
+    /**
+     * @brief Decode entity and character references in place.
+     * @return Decoded length, never more than the original length
+     */
+    static size_t decode(char* text, size_t length) {
+        if (!std::memchr(text, '&', length)) {
+            return length;
+        }
+        
+        size_t out = 0;
+        for (size_t i = 0; i < length;) {
+            if (text[i] != '&') {
+                text[out++] = text[i++];
+                continue;
+            }
+            const void* semicolon = std::memchr(text + i, ';', length - i);
+            if (!semicolon) {
+                text[out++] = text[i++];
+                continue;
+            }
+            size_t referenceEnd = static_cast<size_t>(static_cast<const char*>(semicolon) - text);
+            std::string_view reference(text + i + 1, referenceEnd - i - 1);
+            
+            uint32_t codePoint = 0;
+            bool known = true;
+            if (reference == "amp") {
+                codePoint = '&';
+            } else if (reference == "lt") {
+                codePoint = '<';
+            } else if (reference == "gt") {
+                codePoint = '>';
+            } else if (reference == "quot") {
+                codePoint = '"';
+            } else if (reference == "apos") {
+                codePoint = '\'';
+            } else if (reference.size() > 1 && reference[0] == '#') {
+                bool hex = reference[1] == 'x' || reference[1] == 'X';
+                std::string_view digits = reference.substr(hex ? 2 : 1);
+                auto result = std::from_chars(digits.data(), digits.data() + digits.size(), codePoint, hex ? 16 : 10);
+                known = result.ec == std::errc() && result.ptr == digits.data() + digits.size() &&
+                        codePoint <= 0x10FFFF;
+            } else {
+                known = false;
+            }
+            if (!known) {
+                text[out++] = text[i++];
+                continue;
+            }
+            
+            // UTF-8 encoding is always shorter than the reference it replaces
+            if (codePoint < 0x80) {
+                text[out++] = static_cast<char>(codePoint);
+            } else if (codePoint < 0x800) {
+                text[out++] = static_cast<char>(0xC0 | (codePoint >> 6));
+                text[out++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            } else if (codePoint < 0x10000) {
+                text[out++] = static_cast<char>(0xE0 | (codePoint >> 12));
+                text[out++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text[out++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            } else {
+                text[out++] = static_cast<char>(0xF0 | (codePoint >> 18));
+                text[out++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                text[out++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text[out++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            i = referenceEnd + 1;
+        }
+        return out;
+    }
+};
+
+bool parseId(std::string_view text, int64_t& id) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), id);
+    return !text.empty() && result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseDegrees(std::string_view text, int32_t& fixed) {
+    // strtod needs a terminated string; coordinates are short
+    char digits[32];
+    if (text.empty() || text.size() >= sizeof(digits)) {
+        return false;
+    }
+    std::copy(text.begin(), text.end(), digits);
+    digits[text.size()] = '\0';
+    char* end = nullptr;
+    double degrees = std::strtod(digits, &end);
+    if (end != digits + text.size() || !(std::fabs(degrees) <= 180.0)) {
+        return false;
+    }
+    fixed = static_cast<int32_t>(std::lround(degrees * COORDINATE_SCALE));
+    return true;
+}
+
+/**
+ * @brief The tags of a way that decide who may use it and in which direction.
+ */
+struct WayTags {
+    std::string highway;
+    std::string access;
+    std::string vehicle;
+    std::string motorVehicle;
+    std::string motorcar;
+    std::string foot;
+    std::string bicycle;
+    std::string oneway;
+    std::string onewayBicycle;
+    std::string junction;
+    std::string area;
+    
+    void set(std::string_view key, std::string_view value) {
+        std::string* field = nullptr;
+        if (key == "highway") {
+            field = &highway;
+        } else if (key == "access") {
+            field = &access;
+        } else if (key == "vehicle") {
+            field = &vehicle;
+        } else if (key == "motor_vehicle") {
+            field = &motorVehicle;
+        } else if (key == "motorcar") {
+            field = &motorcar;
+        } else if (key == "foot") {
+            field = &foot;
+        } else if (key == "bicycle") {
+            field = &bicycle;
+        } else if (key == "oneway") {
+            field = &oneway;
+        } else if (key == "oneway:bicycle") {
+            field = &onewayBicycle;
+        } else if (key == "junction") {
+            field = &junction;
+        } else if (key == "area") {
+            field = &area;
+        }
+        if (field) {
+            field->assign(value.data(), value.size());
+        }
+    }
+    
+    void clear() {
+        *this = WayTags();
+    }
+};
+
+struct Directions {
+    bool forward = false;
+    bool backward = false;
+};
+
+bool isOneOf(const std::string& value, std::initializer_list<const char*> candidates) {
+    return std::any_of(candidates.begin(), candidates.end(),
+                       [&](const char* candidate) { return value == candidate; });
+}
+
+bool isPublicRoad(const std::string& highway) {
+    return isOneOf(highway, {"primary", "primary_link", "secondary", "secondary_link", "tertiary",
+                             "tertiary_link", "unclassified", "residential", "living_street", "service", "road"});
+}
+
+/**
+ * @brief The most specific access tag that is set, e.g. motorcar over motor_vehicle over access.
+ */
+const std::string& effectiveAccess(std::initializer_list<const std::string*> mostSpecificFirst) {
+    static const std::string none;
+    for (const std::string* value : mostSpecificFirst) {
+        if (!value->empty()) {
+            return *value;
+        }
+    }
+    return none;
+}
+
+/**
+ * @brief Decide whether a mode may use a way, and in which directions.
+ */
+Directions classifyWay(travel::TransportMode mode, const WayTags& tags) {
+    Directions directions;
+    if (tags.highway.empty() || tags.area == "yes") {
+        return directions;
+    }
+    
+    bool byDefault = false;
+    const std::string* access = nullptr;
+    switch (mode) {
+        case travel::TransportMode::DRIVING:
+            byDefault = isPublicRoad(tags.highway) ||
+                        isOneOf(tags.highway, {"motorway", "motorway_link", "trunk", "trunk_link"});
+            access = &effectiveAccess({&tags.motorcar, &tags.motorVehicle, &tags.vehicle, &tags.access});
+            break;
+        case travel::TransportMode::CYCLING:
+            byDefault = isPublicRoad(tags.highway) || isOneOf(tags.highway, {"cycleway", "path", "track"});
+            access = &effectiveAccess({&tags.bicycle, &tags.vehicle, &tags.access});
+            break;
+        case travel::TransportMode::WALKING:
+            byDefault = isPublicRoad(tags.highway) ||
+                        isOneOf(tags.highway, {"pedestrian", "footway", "path", "steps", "track"});
+            access = &effectiveAccess({&tags.foot, &tags.access});
+            break;
+        default:
+            return directions;
+    }
+    
+    bool allowed = byDefault;
+    if (isOneOf(*access, {"no", "private"})) {
+        allowed = false;
+    } else if (isOneOf(*access, {"yes", "designated", "permissive", "destination"})) {
+        allowed = true;
+    }
+    if (!allowed || tags.highway == "construction" || tags.highway == "proposed") {
+        return directions;
+    }
+    
+    directions.forward = true;
+    directions.backward = true;
+    if (mode == travel::TransportMode::WALKING) {
+        return directions; // Pedestrians may walk against the traffic
+    }
+    
+    const std::string& oneway =
+        (mode == travel::TransportMode::CYCLING && !tags.onewayBicycle.empty()) ? tags.onewayBicycle : tags.oneway;
+    if (isOneOf(oneway, {"yes", "true", "1"})) {
+        directions.backward = false;
+    } else if (isOneOf(oneway, {"-1", "reverse"})) {
+        directions.forward = false;
+    } else if (oneway.empty() && (tags.junction == "roundabout" ||
+                                  tags.highway == "motorway" || tags.highway == "motorway_link")) {
+        directions.backward = false; // Implied oneway
+    }
+    return directions;
+}
+
+/**
+ * @brief A way kept by the first pass; its nodes are refs[begin, end).
+ */
+struct WayRecord {
+    int64_t id;
+    uint64_t begin;
+    uint64_t end;
+    Directions directions;
+};
+
+} // namespace
+
+OsmImporter::OsmImporter(travel::TransportMode mode) : mode_(mode) {
+    if (mode != travel::TransportMode::WALKING && mode != travel::TransportMode::CYCLING &&
+        mode != travel::TransportMode::DRIVING) {
+        throw std::invalid_argument("OSM street graphs support walking, cycling and driving only, not " +
+                                    travel::TransportFactory::transportModeToString(mode));
+    }
+}
+
+graph::CompactGraph OsmImporter::load(const std::string& filePath) {
+    waysKept_ = 0;
+    nodeReferences_ = 0;
+    nodesLoaded_ = 0;
+    edgesBuilt_ = 0;
+    segmentsSkipped_ = 0;
+    std::error_code ec;
+    bytesRead_ = static_cast<size_t>(std::filesystem::file_size(filePath, ec));
+    
+    // Pass 1: ways the mode may use, as node ID lists
+    std::vector<int64_t> refs;
+    std::vector<WayRecord> ways;
+    bool nodesBeforeWays = true;
+    {
+        XmlReader xml(filePath);
+        if (!xml.next() || !xml.isStart() || xml.name() != "osm") {
+            throw std::runtime_error("Not an OSM XML file: " + filePath);
+        }
+        
+        bool inWay = false;
+        bool waySeen = false;
+        int64_t wayId = 0;
+        uint64_t wayBegin = 0;
+        WayTags tags;
+        while (xml.next()) {
+            auto name = xml.name();
+            if (xml.isStart()) {
+                if (name == "way") {
+                    inWay = parseId(xml.attribute("id"), wayId);
+                    waySeen = true;
+                    wayBegin = refs.size();
+                    tags.clear();
+                } else if (inWay && name == "nd") {
+                    int64_t ref = 0;
+                    if (parseId(xml.attribute("ref"), ref)) {
+                        refs.push_back(ref);
+                    }
+                } else if (inWay && name == "tag") {
+                    tags.set(xml.attribute("k"), xml.attribute("v"));
+                } else if (name == "node" && waySeen) {
+                    nodesBeforeWays = false;
+                }
+            } else if (inWay && name == "way") {
+                inWay = false;
+                Directions directions = classifyWay(mode_, tags);
+                if ((directions.forward || directions.backward) && refs.size() - wayBegin >= 2) {
+                    ways.push_back(WayRecord{wayId, wayBegin, refs.size(), directions});
+                } else {
+                    refs.resize(wayBegin);
+                }
+            }
+        }
+    }
+    waysKept_ = ways.size();
+    nodeReferences_ = refs.size();
+    
+    // Distinct referenced nodes, and how many way pieces meet at each
+    std::vector<int64_t> nodeIds(refs);
+    std::sort(nodeIds.begin(), nodeIds.end());
+    nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+    nodeIds.shrink_to_fit();
+    if (nodeIds.size() >= graph::CompactGraph::INVALID_INDEX) {
+        throw std::runtime_error("Too many nodes in " + filePath);
+    }
+    
+    std::vector<Index> refNodes(refs.size());
+    std::vector<uint8_t> useCount(nodeIds.size(), 0);
+    for (size_t i = 0; i < refs.size(); ++i) {
+        auto node = static_cast<Index>(std::lower_bound(nodeIds.begin(), nodeIds.end(), refs[i]) - nodeIds.begin());
+        refNodes[i] = node;
+        useCount[node] = static_cast<uint8_t>(std::min(useCount[node] + 1, 2));
+    }
+    std::vector<int64_t>().swap(refs);
+    for (const auto& way : ways) {
+        useCount[refNodes[way.begin]] = 2; // Way ends are always graph nodes
+        useCount[refNodes[way.end - 1]] = 2;
+    }
+    
+    // Pass 2: coordinates of the referenced nodes
+    std::vector<int32_t> latitudes(nodeIds.size(), NO_COORDINATE);
+    std::vector<int32_t> longitudes(nodeIds.size(), NO_COORDINATE);
+    {
+        XmlReader xml(filePath);
+        while (xml.next()) {
+            if (!xml.isStart()) {
+                continue;
+            }
+            if (xml.name() == "way" && nodesBeforeWays) {
+                break; // Files are normally sorted nodes, ways, relations
+            }
+            int64_t id = 0;
+            if (xml.name() != "node" || !parseId(xml.attribute("id"), id)) {
+                continue;
+            }
+            auto it = std::lower_bound(nodeIds.begin(), nodeIds.end(), id);
+            if (it == nodeIds.end() || *it != id) {
+                continue;
+            }
+            size_t node = static_cast<size_t>(it - nodeIds.begin());
+            int32_t latitude = 0;
+            int32_t longitude = 0;
+            if (parseDegrees(xml.attribute("lat"), latitude) && parseDegrees(xml.attribute("lon"), longitude)) {
+                latitudes[node] = latitude;
+                longitudes[node] = longitude;
+            }
+        }
+    }
+    
+    // Graph nodes are the shared and end nodes whose position is known
+    graph::CompactGraphBuilder builder;
+    std::vector<Index> graphNodes(nodeIds.size(), graph::CompactGraph::INVALID_INDEX);
+    for (size_t node = 0; node < nodeIds.size(); ++node) {
+        if (useCount[node] >= 2 && latitudes[node] != NO_COORDINATE) {
+            graphNodes[node] = builder.addNode(std::to_string(nodeIds[node]));
+            builder.setCoordinate(graphNodes[node], latitudes[node] / COORDINATE_SCALE,
+                                  longitudes[node] / COORDINATE_SCALE);
+        }
+    }
+    nodesLoaded_ = builder.getNodeCount();
+    std::vector<uint8_t>().swap(useCount);
+    
+    // Cut every way at its graph nodes
+    auto transport = travel::TransportFactory::createTransport(mode_);
+    auto modeTag = static_cast<uint8_t>(mode_);
+    for (const auto& way : ways) {
+        Index from = graph::CompactGraph::INVALID_INDEX;
+        size_t previous = 0;
+        bool complete = false;
+        double length = 0.0;
+        size_t segment = 0;
+        
+        for (uint64_t i = way.begin; i < way.end; ++i) {
+            size_t node = refNodes[i];
+            bool located = latitudes[node] != NO_COORDINATE;
+            if (i > way.begin) {
+                if (located && complete) {
+                    geo::GeoCoordinate a(latitudes[previous] / COORDINATE_SCALE, longitudes[previous] / COORDINATE_SCALE);
+                    geo::GeoCoordinate b(latitudes[node] / COORDINATE_SCALE, longitudes[node] / COORDINATE_SCALE);
+                    length += a.distanceTo(b);
+                } else {
+                    complete = false;
+                }
+            }
+            previous = node;
+            
+            Index to = graphNodes[node];
+            if (to == graph::CompactGraph::INVALID_INDEX) {
+                continue;
+            }
+            if (from == graph::CompactGraph::INVALID_INDEX && i > way.begin) {
+                ++segmentsSkipped_; // The way starts outside the extract
+            } else if (from != graph::CompactGraph::INVALID_INDEX) {
+                if (!complete) {
+                    ++segmentsSkipped_; // Part of the way lies outside the extract
+                } else if (from != to) {
+                    std::string edgeId = std::to_string(way.id) + ":" + std::to_string(segment);
+                    double time = transport->calculateTravelTime(length);
+                    double cost = transport->calculateTravelCost(length);
+                    if (way.directions.forward) {
+                        builder.addEdge(edgeId, from, to, length, time, cost, modeTag);
+                    }
+                    if (way.directions.backward) {
+                        builder.addEdge(edgeId + ":r", to, from, length, time, cost, modeTag);
+                    }
+                }
+                ++segment;
+            }
+            from = to;
+            complete = true;
+            length = 0.0;
+        }
+    }
+    edgesBuilt_ = builder.getEdgeCount();
+    
+    return builder.build();
+}
+
+} // namespace data
+} // namespace dijkstra
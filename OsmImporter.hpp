@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../graph/CompactGraph.hpp"
+#include "../travel/Transport.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class OsmImporter
+ * @brief Builds a street graph for walking, cycling or driving from an OpenStreetMap XML extract.
+ * 
+ * The file is streamed twice and never held in memory. The first pass keeps
+ * the ways the chosen mode may use (by their highway, access and oneway tags)
+ * as lists of node references and counts how many ways share each node. Nodes
+ * at way ends or shared by several ways become graph nodes; the others only
+ * shape the geometry. The second pass reads the coordinates of the referenced
+ * nodes, after which every way is cut at its graph nodes into edges whose
+ * length is summed segment by segment with GeoCoordinate. Time and cost come
+ * from the mode's TransportFactory speed and tariff.
+ * 
+ * Memory use is about 30 bytes per node reference of the kept ways, which is
+ * a few gigabytes for a large country extract. Only the XML format is read;
+ * convert PBF extracts first, e.g. with `osmium cat extract.osm.pbf -o extract.osm`.
+ */
+class OsmImporter {
+public:
+    /**
+     * @brief Constructs an importer for one transport mode.
+     * @param mode WALKING, CYCLING or DRIVING
+     * @throws std::invalid_argument for any other mode
+     */
+    explicit OsmImporter(travel::TransportMode mode);
+    
+    /**
+     * @brief Import an extract.
+     * @param filePath Path to the .osm XML file
+     * @return The street graph; node IDs are OSM node IDs
+     * @throws std::runtime_error if the file cannot be read or is not OSM XML
+     */
+    graph::CompactGraph load(const std::string& filePath);
+    
+    travel::TransportMode getMode() const { return mode_; }
+    size_t getBytesRead() const { return bytesRead_; }
+    size_t getWaysKept() const { return waysKept_; }
+    size_t getNodeReferences() const { return nodeReferences_; }
+    size_t getNodesLoaded() const { return nodesLoaded_; }
+    size_t getEdgesBuilt() const { return edgesBuilt_; }
+    size_t getSegmentsSkipped() const { return segmentsSkipped_; }
+
+private:
+    travel::TransportMode mode_;
+    
+    size_t bytesRead_ = 0;
+    size_t waysKept_ = 0;
+    size_t nodeReferences_ = 0;
+    size_t nodesLoaded_ = 0;
+    size_t edgesBuilt_ = 0;
+    size_t segmentsSkipped_ = 0; ///< Way pieces dropped because a node lies outside the extract
+};
+
+} // namespace data
+} // namespace dijkstra
@@ -0,0 +1,158 @@
+#include "OverlayGraph.hpp"
+#include "OverlayPathFinder.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace dijkstra {
+namespace graph {
+
+OverlayGraph::OverlayGraph(const CompactGraph& graph, const GraphPartition& partition, OptimizationMode mode,
+                           unsigned threads)
+    : graph_(graph), partition_(partition), mode_(mode), weights_(graph.getEdgeCount()) {
+    if (partition.getNodeCount() != graph.getNodeCount()) {
+        throw std::invalid_argument("Partition does not match the graph");
+    }
+    
+    for (EdgeIndex edge = 0; edge < graph.getEdgeCount(); ++edge) {
+        weights_[edge] = PathFinder::combineWeights(graph.getDistance(edge), graph.getTime(edge),
+                                                    graph.getCost(edge), mode);
+    }
+    
+    const size_t nodeCount = graph.getNodeCount();
+    levels_.resize(partition.getLevelCount());
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        Level& overlayLevel = levels_[level];
+        const size_t cellCount = partition.getCellCount(level);
+        
+        // Sources of cut edges are exits, their targets entries
+        std::vector<uint8_t> isEntry(nodeCount, 0);
+        std::vector<uint8_t> isExit(nodeCount, 0);
+        for (Index node = 0; node < nodeCount; ++node) {
+            for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+                Index target = graph.getTarget(edge);
+                if (partition.getCell(level, node) != partition.getCell(level, target)) {
+                    isExit[node] = 1;
+                    isEntry[target] = 1;
+                }
+            }
+        }
+        
+        // Group them by cell, in node order within a cell
+        auto group = [&](const std::vector<uint8_t>& isBoundary, std::vector<uint32_t>& offsets,
+                         std::vector<Index>& nodes, std::vector<uint32_t>& slots) {
+            offsets.assign(cellCount + 1, 0);
+            for (Index node = 0; node < nodeCount; ++node) {
+                offsets[partition.getCell(level, node) + 1] += isBoundary[node];
+            }
+            for (size_t cell = 0; cell < cellCount; ++cell) {
+                offsets[cell + 1] += offsets[cell];
+            }
+            nodes.resize(offsets[cellCount]);
+            slots.assign(nodeCount, NO_SLOT);
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (Index node = 0; node < nodeCount; ++node) {
+                if (isBoundary[node]) {
+                    uint32_t slot = fill[partition.getCell(level, node)]++;
+                    nodes[slot] = node;
+                    slots[node] = slot;
+                }
+            }
+        };
+        group(isEntry, overlayLevel.entryOffsets, overlayLevel.entries, overlayLevel.entrySlots);
+        group(isExit, overlayLevel.exitOffsets, overlayLevel.exits, overlayLevel.exitSlots);
+        
+        overlayLevel.matrixOffsets.assign(cellCount + 1, 0);
+        for (size_t cell = 0; cell < cellCount; ++cell) {
+            uint64_t entries = overlayLevel.entryOffsets[cell + 1] - overlayLevel.entryOffsets[cell];
+            uint64_t exits = overlayLevel.exitOffsets[cell + 1] - overlayLevel.exitOffsets[cell];
+            overlayLevel.matrixOffsets[cell + 1] = overlayLevel.matrixOffsets[cell] + entries * exits;
+        }
+        overlayLevel.matrix.assign(overlayLevel.matrixOffsets[cellCount], std::numeric_limits<double>::infinity());
+        overlayLevel.dirty.assign(cellCount, 1);
+    }
+    
+    customize(threads);
+}
+
+void OverlayGraph::setWeight(EdgeIndex edge, double weight) {
+    if (!(weight >= 0.0) || std::isinf(weight)) {
+        throw std::invalid_argument("Edge weights must be finite and non-negative");
+    }
+    weights_[edge] = weight;
+    
+    // The edge lies inside a cell on every level where both endpoints share one
+    Index source = graph_.getSource(edge);
+    Index target = graph_.getTarget(edge);
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        uint32_t cell = partition_.getCell(level, source);
+        if (cell == partition_.getCell(level, target)) {
+            levels_[level].dirty[cell] = 1;
+        }
+    }
+}
+
+size_t OverlayGraph::customize(unsigned threads) {
+    threads = util::resolveThreadCount(threads);
+    std::vector<std::unique_ptr<OverlayPathFinder>> finders(threads);
+    size_t customized = 0;
+    
+    // Each level is searched on the cliques of the level below, so go upwards
+    for (size_t level = 0; level < levels_.size(); ++level) {
+        Level& overlayLevel = levels_[level];
+        std::vector<uint32_t> cells;
+        for (uint32_t cell = 0; cell < overlayLevel.dirty.size(); ++cell) {
+            if (overlayLevel.dirty[cell]) {
+                cells.push_back(cell);
+            }
+        }
+        
+        util::parallelForEach(cells.size(), threads, [&](size_t item, unsigned threadIndex) {
+            if (!finders[threadIndex]) {
+                finders[threadIndex] = std::make_unique<OverlayPathFinder>(*this);
+            }
+            customizeCell(*finders[threadIndex], level, cells[item]);
+        });
+        
+        for (uint32_t cell : cells) {
+            overlayLevel.dirty[cell] = 0;
+        }
+        customized += cells.size();
+    }
+    return customized;
+}
+
+bool OverlayGraph::isCustomized() const {
+    return std::none_of(levels_.begin(), levels_.end(), [](const Level& level) {
+        return std::any_of(level.dirty.begin(), level.dirty.end(), [](uint8_t dirty) { return dirty != 0; });
+    });
+}
+
+size_t OverlayGraph::getBoundaryNodeCount(size_t level) const {
+    return levels_[level].entries.size() + levels_[level].exits.size();
+}
+
+void OverlayGraph::customizeCell(OverlayPathFinder& finder, size_t level, uint32_t cell) {
+    Level& overlayLevel = levels_[level];
+    const uint32_t firstEntry = overlayLevel.entryOffsets[cell];
+    const uint32_t entryCount = overlayLevel.entryOffsets[cell + 1] - firstEntry;
+    const uint32_t firstExit = overlayLevel.exitOffsets[cell];
+    const uint32_t exitCount = overlayLevel.exitOffsets[cell + 1] - firstExit;
+    if (exitCount == 0) {
+        return;
+    }
+    
+    double* row = overlayLevel.matrix.data() + overlayLevel.matrixOffsets[cell];
+    for (uint32_t entry = 0; entry < entryCount; ++entry, row += exitCount) {
+        finder.searchExits(overlayLevel.entries[firstEntry + entry], level, cell, exitCount);
+        for (uint32_t exit = 0; exit < exitCount; ++exit) {
+            row[exit] = finder.workspace_.distanceOf(overlayLevel.exits[firstExit + exit]);
+        }
+    }
+}
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CompactGraph.hpp"
+#include "GraphPartition.hpp"
+#include "PathFinder.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+class OverlayPathFinder;
+
+/**
+ * @class OverlayGraph
+ * @brief Multilevel overlay of a partitioned graph for one optimization mode (CRP).
+ * 
+ * On every level of the partition, an edge whose endpoints lie in different
+ * cells is a cut edge. Its source is an exit of its cell and its target an
+ * entry of the other cell. For each cell, a clique matrix holds the cost of
+ * the shortest path inside the cell from every entry to every exit. An
+ * OverlayPathFinder searches the original edges only in the cells of the
+ * source and target, and elsewhere uses the cliques of the coarsest level
+ * that keeps away from both.
+ * 
+ * The partition depends only on the graph's structure, so it can be shared
+ * by the overlays of every mode. Edge weights start as the mode's combined
+ * weights and can be changed with setWeight(). Customization then updates
+ * only the cells containing changed edges: first the cells of level 0,
+ * searched on the original edges, then each level from the cliques of the
+ * level below. Clique matrices of different cells are computed in parallel.
+ * 
+ * Edge weights must not be negative. Queries must not run while weights
+ * change or cells are customized.
+ */
+class OverlayGraph {
+public:
+    using Index = CompactGraph::Index;
+    using EdgeIndex = CompactGraph::EdgeIndex;
+    using OptimizationMode = PathFinder::OptimizationMode;
+    
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+    
+    /**
+     * @brief Builds the overlay and customizes every cell.
+     * @param graph Graph to search (shared, not copied)
+     * @param partition Partition of the graph
+     * @param mode Optimization mode giving the initial edge weights
+     * @param threads Number of threads for customization (0 = one per hardware thread)
+     * @throws std::invalid_argument if the partition is of a graph of another size
+     */
+    OverlayGraph(const CompactGraph& graph, const GraphPartition& partition,
+                 OptimizationMode mode = OptimizationMode::DISTANCE, unsigned threads = 0);
+    
+    const CompactGraph& getGraph() const { return graph_; }
+    const GraphPartition& getPartition() const { return partition_; }
+    OptimizationMode getMode() const { return mode_; }
+    size_t getLevelCount() const { return levels_.size(); }
+    
+    double getWeight(EdgeIndex edge) const { return weights_[edge]; }
+    
+    /**
+     * @brief Change the weight an edge has in searches.
+     * 
+     * Takes effect in the cliques at the next customize(). Path totals still
+     * report the graph's own distance, time and cost.
+     * 
+     * @param edge Edge index
+     * @param weight New non-negative weight
+     * @throws std::invalid_argument if the weight is negative or not a number
+     */
+    void setWeight(EdgeIndex edge, double weight);
+    
+    /**
+     * @brief Recompute the clique matrices of the cells whose edges changed weight.
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @return Number of cells recomputed over all levels
+     */
+    size_t customize(unsigned threads = 0);
+    
+    /**
+     * @brief Check whether every weight change has been customized.
+     */
+    bool isCustomized() const;
+    
+    /**
+     * @brief Get the number of entries and exits of all cells of a level.
+     */
+    size_t getBoundaryNodeCount(size_t level) const;
+
+private:
+    friend class OverlayPathFinder;
+    
+    /**
+     * @brief Entries, exits and clique matrices of the cells of one level.
+     * 
+     * The matrix of a cell is row-major, one row per entry and one column per
+     * exit; infinity where an exit cannot be reached inside the cell.
+     */
+    struct Level {
+        std::vector<uint32_t> entryOffsets;  ///< Entries of each cell (cellCount + 1)
+        std::vector<uint32_t> exitOffsets;   ///< Exits of each cell (cellCount + 1)
+        std::vector<Index> entries;
+        std::vector<Index> exits;
+        std::vector<uint32_t> entrySlots;    ///< Position of each node in `entries`, or NO_SLOT
+        std::vector<uint32_t> exitSlots;     ///< Position of each node in `exits`, or NO_SLOT
+        std::vector<uint64_t> matrixOffsets; ///< Matrix of each cell (cellCount + 1)
+        std::vector<double> matrix;
+        std::vector<uint8_t> dirty;          ///< Cells to customize
+    };
+    
+    CompactGraph graph_;
+    GraphPartition partition_;
+    OptimizationMode mode_;
+    std::vector<double> weights_;
+    std::vector<Level> levels_;
+    
+    void customizeCell(OverlayPathFinder& finder, size_t level, uint32_t cell);
+};
+
+} // namespace graph
+} // namespace dijkstra
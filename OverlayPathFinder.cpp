@@ -0,0 +1,220 @@
+#include "OverlayPathFinder.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace dijkstra {
+namespace graph {
+
+OverlayPathFinder::OverlayPathFinder(const OverlayGraph& overlay)
+    : overlay_(overlay)
+    , workspace_(overlay.getGraph().getNodeCount()) {
+}
+
+PathResult OverlayPathFinder::findShortestPath(const Node::NodeId& source, const Node::NodeId& destination) {
+    const CompactGraph& graph = overlay_.getGraph();
+    Index sourceIndex = graph.findNode(source);
+    Index destIndex = graph.findNode(destination);
+    
+    if (sourceIndex == CompactGraph::INVALID_INDEX || destIndex == CompactGraph::INVALID_INDEX) {
+        beginQuery();
+        stats_.end();
+        return PathResult(); // Source or destination not found
+    }
+    
+    return findShortestPath(sourceIndex, destIndex);
+}
+
+PathResult OverlayPathFinder::findShortestPath(Index source, Index destination) {
+    std::vector<Index> nodes;
+    PathResult result = findShortestPath(source, destination, nodes);
+    
+    PathResult::Path path;
+    path.reserve(nodes.size());
+    for (Index node : nodes) {
+        path.emplace_back(overlay_.getGraph().getNodeId(node));
+    }
+    result.setPath(path);
+    return result;
+}
+
+PathResult OverlayPathFinder::findShortestPath(Index source, Index destination, std::vector<Index>& path) {
+    const CompactGraph& graph = overlay_.getGraph();
+    PathResult result;
+    path.clear();
+    beginQuery();
+    SearchStats::Scope timing(stats_);
+    if (source >= graph.getNodeCount() || destination >= graph.getNodeCount()) {
+        return result;
+    }
+    
+    searchUntil(source, destination, overlay_.getLevelCount(), 0,
+                [destination](Index node, double) { return node == destination; });
+    const bool found = workspace_.isReached(destination);
+    std::vector<EdgeIndex> edges;
+    if (found && stop_.getReason() == util::StopCondition::Reason::NONE) {
+        unpack(destination, edges);
+    }
+    stats_.end();
+    result.setStats(stats_);
+    if (stop_.getReason() != util::StopCondition::Reason::NONE) {
+        result.setStatus(PathFinder::stoppedStatus(stop_.getReason()));
+        return result;
+    }
+    if (!found) {
+        return result; // No path found
+    }
+    
+    double totalDistance = 0.0;
+    double totalTime = 0.0;
+    double totalCost = 0.0;
+    path.push_back(source);
+    for (EdgeIndex edge : edges) {
+        totalDistance += graph.getDistance(edge);
+        totalTime += graph.getTime(edge);
+        totalCost += graph.getCost(edge);
+        path.push_back(graph.getTarget(edge));
+    }
+    
+    result.setFound(true);
+    result.setTotalDistance(totalDistance);
+    result.setTotalTime(totalTime);
+    result.setTotalCost(totalCost);
+    return result;
+}
+
+void OverlayPathFinder::beginQuery() {
+    stop_.begin();
+    stats_.begin("crp-overlay");
+}
+
+void OverlayPathFinder::reach(Index node, double distance, const Arc& parent) {
+    if (workspace_.isReached(node)) {
+        stats_.countDecreaseKey();
+    }
+    workspace_.reach(node, distance, parent);
+    stats_.countPush(workspace_.getHeapSize());
+}
+
+int OverlayPathFinder::searchLevel(Index node, Index source, Index target, size_t limit) const {
+    // A node outside the source's cell on some level is outside it on every finer level too
+    const GraphPartition& partition = overlay_.getPartition();
+    for (size_t level = limit; level-- > 0;) {
+        uint32_t cell = partition.getCell(level, node);
+        if (cell != partition.getCell(level, source) &&
+            (target == CompactGraph::INVALID_INDEX || cell != partition.getCell(level, target))) {
+            return static_cast<int>(level);
+        }
+    }
+    return FLAT;
+}
+
+template <typename OnSettle>
+void OverlayPathFinder::searchUntil(Index source, Index target, size_t level, uint32_t cell, OnSettle onSettle) {
+    const CompactGraph& graph = overlay_.getGraph();
+    const GraphPartition& partition = overlay_.getPartition();
+    const bool wholeGraph = level == overlay_.getLevelCount();
+    auto inScope = [&](Index node) { return wholeGraph || partition.getCell(level, node) == cell; };
+    
+    workspace_.clear();
+    reach(source, 0.0, {source, 0, NO_EDGE});
+    
+    while (!workspace_.isHeapEmpty()) {
+        auto current = workspace_.pop();
+        stats_.countPop();
+        
+        // Skip if we've found a better path already
+        if (current.distance > workspace_.getDistance(current.node)) {
+            continue;
+        }
+        
+        // Give up if the deadline has passed or the query was cancelled
+        if (stop_.shouldStop()) {
+            break;
+        }
+        stats_.countSettled();
+        
+        if (onSettle(current.node, current.distance)) {
+            break;
+        }
+        
+        const Index node = current.node;
+        auto relax = [&](Index neighbor, double distance, const Arc& arc) {
+            stats_.countRelaxed();
+            if (!workspace_.isReached(neighbor) || distance < workspace_.getDistance(neighbor)) {
+                reach(neighbor, distance, arc);
+            }
+        };
+        
+        const int searchAt = searchLevel(node, source, target, level);
+        if (searchAt == FLAT) {
+            for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+                Index neighbor = graph.getTarget(edge);
+                if (inScope(neighbor)) {
+                    relax(neighbor, current.distance + overlay_.weights_[edge], {node, 0, edge});
+                }
+            }
+            continue;
+        }
+        
+        // Cross the node's cell through its clique, and leave it through its cut edges
+        const OverlayGraph::Level& overlayLevel = overlay_.levels_[searchAt];
+        const uint32_t nodeCell = partition.getCell(searchAt, node);
+        const uint32_t entry = overlayLevel.entrySlots[node];
+        if (entry != OverlayGraph::NO_SLOT) {
+            const uint32_t firstExit = overlayLevel.exitOffsets[nodeCell];
+            const uint32_t exitCount = overlayLevel.exitOffsets[nodeCell + 1] - firstExit;
+            const double* costs = overlayLevel.matrix.data() + overlayLevel.matrixOffsets[nodeCell] +
+                                  static_cast<uint64_t>(entry - overlayLevel.entryOffsets[nodeCell]) * exitCount;
+            for (uint32_t exit = 0; exit < exitCount; ++exit) {
+                Index neighbor = overlayLevel.exits[firstExit + exit];
+                if (neighbor != node && costs[exit] != std::numeric_limits<double>::infinity()) {
+                    relax(neighbor, current.distance + costs[exit],
+                          {node, static_cast<uint32_t>(searchAt), NO_EDGE});
+                }
+            }
+        }
+        if (overlayLevel.exitSlots[node] != OverlayGraph::NO_SLOT) {
+            for (EdgeIndex edge = graph.getFirstEdge(node); edge < graph.getLastEdge(node); ++edge) {
+                Index neighbor = graph.getTarget(edge);
+                if (partition.getCell(searchAt, neighbor) != nodeCell && inScope(neighbor)) {
+                    relax(neighbor, current.distance + overlay_.weights_[edge], {node, 0, edge});
+                }
+            }
+        }
+    }
+}
+
+void OverlayPathFinder::searchExits(Index entry, size_t level, uint32_t cell, size_t exitCount) {
+    const OverlayGraph::Level& overlayLevel = overlay_.levels_[level];
+    size_t remaining = exitCount;
+    searchUntil(entry, CompactGraph::INVALID_INDEX, level, cell, [&](Index node, double) {
+        return overlayLevel.exitSlots[node] != OverlayGraph::NO_SLOT && --remaining == 0;
+    });
+}
+
+void OverlayPathFinder::unpack(Index target, std::vector<EdgeIndex>& edges) {
+    // Collect the arcs before searching again overwrites the parents
+    std::vector<std::pair<Index, Arc>> arcs;
+    for (Index node = target; workspace_.getParent(node).from != node; node = workspace_.getParent(node).from) {
+        arcs.emplace_back(node, workspace_.getParent(node));
+    }
+    std::reverse(arcs.begin(), arcs.end());
+    
+    for (const auto& step : arcs) {
+        const Arc& arc = step.second;
+        if (arc.edge != NO_EDGE) {
+            edges.push_back(arc.edge);
+            continue;
+        }
+        const Index to = step.first;
+        const uint32_t cell = overlay_.getPartition().getCell(arc.level, arc.from);
+        searchUntil(arc.from, to, arc.level, cell, [to](Index node, double) { return node == to; });
+        if (stop_.getReason() != util::StopCondition::Reason::NONE) {
+            return; // The caller reports the stop
+        }
+        unpack(to, edges);
+    }
+}
+
+} // namespace graph
+} // namespace dijkstra
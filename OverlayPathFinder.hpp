@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "OverlayGraph.hpp"
+#include "SearchWorkspace.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class OverlayPathFinder
+ * @brief Multilevel Dijkstra search over an OverlayGraph.
+ * 
+ * A settled node is expanded on the coarsest level whose cell contains
+ * neither the source nor the target: it follows its cell's clique to the
+ * cell's exits, and from an exit the cut edges leaving the cell. Nodes
+ * sharing the finest cell with the source or target are expanded along their
+ * original edges. Clique arcs on the shortest path are then unpacked into
+ * original edges by searching inside their cells, one level down at a time.
+ * 
+ * Costs use the overlay's edge weights, i.e. the overlay's optimization mode.
+ * Like CompactPathFinder, the workspace is reused across queries and an
+ * instance is not thread-safe; use one per thread.
+ */
+class OverlayPathFinder {
+public:
+    using Index = CompactGraph::Index;
+    using EdgeIndex = CompactGraph::EdgeIndex;
+    
+    /**
+     * @brief Constructs a path finder for an overlay.
+     * @param overlay Customized overlay to search; must outlive the finder
+     */
+    explicit OverlayPathFinder(const OverlayGraph& overlay);
+    
+    /**
+     * @brief Find the shortest path between two nodes.
+     * @param source Source node ID
+     * @param destination Destination node ID
+     * @return PathResult containing the path and metrics
+     */
+    PathResult findShortestPath(const Node::NodeId& source, const Node::NodeId& destination);
+    
+    /**
+     * @brief Find the shortest path between two node indices.
+     * @param source Source node index
+     * @param destination Destination node index
+     * @return PathResult containing the path and metrics
+     */
+    PathResult findShortestPath(Index source, Index destination);
+    
+    /**
+     * @brief Find the shortest path between two node indices without resolving node IDs.
+     * @param source Source node index
+     * @param destination Destination node index
+     * @param path Receives the node indices from source to destination (empty if none)
+     * @return PathResult with the totals; its path of node IDs is left empty
+     */
+    PathResult findShortestPath(Index source, Index destination, std::vector<Index>& path);
+    
+    /**
+     * @brief Bound later queries by a deadline, timeout and/or cancellation token.
+     * @param stop Stop condition to copy
+     */
+    void setStopCondition(const util::StopCondition& stop) { stop_ = stop; }
+    
+    /**
+     * @brief Get why the last query stopped early.
+     * @return Reason::NONE if it ran to completion
+     */
+    util::StopCondition::Reason getStopReason() const { return stop_.getReason(); }
+    
+    /**
+     * @brief Get the work done by the last query, including unpacking.
+     */
+    const SearchStats& getLastStats() const { return stats_; }
+
+private:
+    friend class OverlayGraph;
+    
+    /**
+     * @brief How a node was reached: by an original edge, or by a clique arc of a level.
+     */
+    struct Arc {
+        Index from;
+        uint32_t level; ///< Level of the clique arc
+        EdgeIndex edge; ///< Original edge, or NO_EDGE for a clique arc
+    };
+    
+    static constexpr EdgeIndex NO_EDGE = ~EdgeIndex(0);
+    static constexpr int FLAT = -1; ///< Search level of nodes expanded along original edges
+    
+    const OverlayGraph& overlay_;
+    util::StopCondition stop_;
+    SearchStats stats_;
+    SearchWorkspace<Arc> workspace_;
+    
+    void beginQuery();
+    void reach(Index node, double distance, const Arc& parent);
+    
+    /**
+     * @brief Get the coarsest level below `limit` whose cell holds neither endpoint.
+     * @return The level, or FLAT if there is none
+     */
+    int searchLevel(Index node, Index source, Index target, size_t limit) const;
+    
+    /**
+     * @brief Run Dijkstra from a source inside one cell, on the cliques of the levels below it.
+     * @param level Level of the cell; the level count searches the whole graph
+     * @param cell Cell to stay in
+     * @param onSettle Called for every settled node and its distance; returns true to stop
+     */
+    template <typename OnSettle>
+    void searchUntil(Index source, Index target, size_t level, uint32_t cell, OnSettle onSettle);
+    
+    /**
+     * @brief Compute the costs from an entry of a cell to its exits (for customization).
+     */
+    void searchExits(Index entry, size_t level, uint32_t cell, size_t exitCount);
+    
+    /**
+     * @brief Append the original edges of the shortest path behind a reached node.
+     * @param target Node whose parent arcs lead back to the search source
+     * @param edges Receives the edges in path order
+     */
+    void unpack(Index target, std::vector<EdgeIndex>& edges);
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dijkstra {
+namespace util {
+
+/**
+ * @brief Turn a requested thread count into an actual one.
+ * @param requested Requested number of threads (0 = one per hardware thread)
+ * @return Number of threads to use (at least 1)
+ */
+inline unsigned resolveThreadCount(unsigned requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+namespace detail {
+
+/**
+ * @brief Run a worker on `threads` threads (the caller being one of them) and
+ *        rethrow the first exception any of them raised.
+ */
+template <typename Worker>
+void runOnThreads(unsigned threads, Worker&& worker) {
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    
+    auto guarded = [&](unsigned threadIndex) {
+        try {
+            worker(threadIndex);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(guarded, t);
+    }
+    guarded(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Split [0, count) into one contiguous block per thread.
+ * 
+ * `function(begin, end)` is called once per non-empty block.
+ * 
+ * @param count Number of items
+ * @param threads Number of threads
+ * @param function Callable taking (size_t begin, size_t end)
+ */
+template <typename Function>
+void parallelForRange(size_t count, unsigned threads, Function&& function) {
+    threads = static_cast<unsigned>(std::min<size_t>(std::max(1u, threads), std::max<size_t>(count, 1)));
+    if (threads == 1) {
+        if (count > 0) {
+            function(size_t(0), count);
+        }
+        return;
+    }
+    
+    detail::runOnThreads(threads, [&](unsigned threadIndex) {
+        size_t begin = count * threadIndex / threads;
+        size_t end = count * (threadIndex + 1) / threads;
+        if (begin < end) {
+            function(begin, end);
+        }
+    });
+}
+
+/**
+ * @brief Hand out items [0, count) one at a time to whichever thread is free.
+ * 
+ * Suited to items of uneven cost, such as parse chunks.
+ * 
+ * @param count Number of items
+ * @param threads Number of threads
+ * @param function Callable taking (size_t item, unsigned threadIndex)
+ */
+template <typename Function>
+void parallelForEach(size_t count, unsigned threads, Function&& function) {
+    threads = static_cast<unsigned>(std::min<size_t>(std::max(1u, threads), std::max<size_t>(count, 1)));
+    std::atomic<size_t> next{0};
+    
+    detail::runOnThreads(threads, [&](unsigned threadIndex) {
+        for (size_t item = next.fetch_add(1); item < count; item = next.fetch_add(1)) {
+            function(item, threadIndex);
+        }
+    });
+}
+
+/**
+ * @brief Sort a vector using several threads.
+ * 
+ * Blocks are sorted independently and then merged pairwise, each merge round
+ * running in parallel.
+ * 
+ * @param values Vector to sort
+ * @param threads Number of threads
+ * @param compare Strict weak ordering
+ */
+template <typename T, typename Compare>
+void parallelSort(std::vector<T>& values, unsigned threads, Compare compare) {
+    const size_t count = values.size();
+    size_t blocks = std::min<size_t>(std::max(1u, threads), std::max<size_t>(count / 4096, 1));
+    if (blocks <= 1) {
+        std::sort(values.begin(), values.end(), compare);
+        return;
+    }
+    
+    std::vector<size_t> bounds(blocks + 1);
+    for (size_t b = 0; b <= blocks; ++b) {
+        bounds[b] = count * b / blocks;
+    }
+    
+    parallelForEach(blocks, threads, [&](size_t b, unsigned) {
+        std::sort(values.begin() + bounds[b], values.begin() + bounds[b + 1], compare);
+    });
+    
+    for (size_t width = 1; width < blocks; width *= 2) {
+        size_t merges = (blocks + 2 * width - 1) / (2 * width);
+        parallelForEach(merges, threads, [&](size_t m, unsigned) {
+            size_t first = 2 * width * m;
+            size_t middle = std::min(first + width, blocks);
+            size_t last = std::min(first + 2 * width, blocks);
+            if (middle < last) {
+                std::inplace_merge(values.begin() + bounds[first], values.begin() + bounds[middle],
+                                   values.begin() + bounds[last], compare);
+            }
+        });
+    }
+}
+
+} // namespace util
+} // namespace dijkstra
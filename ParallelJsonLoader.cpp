@@ -0,0 +1,267 @@
+#include "ParallelJsonLoader.hpp"
+#include "GraphSaxHandler.hpp"
+#include "MappedFile.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace dijkstra {
+namespace data {
+
+namespace {
+
+enum class Section { NONE, NODES, EDGES };
+
+/**
+ * @brief A run of whole records inside the `nodes` or `edges` array.
+ */
+struct Chunk {
+    Section section;
+    size_t begin; ///< Offset of the first byte of the run
+    size_t end;   ///< Offset one past the last byte of the run
+};
+
+/**
+ * @brief Find the record runs of both arrays in one pass over the file.
+ * 
+ * Tracks strings and nesting only; a run is closed at the first record that
+ * starts at least chunkBytes after the run began.
+ */
+std::vector<Chunk> scanChunks(const char* data, size_t size, size_t chunkBytes,
+                              const std::string& filePath) {
+    std::vector<Chunk> chunks;
+    size_t depth = 0;
+    bool sawRoot = false;
+    bool inString = false;
+    size_t keyBegin = 0;
+    size_t keyEnd = 0;
+    bool hasKey = false;
+    Section pending = Section::NONE;
+    Section current = Section::NONE;
+    size_t chunkBegin = 0;
+    
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (inString) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                inString = false;
+                if (depth == 1) {
+                    keyEnd = i;
+                    hasKey = true;
+                }
+            }
+            continue;
+        }
+        
+        switch (c) {
+            case '"':
+                inString = true;
+                if (depth == 1) {
+                    keyBegin = i + 1;
+                }
+                break;
+            case ':':
+                if (depth == 1 && hasKey) {
+                    std::string_view key(data + keyBegin, keyEnd - keyBegin);
+                    pending = (key == "nodes") ? Section::NODES
+                            : (key == "edges") ? Section::EDGES : Section::NONE;
+                }
+                hasKey = false;
+                break;
+            case ',':
+                if (depth == 1) {
+                    hasKey = false;
+                    pending = Section::NONE;
+                }
+                break;
+            case '{':
+            case '[':
+                if (depth == 0) {
+                    if (sawRoot || c != '{') {
+                        throw std::runtime_error("Failed to parse JSON file " + filePath +
+                                                 ": top-level value must be a single object");
+                    }
+                    sawRoot = true;
+                } else if (depth == 1) {
+                    if (c == '[' && pending != Section::NONE) {
+                        current = pending;
+                        chunkBegin = i + 1;
+                    }
+                    pending = Section::NONE;
+                } else if (depth == 2 && current != Section::NONE && c == '{' &&
+                           i - chunkBegin >= chunkBytes) {
+                    chunks.push_back({current, chunkBegin, i});
+                    chunkBegin = i;
+                }
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    throw std::runtime_error("Failed to parse JSON file " + filePath +
+                                             ": unbalanced brackets at byte " + std::to_string(i));
+                }
+                --depth;
+                if (depth == 1 && current != Section::NONE) {
+                    chunks.push_back({current, chunkBegin, i});
+                    current = Section::NONE;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    
+    if (!sawRoot || inString || depth != 0) {
+        throw std::runtime_error("Failed to parse JSON file " + filePath + ": unexpected end of input");
+    }
+    // Even an empty array leaves a (zero-length) run, so no runs means neither array was there
+    if (chunks.empty()) {
+        throw std::runtime_error("Failed to parse JSON file " + filePath +
+                                 ": no top-level \"nodes\" or \"edges\" array");
+    }
+    return chunks;
+}
+
+/**
+ * @brief Parse one run of records by wrapping it in a minimal document.
+ * @param buffer Reusable per-thread buffer
+ */
+void parseChunk(const char* data, const Chunk& chunk, const std::string& filePath,
+                std::string& buffer, GraphSaxHandler::RecordSink& sink) {
+    // Drop the separator between this run and the next one
+    size_t end = chunk.end;
+    while (end > chunk.begin && std::isspace(static_cast<unsigned char>(data[end - 1]))) {
+        --end;
+    }
+    if (end > chunk.begin && data[end - 1] == ',') {
+        --end;
+    }
+    
+    buffer.assign(chunk.section == Section::NODES ? "{\"nodes\":[" : "{\"edges\":[");
+    buffer.append(data + chunk.begin, end - chunk.begin);
+    buffer.append("]}");
+    
+    GraphSaxHandler handler(sink);
+    if (!nlohmann::json::sax_parse(buffer, &handler)) {
+        throw std::runtime_error("Failed to parse JSON file " + filePath + " in records starting at byte " +
+                                 std::to_string(chunk.begin) + ": " + handler.getErrorMessage());
+    }
+}
+
+/**
+ * @brief Collects the node records of one chunk for in-order interning.
+ */
+class NodeCollector : public GraphSaxHandler::RecordSink {
+public:
+    std::vector<GraphSaxHandler::NodeRecord> nodes;
+    
+    void onNode(GraphSaxHandler::NodeRecord& record) override {
+        nodes.push_back(std::move(record));
+    }
+    void onEdge(GraphSaxHandler::EdgeRecord&) override {}
+};
+
+/**
+ * @brief Resolves the edge records of one chunk against the finished node table.
+ */
+class EdgeResolver : public GraphSaxHandler::RecordSink {
+public:
+    explicit EdgeResolver(const graph::CompactGraphBuilder& builder, graph::EdgeBatch& batch)
+        : builder_(builder), batch_(batch) {}
+    
+    void onNode(GraphSaxHandler::NodeRecord&) override {}
+    void onEdge(GraphSaxHandler::EdgeRecord& record) override {
+        auto source = builder_.findNode(record.source);
+        auto target = builder_.findNode(record.destination);
+        if (source == graph::CompactGraph::INVALID_INDEX || target == graph::CompactGraph::INVALID_INDEX) {
+            ++skipped;
+            return;
+        }
+        batch_.add(record.id, source, target, record.weight, record.timeWeight, record.costWeight);
+    }
+    
+    size_t skipped = 0;
+
+private:
+    const graph::CompactGraphBuilder& builder_;
+    graph::EdgeBatch& batch_;
+};
+
+} // namespace
+
+ParallelJsonLoader::ParallelJsonLoader(unsigned threads, size_t chunkBytes)
+    : threads_(util::resolveThreadCount(threads)), chunkBytes_(std::max<size_t>(chunkBytes, 1)) {
+}
+
+graph::CompactGraph ParallelJsonLoader::load(const std::string& filePath) {
+    MappedFile file(filePath);
+    file.adviseSequential();
+    const char* data = file.data();
+    bytesRead_ = file.size();
+    
+    auto chunks = scanChunks(data, file.size(), chunkBytes_, filePath);
+    chunkCount_ = chunks.size();
+    std::vector<Chunk> nodeChunks;
+    std::vector<Chunk> edgeChunks;
+    for (const auto& chunk : chunks) {
+        (chunk.section == Section::NODES ? nodeChunks : edgeChunks).push_back(chunk);
+    }
+    
+    std::vector<std::string> buffers(threads_);
+    graph::CompactGraphBuilder builder;
+    
+    // Nodes: parse in parallel, intern in file order so duplicates resolve
+    // the same way as in the sequential loaders
+    {
+        std::vector<NodeCollector> collectors(nodeChunks.size());
+        util::parallelForEach(nodeChunks.size(), threads_, [&](size_t item, unsigned threadIndex) {
+            parseChunk(data, nodeChunks[item], filePath, buffers[threadIndex], collectors[item]);
+        });
+        
+        size_t nodeCount = 0;
+        for (const auto& collector : collectors) {
+            nodeCount += collector.nodes.size();
+        }
+        builder.reserve(nodeCount, 0);
+        
+        nodesLoaded_ = 0;
+        for (const auto& collector : collectors) {
+            for (const auto& record : collector.nodes) {
+                if (builder.addNode(record.id, record.name) != graph::CompactGraph::INVALID_INDEX) {
+                    ++nodesLoaded_;
+                }
+            }
+        }
+    }
+    
+    // Edges: the node table is now read-only, so every chunk resolves its own
+    // endpoints into a private batch
+    {
+        std::vector<graph::EdgeBatch> batches(edgeChunks.size());
+        std::vector<size_t> skipped(edgeChunks.size(), 0);
+        util::parallelForEach(edgeChunks.size(), threads_, [&](size_t item, unsigned threadIndex) {
+            EdgeResolver resolver(builder, batches[item]);
+            parseChunk(data, edgeChunks[item], filePath, buffers[threadIndex], resolver);
+            skipped[item] = resolver.skipped;
+        });
+        
+        builder.appendEdges(batches, threads_);
+        edgesLoaded_ = builder.getEdgeCount();
+        edgesSkipped_ = 0;
+        for (size_t count : skipped) {
+            edgesSkipped_ += count;
+        }
+    }
+    
+    buffers.clear();
+    return builder.build(threads_);
+}
+
+} // namespace data
+} // namespace dijkstra
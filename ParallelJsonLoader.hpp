@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "../graph/CompactGraph.hpp"
+
+namespace dijkstra {
+namespace data {
+
+/**
+ * @class ParallelJsonLoader
+ * @brief Loads a `nodes`/`edges` JSON graph file into a CompactGraph using several threads.
+ * 
+ * The file is memory-mapped and scanned once for its structure: the extent of
+ * the `nodes` and `edges` arrays and record boundaries roughly every
+ * chunk-size bytes inside them. Each chunk is then parsed independently with
+ * GraphSaxHandler on a worker thread. Node chunks are interned in file order,
+ * so duplicate node IDs resolve exactly as in the sequential loaders; edge
+ * chunks are resolved against the finished node table into per-chunk batches
+ * that the builder appends and packs in parallel.
+ * 
+ * The resulting graph is identical for every thread count. Values outside the
+ * two arrays are skipped by the structural scan rather than fully validated.
+ */
+class ParallelJsonLoader {
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 4 << 20; ///< Target bytes per parse chunk
+    
+    /**
+     * @brief Constructs a loader.
+     * @param threads Number of threads (0 = one per hardware thread)
+     * @param chunkBytes Target size of each parse chunk
+     */
+    explicit ParallelJsonLoader(unsigned threads = 0, size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+    
+    /**
+     * @brief Load a graph file.
+     * @param filePath Path to the JSON file
+     * @return The loaded graph
+     * @throws std::runtime_error if the file cannot be read or parsed, or has
+     *         neither a `nodes` nor an `edges` array
+     */
+    graph::CompactGraph load(const std::string& filePath);
+    
+    size_t getBytesRead() const { return bytesRead_; }
+    size_t getNodesLoaded() const { return nodesLoaded_; }
+    size_t getEdgesLoaded() const { return edgesLoaded_; }
+    size_t getEdgesSkipped() const { return edgesSkipped_; }
+    size_t getChunkCount() const { return chunkCount_; }
+    unsigned getThreadCount() const { return threads_; }
+
+private:
+    unsigned threads_;
+    size_t chunkBytes_;
+    
+    size_t bytesRead_ = 0;
+    size_t nodesLoaded_ = 0;
+    size_t edgesLoaded_ = 0;
+    size_t edgesSkipped_ = 0;
+    size_t chunkCount_ = 0;
+};
+
+} // namespace data
+} // namespace dijkstra
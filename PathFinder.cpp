@@ -1,9 +1,11 @@
 #include "PathFinder.hpp"
+#include "CompoundEdge.hpp"
+#include <algorithm>
 
 namespace dijkstra {
 namespace graph {
 
-PathFinder::PathFinder(const Graph& graph) : graph_(graph) {
+PathFinder::PathFinder(const GraphView& graph) : graph_(graph) {
 }
 
 PathResult PathFinder::findShortestPath(
@@ -11,7 +13,20 @@ PathResult PathFinder::findShortestPath(
     const Node::NodeId& destination,
     OptimizationMode mode) {
     
+    stats_.begin("dijkstra");
+    PathResult result = searchPath(source, destination, mode);
+    stats_.end();
+    result.setStats(stats_);
+    return result;
+}
+
+PathResult PathFinder::searchPath(
+    const Node::NodeId& source,
+    const Node::NodeId& destination,
+    OptimizationMode mode) {
+    
     PathResult result;
+    stop_.begin();
     
     // Check if source and destination nodes exist
     auto sourceNode = graph_.getNode(source);
@@ -38,17 +53,20 @@ PathResult PathFinder::findShortestPath(
     
     // Initialize priority queue
     pq.push({source, 0.0});
+    stats_.countPush(pq.size());
     
     // Dijkstra's algorithm
     while (!pq.empty()) {
         NodeDistance current = pq.top();
         pq.pop();
+        stats_.countPop();
         
         const auto& currentId = current.nodeId;
         double currentDist = current.distance;
         
         // If we've reached the destination, we can stop
         if (currentId == destination) {
+            stats_.countSettled();
             break;
         }
         
@@ -56,18 +74,31 @@ PathResult PathFinder::findShortestPath(
         if (currentDist > distances[currentId]) {
             continue;
         }
+        stats_.countSettled();
+        
+        // Give up if the deadline has passed or the query was cancelled
+        if (stop_.shouldStop()) {
+            result.setStatus(stoppedStatus(stop_.getReason()));
+            return result;
+        }
         
         // Process all outgoing edges
         for (const auto& edge : graph_.getOutgoingEdges(currentId)) {
             const auto& neighborId = edge->getDestination()->getId();
             double weight = getEdgeWeight(edge, mode);
             double dist = currentDist + weight;
+            stats_.countRelaxed();
             
             // If we've found a better path
-            if (dist < distances[neighborId]) {
-                distances[neighborId] = dist;
+            double& known = distances[neighborId];
+            if (dist < known) {
+                if (known != std::numeric_limits<double>::infinity()) {
+                    stats_.countDecreaseKey();
+                }
+                known = dist;
                 predecessors[neighborId] = currentId;
                 pq.push({neighborId, dist});
+                stats_.countPush(pq.size());
             }
         }
     }
@@ -79,34 +110,50 @@ PathResult PathFinder::findShortestPath(
     
     // Reconstruct the path
     auto path = reconstructPath(predecessors, source, destination);
+    if (path.empty()) {
+        return result;
+    }
     
-    // Calculate metrics
+    // Calculate metrics, restoring the nodes inside compound edges
     double totalDistance = 0.0;
     double totalTime = 0.0;
     double totalCost = 0.0;
+    Path expanded{path.front()};
     
     for (size_t i = 0; i < path.size() - 1; ++i) {
         const auto& currentId = path[i];
         const auto& nextId = path[i + 1];
         
-        // Find the edge between current and next node
-        auto edgeList = graph_.getOutgoingEdges(currentId);
-        auto edgeIt = std::find_if(edgeList.begin(), edgeList.end(),
-            [&nextId](const EdgePtr& edge) {
-                return edge->getDestination()->getId() == nextId;
-            });
+        // Find the edge the search took: with parallel edges between the two
+        // nodes, that is the cheapest one for the mode, not the first one
+        EdgePtr edge;
+        double edgeWeight = std::numeric_limits<double>::infinity();
+        for (const auto& candidate : graph_.getOutgoingEdges(currentId)) {
+            if (candidate->getDestination()->getId() == nextId) {
+                double weight = getEdgeWeight(candidate, mode);
+                if (!edge || weight < edgeWeight) {
+                    edge = candidate;
+                    edgeWeight = weight;
+                }
+            }
+        }
         
-        if (edgeIt != edgeList.end()) {
-            EdgePtr edge = *edgeIt;
+        if (edge) {
             totalDistance += edge->getWeight();
             totalTime += edge->getTimeWeight();
             totalCost += edge->getCostWeight();
+            if (auto compound = std::dynamic_pointer_cast<CompoundEdge>(edge)) {
+                for (const auto& via : compound->getVia()) {
+                    expanded.push_back(via->getId());
+                }
+            }
         }
+        expanded.push_back(nextId);
     }
     
     // Set the result
     result.setFound(true);
-    result.setPath(path);
+    result.setPath(expanded);
     result.setTotalDistance(totalDistance);
     result.setTotalTime(totalTime);
     result.setTotalCost(totalCost);
@@ -120,6 +167,9 @@ std::unordered_map<Node::NodeId, double> PathFinder::findShortestPaths(
     
     // Distance map (node ID -> distance)
     std::unordered_map<Node::NodeId, double> distances;
+    stop_.begin();
+    stats_.begin("dijkstra-linear-scan");
+    SearchStats::Scope timing(stats_);
     
     // Check if source node exists
     if (!graph_.getNode(source)) {
@@ -136,7 +186,7 @@ std::unordered_map<Node::NodeId, double> PathFinder::findShortestPaths(
     }
     
     // Dijkstra's algorithm
-    while (processed.size() < graph_.getNodeCount()) {
+    while (processed.size() < graph_.getNodeCount() && !stop_.shouldStop()) {
         // Find the node with the minimum distance
         double minDist = std::numeric_limits<double>::infinity();
         Node::NodeId minNode;
@@ -158,11 +208,13 @@ std::unordered_map<Node::NodeId, double> PathFinder::findShortestPaths(
         
         // Mark node as processed
         processed.insert(minNode);
+        stats_.countSettled();
         
         // Update distances to neighbors
         for (const auto& edge : graph_.getOutgoingEdges(minNode)) {
             const auto& neighborId = edge->getDestination()->getId();
             
+            stats_.countRelaxed();
             if (processed.find(neighborId) == processed.end()) {
                 double weight = getEdgeWeight(edge, mode);
                 double dist = distances[minNode] + weight;
@@ -178,22 +230,7 @@ std::unordered_map<Node::NodeId, double> PathFinder::findShortestPaths(
 }
 
 double PathFinder::getEdgeWeight(EdgePtr edge, OptimizationMode mode) const {
-    switch (mode) {
-        case OptimizationMode::DISTANCE:
-            return edge->getWeight();
-        case OptimizationMode::TIME:
-            return edge->getTimeWeight();
-        case OptimizationMode::COST:
-            return edge->getCostWeight();
-        case OptimizationMode::BALANCED:
-            // Balanced optimization: normalize and combine all three weights
-            double distNorm = edge->getWeight() / 100.0;       // Normalize to approximately 0-1
-            double timeNorm = edge->getTimeWeight() / 5.0;     // Normalize to approximately 0-1
-            double costNorm = edge->getCostWeight() / 50.0;    // Normalize to approximately 0-1
-            return (distNorm + timeNorm + costNorm) / 3.0;     // Equal weight to all three
-        default:
-            return edge->getWeight();
-    }
+    return combineWeights(edge->getWeight(), edge->getTimeWeight(), edge->getCostWeight(), mode);
 }
 
 PathFinder::Path PathFinder::reconstructPath(
@@ -4,7 +4,10 @@
 #include <unordered_map>
 #include <limits>
 #include <queue>
+#include <string_view>
 #include "Graph.hpp"
+#include "SearchStats.hpp"
+#include "../util/Cancellation.hpp"
 
 namespace dijkstra {
 namespace graph {
@@ -17,10 +20,31 @@ class PathResult {
 public:
     using Path = std::vector<Node::NodeId>;
     
-    PathResult() : totalDistance_(0.0), totalTime_(0.0), totalCost_(0.0), found_(false) {}
+    enum class Status {
+        FOUND,      ///< A shortest path was found
+        NOT_FOUND,  ///< No path exists (or an endpoint does not)
+        TIMED_OUT,  ///< The search was stopped by its deadline
+        CANCELLED   ///< The search was stopped by its cancellation token
+    };
+    
+    PathResult() : totalDistance_(0.0), totalTime_(0.0), totalCost_(0.0), status_(Status::NOT_FOUND) {}
+    
+    bool isFound() const { return status_ == Status::FOUND; }
+    void setFound(bool found) { status_ = found ? Status::FOUND : Status::NOT_FOUND; }
     
-    bool isFound() const { return found_; }
-    void setFound(bool found) { found_ = found; }
+    Status getStatus() const { return status_; }
+    void setStatus(Status status) { status_ = status; }
+    
+    /**
+     * @brief Check whether the search gave up before it could decide.
+     */
+    bool isInterrupted() const { return status_ == Status::TIMED_OUT || status_ == Status::CANCELLED; }
+    
+    /**
+     * @brief Get the work the search did (all zero if statistics are compiled out).
+     */
+    const SearchStats& getStats() const { return stats_; }
+    void setStats(const SearchStats& stats) { stats_ = stats; }
     
     const Path& getPath() const { return path_; }
     void setPath(const Path& path) { path_ = path; }
@@ -39,12 +63,16 @@ private:
     double totalDistance_;
     double totalTime_;
     double totalCost_;
-    bool found_;
+    Status status_;
+    SearchStats stats_;
 };
 
 /**
  * @class PathFinder
  * @brief Implements Dijkstra's algorithm for shortest path finding.
+ * 
+ * Searches any GraphView: a Graph, or a snapshot read from a ConcurrentGraph
+ * while it is being updated. The view must outlive the finder.
  */
 class PathFinder {
 public:
@@ -55,10 +83,15 @@ public:
         BALANCED   ///< Balanced optimization
     };
     
-    explicit PathFinder(const Graph& graph);
+    using Path = PathResult::Path;
+    
+    explicit PathFinder(const GraphView& graph);
     
     /**
      * @brief Find the shortest path between two nodes.
+     * 
+     * The path lists the nodes inside any CompoundEdge it uses.
+     * 
      * @param source Source node ID
      * @param destination Destination node ID
      * @param mode Optimization mode
@@ -72,11 +105,103 @@ public:
      * @brief Find shortest paths from source to all other nodes.
      * @param source Source node ID
      * @param mode Optimization mode
-     * @return Map of node IDs to their shortest distances
+     * @return Map of node IDs to their shortest distances; distances are only
+     *         final for settled nodes if getStopReason() reports an early stop
      */
     std::unordered_map<Node::NodeId, double> findShortestPaths(
         const Node::NodeId& source,
         OptimizationMode mode = OptimizationMode::DISTANCE);
+    
+    /**
+     * @brief Bound later queries by a deadline, timeout and/or cancellation token.
+     * 
+     * A query that has to stop returns a TIMED_OUT or CANCELLED result.
+     * 
+     * @param stop Stop condition to copy
+     */
+    void setStopCondition(const util::StopCondition& stop) { stop_ = stop; }
+    
+    /**
+     * @brief Get why the last query stopped early.
+     * @return Reason::NONE if it ran to completion
+     */
+    util::StopCondition::Reason getStopReason() const { return stop_.getReason(); }
+    
+    /**
+     * @brief Get the work done by the last query.
+     */
+    const SearchStats& getLastStats() const { return stats_; }
+    
+    /**
+     * @brief Get the result status that reports an early stop.
+     * @param reason Reason the search stopped (not Reason::NONE)
+     */
+    static PathResult::Status stoppedStatus(util::StopCondition::Reason reason) {
+        return reason == util::StopCondition::Reason::CANCELLED ? PathResult::Status::CANCELLED
+                                                                : PathResult::Status::TIMED_OUT;
+    }
+    
+    /**
+     * @brief Combine the weights of an edge into a single cost for a mode.
+     * @param distance Primary (distance) weight
+     * @param time Time weight
+     * @param cost Cost weight
+     * @param mode Optimization mode
+     * @return Edge cost used by the search
+     */
+    static double combineWeights(double distance, double time, double cost, OptimizationMode mode) {
+        switch (mode) {
+            case OptimizationMode::DISTANCE:
+                return distance;
+            case OptimizationMode::TIME:
+                return time;
+            case OptimizationMode::COST:
+                return cost;
+            case OptimizationMode::BALANCED: {
+                // Balanced optimization: normalize and combine all three weights
+                double distNorm = distance / 100.0;   // Normalize to approximately 0-1
+                double timeNorm = time / 5.0;         // Normalize to approximately 0-1
+                double costNorm = cost / 50.0;        // Normalize to approximately 0-1
+                return (distNorm + timeNorm + costNorm) / 3.0; // Equal weight to all three
+            }
+            default:
+                return distance;
+        }
+    }
+    
+    /**
+     * @brief Look up a mode by name ("distance", "time", "cost" or "balanced").
+     * @param name Mode name
+     * @param mode Receives the mode if the name is known
+     * @return false if the name is not a mode
+     */
+    static bool parseMode(std::string_view name, OptimizationMode& mode) {
+        if (name == "distance") {
+            mode = OptimizationMode::DISTANCE;
+        } else if (name == "time") {
+            mode = OptimizationMode::TIME;
+        } else if (name == "cost") {
+            mode = OptimizationMode::COST;
+        } else if (name == "balanced") {
+            mode = OptimizationMode::BALANCED;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Get the name parseMode() accepts for a mode.
+     */
+    static const char* modeName(OptimizationMode mode) {
+        switch (mode) {
+            case OptimizationMode::TIME: return "time";
+            case OptimizationMode::COST: return "cost";
+            case OptimizationMode::BALANCED: return "balanced";
+            case OptimizationMode::DISTANCE:
+            default: return "distance";
+        }
+    }
 
 private:
     struct NodeDistance {
@@ -88,8 +213,11 @@ private:
         }
     };
     
-    const Graph& graph_;
+    const GraphView& graph_;
+    util::StopCondition stop_;
+    SearchStats stats_;
     
+    PathResult searchPath(const Node::NodeId& source, const Node::NodeId& destination, OptimizationMode mode);
     double getEdgeWeight(EdgePtr edge, OptimizationMode mode) const;
     Path reconstructPath(const std::unordered_map<Node::NodeId, Node::NodeId>& predecessors,
                         const Node::NodeId& source, const Node::NodeId& destination) const;
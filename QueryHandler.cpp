@@ -0,0 +1,182 @@
+#include "QueryHandler.hpp"
+#include "../data/JsonHandler.hpp"
+#include "../data/JsonWriter.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace dijkstra {
+namespace server {
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+const nlohmann::json& requireArray(const nlohmann::json& request, const char* name) {
+    auto it = request.find(name);
+    if (it == request.end() || !it->is_array()) {
+        throw std::invalid_argument(std::string("Missing or invalid \"") + name + "\"");
+    }
+    return *it;
+}
+
+Index requireNode(const graph::CompactGraph& graph, const std::string& nodeId) {
+    Index node = graph.findNode(nodeId);
+    if (node == graph::CompactGraph::INVALID_INDEX) {
+        throw std::invalid_argument("Unknown node: " + nodeId);
+    }
+    return node;
+}
+
+/**
+ * @brief Resolve an array of node IDs; unknown IDs become INVALID_INDEX.
+ */
+std::vector<Index> findNodes(const graph::CompactGraph& graph, const nlohmann::json& nodeIds, const char* name) {
+    std::vector<Index> nodes;
+    nodes.reserve(nodeIds.size());
+    for (const auto& nodeId : nodeIds) {
+        if (!nodeId.is_string()) {
+            throw std::invalid_argument(std::string("\"") + name + "\" must hold node ID strings");
+        }
+        nodes.push_back(graph.findNode(nodeId.get_ref<const std::string&>()));
+    }
+    return nodes;
+}
+
+/**
+ * @brief Resolve route sources given as {"id": ..., "cost": ...} objects.
+ */
+std::vector<std::pair<Index, double>> findSources(const graph::CompactGraph& graph, const nlohmann::json& sources) {
+    std::vector<std::pair<Index, double>> nodes;
+    nodes.reserve(sources.size());
+    for (const auto& source : sources) {
+        auto cost = source.is_object() ? source.find("cost") : source.end();
+        if (!source.is_object() || cost == source.end() || !cost->is_number() || !(cost->get<double>() >= 0.0)) {
+            throw std::invalid_argument("\"sources\" must hold objects with an \"id\" and a non-negative \"cost\"");
+        }
+        nodes.emplace_back(requireNode(graph, RequestHandler::requireString(source, "id")), cost->get<double>());
+    }
+    return nodes;
+}
+
+} // namespace
+
+QueryHandler::QueryHandler(const graph::CompactGraph& graph) : finder_(graph) {
+}
+
+QueryHandler::Outcome QueryHandler::handle(std::string_view request, std::string& response, std::string_view type) {
+    // One clock read serves both the deadline and the latency metric
+    const bool timed = metrics_ || timeout_ > std::chrono::steady_clock::duration::zero();
+    const auto started = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    const graph::CompactGraph& graph = finder_.getGraph();
+    
+    // One deadline covers every search the request needs
+    util::StopCondition stop;
+    stop.setCancellationToken(token_);
+    if (timeout_ > std::chrono::steady_clock::duration::zero()) {
+        stop.setDeadline(started + timeout_);
+    }
+    finder_.setStopCondition(stop);
+    stats_ = graph::SearchStats();
+    
+    // Collect each search's statistics and give up once one was stopped
+    auto afterSearch = [this] {
+        stats_ += finder_.getLastStats();
+        if (finder_.getStopReason() != util::StopCondition::Reason::NONE) {
+            throw QueryStopped(finder_.getStopReason());
+        }
+    };
+    
+    return respond(request, response, type, started, stats_, metrics_,
+                   [&](const nlohmann::json& json, std::string_view requestType, data::JsonWriter& writer,
+                       RequestKind& kind) {
+        const OptimizationMode mode = parseMode(json);
+        kind.mode = mode;
+        
+        // A request may shorten its own deadline, as a shard coordinator does for its workers
+        auto timeoutMs = json.find("timeout_ms");
+        if (timeoutMs != json.end()) {
+            if (!timeoutMs->is_number() || !(timeoutMs->get<double>() >= 0.0)) {
+                throw std::invalid_argument("Invalid \"timeout_ms\"");
+            }
+            auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double, std::milli>(
+                                    std::min(timeoutMs->get<double>(), 1e12)));
+            if (timeout_ > std::chrono::steady_clock::duration::zero()) {
+                deadline = std::min(deadline, started + timeout_);
+            }
+            stop.setDeadline(deadline);
+            finder_.setStopCondition(stop);
+        }
+        kind.typed = requestType == "route" || requestType == "matrix" || requestType == "isochrone";
+        kind.type = requestType == "matrix" ? QueryMetrics::QueryType::MATRIX
+                  : requestType == "isochrone" ? QueryMetrics::QueryType::ISOCHRONE
+                                               : QueryMetrics::QueryType::ROUTE;
+        
+        if (requestType == "route" && json.contains("sources")) {
+            auto sources = findSources(graph, requireArray(json, "sources"));
+            Index to = requireNode(graph, requireString(json, "to"));
+            std::vector<Index> nodes;
+            auto result = finder_.findShortestPath(sources, to, mode, nodes);
+            afterSearch();
+            graph::PathResult::Path path;
+            path.reserve(nodes.size());
+            for (Index node : nodes) {
+                path.emplace_back(graph.getNodeId(node));
+            }
+            result.setPath(path);
+            writer.key("result");
+            data::JsonHandler::writePathResult(writer, result);
+        } else if (requestType == "route") {
+            Index from = requireNode(graph, requireString(json, "from"));
+            Index to = requireNode(graph, requireString(json, "to"));
+            auto result = finder_.findShortestPath(from, to, mode);
+            afterSearch();
+            writer.key("result");
+            data::JsonHandler::writePathResult(writer, result);
+        } else if (requestType == "matrix") {
+            auto sources = findNodes(graph, requireArray(json, "sources"), "sources");
+            auto targets = findNodes(graph, requireArray(json, "targets"), "targets");
+            if (!sources.empty() && targets.size() > MAX_MATRIX_CELLS / sources.size()) {
+                throw std::invalid_argument("Matrix too large");
+            }
+            std::vector<std::vector<double>> costs;
+            costs.reserve(sources.size());
+            for (Index source : sources) {
+                costs.push_back(finder_.findCosts(source, targets, mode));
+                afterSearch();
+            }
+            writer.key("result").beginObject().key("costs").beginArray();
+            for (const auto& row : costs) {
+                writer.beginArray();
+                for (double cost : row) {
+                    writer.value(cost);
+                }
+                writer.endArray();
+            }
+            writer.endArray().endObject();
+        } else if (requestType == "isochrone") {
+            Index from = requireNode(graph, requireString(json, "from"));
+            auto limit = json.find("limit");
+            if (limit == json.end() || !limit->is_number() || !(limit->get<double>() >= 0.0)) {
+                throw std::invalid_argument("Missing or invalid \"limit\"");
+            }
+            auto reached = finder_.findWithin(from, limit->get<double>(), mode);
+            afterSearch();
+            writer.key("result").beginObject().key("nodes").beginArray();
+            for (const auto& [node, cost] : reached) {
+                writer.beginObject().member("id", graph.getNodeId(node)).member("cost", cost).endObject();
+            }
+            writer.endArray().endObject();
+        } else {
+            throw std::invalid_argument("Unknown request type (expected route, matrix or isochrone)");
+        }
+    });
+}
+
+} // namespace server
+} // namespace dijkstra
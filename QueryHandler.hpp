@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "../graph/CompactGraph.hpp"
+#include "../graph/CompactPathFinder.hpp"
+#include "../graph/ComponentIndex.hpp"
+#include "../util/Cancellation.hpp"
+#include "QueryMetrics.hpp"
+#include "RequestHandler.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class QueryHandler
+ * @brief Answers JSON query requests against a CompactGraph.
+ * 
+ * A request is a JSON object with a "type" and an optional "id" that is
+ * echoed in the response, plus an optional "mode" ("distance", "time",
+ * "cost" or "balanced"; default "distance"):
+ * 
+ * - `route`: "from" and "to" node IDs. The result is a path result as written
+ *   by JsonHandler::writePathResult. Instead of "from", "sources" may list
+ *   several `{"id": ..., "cost": ...}` starting points with non-negative
+ *   initial costs; the path then starts at the one giving the lowest total.
+ * - `matrix`: "sources" and "targets" arrays of node IDs. The result is
+ *   `{"costs": [[...], ...]}` with one row per source; unknown or unreachable
+ *   targets are null.
+ * - `isochrone`: "from" and a non-negative "limit". The result is
+ *   `{"nodes": [{"id": ..., "cost": ...}, ...]}` in increasing order of cost.
+ * 
+ * A response is `{"id": ..., "result": ...}` or `{"id": ..., "error": "..."}`.
+ * If the request has `"stats": true`, the response also carries the search
+ * statistics of the request as `"stats": {...}`.
+ * A request that runs past its timeout, or whose cancellation token is
+ * raised, is answered with an error rather than a partial result. An optional
+ * "timeout_ms" shortens the timeout for that request.
+ * With a metrics shard, every request's latency is recorded under its type
+ * and mode.
+ * Each handler owns its search workspace, so it must be used by one thread
+ * at a time; give every worker its own.
+ */
+class QueryHandler : public RequestHandler {
+public:
+    static constexpr size_t MAX_MATRIX_CELLS = 1 << 20; ///< Largest sources x targets product
+    
+    /**
+     * @brief Constructs a handler for a graph.
+     * @param graph Graph to query (shared, not copied)
+     */
+    explicit QueryHandler(const graph::CompactGraph& graph);
+    
+    /**
+     * @brief Use component labels to reject unreachable queries without searching.
+     * @param components Component index of the same graph
+     */
+    void setComponentIndex(const graph::ComponentIndex& components) { finder_.setComponentIndex(components); }
+    
+    /**
+     * @brief Limit the search time spent on one request.
+     * @param timeout Time allowed per request (zero for no limit)
+     */
+    void setTimeout(std::chrono::steady_clock::duration timeout) override { timeout_ = timeout; }
+    
+    /**
+     * @brief Abandon requests in progress once a token is cancelled.
+     * @param token Token that outlives the handler (nullptr for none)
+     */
+    void setCancellationToken(const util::CancellationToken* token) override { token_ = token; }
+    
+    /**
+     * @brief Record every request into a metrics shard.
+     * @param metrics Shard owned by the thread using this handler (nullptr for none)
+     */
+    void setMetrics(QueryMetrics::Shard* metrics) override { metrics_ = metrics; }
+    
+    /**
+     * @brief Answer one request.
+     * @param request JSON request text
+     * @param response Receives the JSON response
+     * @param type Type to assume when the request has no "type" member
+     * @return Whether the response carries a result or an error, and why
+     */
+    Outcome handle(std::string_view request, std::string& response, std::string_view type = {}) override;
+    
+    /**
+     * @brief Get the search statistics of the last request, summed over its searches.
+     */
+    const graph::SearchStats& getLastStats() const override { return stats_; }
+
+private:
+    graph::CompactPathFinder finder_;
+    std::chrono::steady_clock::duration timeout_ = std::chrono::steady_clock::duration::zero();
+    const util::CancellationToken* token_ = nullptr;
+    QueryMetrics::Shard* metrics_ = nullptr;
+    graph::SearchStats stats_;
+};
+
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,157 @@
+#include "QueryMetrics.hpp"
+#include <ostream>
+#include <string>
+
+namespace dijkstra {
+namespace server {
+
+namespace {
+
+struct Quantile {
+    double quantile;
+    const char* label;  ///< Prometheus quantile label
+    const char* key;    ///< JSON key
+};
+
+constexpr Quantile QUANTILES[] = {{0.5, "0.5", "p50"}, {0.99, "0.99", "p99"}, {0.999, "0.999", "p999"}};
+
+/**
+ * @brief Write nanoseconds as seconds with round-trip precision.
+ */
+void writeSeconds(std::ostream& out, uint64_t nanoseconds) {
+    char digits[32];
+    const char* end = data::JsonWriter::formatDouble(digits, static_cast<double>(nanoseconds) / 1e9);
+    out.write(digits, end - digits);
+}
+
+} // namespace
+
+const char* QueryMetrics::typeName(QueryType type) {
+    switch (type) {
+        case QueryType::MATRIX: return "matrix";
+        case QueryType::ISOCHRONE: return "isochrone";
+        case QueryType::ROUTE:
+        default: return "route";
+    }
+}
+
+QueryMetrics::Shard& QueryMetrics::addShard() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.push_back(std::make_unique<Shard>());
+    return *shards_.back();
+}
+
+void QueryMetrics::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.clear();
+}
+
+std::vector<QueryMetrics::SeriesTotals> QueryMetrics::merge(uint64_t& rejected) const {
+    std::vector<SeriesTotals> totals(TYPE_COUNT * MODE_COUNT);
+    rejected = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < totals.size(); ++i) {
+            const Shard::Series& series = shard->series_[i];
+            if (series.latency.getCount() == 0) {
+                continue;
+            }
+            totals[i].latency += series.latency.snapshot();
+            totals[i].queries += series.queries.get();
+            totals[i].failed += series.failed.get();
+            totals[i].timedOut += series.timedOut.get();
+            totals[i].nodesSettled += series.nodesSettled.get();
+        }
+        rejected += shard->rejected_.get();
+    }
+    return totals;
+}
+
+void QueryMetrics::writePrometheus(std::ostream& out) const {
+    uint64_t rejected = 0;
+    const auto totals = merge(rejected);
+    
+    // Writes one sample per series that saw queries
+    auto writeFamily = [&](const char* name, const char* type, const char* help, auto sample) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+        for (size_t i = 0; i < totals.size(); ++i) {
+            if (totals[i].queries == 0) {
+                continue;
+            }
+            const std::string labels = std::string("type=\"") + typeName(static_cast<QueryType>(i / MODE_COUNT)) +
+                                       "\",mode=\"" +
+                                       graph::PathFinder::modeName(static_cast<OptimizationMode>(i % MODE_COUNT)) +
+                                       "\"";
+            sample(labels, totals[i]);
+        }
+    };
+    
+    writeFamily("dijkstra_queries_total", "counter", "Queries answered or failed.",
+                [&](const std::string& labels, const SeriesTotals& series) {
+                    out << "dijkstra_queries_total{" << labels << "} " << series.queries << '\n';
+                });
+    writeFamily("dijkstra_query_failures_total", "counter", "Queries answered with an error.",
+                [&](const std::string& labels, const SeriesTotals& series) {
+                    out << "dijkstra_query_failures_total{" << labels << "} " << series.failed << '\n';
+                });
+    writeFamily("dijkstra_query_timeouts_total", "counter", "Queries stopped by their timeout or by shutdown.",
+                [&](const std::string& labels, const SeriesTotals& series) {
+                    out << "dijkstra_query_timeouts_total{" << labels << "} " << series.timedOut << '\n';
+                });
+    writeFamily("dijkstra_nodes_settled_total", "counter", "Nodes settled by the searches of queries.",
+                [&](const std::string& labels, const SeriesTotals& series) {
+                    out << "dijkstra_nodes_settled_total{" << labels << "} " << series.nodesSettled << '\n';
+                });
+    writeFamily("dijkstra_query_duration_seconds", "summary", "Time taken to answer a query.",
+                [&](const std::string& labels, const SeriesTotals& series) {
+                    for (const Quantile& quantile : QUANTILES) {
+                        out << "dijkstra_query_duration_seconds{" << labels << ",quantile=\"" << quantile.label
+                            << "\"} ";
+                        writeSeconds(out, series.latency.valueAt(quantile.quantile));
+                        out << '\n';
+                    }
+                    out << "dijkstra_query_duration_seconds_sum{" << labels << "} ";
+                    writeSeconds(out, series.latency.sum);
+                    out << '\n';
+                    out << "dijkstra_query_duration_seconds_count{" << labels << "} " << series.latency.count
+                        << '\n';
+                });
+    
+    out << "# HELP dijkstra_requests_rejected_total Requests without a valid type or mode.\n"
+        << "# TYPE dijkstra_requests_rejected_total counter\n"
+        << "dijkstra_requests_rejected_total " << rejected << '\n';
+}
+
+void QueryMetrics::writeJson(data::JsonWriter& writer) const {
+    uint64_t rejected = 0;
+    const auto totals = merge(rejected);
+    
+    writer.beginObject().key("queries").beginArray();
+    for (size_t i = 0; i < totals.size(); ++i) {
+        const SeriesTotals& series = totals[i];
+        if (series.queries == 0) {
+            continue;
+        }
+        writer.beginObject();
+        writer.member("count", series.queries);
+        writer.member("failed", series.failed);
+        writer.key("latency_ns").beginObject();
+        writer.member("max", series.latency.max);
+        writer.member("mean", series.latency.mean());
+        for (const Quantile& quantile : QUANTILES) {
+            writer.member(quantile.key, series.latency.valueAt(quantile.quantile));
+        }
+        writer.endObject();
+        writer.member("mode", graph::PathFinder::modeName(static_cast<OptimizationMode>(i % MODE_COUNT)));
+        writer.member("nodes_settled", series.nodesSettled);
+        writer.member("timed_out", series.timedOut);
+        writer.member("type", typeName(static_cast<QueryType>(i / MODE_COUNT)));
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.member("rejected", rejected);
+    writer.endObject();
+}
+
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../data/JsonWriter.hpp"
+#include "../graph/PathFinder.hpp"
+#include "../util/Metrics.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class QueryMetrics
+ * @brief Per-thread query latency histograms and counters, merged when read.
+ * 
+ * Every worker thread takes its own Shard and records each query into it with
+ * plain loads and stores, so recording never contends with other workers or
+ * with a concurrent scrape. A query is filed under its type and optimization
+ * mode; each such series has a latency histogram and counts of queries,
+ * failures, timeouts and settled nodes. Requests too malformed to have a type
+ * are only counted as rejected.
+ * 
+ * Reading (writePrometheus(), writeJson()) sums the shards; a query recorded
+ * during the read may be partly included.
+ */
+class QueryMetrics {
+public:
+    using OptimizationMode = graph::PathFinder::OptimizationMode;
+    
+    enum class QueryType {
+        ROUTE,
+        MATRIX,
+        ISOCHRONE
+    };
+    
+    enum class Result {
+        ANSWERED,  ///< Answered, whether or not a path exists
+        FAILED,    ///< Invalid request, unknown node or similar
+        TIMED_OUT  ///< Stopped by the query timeout or by cancellation
+    };
+    
+    static constexpr size_t TYPE_COUNT = 3;
+    static constexpr size_t MODE_COUNT = 4;
+    
+    /**
+     * @class Shard
+     * @brief The metrics of one thread; only that thread may record into it.
+     */
+    class Shard {
+    public:
+        /**
+         * @brief Record one query.
+         * @param nanoseconds Time taken to answer it
+         * @param nodesSettled Nodes its searches settled
+         */
+        void record(QueryType type, OptimizationMode mode, Result result, uint64_t nanoseconds,
+                    uint64_t nodesSettled) {
+            Series& series = series_[static_cast<size_t>(type) * MODE_COUNT + static_cast<size_t>(mode)];
+            series.latency.record(nanoseconds);
+            series.queries.add();
+            if (result == Result::FAILED) {
+                series.failed.add();
+            } else if (result == Result::TIMED_OUT) {
+                series.timedOut.add();
+            }
+            series.nodesSettled.add(nodesSettled);
+        }
+        
+        /**
+         * @brief Count a request whose type or mode could not be determined.
+         */
+        void recordRejected() { rejected_.add(); }
+    
+    private:
+        friend class QueryMetrics;
+        
+        struct Series {
+            util::LatencyHistogram latency;
+            util::Counter queries;
+            util::Counter failed;
+            util::Counter timedOut;
+            util::Counter nodesSettled;
+        };
+        
+        std::array<Series, TYPE_COUNT * MODE_COUNT> series_;
+        util::Counter rejected_;
+    };
+    
+    static const char* typeName(QueryType type);
+    
+    /**
+     * @brief Create a shard for the calling thread.
+     * @return Shard that lives as long as this object
+     */
+    Shard& addShard();
+    
+    /**
+     * @brief Forget all shards; only call while no thread records.
+     */
+    void clear();
+    
+    /**
+     * @brief Write the metrics in the Prometheus text exposition format.
+     * 
+     * Latency is a summary (`dijkstra_query_duration_seconds`) with the 0.5,
+     * 0.99 and 0.999 quantiles, labelled by type and mode like the counters.
+     * Series without queries are left out.
+     */
+    void writePrometheus(std::ostream& out) const;
+    
+    /**
+     * @brief Write the metrics as a JSON object.
+     * 
+     * `{"queries":[{"count":...,"failed":...,"latency_ns":{"max":...,"mean":...,
+     * "p50":...,"p99":...,"p999":...},"mode":...,"nodes_settled":...,"timed_out":...,
+     * "type":...}, ...],"rejected":...}` with one entry per series that saw queries.
+     */
+    void writeJson(data::JsonWriter& writer) const;
+
+private:
+    struct SeriesTotals {
+        util::HistogramSnapshot latency;
+        uint64_t queries = 0;
+        uint64_t failed = 0;
+        uint64_t timedOut = 0;
+        uint64_t nodesSettled = 0;
+    };
+    
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    
+    /**
+     * @brief Sum the shards; sets rejected to the rejected request count.
+     */
+    std::vector<SeriesTotals> merge(uint64_t& rejected) const;
+};
+
+} // namespace server
+} // namespace dijkstra
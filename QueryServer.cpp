@@ -0,0 +1,730 @@
+#include "QueryServer.hpp"
+#include "QueryHandler.hpp"
+#include "../data/JsonHandler.hpp"
+#include "../data/JsonWriter.hpp"
+#include "../util/Parallel.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dijkstra {
+namespace server {
+
+namespace {
+
+// epoll tags; connection IDs start above them
+constexpr uint64_t WAKE_TAG = 0;
+constexpr uint64_t UNIX_TAG = 1;
+constexpr uint64_t HTTP_TAG = 2;
+constexpr uint64_t FIRST_CONNECTION = 16;
+
+constexpr size_t READ_CHUNK = 1 << 16;
+
+constexpr const char* PROMETHEUS_CONTENT_TYPE = "text/plain; version=0.0.4";
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Error";
+    }
+}
+
+std::string httpResponse(int status, std::string_view body, bool keepAlive,
+                         std::string_view contentType = "application/json") {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + statusText(status) +
+                            "\r\nContent-Type: " + std::string(contentType) + "\r\nContent-Length: " +
+                            std::to_string(body.size()) +
+                            (keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    response.append(body.data(), body.size());
+    return response;
+}
+
+std::string errorBody(std::string_view message) {
+    return "{\"error\":\"" + std::string(message) + "\"}";
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
+/**
+ * @brief State of one client connection, owned by the event loop thread.
+ */
+struct QueryServer::Connection {
+    uint64_t id = 0;
+    int fd = -1;
+    bool http = false;
+    uint32_t events = 0;            ///< Events currently registered with epoll
+    
+    std::string input;              ///< Received bytes not yet framed into requests
+    std::string output;             ///< Response bytes not yet written
+    size_t outputOffset = 0;
+    
+    uint64_t nextSequence = 0;      ///< Sequence number of the next request
+    uint64_t nextReply = 0;         ///< Sequence number of the next response to write
+    std::map<uint64_t, std::pair<std::string, bool>> ready; ///< Finished responses (and close flags) by sequence
+    
+    bool readClosed = false;        ///< Peer finished sending, or nothing more will be read
+    bool closeAfterWrite = false;   ///< Close once the output is written
+    
+    size_t pending() const { return nextSequence - nextReply; }
+    bool hasOutput() const { return outputOffset < output.size(); }
+};
+
+QueryServer::QueryServer(const graph::CompactGraph& graph, unsigned threads)
+    : QueryServer(HandlerFactory(), threads) {
+    served_ = std::make_shared<const ServedGraph>(ServedGraph{graph, graph::ComponentIndex(), 1});
+}
+
+QueryServer::QueryServer(HandlerFactory factory, unsigned threads)
+    : served_(std::make_shared<const ServedGraph>(ServedGraph{graph::CompactGraph(), graph::ComponentIndex(), 1}))
+    , handlerFactory_(std::move(factory))
+    , threads_(util::resolveThreadCount(threads))
+    , nextConnection_(FIRST_CONNECTION) {
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        std::string message = systemError("Failed to create the server event loop");
+        if (epollFd_ >= 0) {
+            ::close(epollFd_);
+        }
+        if (wakeFd_ >= 0) {
+            ::close(wakeFd_);
+        }
+        throw std::runtime_error(message);
+    }
+    
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event);
+}
+
+QueryServer::~QueryServer() {
+    for (auto& entry : connections_) {
+        ::close(entry.second->fd);
+    }
+    if (unixFd_ >= 0) {
+        ::close(unixFd_);
+        ::unlink(unixPath_.c_str());
+    }
+    if (httpFd_ >= 0) {
+        ::close(httpFd_);
+    }
+    ::close(wakeFd_);
+    ::close(epollFd_);
+}
+
+void QueryServer::listenUnix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    
+    struct stat status;
+    if (::lstat(path.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            throw std::runtime_error("Refusing to replace non-socket file: " + path);
+        }
+        ::unlink(path.c_str());
+    }
+    
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        std::string message = systemError("Failed to listen on " + path);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error(message);
+    }
+    
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = UNIX_TAG;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+    unixFd_ = fd;
+    unixPath_ = path;
+}
+
+uint16_t QueryServer::listenHttp(uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    socklen_t length = sizeof(address);
+    if (fd < 0 || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::string message = systemError("Failed to listen on 127.0.0.1:" + std::to_string(port));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error(message);
+    }
+    
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = HTTP_TAG;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event);
+    httpFd_ = fd;
+    return ntohs(address.sin_port);
+}
+
+void QueryServer::setComponentIndex(const graph::ComponentIndex& components) {
+    std::lock_guard<std::mutex> lock(replaceMutex_);
+    auto served = std::atomic_load(&served_);
+    std::atomic_store(&served_, std::make_shared<const ServedGraph>(
+                                    ServedGraph{served->graph, components, served->version}));
+}
+
+uint64_t QueryServer::replaceGraph(const graph::CompactGraph& graph, const graph::ComponentIndex& components) {
+    uint64_t version;
+    {
+        std::lock_guard<std::mutex> lock(replaceMutex_);
+        version = std::atomic_load(&served_)->version + 1;
+        std::atomic_store(&served_, std::make_shared<const ServedGraph>(ServedGraph{graph, components, version}));
+    }
+    
+    // Wake idle workers so they drop their handlers for the old graph
+    std::lock_guard<std::mutex> lock(jobMutex_);
+    jobReady_.notify_all();
+    return version;
+}
+
+graph::SearchStats QueryServer::getSearchStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return searchStats_;
+}
+
+std::string QueryServer::statsBody() const {
+    std::ostringstream out;
+    {
+        data::JsonWriter writer(out);
+        writer.beginObject();
+        writer.member("requests", getRequestsServed());
+        writer.member("graph_version", getGraphVersion());
+        writer.key("search");
+        data::JsonHandler::writeSearchStats(writer, getSearchStats());
+        writer.endObject();
+    }
+    return out.str();
+}
+
+void QueryServer::stop() {
+    stopping_.store(true);
+    cancel_.cancel();
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+void QueryServer::run() {
+    if (unixFd_ < 0 && httpFd_ < 0) {
+        throw std::runtime_error("QueryServer::run called before listenUnix or listenHttp");
+    }
+    
+    workersDone_ = false;
+    cancel_.reset();
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads_; ++i) {
+        workers.emplace_back(&QueryServer::workerLoop, this);
+    }
+    
+    std::string failure;
+    epoll_event events[64];
+    while (!stopping_.load()) {
+        int count = epoll_wait(epollFd_, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failure = systemError("Server event loop failed");
+            break;
+        }
+        
+        for (int i = 0; i < count; ++i) {
+            const uint64_t tag = events[i].data.u64;
+            if (tag == WAKE_TAG) {
+                uint64_t value;
+                while (::read(wakeFd_, &value, sizeof(value)) > 0) {
+                }
+                deliverReplies();
+            } else if (tag == UNIX_TAG) {
+                accept(unixFd_, false);
+            } else if (tag == HTTP_TAG) {
+                accept(httpFd_, true);
+            } else {
+                auto it = connections_.find(tag);
+                if (it == connections_.end()) {
+                    continue; // Closed earlier in this batch
+                }
+                Connection& connection = *it->second;
+                if (events[i].events & EPOLLERR) {
+                    closeConnection(tag);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !writeTo(connection)) {
+                    continue;
+                }
+                if (!connection.readClosed && (events[i].events & (EPOLLIN | EPOLLHUP))) {
+                    readFrom(connection);
+                } else if (events[i].events & EPOLLHUP) {
+                    closeConnection(tag);
+                }
+            }
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        workersDone_ = true;
+        jobs_.clear();
+    }
+    jobReady_.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    replies_.clear();
+    while (!connections_.empty()) {
+        closeConnection(connections_.begin()->first);
+    }
+    
+    if (!failure.empty()) {
+        throw std::runtime_error(failure);
+    }
+}
+
+void QueryServer::workerLoop() {
+    QueryMetrics::Shard& metrics = metrics_.addShard();
+    
+    // The handler's graph copy keeps its ServedGraph alive; it is rebuilt when
+    // the served graph is replaced, and dropped while idle on a replaced graph
+    std::shared_ptr<const ServedGraph> served;
+    std::unique_ptr<RequestHandler> handler;
+    auto isStale = [this, &served] { return served && served != std::atomic_load(&served_); };
+    auto configure = [this, &metrics](RequestHandler& configured) {
+        configured.setTimeout(queryTimeout_);
+        configured.setCancellationToken(&cancel_);
+        configured.setMetrics(&metrics);
+    };
+    
+    std::string response;
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex_);
+            while (!workersDone_ && jobs_.empty()) {
+                if (isStale()) {
+                    handler.reset();
+                    served.reset();
+                }
+                jobReady_.wait(lock, [&] { return workersDone_ || !jobs_.empty() || isStale(); });
+            }
+            if (workersDone_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        
+        if (handlerFactory_) {
+            if (!handler) {
+                handler = handlerFactory_();
+                configure(*handler);
+            }
+        } else {
+            // Pin the graph that is current now for the whole request
+            std::shared_ptr<const ServedGraph> latest = std::atomic_load(&served_);
+            if (latest != served) {
+                handler.reset();
+                served = std::move(latest);
+                auto graphHandler = std::make_unique<QueryHandler>(served->graph);
+                if (!served->components.isEmpty()) {
+                    graphHandler->setComponentIndex(served->components);
+                }
+                configure(*graphHandler);
+                handler = std::move(graphHandler);
+            }
+        }
+        
+        RequestHandler::Outcome outcome = handler->handle(job.request, response, job.type);
+        Reply reply{job.connection, job.sequence, std::string(), !job.keepAlive};
+        if (job.http) {
+            int status = outcome == RequestHandler::Outcome::ANSWERED ? 200
+                       : outcome == RequestHandler::Outcome::REJECTED ? 400 : 503;
+            reply.bytes = httpResponse(status, response, job.keepAlive);
+        } else {
+            reply.bytes = response;
+            reply.bytes.push_back('\n');
+        }
+        requestsServed_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            searchStats_ += handler->getLastStats();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(replyMutex_);
+            replies_.push_back(std::move(reply));
+        }
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void QueryServer::accept(int listenFd, bool http) {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN, or out of descriptors until a connection closes
+        }
+        if (http) {
+            int noDelay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        }
+        
+        auto connection = std::make_unique<Connection>();
+        connection->id = nextConnection_++;
+        connection->fd = fd;
+        connection->http = http;
+        connection->events = EPOLLIN;
+        
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = connection->id;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.emplace(connection->id, std::move(connection));
+    }
+}
+
+void QueryServer::readFrom(Connection& connection) {
+    char buffer[READ_CHUNK];
+    ssize_t count = ::read(connection.fd, buffer, sizeof(buffer));
+    if (count < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            closeConnection(connection.id);
+        }
+        return;
+    }
+    if (count == 0) {
+        connection.readClosed = true;
+    } else {
+        connection.input.append(buffer, static_cast<size_t>(count));
+    }
+    service(connection);
+}
+
+void QueryServer::service(Connection& connection) {
+    if (!connection.closeAfterWrite) {
+        if (connection.http) {
+            parseHttp(connection);
+        } else {
+            parseLines(connection);
+        }
+    }
+    
+    // Move finished responses to the output in request order
+    for (auto it = connection.ready.begin();
+         it != connection.ready.end() && it->first == connection.nextReply;
+         it = connection.ready.erase(it)) {
+        connection.output += it->second.first;
+        ++connection.nextReply;
+        if (it->second.second) {
+            connection.closeAfterWrite = true;
+            connection.readClosed = true;
+            connection.input.clear();
+        }
+    }
+    
+    if (!writeTo(connection)) {
+        return;
+    }
+    if (connection.pending() == 0 && !connection.hasOutput() && connection.readClosed) {
+        closeConnection(connection.id);
+        return;
+    }
+    updateEvents(connection);
+}
+
+void QueryServer::parseLines(Connection& connection) {
+    size_t offset = 0;
+    while (connection.pending() < MAX_PIPELINE) {
+        size_t lineEnd = connection.input.find('\n', offset);
+        if (lineEnd == std::string::npos) {
+            break;
+        }
+        std::string_view line = trim(std::string_view(connection.input).substr(offset, lineEnd - offset));
+        offset = lineEnd + 1;
+        if (!line.empty()) {
+            submit(connection, {0, 0, std::string(line), std::string(), false, true});
+        }
+    }
+    connection.input.erase(0, offset);
+    
+    if (connection.input.size() > MAX_REQUEST_BYTES && connection.input.find('\n') == std::string::npos) {
+        respondNow(connection, errorBody("Request too long") + "\n", true);
+    }
+}
+
+void QueryServer::parseHttp(Connection& connection) {
+    size_t offset = 0;
+    while (connection.pending() < MAX_PIPELINE && !connection.closeAfterWrite) {
+        std::string_view input = std::string_view(connection.input).substr(offset);
+        size_t headerEnd = input.find("\r\n\r\n");
+        if (headerEnd == std::string_view::npos) {
+            if (input.size() > MAX_REQUEST_BYTES) {
+                respondNow(connection, httpResponse(413, errorBody("Request too long"), false), true);
+            }
+            break;
+        }
+        
+        // Request line
+        std::string_view head = input.substr(0, headerEnd + 2);
+        size_t lineEnd = head.find("\r\n");
+        std::string_view requestLine = head.substr(0, lineEnd);
+        size_t firstSpace = requestLine.find(' ');
+        size_t secondSpace = requestLine.rfind(' ');
+        if (firstSpace == std::string_view::npos || secondSpace == firstSpace) {
+            respondNow(connection, httpResponse(400, errorBody("Malformed request line"), false), true);
+            break;
+        }
+        std::string_view method = requestLine.substr(0, firstSpace);
+        std::string_view target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+        std::string_view version = requestLine.substr(secondSpace + 1);
+        target = target.substr(0, target.find('?'));
+        
+        // Headers
+        bool keepAlive = version != "HTTP/1.0";
+        bool chunked = false;
+        size_t contentLength = 0;
+        bool badLength = false;
+        for (size_t position = lineEnd + 2; position < head.size();) {
+            size_t end = head.find("\r\n", position);
+            std::string_view line = head.substr(position, end - position);
+            position = end + 2;
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            std::string_view name = trim(line.substr(0, colon));
+            std::string_view value = trim(line.substr(colon + 1));
+            if (equalsIgnoreCase(name, "content-length")) {
+                auto result = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+                badLength = result.ec != std::errc() || result.ptr != value.data() + value.size();
+            } else if (equalsIgnoreCase(name, "connection")) {
+                if (equalsIgnoreCase(value, "close")) {
+                    keepAlive = false;
+                } else if (equalsIgnoreCase(value, "keep-alive")) {
+                    keepAlive = true;
+                }
+            } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+                chunked = true;
+            }
+        }
+        if (chunked || badLength) {
+            respondNow(connection, httpResponse(411, errorBody("A valid Content-Length is required"), false), true);
+            break;
+        }
+        if (contentLength > MAX_REQUEST_BYTES) {
+            respondNow(connection, httpResponse(413, errorBody("Request too long"), false), true);
+            break;
+        }
+        
+        // Body
+        size_t bodyBegin = headerEnd + 4;
+        if (input.size() - bodyBegin < contentLength) {
+            break; // Wait for the rest
+        }
+        std::string_view body = input.substr(bodyBegin, contentLength);
+        offset += bodyBegin + contentLength;
+        
+        if (target == "/health") {
+            if (method != "GET") {
+                respondNow(connection, httpResponse(405, errorBody("Use GET"), keepAlive), !keepAlive);
+            } else {
+                respondNow(connection, httpResponse(200, "{\"status\":\"ok\"}", keepAlive), !keepAlive);
+            }
+        } else if (target == "/stats") {
+            if (method != "GET") {
+                respondNow(connection, httpResponse(405, errorBody("Use GET"), keepAlive), !keepAlive);
+            } else {
+                respondNow(connection, httpResponse(200, statsBody(), keepAlive), !keepAlive);
+            }
+        } else if (target == "/metrics") {
+            if (method != "GET") {
+                respondNow(connection, httpResponse(405, errorBody("Use GET"), keepAlive), !keepAlive);
+            } else {
+                std::ostringstream metrics;
+                metrics_.writePrometheus(metrics);
+                respondNow(connection, httpResponse(200, metrics.str(), keepAlive, PROMETHEUS_CONTENT_TYPE),
+                           !keepAlive);
+            }
+        } else if (target == "/" || target == "/route" || target == "/matrix" || target == "/isochrone") {
+            if (method != "POST") {
+                respondNow(connection, httpResponse(405, errorBody("Use POST"), keepAlive), !keepAlive);
+            } else {
+                submit(connection, {0, 0, std::string(body), std::string(target.substr(1)), true, keepAlive});
+            }
+        } else {
+            respondNow(connection, httpResponse(404, errorBody("Unknown path"), keepAlive), !keepAlive);
+        }
+        if (!keepAlive) {
+            // Nothing after this request will be answered
+            connection.readClosed = true;
+            offset = connection.input.size();
+            break;
+        }
+    }
+    connection.input.erase(0, offset);
+}
+
+void QueryServer::submit(Connection& connection, Job job) {
+    job.connection = connection.id;
+    job.sequence = connection.nextSequence++;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobReady_.notify_one();
+}
+
+void QueryServer::respondNow(Connection& connection, std::string bytes, bool close) {
+    connection.ready.emplace(connection.nextSequence++, std::make_pair(std::move(bytes), close));
+    if (close) {
+        connection.readClosed = true;
+        connection.input.clear();
+    }
+}
+
+void QueryServer::deliverReplies() {
+    std::vector<Reply> replies;
+    {
+        std::lock_guard<std::mutex> lock(replyMutex_);
+        replies.swap(replies_);
+    }
+    
+    std::unordered_set<uint64_t> touched;
+    for (auto& reply : replies) {
+        auto it = connections_.find(reply.connection);
+        if (it == connections_.end()) {
+            continue; // Connection closed while the request was being answered
+        }
+        it->second->ready.emplace(reply.sequence, std::make_pair(std::move(reply.bytes), reply.close));
+        touched.insert(reply.connection);
+    }
+    for (uint64_t id : touched) {
+        auto it = connections_.find(id);
+        if (it != connections_.end()) {
+            service(*it->second);
+        }
+    }
+}
+
+bool QueryServer::writeTo(Connection& connection) {
+    while (connection.hasOutput()) {
+        ssize_t count = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                               connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                updateEvents(connection);
+                return true;
+            }
+            closeConnection(connection.id);
+            return false;
+        }
+        connection.outputOffset += static_cast<size_t>(count);
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    
+    if (connection.closeAfterWrite && connection.pending() == 0) {
+        closeConnection(connection.id);
+        return false;
+    }
+    return true;
+}
+
+void QueryServer::updateEvents(Connection& connection) {
+    uint32_t events = 0;
+    if (!connection.readClosed && connection.pending() < MAX_PIPELINE) {
+        events |= EPOLLIN;
+    }
+    if (connection.hasOutput()) {
+        events |= EPOLLOUT;
+    }
+    if (events != connection.events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = connection.id;
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+}
+
+void QueryServer::closeConnection(uint64_t id) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) {
+        return;
+    }
+    ::close(it->second->fd); // Also removes it from the epoll set
+    connections_.erase(it);
+}
+
+} // namespace server
+} // namespace dijkstra
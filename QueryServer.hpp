@@ -0,0 +1,245 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../graph/CompactGraph.hpp"
+#include "../graph/ComponentIndex.hpp"
+#include "../graph/SearchStats.hpp"
+#include "../util/Cancellation.hpp"
+#include "QueryMetrics.hpp"
+#include "RequestHandler.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class QueryServer
+ * @brief Serves QueryHandler requests from a loaded graph over local sockets.
+ * 
+ * Two transports are offered:
+ * - a Unix-domain socket carrying JSON lines, one request per line and one
+ *   response line per request;
+ * - HTTP/1.1 on a loopback TCP port. The request body is POSTed to `/route`,
+ *   `/matrix` or `/isochrone` (which set the request type) or to `/`,
+ *   `GET /health` answers `{"status":"ok"}`, `GET /stats` answers the
+ *   request count and the search statistics summed over all requests, and
+ *   `GET /metrics` answers QueryMetrics in the Prometheus text format.
+ * 
+ * One thread runs an epoll loop that accepts connections, reads and frames
+ * requests and writes responses. A fixed pool of workers answers the requests,
+ * each with its own QueryHandler and therefore its own search workspace.
+ * Clients may pipeline: every request on a connection is handed to the pool as
+ * soon as it is complete, and responses are written back in request order.
+ * Reading from a connection pauses while MAX_PIPELINE of its requests are
+ * unanswered.
+ * 
+ * With a query timeout, a request whose searches run past it is answered with
+ * an error (HTTP 503), so one pathological query cannot hold a worker for
+ * long. stop() also abandons the searches in progress.
+ * 
+ * replaceGraph() switches to a new graph while serving. The served graph is
+ * held through a reference-counted pointer that is swapped atomically: each
+ * request pins the graph that is current when a worker picks it up, so
+ * requests already being answered finish on the old graph, which is freed
+ * once the last of them completes.
+ * 
+ * Instead of a graph, the server can be given a factory of RequestHandlers,
+ * e.g. to answer requests through a ShardCoordinator. Each worker then makes
+ * one handler when it starts and keeps it.
+ */
+class QueryServer {
+public:
+    static constexpr size_t MAX_REQUEST_BYTES = 1 << 20; ///< Longest request line or HTTP message
+    static constexpr size_t MAX_PIPELINE = 64;           ///< Unanswered requests per connection
+    
+    /**
+     * @brief Constructs a server for a graph; nothing listens until listenUnix()/listenHttp().
+     * @param graph Graph to serve (shared, not copied)
+     * @param threads Number of query workers (0 = one per hardware thread)
+     */
+    explicit QueryServer(const graph::CompactGraph& graph, unsigned threads = 0);
+    
+    /**
+     * @brief Creates the request handler of one worker.
+     */
+    using HandlerFactory = std::function<std::unique_ptr<RequestHandler>()>;
+    
+    /**
+     * @brief Constructs a server whose workers answer with handlers of their own.
+     * 
+     * setComponentIndex() and replaceGraph() have no effect on such a server.
+     * 
+     * @param factory Called once on each worker thread
+     * @param threads Number of query workers (0 = one per hardware thread)
+     */
+    QueryServer(HandlerFactory factory, unsigned threads = 0);
+    
+    /**
+     * @brief Closes the listening sockets and any remaining connections.
+     */
+    ~QueryServer();
+    
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+    
+    /**
+     * @brief Use component labels to reject unreachable queries without searching.
+     * @param components Component index of the served graph
+     */
+    void setComponentIndex(const graph::ComponentIndex& components);
+    
+    /**
+     * @brief Answer new requests from another graph.
+     * 
+     * Safe to call from any thread while run() is serving. Load and index the
+     * new graph before calling; the swap itself does not wait for requests.
+     * 
+     * @param graph Graph to serve from now on (shared, not copied)
+     * @param components Component index of that graph (empty for none)
+     * @return The version number of the new graph; the initial graph is version 1
+     */
+    uint64_t replaceGraph(const graph::CompactGraph& graph, const graph::ComponentIndex& components = {});
+    
+    /**
+     * @brief Get the version number of the graph new requests are answered from.
+     */
+    uint64_t getGraphVersion() const { return std::atomic_load(&served_)->version; }
+    
+    /**
+     * @brief Limit the search time spent on one request.
+     * @param timeout Time allowed per request (zero for no limit)
+     */
+    void setQueryTimeout(std::chrono::steady_clock::duration timeout) { queryTimeout_ = timeout; }
+    
+    /**
+     * @brief Accept JSON-lines connections on a Unix-domain socket.
+     * 
+     * A stale socket file at the path is replaced.
+     * 
+     * @param path Socket path
+     * @throws std::runtime_error if the socket cannot be bound
+     */
+    void listenUnix(const std::string& path);
+    
+    /**
+     * @brief Accept HTTP connections on 127.0.0.1.
+     * @param port TCP port (0 = any free port)
+     * @return The bound port
+     * @throws std::runtime_error if the socket cannot be bound
+     */
+    uint16_t listenHttp(uint16_t port);
+    
+    /**
+     * @brief Serve until stop() is called.
+     * @throws std::runtime_error if nothing is listening or the event loop fails
+     */
+    void run();
+    
+    /**
+     * @brief Make run() return. Safe to call from another thread or a signal handler.
+     */
+    void stop();
+    
+    unsigned getThreadCount() const { return threads_; }
+    uint64_t getRequestsServed() const { return requestsServed_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Get the search statistics summed over all requests served.
+     */
+    graph::SearchStats getSearchStats() const;
+    
+    /**
+     * @brief Get the latency histograms and counters of all requests served.
+     */
+    const QueryMetrics& getMetrics() const { return metrics_; }
+
+private:
+    struct Connection;
+    
+    /**
+     * @brief A graph being served; replaced as a whole, never modified.
+     */
+    struct ServedGraph {
+        graph::CompactGraph graph;
+        graph::ComponentIndex components;
+        uint64_t version;
+    };
+    
+    /**
+     * @brief A complete request waiting for a worker.
+     */
+    struct Job {
+        uint64_t connection;
+        uint64_t sequence;
+        std::string request;
+        std::string type;     ///< Type implied by the HTTP path, if any
+        bool http;
+        bool keepAlive;
+    };
+    
+    /**
+     * @brief A response ready to be written.
+     */
+    struct Reply {
+        uint64_t connection;
+        uint64_t sequence;
+        std::string bytes;
+        bool close;
+    };
+    
+    std::shared_ptr<const ServedGraph> served_; ///< Accessed only through std::atomic_load/atomic_store
+    std::mutex replaceMutex_;                    ///< Serializes replaceGraph() and setComponentIndex()
+    HandlerFactory handlerFactory_;              ///< Makes the workers' handlers instead of the graph, if set
+    unsigned threads_;
+    std::chrono::steady_clock::duration queryTimeout_ = std::chrono::steady_clock::duration::zero();
+    util::CancellationToken cancel_;
+    
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    int unixFd_ = -1;
+    int httpFd_ = -1;
+    std::string unixPath_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> requestsServed_{0};
+    mutable std::mutex statsMutex_;
+    graph::SearchStats searchStats_;
+    QueryMetrics metrics_;
+    
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections_;
+    uint64_t nextConnection_;
+    
+    std::mutex jobMutex_;
+    std::condition_variable jobReady_;
+    std::deque<Job> jobs_;
+    bool workersDone_ = false;
+    
+    std::mutex replyMutex_;
+    std::vector<Reply> replies_;
+    
+    void workerLoop();
+    void accept(int listenFd, bool http);
+    void readFrom(Connection& connection);
+    void service(Connection& connection);
+    void parseLines(Connection& connection);
+    void parseHttp(Connection& connection);
+    void submit(Connection& connection, Job job);
+    void respondNow(Connection& connection, std::string bytes, bool close);
+    void deliverReplies();
+    bool writeTo(Connection& connection);
+    void updateEvents(Connection& connection);
+    void closeConnection(uint64_t id);
+    std::string statsBody() const;
+};
+
+} // namespace server
+} // namespace dijkstra
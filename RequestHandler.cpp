@@ -0,0 +1,109 @@
+#include "RequestHandler.hpp"
+#include "../data/JsonHandler.hpp"
+#include <cstdint>
+#include <sstream>
+
+namespace dijkstra {
+namespace server {
+
+namespace {
+
+void writeId(data::JsonWriter& writer, const nlohmann::json& id) {
+    writer.key("id");
+    if (id.is_string()) {
+        writer.value(id.get_ref<const std::string&>());
+    } else if (id.is_number_unsigned()) {
+        writer.value(id.get<uint64_t>());
+    } else if (id.is_number_integer()) {
+        writer.value(id.get<int64_t>());
+    } else if (id.is_number()) {
+        writer.value(id.get<double>());
+    } else {
+        writer.null();
+    }
+}
+
+} // namespace
+
+RequestHandler::Outcome RequestHandler::respond(std::string_view request, std::string& response, std::string_view type,
+                                                std::chrono::steady_clock::time_point started,
+                                                const graph::SearchStats& stats, QueryMetrics::Shard* metrics,
+                                                const Answer& answer) {
+    const auto json = nlohmann::json::parse(request.begin(), request.end(), nullptr, false);
+    
+    std::ostringstream out;
+    Outcome outcome = Outcome::ANSWERED;
+    RequestKind kind;
+    {
+        data::JsonWriter writer(out);
+        writer.beginObject();
+        if (json.is_object() && json.contains("id")) {
+            writeId(writer, json["id"]);
+        }
+        
+        // Everything that can fail is checked before the result is written
+        try {
+            if (!json.is_object()) {
+                throw std::invalid_argument("Request is not a JSON object");
+            }
+            auto typeIt = json.find("type");
+            if (typeIt != json.end()) {
+                if (!typeIt->is_string()) {
+                    throw std::invalid_argument("Invalid \"type\"");
+                }
+                type = typeIt->get_ref<const std::string&>();
+            }
+            answer(json, type, writer, kind);
+        } catch (const QueryStopped& e) {
+            writer.member("error", e.what());
+            outcome = Outcome::STOPPED;
+        } catch (const std::exception& e) {
+            writer.member("error", e.what());
+            outcome = Outcome::REJECTED;
+        }
+        auto wantStats = json.is_object() ? json.find("stats") : json.end();
+        if (wantStats != json.end() && wantStats->is_boolean() && wantStats->get<bool>()) {
+            writer.key("stats");
+            data::JsonHandler::writeSearchStats(writer, stats);
+        }
+        writer.endObject();
+    }
+    
+    response = out.str();
+    
+    if (metrics) {
+        if (kind.typed) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started);
+            QueryMetrics::Result result = outcome == Outcome::ANSWERED ? QueryMetrics::Result::ANSWERED
+                                        : outcome == Outcome::REJECTED ? QueryMetrics::Result::FAILED
+                                                                       : QueryMetrics::Result::TIMED_OUT;
+            metrics->record(kind.type, kind.mode, result, static_cast<uint64_t>(elapsed.count()), stats.nodesSettled);
+        } else {
+            metrics->recordRejected();
+        }
+    }
+    return outcome;
+}
+
+RequestHandler::OptimizationMode RequestHandler::parseMode(const nlohmann::json& request) {
+    OptimizationMode mode = OptimizationMode::DISTANCE;
+    auto it = request.find("mode");
+    if (it == request.end()) {
+        return mode;
+    }
+    if (!it->is_string() || !graph::PathFinder::parseMode(it->get_ref<const std::string&>(), mode)) {
+        throw std::invalid_argument("Invalid mode (expected distance, time, cost or balanced)");
+    }
+    return mode;
+}
+
+const std::string& RequestHandler::requireString(const nlohmann::json& request, const char* name) {
+    auto it = request.find(name);
+    if (it == request.end() || !it->is_string()) {
+        throw std::invalid_argument(std::string("Missing or invalid \"") + name + "\"");
+    }
+    return it->get_ref<const std::string&>();
+}
+
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "../data/JsonWriter.hpp"
+#include "../graph/PathFinder.hpp"
+#include "../graph/SearchStats.hpp"
+#include "../util/Cancellation.hpp"
+#include "QueryMetrics.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class QueryStopped
+ * @brief Thrown while answering a request that its timeout or cancellation token stopped.
+ */
+class QueryStopped : public std::runtime_error {
+public:
+    explicit QueryStopped(util::StopCondition::Reason reason) : std::runtime_error(message(reason)) {}
+    
+    /**
+     * @brief Get the error a response carries when a request was stopped for a reason.
+     */
+    static const char* message(util::StopCondition::Reason reason) {
+        return reason == util::StopCondition::Reason::CANCELLED ? "Query cancelled" : "Query timed out";
+    }
+};
+
+/**
+ * @class RequestHandler
+ * @brief Answers JSON requests on behalf of a QueryServer worker.
+ * 
+ * QueryHandler answers them from a graph in memory; ShardCoordinator from
+ * shard worker processes. A handler owns its per-request state, such as a
+ * search workspace or connections, so it must be used by one thread at a time.
+ */
+class RequestHandler {
+public:
+    enum class Outcome {
+        ANSWERED, ///< The response carries a result
+        REJECTED, ///< The request was invalid; the response carries the error
+        STOPPED   ///< The timeout passed or the token was cancelled; the response carries the error
+    };
+    
+    using OptimizationMode = graph::PathFinder::OptimizationMode;
+    
+    virtual ~RequestHandler() = default;
+    
+    /**
+     * @brief Limit the time spent on one request.
+     * @param timeout Time allowed per request (zero for no limit)
+     */
+    virtual void setTimeout(std::chrono::steady_clock::duration timeout) = 0;
+    
+    /**
+     * @brief Abandon requests in progress once a token is cancelled.
+     * @param token Token that outlives the handler (nullptr for none)
+     */
+    virtual void setCancellationToken(const util::CancellationToken* token) = 0;
+    
+    /**
+     * @brief Record every request into a metrics shard.
+     * @param metrics Shard owned by the thread using this handler (nullptr for none)
+     */
+    virtual void setMetrics(QueryMetrics::Shard* metrics) = 0;
+    
+    /**
+     * @brief Answer one request.
+     * @param request JSON request text
+     * @param response Receives the JSON response
+     * @param type Type to assume when the request has no "type" member
+     * @return Whether the response carries a result or an error, and why
+     */
+    virtual Outcome handle(std::string_view request, std::string& response, std::string_view type = {}) = 0;
+    
+    /**
+     * @brief Get the search statistics of the last request, summed over its searches.
+     */
+    virtual const graph::SearchStats& getLastStats() const = 0;
+    
+    /**
+     * @brief Parse a request's "mode" member; distance if it has none.
+     * @throws std::invalid_argument if the mode is invalid
+     */
+    static OptimizationMode parseMode(const nlohmann::json& request);
+    
+    /**
+     * @brief Get a string member of a request.
+     * @throws std::invalid_argument if the member is missing or not a string
+     */
+    static const std::string& requireString(const nlohmann::json& request, const char* name);
+
+protected:
+    /**
+     * @brief What a request asks for, as far as it is understood, for the metrics.
+     */
+    struct RequestKind {
+        bool typed = false; ///< Whether type and mode are known; if not, the request counts as rejected
+        QueryMetrics::QueryType type = QueryMetrics::QueryType::ROUTE;
+        OptimizationMode mode = OptimizationMode::DISTANCE;
+    };
+    
+    /**
+     * @brief Answers a request object by writing its "result" member, or throws.
+     * 
+     * Receives the request, its type (the "type" member or the one assumed),
+     * the writer of the response, and the kind to fill in as it is understood.
+     * Throws QueryStopped if the request was stopped, and any other exception
+     * if it is invalid.
+     */
+    using Answer = std::function<void(const nlohmann::json&, std::string_view, data::JsonWriter&, RequestKind&)>;
+    
+    /**
+     * @brief Write the response to a request around the result written by `answer`.
+     * 
+     * The response echoes the request's "id", carries an "error" instead of
+     * the result if the request is not a JSON object or `answer` throws, and
+     * has the "stats" member if the request asks for it. The request is
+     * recorded in `metrics` with the time since `started`.
+     * 
+     * @param request JSON request text
+     * @param response Receives the JSON response
+     * @param type Type to assume when the request has no "type" member
+     * @param started When the request was received
+     * @param stats Statistics of the request's searches, read once `answer` returns
+     * @param metrics Metrics shard (nullptr for none)
+     * @param answer Writes the result
+     * @return Whether the response carries a result or an error, and why
+     */
+    static Outcome respond(std::string_view request, std::string& response, std::string_view type,
+                           std::chrono::steady_clock::time_point started, const graph::SearchStats& stats,
+                           QueryMetrics::Shard* metrics, const Answer& answer);
+};
+
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Set DIJKSTRA_SEARCH_STATS to 0 (CMake: -DENABLE_SEARCH_STATS=OFF) to compile
+ * the counting out of the search loops; SearchStats then stays all zero.
+ */
+#ifndef DIJKSTRA_SEARCH_STATS
+#define DIJKSTRA_SEARCH_STATS 1
+#endif
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @struct SearchStats
+ * @brief Work done by one search, or summed over many.
+ * 
+ * The heap counters follow the lazy-deletion heap the path finders use:
+ * a decrease-key pushes a second entry for the node, and popping the stale
+ * entry later counts as a pop but not as a settled node.
+ */
+struct SearchStats {
+    static constexpr bool ENABLED = DIJKSTRA_SEARCH_STATS != 0;
+    
+    uint64_t searches = 0;           ///< Number of searches counted
+    uint64_t nodesSettled = 0;       ///< Nodes whose distance became final
+    uint64_t edgesRelaxed = 0;       ///< Edges examined from settled nodes
+    uint64_t heapPushes = 0;         ///< Queue insertions, including decrease-keys
+    uint64_t heapPops = 0;           ///< Queue removals, including stale entries
+    uint64_t decreaseKeys = 0;       ///< Relaxations that improved an already reached node
+    uint64_t peakHeapSize = 0;       ///< Largest queue size (maximum over searches)
+    uint64_t elapsedNanoseconds = 0; ///< Wall time spent searching
+    const char* algorithm = "";      ///< Algorithm name; "mixed" if summed over different ones
+    
+    /**
+     * @brief Start counting a search.
+     * @param name Algorithm name (a string literal)
+     */
+    void begin(const char* name) {
+        if constexpr (ENABLED) {
+            *this = SearchStats();
+            searches = 1;
+            algorithm = name;
+            started_ = std::chrono::steady_clock::now();
+        }
+    }
+    
+    /**
+     * @class Scope
+     * @brief Calls end() when it goes out of scope, so every return path of a query stops the clock.
+     */
+    class Scope {
+    public:
+        explicit Scope(SearchStats& stats) : stats_(stats) {}
+        ~Scope() { stats_.end(); }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    
+    private:
+        SearchStats& stats_;
+    };
+    
+    /**
+     * @brief Stop the wall clock; a later call measures again from begin().
+     */
+    void end() {
+        if constexpr (ENABLED) {
+            elapsedNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started_).count());
+        }
+    }
+    
+    void countSettled() {
+        if constexpr (ENABLED) {
+            ++nodesSettled;
+        }
+    }
+    
+    void countRelaxed() {
+        if constexpr (ENABLED) {
+            ++edgesRelaxed;
+        }
+    }
+    
+    void countDecreaseKey() {
+        if constexpr (ENABLED) {
+            ++decreaseKeys;
+        }
+    }
+    
+    /**
+     * @param heapSize Queue size after the push
+     */
+    void countPush(size_t heapSize) {
+        if constexpr (ENABLED) {
+            ++heapPushes;
+            peakHeapSize = std::max<uint64_t>(peakHeapSize, heapSize);
+        }
+    }
+    
+    void countPop() {
+        if constexpr (ENABLED) {
+            ++heapPops;
+        }
+    }
+    
+    /**
+     * @brief Add another search (or sum of searches) to this one.
+     */
+    SearchStats& operator+=(const SearchStats& other) {
+        if (other.searches == 0) {
+            return *this;
+        }
+        if (searches == 0) {
+            algorithm = other.algorithm;
+        } else if (std::strcmp(algorithm, other.algorithm) != 0) {
+            algorithm = "mixed";
+        }
+        searches += other.searches;
+        nodesSettled += other.nodesSettled;
+        edgesRelaxed += other.edgesRelaxed;
+        heapPushes += other.heapPushes;
+        heapPops += other.heapPops;
+        decreaseKeys += other.decreaseKeys;
+        peakHeapSize = std::max(peakHeapSize, other.peakHeapSize);
+        elapsedNanoseconds += other.elapsedNanoseconds;
+        return *this;
+    }
+
+private:
+    std::chrono::steady_clock::time_point started_;
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+#include "CompactGraph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class SearchWorkspace
+ * @brief The labels and heap of a Dijkstra search over dense node indices, reused across searches.
+ * 
+ * Each node's distance and parent are valid only if the node was reached in
+ * the current search. clear() invalidates them all at once by starting a new
+ * generation stamp, so a search costs time in proportion to the nodes it
+ * reaches, not to the size of the graph.
+ * 
+ * @tparam Parent How a node was reached, e.g. the edge used
+ */
+template <typename Parent>
+class SearchWorkspace {
+public:
+    using Index = CompactGraph::Index;
+    
+    struct HeapEntry {
+        double distance;
+        Index node;
+        
+        bool operator>(const HeapEntry& other) const {
+            return distance > other.distance;
+        }
+    };
+    
+    /**
+     * @brief Constructs a workspace for graphs of up to `nodeCount` nodes.
+     */
+    explicit SearchWorkspace(size_t nodeCount = 0)
+        : distances_(nodeCount), parents_(nodeCount), stamps_(nodeCount, 0) {}
+    
+    /**
+     * @brief Forget every label and empty the heap, to start a new search.
+     */
+    void clear() {
+        heap_.clear();
+        if (++currentStamp_ == 0) {
+            // Stamp counter wrapped around: stale stamps could alias, so reset them
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            currentStamp_ = 1;
+        }
+    }
+    
+    bool isReached(Index node) const { return stamps_[node] == currentStamp_; }
+    
+    /**
+     * @brief Get the distance of a node reached in this search.
+     */
+    double getDistance(Index node) const { return distances_[node]; }
+    
+    /**
+     * @brief Get the distance of a node, infinity if it was not reached in this search.
+     */
+    double distanceOf(Index node) const {
+        return isReached(node) ? distances_[node] : std::numeric_limits<double>::infinity();
+    }
+    
+    /**
+     * @brief Get how a node reached in this search was reached.
+     */
+    const Parent& getParent(Index node) const { return parents_[node]; }
+    
+    /**
+     * @brief Label a node with a distance and parent, and queue it.
+     */
+    void reach(Index node, double distance, const Parent& parent) {
+        stamps_[node] = currentStamp_;
+        distances_[node] = distance;
+        parents_[node] = parent;
+        heap_.push_back({distance, node});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+    }
+    
+    bool isHeapEmpty() const { return heap_.empty(); }
+    size_t getHeapSize() const { return heap_.size(); }
+    
+    /**
+     * @brief Remove the queued entry with the smallest distance; the heap must not be empty.
+     * 
+     * A node is queued again whenever its distance drops, so an entry whose
+     * distance is above the node's label is stale and should be skipped.
+     */
+    HeapEntry pop() {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<HeapEntry>());
+        HeapEntry entry = heap_.back();
+        heap_.pop_back();
+        return entry;
+    }
+
+private:
+    std::vector<double> distances_;
+    std::vector<Parent> parents_;
+    std::vector<uint32_t> stamps_;
+    uint32_t currentStamp_ = 0;
+    std::vector<HeapEntry> heap_;
+};
+
+} // namespace graph
+} // namespace dijkstra
@@ -0,0 +1,121 @@
+#include "ShardClient.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dijkstra {
+namespace server {
+
+ShardClient::ShardClient(std::string path) : path_(std::move(path)) {
+}
+
+ShardClient::~ShardClient() {
+    disconnect();
+}
+
+bool ShardClient::connect() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    sockaddr_un address{};
+    if (path_.empty() || path_.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path_);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+    
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        disconnect();
+        errno = error;
+        return false;
+    }
+    return true;
+}
+
+void ShardClient::send(std::string_view request) {
+    if (!connect()) {
+        throw std::runtime_error("Failed to connect to " + path_ + ": " + std::strerror(errno));
+    }
+    std::string line(request);
+    line.push_back('\n');
+    for (size_t sent = 0; sent < line.size();) {
+        ssize_t written = ::send(fd_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            std::string message = "Failed to send to " + path_ + ": " + std::strerror(errno);
+            disconnect();
+            throw std::runtime_error(message);
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
+
+bool ShardClient::waitForResponse(std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (buffer_.find('\n') == std::string::npos) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (fd_ >= 0) {
+            pollfd request{fd_, POLLIN, 0};
+            int ready = ::poll(&request, 1, static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready == 0) {
+                return false;
+            }
+        }
+        readMore();
+    }
+    return true;
+}
+
+std::string ShardClient::receive() {
+    size_t searched = 0;
+    for (;;) {
+        size_t end = buffer_.find('\n', searched);
+        if (end != std::string::npos) {
+            std::string response = buffer_.substr(0, end);
+            buffer_.erase(0, end + 1);
+            return response;
+        }
+        searched = buffer_.size();
+        readMore();
+    }
+}
+
+void ShardClient::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    buffer_.clear();
+}
+
+void ShardClient::readMore() {
+    for (;;) {
+        char chunk[1 << 16];
+        ssize_t received = fd_ >= 0 ? ::recv(fd_, chunk, sizeof(chunk), 0) : 0;
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            disconnect();
+            throw std::runtime_error("Failed to read from " + path_ + ": connection closed");
+        }
+        buffer_.append(chunk, static_cast<size_t>(received));
+        return;
+    }
+}
+
+} // namespace server
+} // namespace dijkstra
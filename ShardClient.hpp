@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class ShardClient
+ * @brief Blocking JSON-lines connection to a QueryServer's Unix-domain socket.
+ * 
+ * Requests may be pipelined: send() several, then receive() their responses,
+ * which arrive in request order. waitForResponse() bounds the wait for one.
+ * The connection is opened on first use and reopened after a failure, when
+ * the responses still outstanding are lost.
+ */
+class ShardClient {
+public:
+    /**
+     * @brief Constructs a client; nothing is connected until connect() or send().
+     * @param path Socket path of the server
+     */
+    explicit ShardClient(std::string path);
+    
+    ~ShardClient();
+    
+    ShardClient(const ShardClient&) = delete;
+    ShardClient& operator=(const ShardClient&) = delete;
+    
+    /**
+     * @brief Connect unless already connected.
+     * @return true if connected, false if the server is not accepting (yet)
+     */
+    bool connect();
+    
+    /**
+     * @brief Send one request line.
+     * @param request JSON request without the trailing newline
+     * @throws std::runtime_error if the server cannot be reached
+     */
+    void send(std::string_view request);
+    
+    /**
+     * @brief Wait a limited time for the response to the oldest request not yet answered.
+     * @param timeout Longest time to wait
+     * @return true once receive() can return that response without blocking,
+     *         false if it has not arrived in time
+     * @throws std::runtime_error if the connection is lost
+     */
+    bool waitForResponse(std::chrono::milliseconds timeout);
+    
+    /**
+     * @brief Wait for the response to the oldest request not yet answered.
+     * @return JSON response without the trailing newline
+     * @throws std::runtime_error if the connection is lost
+     */
+    std::string receive();
+    
+    const std::string& getPath() const { return path_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    std::string buffer_; ///< Bytes received but not consumed yet
+    
+    void disconnect();
+    
+    /**
+     * @brief Append the bytes of one recv() to the buffer; throws if the connection is closed.
+     */
+    void readMore();
+};
+
+} // namespace server
+} // namespace dijkstra
@@ -0,0 +1,307 @@
+#include "ShardCoordinator.hpp"
+#include "QueryServer.hpp"
+#include "../data/JsonHandler.hpp"
+#include "../data/JsonWriter.hpp"
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+
+namespace dijkstra {
+namespace server {
+
+ShardCoordinator::ShardCoordinator(const data::GraphShards& shards, const std::vector<std::string>& socketPaths)
+    : shards_(shards)
+    , workspace_(shards.getOverlay().getNodeCount()) {
+    if (socketPaths.size() != shards.getShardCount()) {
+        throw std::invalid_argument("Expected one worker socket per shard");
+    }
+    for (const std::string& path : socketPaths) {
+        clients_.push_back(std::make_unique<ShardClient>(path));
+    }
+}
+
+ShardCoordinator::Outcome ShardCoordinator::handle(std::string_view request, std::string& response,
+                                                   std::string_view type) {
+    const auto started = std::chrono::steady_clock::now();
+    stats_ = graph::SearchStats();
+    return respond(request, response, type, started, stats_, metrics_,
+                   [this](const nlohmann::json& json, std::string_view requestType, data::JsonWriter& writer,
+                          RequestKind& kind) {
+        if (requestType != "route") {
+            throw std::invalid_argument("Unknown request type (a sharded graph answers route only)");
+        }
+        kind.mode = parseMode(json);
+        kind.typed = true;
+        const std::string& from = requireString(json, "from");
+        const std::string& to = requireString(json, "to");
+        graph::PathResult result = findShortestPath(from, to, kind.mode);
+        writer.key("result");
+        data::JsonHandler::writePathResult(writer, result);
+    });
+}
+
+graph::PathResult ShardCoordinator::findShortestPath(const std::string& source, const std::string& destination,
+                                                     OptimizationMode mode) {
+    const graph::CompactGraph& overlay = shards_.getOverlay();
+    deadline_ = timeout_ > std::chrono::steady_clock::duration::zero() ? std::chrono::steady_clock::now() + timeout_
+                                                                       : std::chrono::steady_clock::time_point::max();
+    const std::string modeName = graph::PathFinder::modeName(mode);
+    
+    // The node index tells which shards hold the endpoints
+    const uint32_t sourceShard = shards_.findShard(source);
+    if (sourceShard == data::GraphShards::NO_SHARD) {
+        throw std::invalid_argument("Unknown node: " + source);
+    }
+    const uint32_t destinationShard = shards_.findShard(destination);
+    if (destinationShard == data::GraphShards::NO_SHARD) {
+        throw std::invalid_argument("Unknown node: " + destination);
+    }
+    
+    // Round 1: costs from the source to the exits of its shard
+    std::vector<std::pair<Index, double>> seeds;
+    const std::vector<Index>& exits = shards_.getExits(sourceShard);
+    const std::vector<Index>& entries = shards_.getEntries(destinationShard);
+    if (!exits.empty() && !entries.empty()) {
+        nlohmann::json exitIds = nlohmann::json::array();
+        for (Index exit : exits) {
+            exitIds.push_back(overlay.getNodeId(exit));
+        }
+        nlohmann::json request = {{"type", "matrix"}, {"mode", modeName}, {"sources", {source}},
+                                  {"targets", std::move(exitIds)}};
+        nlohmann::json result = exchange({{sourceShard, std::move(request)}})[0];
+        const nlohmann::json& row = result.at("costs").at(0);
+        for (size_t exit = 0; exit < exits.size(); ++exit) {
+            if (row.at(exit).is_number()) {
+                seeds.emplace_back(exits[exit], row.at(exit).get<double>());
+            }
+        }
+    }
+    
+    // Round 2: the overlay, from those exits to the entries of the destination's shard
+    searchOverlay(seeds, entries, mode);
+    checkStop();
+    
+    // Round 3: from those entries (and the source itself, within one shard) to the destination
+    nlohmann::json starts = nlohmann::json::array();
+    if (sourceShard == destinationShard) {
+        starts.push_back({{"id", source}, {"cost", 0.0}});
+    }
+    for (Index entry : entries) {
+        if (workspace_.isReached(entry)) {
+            starts.push_back({{"id", overlay.getNodeId(entry)}, {"cost", workspace_.getDistance(entry)}});
+        }
+    }
+    if (starts.empty()) {
+        return graph::PathResult(); // No way into the destination's shard
+    }
+    nlohmann::json request = {{"type", "route"}, {"mode", modeName}, {"sources", std::move(starts)},
+                              {"to", destination}};
+    nlohmann::json lastLeg = exchange({{destinationShard, std::move(request)}})[0];
+    if (!lastLeg.at("found").get<bool>()) {
+        return graph::PathResult();
+    }
+    const nlohmann::json& lastPath = lastLeg.at("path");
+    const std::string start = lastPath.at(0).get<std::string>();
+    
+    graph::PathResult result;
+    result.setFound(true);
+    double totalDistance = 0.0;
+    double totalTime = 0.0;
+    double totalCost = 0.0;
+    graph::PathResult::Path path;
+    auto appendLeg = [&](const nlohmann::json& leg) {
+        const nlohmann::json& nodes = leg.at("path");
+        for (size_t node = path.empty() ? 0 : 1; node < nodes.size(); ++node) {
+            path.push_back(nodes[node].get<std::string>());
+        }
+        totalDistance += leg.at("total_distance").get<double>();
+        totalTime += leg.at("total_time").get<double>();
+        totalCost += leg.at("total_cost").get<double>();
+    };
+    
+    if (sourceShard != destinationShard || start != source) {
+        // Walk the overlay path back from the entry where the last leg starts
+        std::vector<EdgeIndex> edges;
+        Index at = overlay.findNode(start);
+        for (; workspace_.getParent(at) != NO_EDGE; at = overlay.getSource(workspace_.getParent(at))) {
+            edges.push_back(workspace_.getParent(at));
+        }
+        std::reverse(edges.begin(), edges.end());
+        
+        // Expand the source's leg and the in-shard edges, all at once
+        std::vector<std::pair<uint32_t, nlohmann::json>> legs;
+        auto addLeg = [&](uint32_t shard, const std::string& from, std::string_view to) {
+            legs.emplace_back(shard, nlohmann::json{{"type", "route"}, {"mode", modeName}, {"from", from},
+                                                    {"to", std::string(to)}});
+        };
+        const std::string firstExit(overlay.getNodeId(at));
+        if (firstExit != source) {
+            addLeg(sourceShard, source, firstExit);
+        }
+        for (EdgeIndex edge : edges) {
+            Index from = overlay.getSource(edge);
+            uint32_t shard = shards_.getShardOf(from);
+            if (shard == shards_.getShardOf(overlay.getTarget(edge))) {
+                addLeg(shard, std::string(overlay.getNodeId(from)), overlay.getNodeId(overlay.getTarget(edge)));
+            }
+        }
+        std::vector<nlohmann::json> expanded = exchange(std::move(legs));
+        
+        path.push_back(source);
+        size_t next = 0;
+        if (firstExit != source) {
+            appendLeg(expanded[next++]);
+        }
+        for (EdgeIndex edge : edges) {
+            Index target = overlay.getTarget(edge);
+            if (shards_.getShardOf(overlay.getSource(edge)) == shards_.getShardOf(target)) {
+                if (!expanded[next].at("found").get<bool>()) {
+                    throw std::runtime_error("Shard " + std::to_string(shards_.getShardOf(target)) +
+                                             " found no path for an overlay edge; its files do not match");
+                }
+                appendLeg(expanded[next++]);
+            } else {
+                path.emplace_back(overlay.getNodeId(target));
+                totalDistance += overlay.getDistance(edge);
+                totalTime += overlay.getTime(edge);
+                totalCost += overlay.getCost(edge);
+            }
+        }
+    }
+    appendLeg(lastLeg);
+    
+    result.setPath(path);
+    result.setTotalDistance(totalDistance);
+    result.setTotalTime(totalTime);
+    result.setTotalCost(totalCost);
+    return result;
+}
+
+std::vector<nlohmann::json> ShardCoordinator::exchange(std::vector<std::pair<uint32_t, nlohmann::json>> requests) {
+    std::vector<nlohmann::json> results(requests.size());
+    std::vector<std::deque<size_t>> pending(clients_.size());
+    
+    auto receive = [&](uint32_t shard) {
+        // Wait in slices, so a cancelled query is given up while its worker is still busy
+        while (!clients_[shard]->waitForResponse(std::min(STOP_CHECK_INTERVAL, remainingTime()))) {
+            checkStop();
+        }
+        size_t request = pending[shard].front();
+        pending[shard].pop_front();
+        nlohmann::json response = nlohmann::json::parse(clients_[shard]->receive(), nullptr, false);
+        auto error = response.is_object() ? response.find("error") : response.end();
+        if (error != response.end()) {
+            std::string message = error->is_string() ? error->get<std::string>() : error->dump();
+            if (message == QueryStopped::message(util::StopCondition::Reason::DEADLINE)) {
+                throw QueryStopped(util::StopCondition::Reason::DEADLINE);
+            }
+            if (message == QueryStopped::message(util::StopCondition::Reason::CANCELLED)) {
+                throw QueryStopped(util::StopCondition::Reason::CANCELLED);
+            }
+            throw std::runtime_error("Shard " + std::to_string(shard) + ": " + message);
+        }
+        if (!response.is_object() || !response.contains("result")) {
+            throw std::runtime_error("Shard " + std::to_string(shard) + " sent an invalid response");
+        }
+        results[request] = std::move(response["result"]);
+    };
+    
+    try {
+        // A worker stops reading a connection with MAX_PIPELINE requests unanswered
+        for (size_t request = 0; request < requests.size(); ++request) {
+            uint32_t shard = requests[request].first;
+            if (pending[shard].size() == QueryServer::MAX_PIPELINE) {
+                receive(shard);
+            }
+            // Workers stop at the coordinator's deadline too, rather than at their own timeout
+            nlohmann::json& json = requests[request].second;
+            if (deadline_ != std::chrono::steady_clock::time_point::max()) {
+                json["timeout_ms"] = remainingTime().count();
+            }
+            clients_[shard]->send(json.dump());
+            pending[shard].push_back(request);
+        }
+        for (uint32_t shard = 0; shard < pending.size(); ++shard) {
+            while (!pending[shard].empty()) {
+                receive(shard);
+            }
+        }
+    } catch (...) {
+        // Responses still on their way would answer the next requests; start afresh
+        for (uint32_t shard = 0; shard < pending.size(); ++shard) {
+            if (!pending[shard].empty()) {
+                clients_[shard] = std::make_unique<ShardClient>(clients_[shard]->getPath());
+            }
+        }
+        throw;
+    }
+    checkStop();
+    return results;
+}
+
+std::chrono::milliseconds ShardCoordinator::remainingTime() const {
+    if (deadline_ == std::chrono::steady_clock::time_point::max()) {
+        return std::chrono::milliseconds::max();
+    }
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline_ - std::chrono::steady_clock::now());
+    return std::max(remaining, std::chrono::milliseconds::zero());
+}
+
+void ShardCoordinator::checkStop() const {
+    if (token_ && token_->isCancelled()) {
+        throw QueryStopped(util::StopCondition::Reason::CANCELLED);
+    }
+    if (std::chrono::steady_clock::now() >= deadline_) {
+        throw QueryStopped(util::StopCondition::Reason::DEADLINE);
+    }
+}
+
+void ShardCoordinator::searchOverlay(const std::vector<std::pair<Index, double>>& seeds,
+                                     const std::vector<Index>& targets, OptimizationMode mode) {
+    const graph::CompactGraph& overlay = shards_.getOverlay();
+    stats_.begin("shard-overlay");
+    workspace_.clear();
+    
+    auto reach = [&](Index node, double distance, EdgeIndex parentEdge) {
+        if (workspace_.isReached(node)) {
+            stats_.countDecreaseKey();
+        }
+        workspace_.reach(node, distance, parentEdge);
+        stats_.countPush(workspace_.getHeapSize());
+    };
+    for (const auto& [node, distance] : seeds) {
+        if (!workspace_.isReached(node) || distance < workspace_.getDistance(node)) {
+            reach(node, distance, NO_EDGE);
+        }
+    }
+    
+    // Stop once every target is settled
+    std::vector<Index> pending(targets);
+    std::sort(pending.begin(), pending.end());
+    size_t remaining = pending.size();
+    while (!workspace_.isHeapEmpty() && remaining > 0) {
+        auto current = workspace_.pop();
+        stats_.countPop();
+        if (current.distance > workspace_.getDistance(current.node)) {
+            continue;
+        }
+        stats_.countSettled();
+        if (std::binary_search(pending.begin(), pending.end(), current.node)) {
+            --remaining;
+        }
+        
+        for (EdgeIndex edge = overlay.getFirstEdge(current.node); edge < overlay.getLastEdge(current.node); ++edge) {
+            Index neighbor = overlay.getTarget(edge);
+            double distance = current.distance + graph::PathFinder::combineWeights(
+                overlay.getDistance(edge), overlay.getTime(edge), overlay.getCost(edge), mode);
+            stats_.countRelaxed();
+            if (!workspace_.isReached(neighbor) || distance < workspace_.getDistance(neighbor)) {
+                reach(neighbor, distance, edge);
+            }
+        }
+    }
+    stats_.end();
+}
+
+} // namespace server
+} // namespace dijkstra
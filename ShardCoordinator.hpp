@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../data/GraphShards.hpp"
+#include "../graph/PathFinder.hpp"
+#include "../graph/SearchStats.hpp"
+#include "../graph/SearchWorkspace.hpp"
+#include "../util/Cancellation.hpp"
+#include "QueryMetrics.hpp"
+#include "RequestHandler.hpp"
+#include "ShardClient.hpp"
+
+namespace dijkstra {
+namespace server {
+
+/**
+ * @class ShardCoordinator
+ * @brief Answers route requests over a sharded graph by asking the shards' workers.
+ * 
+ * Every shard graph of a GraphShards directory is served by a QueryServer,
+ * usually in a worker process of its own, on a Unix-domain socket. The
+ * shards holding a route's endpoints are looked up in the directory's node
+ * index. A route from a node in shard A to a node in shard B then takes three
+ * rounds of requests:
+ * 1. A's worker returns the costs from the source to A's exits.
+ * 2. The coordinator searches the overlay from those exits, each starting at
+ *    its cost, until B's entries are settled.
+ * 3. B's worker searches from B's entries, each starting at its overlay cost,
+ *    and from the source too if A is B, to the target. Where the path starts
+ *    tells which way won.
+ * Finally the in-shard edges of the overlay path, and the leg from the source
+ * to the first exit, are expanded by route requests to their workers, all
+ * sent at once, and the legs are joined.
+ * 
+ * Requests and responses have QueryHandler's format; only `route` is
+ * supported. getLastStats() counts the overlay search; the workers count
+ * their own searches. An instance holds one connection to every worker and
+ * is used by one thread at a time.
+ */
+class ShardCoordinator : public RequestHandler {
+public:
+    using OptimizationMode = graph::PathFinder::OptimizationMode;
+    
+    /**
+     * @brief Constructs a coordinator; workers are connected on first use.
+     * @param shards Shard directory contents; must outlive the coordinator
+     * @param socketPaths Socket of the worker serving each shard
+     * @throws std::invalid_argument if there is not one socket per shard
+     */
+    ShardCoordinator(const data::GraphShards& shards, const std::vector<std::string>& socketPaths);
+    
+    void setTimeout(std::chrono::steady_clock::duration timeout) override { timeout_ = timeout; }
+    void setCancellationToken(const util::CancellationToken* token) override { token_ = token; }
+    void setMetrics(QueryMetrics::Shard* metrics) override { metrics_ = metrics; }
+    Outcome handle(std::string_view request, std::string& response, std::string_view type = {}) override;
+    const graph::SearchStats& getLastStats() const override { return stats_; }
+    
+    /**
+     * @brief Find the shortest path between two nodes of any shards.
+     * @param source Source node ID
+     * @param destination Destination node ID
+     * @param mode Optimization mode
+     * @return PathResult containing the path and totals
+     * @throws std::invalid_argument if a node is in no shard
+     * @throws std::runtime_error if a worker fails or stops the query
+     */
+    graph::PathResult findShortestPath(const std::string& source, const std::string& destination,
+                                       OptimizationMode mode);
+
+private:
+    using Index = graph::CompactGraph::Index;
+    using EdgeIndex = graph::CompactGraph::EdgeIndex;
+    
+    static constexpr EdgeIndex NO_EDGE = ~EdgeIndex(0);
+    static constexpr std::chrono::milliseconds STOP_CHECK_INTERVAL{50}; ///< Cancellation latency while waiting
+    
+    const data::GraphShards& shards_;
+    std::vector<std::unique_ptr<ShardClient>> clients_;
+    std::chrono::steady_clock::duration timeout_ = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+    const util::CancellationToken* token_ = nullptr;
+    QueryMetrics::Shard* metrics_ = nullptr;
+    graph::SearchStats stats_;
+    
+    graph::SearchWorkspace<EdgeIndex> workspace_; ///< Overlay search; parent edge of every reached node
+    
+    /**
+     * @brief Send requests to workers and collect the "result" of each response.
+     * 
+     * Requests to different workers are answered concurrently. Each request
+     * carries the time left until the deadline as "timeout_ms", and waiting
+     * for the responses ends at the deadline or when the token is cancelled.
+     * 
+     * @param requests (shard, JSON request) pairs
+     * @return Results in request order
+     * @throws QueryStopped if the deadline passes or the token is cancelled first
+     * @throws std::runtime_error if a worker fails or answers with an error
+     */
+    std::vector<nlohmann::json> exchange(std::vector<std::pair<uint32_t, nlohmann::json>> requests);
+    
+    /**
+     * @brief Get the time left until the deadline, rounded up (milliseconds::max() for none).
+     */
+    std::chrono::milliseconds remainingTime() const;
+    
+    /**
+     * @brief Throw if the deadline has passed or the token was cancelled.
+     */
+    void checkStop() const;
+    
+    /**
+     * @brief Search the overlay from seeded nodes until the given nodes are settled.
+     */
+    void searchOverlay(const std::vector<std::pair<Index, double>>& seeds, const std::vector<Index>& targets,
+                       OptimizationMode mode);
+};
+
+} // namespace server
+} // namespace dijkstra
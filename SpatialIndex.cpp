@@ -0,0 +1,168 @@
+#include "SpatialIndex.hpp"
+#include "../geo/GeoCoordinate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace dijkstra {
+namespace graph {
+
+namespace {
+
+constexpr double KM_PER_DEGREE = 111.19492664455873; ///< Great-circle km per degree of arc
+constexpr double NODES_PER_CELL = 4.0;
+
+struct GridStorage {
+    std::vector<uint64_t> cellOffsets;
+    std::vector<CompactGraph::Index> cellNodes;
+};
+
+} // namespace
+
+SpatialIndex::SpatialIndex(const GridParameters& parameters, const uint64_t* cellOffsets,
+                           const Index* cellNodes, std::shared_ptr<const void> storage)
+    : parameters_(parameters)
+    , cellOffsets_(cellOffsets)
+    , cellNodes_(cellNodes)
+    , storage_(std::move(storage)) {
+}
+
+SpatialIndex SpatialIndex::build(const CompactGraph& graph) {
+    if (!graph.hasCoordinates()) {
+        return SpatialIndex();
+    }
+    
+    std::vector<Index> located;
+    GridParameters params;
+    double maxLatitude = -std::numeric_limits<double>::infinity();
+    double maxLongitude = -std::numeric_limits<double>::infinity();
+    params.minLatitude = std::numeric_limits<double>::infinity();
+    params.minLongitude = std::numeric_limits<double>::infinity();
+    
+    for (Index node = 0; node < graph.getNodeCount(); ++node) {
+        double lat = graph.getLatitude(node);
+        double lon = graph.getLongitude(node);
+        if (!std::isfinite(lat) || !std::isfinite(lon)) {
+            continue;
+        }
+        located.push_back(node);
+        params.minLatitude = std::min(params.minLatitude, lat);
+        params.minLongitude = std::min(params.minLongitude, lon);
+        maxLatitude = std::max(maxLatitude, lat);
+        maxLongitude = std::max(maxLongitude, lon);
+    }
+    
+    if (located.empty()) {
+        return SpatialIndex();
+    }
+    
+    // Choose roughly square cells (in km) holding NODES_PER_CELL nodes on average
+    double latSpan = std::max(maxLatitude - params.minLatitude, 1e-9);
+    double lonScale = std::max(std::cos((params.minLatitude + maxLatitude) / 2.0 * M_PI / 180.0), 0.01);
+    double lonSpan = std::max(maxLongitude - params.minLongitude, 1e-9);
+    double targetCells = std::max(1.0, located.size() / NODES_PER_CELL);
+    double cellSide = std::sqrt(latSpan * lonSpan * lonScale / targetCells);
+    
+    params.rows = static_cast<uint32_t>(std::clamp(std::ceil(latSpan / cellSide), 1.0, 65535.0));
+    params.columns = static_cast<uint32_t>(std::clamp(std::ceil(lonSpan * lonScale / cellSide), 1.0, 65535.0));
+    params.cellSizeLatitude = latSpan / params.rows;
+    params.cellSizeLongitude = lonSpan / params.columns;
+    params.maxAbsLatitude = std::max(std::abs(params.minLatitude), std::abs(maxLatitude));
+    
+    // Counting sort of the located nodes by cell
+    auto storage = std::make_shared<GridStorage>();
+    SpatialIndex index(params, nullptr, nullptr, nullptr);
+    const size_t cellCount = size_t(params.rows) * params.columns;
+    std::vector<uint64_t> cellOf(located.size());
+    storage->cellOffsets.assign(cellCount + 1, 0);
+    for (size_t i = 0; i < located.size(); ++i) {
+        Index node = located[i];
+        cellOf[i] = size_t(index.rowOf(graph.getLatitude(node))) * params.columns +
+                    index.columnOf(graph.getLongitude(node));
+        ++storage->cellOffsets[cellOf[i] + 1];
+    }
+    std::partial_sum(storage->cellOffsets.begin(), storage->cellOffsets.end(), storage->cellOffsets.begin());
+    
+    storage->cellNodes.resize(located.size());
+    std::vector<uint64_t> cursor(storage->cellOffsets.begin(), storage->cellOffsets.end() - 1);
+    for (size_t i = 0; i < located.size(); ++i) {
+        storage->cellNodes[cursor[cellOf[i]]++] = located[i];
+    }
+    
+    const uint64_t* offsets = storage->cellOffsets.data();
+    const Index* nodes = storage->cellNodes.data();
+    return SpatialIndex(params, offsets, nodes, std::move(storage));
+}
+
+SpatialIndex::Index SpatialIndex::findNearest(const CompactGraph& graph, double latitude, double longitude) const {
+    if (isEmpty()) {
+        return CompactGraph::INVALID_INDEX;
+    }
+    
+    const geo::GeoCoordinate query(latitude, longitude);
+    const int64_t row = rowOf(latitude);
+    const int64_t column = columnOf(longitude);
+    const int64_t rows = parameters_.rows;
+    const int64_t columns = parameters_.columns;
+    
+    // Every cell in ring k + 1 is at least k whole cells away from the query
+    const double minCellKm = KM_PER_DEGREE * std::min(
+        parameters_.cellSizeLatitude,
+        parameters_.cellSizeLongitude * std::cos(parameters_.maxAbsLatitude * M_PI / 180.0));
+    
+    Index best = CompactGraph::INVALID_INDEX;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    
+    auto scanCell = [&](int64_t r, int64_t c) {
+        if (r < 0 || r >= rows || c < 0 || c >= columns) {
+            return;
+        }
+        size_t cell = size_t(r) * parameters_.columns + size_t(c);
+        for (uint64_t i = cellOffsets_[cell]; i < cellOffsets_[cell + 1]; ++i) {
+            Index node = cellNodes_[i];
+            double distance = query.distanceTo(
+                geo::GeoCoordinate(graph.getLatitude(node), graph.getLongitude(node)));
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = node;
+            }
+        }
+    };
+    
+    const int64_t maxRing = std::max(rows, columns);
+    for (int64_t ring = 0; ring <= maxRing; ++ring) {
+        if (best != CompactGraph::INVALID_INDEX && (ring - 1) * minCellKm > bestDistance) {
+            break;
+        }
+        
+        if (ring == 0) {
+            scanCell(row, column);
+            continue;
+        }
+        for (int64_t c = column - ring; c <= column + ring; ++c) {
+            scanCell(row - ring, c);
+            scanCell(row + ring, c);
+        }
+        for (int64_t r = row - ring + 1; r <= row + ring - 1; ++r) {
+            scanCell(r, column - ring);
+            scanCell(r, column + ring);
+        }
+    }
+    
+    return best;
+}
+
+uint32_t SpatialIndex::rowOf(double latitude) const {
+    double row = std::floor((latitude - parameters_.minLatitude) / parameters_.cellSizeLatitude);
+    return static_cast<uint32_t>(std::clamp(row, 0.0, double(parameters_.rows - 1)));
+}
+
+uint32_t SpatialIndex::columnOf(double longitude) const {
+    double column = std::floor((longitude - parameters_.minLongitude) / parameters_.cellSizeLongitude);
+    return static_cast<uint32_t>(std::clamp(column, 0.0, double(parameters_.columns - 1)));
+}
+
+} // namespace graph
+} // namespace dijkstra
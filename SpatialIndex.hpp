@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "CompactGraph.hpp"
+
+namespace dijkstra {
+namespace graph {
+
+/**
+ * @class SpatialIndex
+ * @brief Uniform latitude/longitude grid over the node coordinates of a CompactGraph.
+ * 
+ * Used to snap a coordinate to the nearest graph node. Cells hold about four
+ * nodes on average and are stored in CSR form, so the index is two flat arrays
+ * plus a small parameter block and can be borrowed from a mapping.
+ */
+class SpatialIndex {
+public:
+    using Index = CompactGraph::Index;
+    
+    static constexpr uint32_t VERSION = 1; ///< Bump when the grid layout changes
+    
+    /**
+     * @struct GridParameters
+     * @brief Placement and resolution of the grid.
+     */
+    struct GridParameters {
+        double minLatitude = 0.0;
+        double minLongitude = 0.0;
+        double cellSizeLatitude = 1.0;   ///< Cell height in degrees
+        double cellSizeLongitude = 1.0;  ///< Cell width in degrees
+        double maxAbsLatitude = 0.0;     ///< Used to bound longitude distances from below
+        uint32_t rows = 0;
+        uint32_t columns = 0;
+    };
+    
+    /**
+     * @brief Constructs an empty index.
+     */
+    SpatialIndex() = default;
+    
+    /**
+     * @brief Constructs an index over existing arrays.
+     * @param parameters Grid placement
+     * @param cellOffsets rows * columns + 1 offsets into cellNodes
+     * @param cellNodes Node indices grouped by cell
+     * @param storage Owner keeping the arrays alive
+     */
+    SpatialIndex(const GridParameters& parameters, const uint64_t* cellOffsets,
+                 const Index* cellNodes, std::shared_ptr<const void> storage);
+    
+    /**
+     * @brief Build a grid over the coordinates of a graph.
+     * 
+     * Nodes without a coordinate are left out.
+     * 
+     * @param graph Graph whose nodes to index
+     * @return The built index (empty if the graph has no coordinates)
+     */
+    static SpatialIndex build(const CompactGraph& graph);
+    
+    bool isEmpty() const { return parameters_.rows == 0; }
+    
+    /**
+     * @brief Find the node nearest to a coordinate.
+     * @param graph Graph the index was built from
+     * @param latitude Latitude in degrees
+     * @param longitude Longitude in degrees
+     * @return Index of the nearest node, or INVALID_INDEX if the index is empty
+     */
+    Index findNearest(const CompactGraph& graph, double latitude, double longitude) const;
+    
+    const GridParameters& getParameters() const { return parameters_; }
+    size_t getCellCount() const { return size_t(parameters_.rows) * parameters_.columns; }
+    const uint64_t* getCellOffsets() const { return cellOffsets_; }
+    const Index* getCellNodes() const { return cellNodes_; }
+
+private:
+    GridParameters parameters_;
+    const uint64_t* cellOffsets_ = nullptr;
+    const Index* cellNodes_ = nullptr;
+    std::shared_ptr<const void> storage_;
+    
+    uint32_t rowOf(double latitude) const;
+    uint32_t columnOf(double longitude) const;
+};
+
+} // namespace graph
+} // namespace dijkstra
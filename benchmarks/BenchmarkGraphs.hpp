@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph/Graph.hpp"
+
+namespace dijkstra {
+namespace benchmarks {
+
+constexpr uint32_t SEED = 42; ///< Seed of every generated input, so runs are comparable
+
+/**
+ * @brief Get the ID of a grid node.
+ */
+inline std::string gridNodeId(int x, int y) {
+    return "n" + std::to_string(x) + "_" + std::to_string(y);
+}
+
+/**
+ * @brief Create the nodes of a side x side grid, row by row.
+ */
+inline std::vector<graph::NodePtr> makeGridNodes(int side) {
+    std::vector<graph::NodePtr> nodes;
+    nodes.reserve(static_cast<size_t>(side) * side);
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            nodes.push_back(std::make_shared<graph::Node>(gridNodeId(x, y)));
+        }
+    }
+    return nodes;
+}
+
+/**
+ * @brief Create the edges of a side x side grid over nodes from makeGridNodes().
+ * 
+ * Neighbours are linked in both directions, like two-way streets. Distances
+ * vary by up to 50% around 1 km and speeds and prices vary independently, so
+ * the distance, time and cost modes prefer different paths. The same seed
+ * always gives the same edges.
+ */
+inline std::vector<graph::EdgePtr> makeGridEdges(const std::vector<graph::NodePtr>& nodes, int side,
+                                                 uint32_t seed = SEED) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<double> spread(0.5, 1.5);
+    std::vector<graph::EdgePtr> edges;
+    edges.reserve(static_cast<size_t>(side) * side * 4);
+    auto link = [&](size_t from, size_t to) {
+        for (int direction = 0; direction < 2; ++direction) {
+            const auto& source = nodes[direction == 0 ? from : to];
+            const auto& destination = nodes[direction == 0 ? to : from];
+            double distance = spread(random);
+            auto edge = std::make_shared<graph::Edge>(source->getId() + "-" + destination->getId(), source,
+                                                      destination, distance);
+            edge->setTimeWeight(distance / (40.0 * spread(random)));
+            edge->setCostWeight(distance * 0.2 * spread(random));
+            edges.push_back(std::move(edge));
+        }
+    };
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            size_t node = static_cast<size_t>(y) * side + x;
+            if (x + 1 < side) {
+                link(node, node + 1);
+            }
+            if (y + 1 < side) {
+                link(node, node + side);
+            }
+        }
+    }
+    return edges;
+}
+
+/**
+ * @brief Build a side x side grid road network (see makeGridEdges()).
+ */
+inline graph::Graph makeGridGraph(int side, uint32_t seed = SEED) {
+    auto nodes = makeGridNodes(side);
+    auto edges = makeGridEdges(nodes, side, seed);
+    graph::Graph graph;
+    graph.reserve(nodes.size(), edges.size());
+    for (const auto& node : nodes) {
+        graph.addNode(node);
+    }
+    for (const auto& edge : edges) {
+        graph.addEdge(edge);
+    }
+    return graph;
+}
+
+} // namespace benchmarks
+} // namespace dijkstra
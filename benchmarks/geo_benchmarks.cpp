@@ -0,0 +1,34 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkGraphs.hpp"
+#include "geo/GeoCoordinate.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+/**
+ * @brief Compute great-circle distances between random coordinates.
+ */
+void BM_GeoDistanceTo(benchmark::State& state) {
+    std::mt19937 random(benchmarks::SEED);
+    std::uniform_real_distribution<double> latitude(-90.0, 90.0);
+    std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+    std::vector<geo::GeoCoordinate> points(1024);
+    for (auto& point : points) {
+        point = geo::GeoCoordinate(latitude(random), longitude(random));
+    }
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(points[next].distanceTo(points[next + 1]));
+        next = (next + 1) % (points.size() - 1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GeoDistanceTo);
+
+} // namespace
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkGraphs.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+/**
+ * @brief Add every node of a grid with the given side to an empty graph.
+ */
+void BM_GraphAddNode(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const auto nodes = benchmarks::makeGridNodes(side);
+    for (auto _ : state) {
+        graph::Graph graph;
+        for (const auto& node : nodes) {
+            benchmark::DoNotOptimize(graph.addNode(node));
+        }
+        state.PauseTiming();
+        graph.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(nodes.size()));
+}
+BENCHMARK(BM_GraphAddNode)->Arg(32)->Arg(100)->Arg(316);
+
+/**
+ * @brief Add every edge of a grid to a graph that holds its nodes.
+ */
+void BM_GraphAddEdge(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const auto nodes = benchmarks::makeGridNodes(side);
+    const auto edges = benchmarks::makeGridEdges(nodes, side);
+    for (auto _ : state) {
+        state.PauseTiming();
+        graph::Graph graph;
+        for (const auto& node : nodes) {
+            graph.addNode(node);
+        }
+        state.ResumeTiming();
+        for (const auto& edge : edges) {
+            benchmark::DoNotOptimize(graph.addEdge(edge));
+        }
+        state.PauseTiming();
+        graph.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(edges.size()));
+}
+BENCHMARK(BM_GraphAddEdge)->Arg(32)->Arg(100)->Arg(316);
+
+/**
+ * @brief Remove 1000 random edges from a grid graph.
+ * 
+ * Removal searches the edge list, so its cost grows with the graph.
+ */
+void BM_GraphRemoveEdge(benchmark::State& state) {
+    constexpr size_t REMOVALS = 1000;
+    const int side = static_cast<int>(state.range(0));
+    const graph::Graph grid = benchmarks::makeGridGraph(side);
+    std::vector<graph::Edge::EdgeId> edgeIds;
+    for (const auto& edge : grid.getAllEdges()) {
+        edgeIds.push_back(edge->getId());
+    }
+    std::shuffle(edgeIds.begin(), edgeIds.end(), std::mt19937(benchmarks::SEED));
+    edgeIds.resize(std::min(edgeIds.size(), REMOVALS));
+    
+    for (auto _ : state) {
+        state.PauseTiming();
+        graph::Graph graph = grid;
+        state.ResumeTiming();
+        for (const auto& edgeId : edgeIds) {
+            benchmark::DoNotOptimize(graph.removeEdge(edgeId));
+        }
+        state.PauseTiming();
+        graph.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(edgeIds.size()));
+}
+BENCHMARK(BM_GraphRemoveEdge)->Arg(32)->Arg(100)->Arg(316);
+
+/**
+ * @brief Look up the outgoing edges of random nodes.
+ */
+void BM_GraphGetOutgoingEdges(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const graph::Graph graph = benchmarks::makeGridGraph(side);
+    std::mt19937 random(benchmarks::SEED);
+    std::vector<graph::Node::NodeId> nodeIds(4096);
+    for (auto& nodeId : nodeIds) {
+        nodeId = benchmarks::gridNodeId(static_cast<int>(random() % side), static_cast<int>(random() % side));
+    }
+    
+    size_t next = 0;
+    for (auto _ : state) {
+        auto edges = graph.getOutgoingEdges(nodeIds[next]);
+        benchmark::DoNotOptimize(edges.data());
+        next = (next + 1) % nodeIds.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphGetOutgoingEdges)->Arg(32)->Arg(316);
+
+} // namespace
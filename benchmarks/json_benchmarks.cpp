@@ -0,0 +1,55 @@
+#include <filesystem>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkGraphs.hpp"
+#include "data/JsonHandler.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+std::string graphFilePath(int side) {
+    return (std::filesystem::temp_directory_path() / ("dijkstra_benchmark_grid_" + std::to_string(side) + ".json"))
+        .string();
+}
+
+/**
+ * @brief Save a grid graph as a JSON file.
+ */
+void BM_JsonSaveGraph(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const graph::Graph graph = benchmarks::makeGridGraph(side);
+    const std::string path = graphFilePath(side);
+    for (auto _ : state) {
+        if (!data::JsonHandler::writeGraphFile(graph, path)) {
+            state.SkipWithError("Failed to write the graph file");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_JsonSaveGraph)->Arg(32)->Arg(100)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Load a grid graph from a JSON file.
+ */
+void BM_JsonLoadGraph(benchmark::State& state) {
+    const int side = static_cast<int>(state.range(0));
+    const std::string path = graphFilePath(side);
+    if (!data::JsonHandler::writeGraphFile(benchmarks::makeGridGraph(side), path)) {
+        state.SkipWithError("Failed to write the graph file");
+        return;
+    }
+    for (auto _ : state) {
+        auto graph = data::JsonHandler::loadGraphFile(path);
+        benchmark::DoNotOptimize(graph.getEdgeCount());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_JsonLoadGraph)->Arg(32)->Arg(100)->Unit(benchmark::kMillisecond);
+
+} // namespace
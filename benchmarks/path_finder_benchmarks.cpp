@@ -0,0 +1,90 @@
+#include <map>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkGraphs.hpp"
+#include "graph/PathFinder.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+constexpr int GRID_SIDE = 100;
+constexpr int ALL_PATHS_GRID_SIDE = 32; ///< findShortestPaths scans every node per step, so keep it small
+
+const graph::Graph& grid(int side = GRID_SIDE) {
+    static std::map<int, graph::Graph> graphs;
+    auto it = graphs.find(side);
+    if (it == graphs.end()) {
+        it = graphs.emplace(side, benchmarks::makeGridGraph(side)).first;
+    }
+    return it->second;
+}
+
+/**
+ * @brief Query lengths: a few blocks, across a quarter of the grid, corner to corner.
+ */
+enum QueryLength { SHORT, MEDIUM, LONG };
+
+const char* lengthName(int64_t length) {
+    return length == SHORT ? "short" : length == MEDIUM ? "medium" : "long";
+}
+
+/**
+ * @brief Answer one query of each length in each mode.
+ * 
+ * Reports the nodes the search settled per query, which stays the same from
+ * run to run and so tells algorithmic changes from machine noise.
+ */
+void BM_FindShortestPath(benchmark::State& state) {
+    const auto length = state.range(0);
+    const auto mode = static_cast<OptimizationMode>(state.range(1));
+    const int middle = GRID_SIDE / 2;
+    graph::Node::NodeId source;
+    graph::Node::NodeId destination;
+    if (length == SHORT) {
+        source = benchmarks::gridNodeId(middle, middle);
+        destination = benchmarks::gridNodeId(middle + 3, middle + 2);
+    } else if (length == MEDIUM) {
+        source = benchmarks::gridNodeId(middle - GRID_SIDE / 8, middle - GRID_SIDE / 8);
+        destination = benchmarks::gridNodeId(middle + GRID_SIDE / 8, middle + GRID_SIDE / 8);
+    } else {
+        source = benchmarks::gridNodeId(0, 0);
+        destination = benchmarks::gridNodeId(GRID_SIDE - 1, GRID_SIDE - 1);
+    }
+    
+    graph::PathFinder finder(grid());
+    uint64_t settled = 0;
+    for (auto _ : state) {
+        auto result = finder.findShortestPath(source, destination, mode);
+        benchmark::DoNotOptimize(result.getTotalDistance());
+        settled = result.getStats().nodesSettled;
+    }
+    state.SetLabel(std::string(lengthName(length)) + "/" + graph::PathFinder::modeName(mode));
+    state.counters["nodes_settled"] = static_cast<double>(settled);
+}
+BENCHMARK(BM_FindShortestPath)
+    ->ArgNames({"length", "mode"})
+    ->ArgsProduct({{SHORT, MEDIUM, LONG}, {0, 1, 2, 3}})
+    ->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Compute the distances from one node to all others.
+ */
+void BM_FindShortestPaths(benchmark::State& state) {
+    const auto mode = static_cast<OptimizationMode>(state.range(0));
+    const auto source = benchmarks::gridNodeId(ALL_PATHS_GRID_SIDE / 2, ALL_PATHS_GRID_SIDE / 2);
+    graph::PathFinder finder(grid(ALL_PATHS_GRID_SIDE));
+    for (auto _ : state) {
+        auto distances = finder.findShortestPaths(source, mode);
+        benchmark::DoNotOptimize(distances.size());
+    }
+    state.SetLabel(graph::PathFinder::modeName(mode));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(grid(ALL_PATHS_GRID_SIDE).getNodeCount()));
+}
+BENCHMARK(BM_FindShortestPaths)->ArgName("mode")->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+
+} // namespace
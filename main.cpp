@@ -1,7 +1,22 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 #include <string>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // Include all necessary headers
 #include "graph/Graph.hpp"
@@ -11,6 +26,13 @@
 #include "travel/TravelRoute.hpp"
 #include "travel/Itinerary.hpp"
 #include "data/JsonHandler.hpp"
+#include "data/BinaryGraphHandler.hpp"
+#include "data/GraphArtifacts.hpp"
+#include "data/GraphShards.hpp"
+#include "server/BatchRunner.hpp"
+#include "server/QueryServer.hpp"
+#include "server/ShardClient.hpp"
+#include "server/ShardCoordinator.hpp"
 
 using namespace dijkstra;
 
@@ -171,8 +193,506 @@ private:
     }
 };
 
-int main() {
+namespace {
+
+/**
+ * @brief Load a graph for querying, with its component index.
+ * 
+ * Binary graphs are mapped and come with cached preprocessing; JSON is parsed
+ * in either schema (`nodes`/`edges`, or `locations`/`transportation_routes`
+ * as in sample_data.json). A graph without nodes is refused, since it could
+ * answer nothing.
+ */
+graph::CompactGraph loadGraph(const std::string& graphPath, unsigned threads, graph::ComponentIndex& components) {
+    const bool binary = graphPath.size() > 4 && graphPath.compare(graphPath.size() - 4, 4, ".bin") == 0;
+    graph::CompactGraph graph = binary ? data::BinaryGraphHandler::mapBinaryGraph(graphPath)
+                              : data::JsonHandler::isLocationsFile(graphPath)
+                                  ? data::JsonHandler::loadLocationsFile(graphPath)
+                                  : data::JsonHandler::loadCompactGraphFile(graphPath, threads);
+    if (graph.getNodeCount() == 0) {
+        throw std::runtime_error("Failed to load " + graphPath + ": the graph has no nodes");
+    }
+    components = binary
+        ? data::GraphArtifacts::loadOrBuild(graph, data::BinaryGraphHandler::readContentHash(graphPath),
+                                            data::GraphArtifacts::defaultPath(graphPath)).getComponents()
+        : graph::ComponentIndex::build(graph);
+    return graph;
+}
+
+server::QueryServer* activeServer = nullptr;
+
+void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+/**
+ * @brief Reloads a served graph from its file on every SIGHUP.
+ * 
+ * A thread of its own waits for the signal, then loads and indexes the file
+ * while the server goes on answering from the old graph, and finally swaps
+ * the new graph in. If loading fails, the old graph stays in service.
+ * SIGHUP must be blocked in every thread, so create the reloader before the
+ * server starts its workers.
+ */
+class GraphReloader {
+public:
+    GraphReloader(server::QueryServer& server, std::string graphPath, unsigned threads)
+        : server_(server), graphPath_(std::move(graphPath)), threads_(threads) {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGHUP);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        thread_ = std::thread(&GraphReloader::waitForSignals, this);
+    }
+    
+    ~GraphReloader() {
+        stopping_.store(true);
+        pthread_kill(thread_.native_handle(), SIGHUP);
+        thread_.join();
+    }
+    
+    GraphReloader(const GraphReloader&) = delete;
+    GraphReloader& operator=(const GraphReloader&) = delete;
+
+private:
+    server::QueryServer& server_;
+    std::string graphPath_;
+    unsigned threads_;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+    
+    void waitForSignals() {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGHUP);
+        int signal = 0;
+        while (sigwait(&signals, &signal) == 0 && !stopping_.load()) {
+            auto start = std::chrono::steady_clock::now();
+            try {
+                graph::ComponentIndex components;
+                graph::CompactGraph graph = loadGraph(graphPath_, threads_, components);
+                uint64_t version = server_.replaceGraph(graph, components);
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                std::cout << "Reloaded " << graphPath_ << " as version " << version << ": "
+                          << graph.getNodeCount() << " nodes and " << graph.getEdgeCount() << " edges in "
+                          << elapsed.count() << " ms" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Failed to reload " << graphPath_ << ", still serving the previous graph: "
+                          << e.what() << std::endl;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Runs a `serve` worker process for every shard of a shard directory.
+ * 
+ * The workers are this executable, listening on `shard-<K>.sock` in the
+ * shard directory. The constructor returns once all of them accept
+ * connections; the destructor stops them with SIGTERM and waits for them.
+ */
+class ShardWorkers {
+public:
+    static constexpr std::chrono::seconds STARTUP_TIMEOUT{120};
+    
+    ShardWorkers(const data::GraphShards& shards, unsigned threads, long timeoutMs) {
+        try {
+            start(shards, threads, timeoutMs);
+        } catch (...) {
+            stopAll();
+            throw;
+        }
+    }
+    
+    ~ShardWorkers() {
+        stopAll();
+    }
+    
+    ShardWorkers(const ShardWorkers&) = delete;
+    ShardWorkers& operator=(const ShardWorkers&) = delete;
+    
+    const std::vector<std::string>& getSocketPaths() const { return socketPaths_; }
+
+private:
+    std::vector<pid_t> pids_;
+    std::vector<std::string> socketPaths_;
+    
+    void start(const data::GraphShards& shards, unsigned threads, long timeoutMs) {
+        for (size_t shard = 0; shard < shards.getShardCount(); ++shard) {
+            std::string socketPath = shards.getDirectory() + "/shard-" + std::to_string(shard) + ".sock";
+            struct stat status;
+            if (::lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+                ::unlink(socketPath.c_str()); // Left over; never mistake it for a started worker
+            }
+            
+            std::vector<std::string> arguments = {"/proc/self/exe", "serve", shards.getShardPath(shard),
+                                                  "--socket", socketPath,
+                                                  "--threads", std::to_string(threads),
+                                                  "--timeout", std::to_string(timeoutMs)};
+            std::vector<char*> argv;
+            for (std::string& argument : arguments) {
+                argv.push_back(argument.data());
+            }
+            argv.push_back(nullptr);
+            pid_t pid = 0;
+            int error = posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv.data(), environ);
+            if (error != 0) {
+                throw std::runtime_error("Failed to start the worker for " + shards.getShardPath(shard) + ": " +
+                                         std::strerror(error));
+            }
+            pids_.push_back(pid);
+            socketPaths_.push_back(std::move(socketPath));
+        }
+        
+        // Workers load and index their shards in parallel; wait until each listens
+        auto deadline = std::chrono::steady_clock::now() + STARTUP_TIMEOUT;
+        for (size_t shard = 0; shard < pids_.size(); ++shard) {
+            server::ShardClient probe(socketPaths_[shard]);
+            while (!probe.connect()) {
+                int status = 0;
+                if (::waitpid(pids_[shard], &status, WNOHANG) == pids_[shard]) {
+                    pids_[shard] = -1;
+                    throw std::runtime_error("Failed to start the worker for " + shards.getShardPath(shard) +
+                                             ": it exited");
+                }
+                if (std::chrono::steady_clock::now() > deadline) {
+                    throw std::runtime_error("Failed to start the worker for " + shards.getShardPath(shard) +
+                                             ": it is not listening");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+    }
+    
+    void stopAll() {
+        for (pid_t pid : pids_) {
+            if (pid > 0) {
+                ::kill(pid, SIGTERM);
+            }
+        }
+        for (pid_t pid : pids_) {
+            if (pid > 0) {
+                ::waitpid(pid, nullptr, 0);
+            }
+        }
+        pids_.clear();
+    }
+};
+
+/**
+ * @brief Print a one-line summary of search statistics.
+ */
+void printSearchStats(std::ostream& out, const graph::SearchStats& stats) {
+    if (stats.searches == 0) {
+        return;
+    }
+    out << "Searches: " << stats.searches << " (" << stats.algorithm << "), "
+        << stats.nodesSettled / stats.searches << " nodes settled and "
+        << stats.edgesRelaxed / stats.searches << " edges relaxed on average, peak queue "
+        << stats.peakHeapSize << ", " << stats.elapsedNanoseconds / stats.searches / 1000 << " us average"
+        << std::endl;
+}
+
+/**
+ * @brief Loads a graph once and answers queries until interrupted.
+ * 
+ * SIGHUP reloads the graph file without interrupting service.
+ * 
+ * Usage: serve <graph.bin|graph.json> [--socket PATH] [--http PORT] [--threads N] [--timeout MS]
+ */
+int serve(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " serve <graph.bin|graph.json> [--socket PATH] [--http PORT] [--threads N] [--timeout MS]"
+                  << std::endl;
+        return 1;
+    }
+    
+    const std::string graphPath = argv[2];
+    std::string socketPath;
+    int httpPort = -1;
+    unsigned threads = 0;
+    long timeoutMs = 0;
+    for (int i = 3; i < argc; i += 2) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        if (option == "--socket") {
+            socketPath = argv[i + 1];
+        } else if (option == "--http") {
+            httpPort = std::atoi(argv[i + 1]);
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        } else if (option == "--timeout") {
+            timeoutMs = std::atol(argv[i + 1]);
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+    if (socketPath.empty() && httpPort < 0) {
+        std::cerr << "Nothing to listen on: give --socket and/or --http" << std::endl;
+        return 1;
+    }
+    
+    graph::ComponentIndex components;
+    graph::CompactGraph graph = loadGraph(graphPath, threads, components);
+    
+    server::QueryServer server(graph, threads);
+    server.setComponentIndex(components);
+    server.setQueryTimeout(std::chrono::milliseconds(timeoutMs));
+    if (!socketPath.empty()) {
+        server.listenUnix(socketPath);
+        std::cout << "Listening on " << socketPath << std::endl;
+    }
+    if (httpPort >= 0) {
+        std::cout << "Listening on http://127.0.0.1:" << server.listenHttp(static_cast<uint16_t>(httpPort))
+                  << std::endl;
+    }
+    std::cout << "Serving " << graph.getNodeCount() << " nodes and " << graph.getEdgeCount() << " edges with "
+              << server.getThreadCount() << " workers" << std::endl;
+    
+    // The server shares the graph; drop our references so a reload can free it
+    graph = graph::CompactGraph();
+    components = graph::ComponentIndex();
+    
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    {
+        GraphReloader reloader(server, graphPath, threads);
+        server.run();
+    }
+    activeServer = nullptr;
+    
+    std::cout << "Served " << server.getRequestsServed() << " requests" << std::endl;
+    printSearchStats(std::cout, server.getSearchStats());
+    return 0;
+}
+
+/**
+ * @brief Serves a graph split with tools/shard_graph from one worker process per shard.
+ * 
+ * The coordinator answers route requests on the given socket or port, asking
+ * the workers over Unix sockets. Workers get --worker-threads threads each
+ * (default: the hardware threads divided among them) and the same timeout.
+ * 
+ * Usage: serve-shards <shard dir> [--socket PATH] [--http PORT] [--threads N] [--worker-threads N]
+ *                     [--timeout MS]
+ */
+int serveShards(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " serve-shards <shard dir> [--socket PATH] [--http PORT] [--threads N] [--worker-threads N]"
+                  << " [--timeout MS]" << std::endl;
+        return 1;
+    }
+    
+    const std::string directory = argv[2];
+    std::string socketPath;
+    int httpPort = -1;
+    unsigned threads = 0;
+    unsigned workerThreads = 0;
+    long timeoutMs = 0;
+    for (int i = 3; i < argc; i += 2) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        if (option == "--socket") {
+            socketPath = argv[i + 1];
+        } else if (option == "--http") {
+            httpPort = std::atoi(argv[i + 1]);
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        } else if (option == "--worker-threads") {
+            workerThreads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        } else if (option == "--timeout") {
+            timeoutMs = std::atol(argv[i + 1]);
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+    if (socketPath.empty() && httpPort < 0) {
+        std::cerr << "Nothing to listen on: give --socket and/or --http" << std::endl;
+        return 1;
+    }
+    
+    data::GraphShards shards = data::GraphShards::open(directory);
+    if (workerThreads == 0) {
+        workerThreads = std::max<unsigned>(1, std::thread::hardware_concurrency() /
+                                                  static_cast<unsigned>(std::max<size_t>(shards.getShardCount(), 1)));
+    }
+    ShardWorkers workers(shards, workerThreads, timeoutMs);
+    
+    server::QueryServer server([&shards, &workers] {
+        return std::make_unique<server::ShardCoordinator>(shards, workers.getSocketPaths());
+    }, threads);
+    server.setQueryTimeout(std::chrono::milliseconds(timeoutMs));
+    if (!socketPath.empty()) {
+        server.listenUnix(socketPath);
+        std::cout << "Listening on " << socketPath << std::endl;
+    }
+    if (httpPort >= 0) {
+        std::cout << "Listening on http://127.0.0.1:" << server.listenHttp(static_cast<uint16_t>(httpPort))
+                  << std::endl;
+    }
+    std::cout << "Coordinating " << shards.getShardCount() << " shards (" << shards.getOverlay().getNodeCount()
+              << " boundary nodes) with " << server.getThreadCount() << " workers" << std::endl;
+    
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    server.run();
+    activeServer = nullptr;
+    
+    std::cout << "Served " << server.getRequestsServed() << " requests" << std::endl;
+    printSearchStats(std::cout, server.getSearchStats());
+    return 0;
+}
+
+/**
+ * @brief Answers origin-destination queries from a file or stdin.
+ * 
+ * Usage: batch <graph.bin|graph.json> [--input FILE] [--output FILE] [--format json|binary]
+ *              [--mode MODE] [--threads N] [--timeout MS] [--unordered] [--stats] [--metrics FILE]
+ * 
+ * Input and output default to stdin and stdout; progress goes to stderr.
+ * --metrics writes the latency histograms and counters of the run as JSON.
+ */
+int runBatch(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " batch <graph.bin|graph.json> [--input FILE] [--output FILE]"
+                  << " [--format json|binary] [--mode MODE] [--threads N] [--timeout MS] [--unordered] [--stats]"
+                  << " [--metrics FILE]" << std::endl;
+        return 1;
+    }
+    
+    const std::string graphPath = argv[2];
+    std::string inputPath = "-";
+    std::string outputPath = "-";
+    std::string metricsPath;
+    auto format = server::BatchRunner::OutputFormat::JSON_LINES;
+    auto mode = graph::PathFinder::OptimizationMode::DISTANCE;
+    unsigned threads = 0;
+    long timeoutMs = 0;
+    bool ordered = true;
+    bool includeStats = false;
+    for (int i = 3; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--unordered") {
+            ordered = false;
+            continue;
+        }
+        if (option == "--stats") {
+            includeStats = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (option == "--input") {
+            inputPath = value;
+        } else if (option == "--output") {
+            outputPath = value;
+        } else if (option == "--metrics") {
+            metricsPath = value;
+        } else if (option == "--format" && value == "json") {
+            format = server::BatchRunner::OutputFormat::JSON_LINES;
+        } else if (option == "--format" && value == "binary") {
+            format = server::BatchRunner::OutputFormat::BINARY;
+        } else if (option == "--mode") {
+            if (!graph::PathFinder::parseMode(value, mode)) {
+                std::cerr << "Invalid mode: " << value << std::endl;
+                return 1;
+            }
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else if (option == "--timeout") {
+            timeoutMs = std::atol(value.c_str());
+        } else {
+            std::cerr << "Invalid option: " << option << " " << value << std::endl;
+            return 1;
+        }
+    }
+    
+    graph::ComponentIndex components;
+    graph::CompactGraph graph = loadGraph(graphPath, threads, components);
+    
+    std::ifstream inputFile;
+    if (inputPath != "-") {
+        inputFile.open(inputPath, std::ios::binary);
+        if (!inputFile) {
+            std::cerr << "Failed to open " << inputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ofstream outputFile;
+    if (outputPath != "-") {
+        outputFile.open(outputPath, std::ios::binary | std::ios::trunc);
+        if (!outputFile) {
+            std::cerr << "Failed to create " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ios::sync_with_stdio(false);
+    
+    server::BatchRunner runner(graph, threads);
+    runner.setComponentIndex(components);
+    runner.setOutputFormat(format);
+    runner.setOrdered(ordered);
+    runner.setDefaultMode(mode);
+    runner.setQueryTimeout(std::chrono::milliseconds(timeoutMs));
+    runner.setIncludeStats(includeStats);
+    
+    auto start = std::chrono::steady_clock::now();
+    runner.run(inputPath != "-" ? static_cast<std::istream&>(inputFile) : std::cin,
+               outputPath != "-" ? static_cast<std::ostream&>(outputFile) : std::cout);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cerr << "Answered " << runner.getQueryCount() << " queries (" << runner.getFoundCount() << " found, "
+              << runner.getInvalidCount() << " invalid, " << runner.getTimedOutCount() << " timed out) in " << seconds << " s with " << runner.getThreadCount()
+              << " workers" << std::endl;
+    printSearchStats(std::cerr, runner.getSearchStats());
+    
+    if (!metricsPath.empty()) {
+        std::ofstream metricsFile(metricsPath, std::ios::trunc);
+        {
+            data::JsonWriter writer(metricsFile);
+            runner.getMetrics().writeJson(writer);
+            writer.newline();
+        }
+        if (!metricsFile.flush()) {
+            std::cerr << "Failed to write " << metricsPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
     try {
+        if (argc > 1 && std::string(argv[1]) == "serve") {
+            return serve(argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "serve-shards") {
+            return serveShards(argc, argv);
+        }
+        if (argc > 1 && std::string(argv[1]) == "batch") {
+            return runBatch(argc, argv);
+        }
+        
         TravelPlannerDemo demo;
         demo.run();
     } catch (const std::exception& e) {
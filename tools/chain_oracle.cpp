@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data/BinaryGraphHandler.hpp"
+#include "graph/CompactGraph.hpp"
+#include "graph/GraphSimplifier.hpp"
+#include "graph/PathFinder.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+constexpr double TOLERANCE = 1e-9; ///< Relative difference allowed between path costs
+constexpr size_t MAX_REPORTED_FAILURES = 10;
+
+bool nearlyEqual(double a, double b) {
+    return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+}
+
+/**
+ * @brief Get the cost of a path of node IDs in the original graph, using the cheapest edge between consecutive nodes.
+ * @return Infinity if a node is unknown or two consecutive nodes are not linked
+ */
+double pathCost(const graph::CompactGraph& graph, const graph::PathResult::Path& path, OptimizationMode mode) {
+    double total = 0.0;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        const Index from = graph.findNode(path[i]);
+        const Index to = graph.findNode(path[i + 1]);
+        if (from == graph::CompactGraph::INVALID_INDEX || to == graph::CompactGraph::INVALID_INDEX) {
+            return std::numeric_limits<double>::infinity();
+        }
+        double cheapest = std::numeric_limits<double>::infinity();
+        for (auto edge = graph.getFirstEdge(from); edge < graph.getLastEdge(from); ++edge) {
+            if (graph.getTarget(edge) == to) {
+                cheapest = std::min(cheapest, graph::PathFinder::combineWeights(
+                    graph.getDistance(edge), graph.getTime(edge), graph.getCost(edge), mode));
+            }
+        }
+        total += cheapest;
+    }
+    return total;
+}
+
+/**
+ * @brief Check a path found on the contracted graph against the original graph's answer.
+ * @return Empty if the answer is correct, otherwise what is wrong with it
+ */
+std::string check(const graph::CompactGraph& original, const graph::PathResult& expected,
+                  const graph::PathResult& contracted, const std::string& source, const std::string& destination,
+                  OptimizationMode mode) {
+    if (contracted.isFound() != expected.isFound()) {
+        return contracted.isFound() ? "found a path where the original graph has none" : "found no path";
+    }
+    if (!expected.isFound()) {
+        return "";
+    }
+    std::ostringstream problem;
+    const double expectedCost = graph::PathFinder::combineWeights(
+        expected.getTotalDistance(), expected.getTotalTime(), expected.getTotalCost(), mode);
+    const double cost = graph::PathFinder::combineWeights(
+        contracted.getTotalDistance(), contracted.getTotalTime(), contracted.getTotalCost(), mode);
+    if (!nearlyEqual(cost, expectedCost)) {
+        problem << "cost " << cost << " instead of " << expectedCost;
+        return problem.str();
+    }
+    const auto& path = contracted.getPath();
+    if (path.empty() || path.front() != source || path.back() != destination) {
+        return "path does not join the source to the destination";
+    }
+    double walked = pathCost(original, path, mode);
+    if (std::isinf(walked)) {
+        return "expanded path uses a node or edge missing from the original graph";
+    }
+    if (!nearlyEqual(walked, expectedCost)) {
+        problem << "expanded path costs " << walked << " instead of " << expectedCost;
+        return problem.str();
+    }
+    return "";
+}
+
+} // namespace
+
+/**
+ * @brief Differential test of GraphSimplifier::contractChains.
+ * 
+ * Contracts the degree-2 chains of a graph and runs random queries between
+ * junctions, the nodes that survive contraction, in every optimization mode
+ * on both graphs with PathFinder::findShortestPath. Checks that the
+ * contracted graph finds a path exactly when the original does, at the same
+ * cost, and that its path, with the compound edges expanded, is a real path
+ * of the original graph with that cost. Reports mean query time and nodes
+ * settled on both graphs. Exits with 1 if any answer was wrong.
+ * 
+ * Usage: chain_oracle <graph.bin> [queries] [seed]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <graph.bin> [queries] [seed]" << std::endl;
+        return 1;
+    }
+    const size_t queryCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    const uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42;
+    
+    try {
+        graph::CompactGraph compact = data::BinaryGraphHandler::mapBinaryGraph(argv[1]);
+        graph::Graph original = compact.toGraph();
+        
+        auto contractionStart = std::chrono::steady_clock::now();
+        graph::GraphSimplifier simplifier;
+        graph::Graph contracted = simplifier.contractChains(original);
+        double contractionSeconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - contractionStart).count();
+        
+        std::vector<std::string> junctions;
+        for (const auto& node : contracted.getAllNodes()) {
+            junctions.push_back(node->getId());
+        }
+        std::sort(junctions.begin(), junctions.end()); // Independent of hash order, so seeds reproduce
+        if (junctions.empty()) {
+            std::cerr << "Error: the graph has no nodes" << std::endl;
+            return 1;
+        }
+        std::cout << "Graph: " << original.getNodeCount() << " nodes, " << original.getEdgeCount()
+                  << " edges; contracted " << simplifier.getChainsContracted() << " chains to "
+                  << contracted.getNodeCount() << " nodes, " << contracted.getEdgeCount() << " edges in "
+                  << std::fixed << std::setprecision(2) << contractionSeconds << " s" << std::endl;
+        
+        graph::PathFinder originalFinder(original);
+        graph::PathFinder contractedFinder(contracted);
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<size_t> pick(0, junctions.size() - 1);
+        const OptimizationMode modes[] = {OptimizationMode::DISTANCE, OptimizationMode::TIME,
+                                          OptimizationMode::COST, OptimizationMode::BALANCED};
+        
+        double originalSeconds = 0.0;
+        double contractedSeconds = 0.0;
+        uint64_t originalSettled = 0;
+        uint64_t contractedSettled = 0;
+        size_t foundCount = 0;
+        size_t failures = 0;
+        for (OptimizationMode mode : modes) {
+            for (size_t query = 0; query < queryCount; ++query) {
+                const std::string& source = junctions[pick(random)];
+                const std::string& destination = junctions[pick(random)];
+                
+                auto startTime = std::chrono::steady_clock::now();
+                graph::PathResult expected = originalFinder.findShortestPath(source, destination, mode);
+                originalSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                startTime = std::chrono::steady_clock::now();
+                graph::PathResult answer = contractedFinder.findShortestPath(source, destination, mode);
+                contractedSeconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - startTime).count();
+                originalSettled += expected.getStats().nodesSettled;
+                contractedSettled += answer.getStats().nodesSettled;
+                foundCount += expected.isFound();
+                
+                std::string problem = check(compact, expected, answer, source, destination, mode);
+                if (!problem.empty() && failures++ < MAX_REPORTED_FAILURES) {
+                    std::cout << "FAIL " << graph::PathFinder::modeName(mode) << " " << source << " -> "
+                              << destination << ": " << problem << std::endl;
+                }
+            }
+        }
+        
+        const size_t totalQueries = queryCount * std::size(modes);
+        const double queries = static_cast<double>(std::max<size_t>(totalQueries, 1));
+        std::cout << foundCount << " of " << totalQueries << " queries have a path" << std::endl;
+        std::cout << std::left << std::setw(12) << "graph" << std::right << std::setw(14) << "mean (us)"
+                  << std::setw(16) << "nodes settled" << std::endl;
+        std::cout << std::left << std::setw(12) << "original" << std::right << std::setprecision(1)
+                  << std::setw(14) << originalSeconds * 1e6 / queries
+                  << std::setw(16) << static_cast<double>(originalSettled) / queries << std::endl;
+        std::cout << std::left << std::setw(12) << "contracted" << std::right
+                  << std::setw(14) << contractedSeconds * 1e6 / queries
+                  << std::setw(16) << static_cast<double>(contractedSettled) / queries << std::endl;
+        
+        if (failures > 0) {
+            std::cout << failures << " wrong answers" << std::endl;
+            return 1;
+        }
+        std::cout << "The contracted graph agrees with the original" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "graph/ConcurrentGraph.hpp"
+#include "graph/PathFinder.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+std::string nodeId(size_t index) {
+    return "n" + std::to_string(index);
+}
+
+std::string ringEdgeId(size_t from, size_t to) {
+    return "e" + std::to_string(from) + "_" + std::to_string(to);
+}
+
+/**
+ * @brief Check that a snapshot's edge index, outgoing edge lists and counts agree.
+ * @return Number of inconsistencies found
+ */
+size_t checkSnapshot(const graph::GraphSnapshot& snapshot) {
+    size_t problems = 0;
+    size_t edges = 0;
+    for (const auto& node : snapshot.getAllNodes()) {
+        for (const auto& edge : snapshot.getOutgoingEdges(node->getId())) {
+            ++edges;
+            if (snapshot.getEdge(edge->getId()) != edge || !snapshot.getNode(edge->getDestination()->getId())) {
+                ++problems;
+            }
+        }
+    }
+    return problems + (edges != snapshot.getEdgeCount()) + (snapshot.getAllEdges().size() != edges);
+}
+
+} // namespace
+
+/**
+ * @brief Stress test of ConcurrentGraph: readers search and check snapshots while a writer edits.
+ * 
+ * Starts from an empty graph, so the node and edge blocks are split several
+ * times while readers hold snapshots. The writer first builds a ring of
+ * `nodes` nodes, each linked both ways to its next and twentieth neighbour,
+ * one update per node, then makes `edits` random edits: reweighting, adding
+ * a node with two edges, removing an added node, or removing a ring edge.
+ * Every reader repeatedly pins a snapshot, checks that its edge index,
+ * outgoing edge lists and counts agree, and runs a PathFinder query on it.
+ * Exits with 1 if any snapshot was inconsistent.
+ * 
+ * Build with -fsanitize=thread (or address) to check the reclamation of
+ * replaced versions as well.
+ * 
+ * Usage: concurrent_graph_stress [nodes] [edits] [readers] [seed]
+ */
+int main(int argc, char* argv[]) {
+    const size_t nodeCount = std::max<size_t>(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000, 21);
+    const size_t editCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 3000;
+    const size_t readerCount = std::max<size_t>(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 3, 1);
+    const uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 42;
+    
+    graph::ConcurrentGraph graph;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> queries{0};
+    std::atomic<size_t> problems{0};
+    
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < readerCount; ++reader) {
+        readers.emplace_back([&, reader] {
+            std::mt19937_64 random(seed + reader + 1);
+            while (!stop.load()) {
+                auto snapshot = graph.read();
+                problems += checkSnapshot(*snapshot);
+                if (snapshot->getNodeCount() > 0) {
+                    auto nodes = snapshot->getAllNodes();
+                    graph::PathFinder finder(*snapshot);
+                    finder.findShortestPath(nodes[random() % nodes.size()]->getId(),
+                                            nodes[random() % nodes.size()]->getId());
+                }
+                ++queries;
+            }
+        });
+    }
+    
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<graph::NodePtr> ring;
+    for (size_t i = 0; i < nodeCount; ++i) {
+        ring.push_back(std::make_shared<graph::Node>(nodeId(i)));
+        graph.addNode(ring.back());
+    }
+    for (size_t i = 0; i < nodeCount; ++i) {
+        graph.update([&](graph::ConcurrentGraph::Batch& batch) {
+            for (size_t step : {size_t{1}, size_t{20}}) {
+                const size_t j = (i + step) % nodeCount;
+                batch.addEdge(std::make_shared<graph::Edge>(ringEdgeId(i, j), ring[i], ring[j], 1.0));
+                batch.addEdge(std::make_shared<graph::Edge>(ringEdgeId(j, i), ring[j], ring[i], 1.0));
+            }
+        });
+    }
+    
+    std::mt19937_64 random(seed);
+    size_t added = 0;
+    for (size_t edit = 0; edit < editCount; ++edit) {
+        const size_t i = random() % nodeCount;
+        switch (random() % 4) {
+            case 0: {
+                auto edge = graph.read()->getEdge(ringEdgeId(i, (i + 1) % nodeCount));
+                if (edge) {
+                    graph.replaceEdge(std::make_shared<graph::Edge>(edge->getId(), edge->getSource(),
+                                                                    edge->getDestination(),
+                                                                    0.5 + static_cast<double>(random() % 100) / 50.0));
+                }
+                break;
+            }
+            case 1: {
+                const std::string id = nodeId(nodeCount + added++);
+                const graph::NodePtr& neighbour = ring[i];
+                graph.update([&](graph::ConcurrentGraph::Batch& batch) {
+                    auto node = std::make_shared<graph::Node>(id);
+                    batch.addNode(node);
+                    batch.addEdge(std::make_shared<graph::Edge>("x" + id, neighbour, node, 1.0));
+                    batch.addEdge(std::make_shared<graph::Edge>("y" + id, node, neighbour, 1.0));
+                });
+                break;
+            }
+            case 2:
+                if (added > 0) {
+                    graph.removeNode(nodeId(nodeCount + random() % added));
+                }
+                break;
+            default:
+                graph.removeEdge(ringEdgeId(i, (i + 20) % nodeCount));
+                break;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    problems += checkSnapshot(*graph.read());
+    graph.reclaim();
+    
+    auto snapshot = graph.read();
+    std::cout << "version " << graph.getVersion() << " in " << seconds << " s: " << snapshot->getNodeCount()
+              << " nodes, " << snapshot->getEdgeCount() << " edges; " << queries.load() << " reader queries, "
+              << graph.getRetiredCount() << " versions left unreclaimed" << std::endl;
+    if (problems.load() > 0) {
+        std::cout << problems.load() << " inconsistencies" << std::endl;
+        return 1;
+    }
+    std::cout << "Every snapshot was consistent" << std::endl;
+    return 0;
+}
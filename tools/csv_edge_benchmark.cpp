@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "data/CsvEdgeLoader.hpp"
+#include "data/BinaryGraphHandler.hpp"
+#include "data/LoadStats.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+/**
+ * @brief Write a random edge list with about one node per eight edges.
+ */
+bool generateEdgeList(uint64_t edgeCount, const std::string& filePath) {
+    std::ofstream out(filePath, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+    
+    std::mt19937_64 random(42);
+    const uint64_t nodeCount = std::max<uint64_t>(edgeCount / 8, 2);
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    buffer += "source,destination,distance,time,cost\n";
+    char line[96];
+    for (uint64_t i = 0; i < edgeCount; ++i) {
+        uint64_t source = random() % nodeCount;
+        uint64_t target = (source + 1 + random() % 64) % nodeCount;
+        double distance = 0.1 + static_cast<double>(random() % 50000) / 1000.0;
+        int length = std::snprintf(line, sizeof(line), "N%llu,N%llu,%.3f,%.4f,%.2f\n",
+                                   static_cast<unsigned long long>(source), static_cast<unsigned long long>(target),
+                                   distance, distance / 40.0, distance * 0.15);
+        buffer.append(line, static_cast<size_t>(length));
+        if (buffer.size() > (1 << 20) - 64) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+/**
+ * @brief Measures CSV edge-list loading throughput in edges per second.
+ * 
+ * Loads the same file at 1, 2, 4, ... threads, keeps the best of several
+ * repetitions and checks that every thread count produces the same graph as
+ * the single-threaded load. `--generate` writes a synthetic input first.
+ * 
+ * Usage: csv_edge_benchmark <edges.csv> [max_threads] [repetitions]
+ *        csv_edge_benchmark --generate <edge_count> <edges.csv>
+ */
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && std::string(argv[1]) == "--generate") {
+        uint64_t edgeCount = std::strtoull(argv[2], nullptr, 10);
+        if (!generateEdgeList(edgeCount, argv[3])) {
+            std::cerr << "Failed to write " << argv[3] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <edges.csv> [max_threads] [repetitions]\n"
+                  << "       " << argv[0] << " --generate <edge_count> <edges.csv>" << std::endl;
+        return 1;
+    }
+    
+    const std::string filePath = argv[1];
+    unsigned maxThreads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2]))
+                                     : std::max(1u, std::thread::hardware_concurrency());
+    int repetitions = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 3;
+    
+    try {
+        std::cout << std::left << std::setw(10) << "threads" << std::setw(12) << "seconds"
+                  << std::setw(14) << "Medges/s" << std::setw(12) << "MB/s"
+                  << std::setw(10) << "speedup" << "peak RSS MiB" << std::endl;
+        
+        uint64_t expectedHash = 0;
+        double baseSeconds = 0.0;
+        for (unsigned threads = 1; threads <= std::min(maxThreads, 64u); threads *= 2) {
+            double bestSeconds = 0.0;
+            data::CsvEdgeLoader loader(threads);
+            for (int rep = 0; rep < repetitions; ++rep) {
+                auto startTime = std::chrono::steady_clock::now();
+                auto graph = loader.load(filePath);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                
+                uint64_t hash = data::BinaryGraphHandler::computeContentHash(graph);
+                if (threads == 1 && rep == 0) {
+                    expectedHash = hash;
+                    std::cout << "nodes: " << loader.getNodesLoaded() << ", edges: " << loader.getEdgesLoaded()
+                              << std::endl;
+                }
+                if (hash != expectedHash) {
+                    std::cerr << "Graph loaded with " << threads
+                              << " threads differs from the reference load" << std::endl;
+                    return 1;
+                }
+                if (rep == 0 || seconds < bestSeconds) {
+                    bestSeconds = seconds;
+                }
+            }
+            if (threads == 1) {
+                baseSeconds = bestSeconds;
+            }
+            
+            std::cout << std::fixed << std::setprecision(3) << std::left
+                      << std::setw(10) << threads << std::setw(12) << bestSeconds
+                      << std::setw(14) << loader.getEdgesLoaded() / 1e6 / bestSeconds
+                      << std::setw(12) << (loader.getBytesRead() / (1024.0 * 1024.0)) / bestSeconds
+                      << std::setw(10) << baseSeconds / bestSeconds
+                      << data::LoadStats::queryPeakRssBytes() / (1024.0 * 1024.0) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,828 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "data/BinaryGraphHandler.hpp"
+#include "data/LoadStats.hpp"
+#include "geo/GeoCoordinate.hpp"
+#include "graph/CompactGraph.hpp"
+#include "travel/Transport.hpp"
+#include "util/Parallel.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+
+constexpr double KM_PER_DEGREE = 111.2;
+
+/**
+ * @brief An edge leaving the node it was generated for.
+ */
+struct OutEdge {
+    Index target;
+    double distance; ///< Kilometres
+    double time;     ///< Hours
+    double cost;     ///< Currency units
+    uint8_t mode;
+};
+
+uint8_t modeTag(travel::TransportMode mode) {
+    return static_cast<uint8_t>(mode);
+}
+
+/**
+ * @brief splitmix64 finalizer.
+ */
+uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @class GraphGenerator
+ * @brief A family of synthetic graphs, generated one node at a time.
+ * 
+ * Every random choice is a hash of the seed and the nodes it concerns, so a
+ * node's coordinate and outgoing edges can be produced on any thread, in any
+ * order and as often as needed, and are always the same for the same seed.
+ * Choices about an undirected link hash the smaller endpoint first, so both
+ * directions agree on whether the link exists and on its length.
+ */
+class GraphGenerator {
+public:
+    explicit GraphGenerator(uint64_t seed) : seed_(seed) {}
+    virtual ~GraphGenerator() = default;
+    
+    virtual size_t getNodeCount() const = 0;
+    
+    /**
+     * @brief Get the letter that starts every node ID.
+     */
+    virtual char getIdPrefix() const = 0;
+    
+    /**
+     * @brief Check whether edges carry transport mode tags.
+     */
+    virtual bool hasModes() const { return true; }
+    
+    virtual void getCoordinate(Index node, double& latitude, double& longitude) const = 0;
+    
+    /**
+     * @brief Append the edges leaving a node.
+     */
+    virtual void getEdges(Index node, std::vector<OutEdge>& edges) const = 0;
+
+protected:
+    /**
+     * @brief Get a uniform number in [0, 1) for a purpose (salt) and up to two nodes.
+     */
+    double random(uint64_t salt, uint64_t a, uint64_t b = 0) const {
+        uint64_t hash = mix(mix(mix(seed_ ^ (salt << 56)) + a) + b);
+        return static_cast<double>(hash >> 11) * 0x1.0p-53;
+    }
+    
+    /**
+     * @brief Same as random(), but the same for (a, b) and (b, a).
+     */
+    double randomLink(uint64_t salt, uint64_t a, uint64_t b) const {
+        return random(salt, std::min(a, b), std::max(a, b));
+    }
+    
+    double distanceBetween(Index a, Index b) const {
+        double latA, lonA, latB, lonB;
+        getCoordinate(a, latA, lonA);
+        getCoordinate(b, latB, lonB);
+        return geo::GeoCoordinate(latA, lonA).distanceTo(geo::GeoCoordinate(latB, lonB));
+    }
+    
+    /**
+     * @brief Get the coordinate of a point on a street grid with about 150 m blocks.
+     * 
+     * Intersections are moved by up to a third of a block, so streets are not
+     * perfectly straight. The grid starts in the American Midwest and grows
+     * north and east.
+     */
+    void gridCoordinate(size_t x, size_t y, uint64_t point, double& latitude, double& longitude) const {
+        constexpr double BLOCK_KM = 0.15;
+        constexpr double ORIGIN_LATITUDE = 36.0;
+        constexpr double ORIGIN_LONGITUDE = -100.0;
+        static const double blockLongitude = BLOCK_KM / (KM_PER_DEGREE * std::cos(ORIGIN_LATITUDE * M_PI / 180.0));
+        latitude = ORIGIN_LATITUDE + (static_cast<double>(y) + (random(1, point) - 0.5) * 0.66) *
+                   (BLOCK_KM / KM_PER_DEGREE);
+        longitude = ORIGIN_LONGITUDE + (static_cast<double>(x) + (random(2, point) - 0.5) * 0.66) * blockLongitude;
+    }
+    
+    uint64_t seed_;
+};
+
+/**
+ * @class RoadGenerator
+ * @brief Perturbed street grid with a road hierarchy.
+ * 
+ * Every eighth row and column is an arterial road and every 64th a motorway;
+ * the rest are local streets, 8% of whose blocks are missing. Driving times
+ * follow the road class, differ by direction with congestion, and motorways
+ * charge a toll on top of the running cost.
+ */
+class RoadGenerator : public GraphGenerator {
+public:
+    RoadGenerator(size_t nodeCount, uint64_t seed)
+        : GraphGenerator(seed), nodeCount_(nodeCount),
+          width_(static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodeCount))))) {}
+    
+    size_t getNodeCount() const override { return nodeCount_; }
+    char getIdPrefix() const override { return 'r'; }
+    
+    void getCoordinate(Index node, double& latitude, double& longitude) const override {
+        gridCoordinate(node % width_, node / width_, node, latitude, longitude);
+    }
+    
+    void getEdges(Index node, std::vector<OutEdge>& edges) const override {
+        static const double SPEEDS[] = {30.0, 60.0, 110.0}; // km/h by road class
+        const size_t x = node % width_;
+        const size_t y = node / width_;
+        const long steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        for (const auto& step : steps) {
+            if ((step[0] < 0 && x == 0) || (step[1] < 0 && y == 0) || (step[0] > 0 && x + 1 >= width_)) {
+                continue;
+            }
+            const size_t neighbour = (y + step[1]) * width_ + (x + step[0]);
+            if (neighbour >= nodeCount_) {
+                continue;
+            }
+            const Index target = static_cast<Index>(neighbour);
+            const int roadClass = classOf(step[1] == 0 ? y : x);
+            if (roadClass == 0 && randomLink(3, node, target) < 0.08) {
+                continue; // Missing block
+            }
+            double distance = distanceBetween(node, target) * (1.0 + 0.25 * randomLink(4, node, target));
+            double congestion = 1.0 + 0.4 * random(5, node, target);
+            double cost = distance * 0.12 + (roadClass == 2 ? distance * 0.06 : 0.0);
+            edges.push_back({target, distance, distance / SPEEDS[roadClass] * congestion, cost,
+                             modeTag(travel::TransportMode::DRIVING)});
+        }
+    }
+
+private:
+    size_t nodeCount_;
+    size_t width_;
+    
+    static int classOf(size_t line) {
+        return line % 64 == 0 ? 2 : line % 8 == 0 ? 1 : 0;
+    }
+};
+
+/**
+ * @class GeometricGenerator
+ * @brief Random geometric graph: random points linked to every point within 500 m.
+ * 
+ * Points are spread evenly over square cells 500 m wide, two per cell, at
+ * random positions inside their cell, so the neighbours of a point lie in the
+ * 3 x 3 cells around it and the average degree is a little over six.
+ */
+class GeometricGenerator : public GraphGenerator {
+public:
+    GeometricGenerator(size_t nodeCount, uint64_t seed)
+        : GraphGenerator(seed), nodeCount_(nodeCount),
+          side_(std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(nodeCount) / 2.0)))) {
+        // Cells are at least RADIUS_KM wide even at the northern edge
+        const double northLatitude = ORIGIN_LATITUDE + static_cast<double>(side_) * RADIUS_KM / KM_PER_DEGREE;
+        cellLongitude_ = RADIUS_KM / (KM_PER_DEGREE * std::cos(std::min(northLatitude, 80.0) * M_PI / 180.0));
+    }
+    
+    size_t getNodeCount() const override { return nodeCount_; }
+    char getIdPrefix() const override { return 'g'; }
+    bool hasModes() const override { return false; }
+    
+    void getCoordinate(Index node, double& latitude, double& longitude) const override {
+        const size_t cell = cellOf(node);
+        latitude = ORIGIN_LATITUDE + (static_cast<double>(cell / side_) + random(1, node)) * (RADIUS_KM / KM_PER_DEGREE);
+        longitude = ORIGIN_LONGITUDE + (static_cast<double>(cell % side_) + random(2, node)) * cellLongitude_;
+    }
+    
+    void getEdges(Index node, std::vector<OutEdge>& edges) const override {
+        const size_t cell = cellOf(node);
+        const size_t cellX = cell % side_;
+        const size_t cellY = cell / side_;
+        for (size_t y = cellY > 0 ? cellY - 1 : 0; y <= std::min(cellY + 1, side_ - 1); ++y) {
+            for (size_t x = cellX > 0 ? cellX - 1 : 0; x <= std::min(cellX + 1, side_ - 1); ++x) {
+                const size_t neighbourCell = y * side_ + x;
+                for (size_t other = firstNode(neighbourCell); other < firstNode(neighbourCell + 1); ++other) {
+                    const Index target = static_cast<Index>(other);
+                    if (target == node) {
+                        continue;
+                    }
+                    const double straight = distanceBetween(node, target);
+                    if (straight >= RADIUS_KM) {
+                        continue;
+                    }
+                    double distance = straight * (1.0 + 0.3 * randomLink(3, node, target));
+                    double speed = 15.0 + 45.0 * randomLink(4, node, target);
+                    edges.push_back({target, distance, distance / speed, distance * 0.1, graph::CompactGraph::NO_MODE});
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr double RADIUS_KM = 0.5;
+    static constexpr double ORIGIN_LATITUDE = 20.0;
+    static constexpr double ORIGIN_LONGITUDE = 75.0;
+    
+    size_t nodeCount_;
+    size_t side_;
+    double cellLongitude_;
+    
+    size_t cellCount() const { return side_ * side_; }
+    
+    /**
+     * @brief Get the first node of a cell; cell c holds [firstNode(c), firstNode(c + 1)).
+     */
+    size_t firstNode(size_t cell) const {
+        return cell * nodeCount_ / cellCount(); // Fits in 64 bits: node counts are below 2^32
+    }
+    
+    size_t cellOf(size_t node) const {
+        size_t cell = node * cellCount() / nodeCount_;
+        while (firstNode(cell + 1) <= node) {
+            ++cell;
+        }
+        while (firstNode(cell) > node) {
+            --cell;
+        }
+        return cell;
+    }
+};
+
+/**
+ * @class AirlineGenerator
+ * @brief Scale-free hub-and-spoke airline network.
+ * 
+ * One node in 64 is a hub airport; the rest are regional airports, each
+ * served by a single hub. Hub catchments follow a Zipf distribution, so hub
+ * degrees are heavy-tailed. The 16 largest hubs fly to each other, and every
+ * other hub flies to its two nearest large hubs. Regional airports lie within
+ * a few hundred kilometres of their hub.
+ */
+class AirlineGenerator : public GraphGenerator {
+public:
+    AirlineGenerator(size_t nodeCount, uint64_t seed)
+        : GraphGenerator(seed), nodeCount_(nodeCount),
+          hubCount_(std::clamp<size_t>(nodeCount / 64, 2, nodeCount)),
+          globalHubCount_(std::min<size_t>(hubCount_, 16)) {
+        // Catchment sizes: hub r serves a share proportional to 1 / (r + 1)^1.1
+        const size_t spokeCount = nodeCount_ - hubCount_;
+        std::vector<double> weights(hubCount_);
+        for (size_t hub = 0; hub < hubCount_; ++hub) {
+            weights[hub] = 1.0 / std::pow(static_cast<double>(hub + 1), 1.1);
+        }
+        const double totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+        firstSpoke_.resize(hubCount_ + 1);
+        double cumulative = 0.0;
+        for (size_t hub = 0; hub < hubCount_; ++hub) {
+            firstSpoke_[hub] = hubCount_ + static_cast<size_t>(spokeCount * (cumulative / totalWeight));
+            cumulative += weights[hub];
+        }
+        firstSpoke_[hubCount_] = nodeCount_;
+        
+        hubLatitudes_.resize(hubCount_);
+        hubLongitudes_.resize(hubCount_);
+        for (size_t hub = 0; hub < hubCount_; ++hub) {
+            hubLatitudes_[hub] = -40.0 + 100.0 * random(1, hub);
+            hubLongitudes_[hub] = -180.0 + 360.0 * random(2, hub);
+        }
+        
+        // Link every smaller hub to its two nearest global hubs, in both directions
+        hubLinks_.resize(hubCount_);
+        for (size_t hub = globalHubCount_; hub < hubCount_; ++hub) {
+            std::vector<std::pair<double, size_t>> byDistance;
+            for (size_t global = 0; global < globalHubCount_; ++global) {
+                byDistance.emplace_back(distanceBetween(static_cast<Index>(hub), static_cast<Index>(global)), global);
+            }
+            std::partial_sort(byDistance.begin(), byDistance.begin() + std::min<size_t>(2, byDistance.size()),
+                              byDistance.end());
+            for (size_t i = 0; i < std::min<size_t>(2, byDistance.size()); ++i) {
+                hubLinks_[hub].push_back(static_cast<Index>(byDistance[i].second));
+                hubLinks_[byDistance[i].second].push_back(static_cast<Index>(hub));
+            }
+        }
+        for (size_t global = 0; global < globalHubCount_; ++global) {
+            for (size_t other = 0; other < globalHubCount_; ++other) {
+                if (other != global) {
+                    hubLinks_[global].push_back(static_cast<Index>(other));
+                }
+            }
+        }
+    }
+    
+    size_t getNodeCount() const override { return nodeCount_; }
+    char getIdPrefix() const override { return 'a'; }
+    
+    void getCoordinate(Index node, double& latitude, double& longitude) const override {
+        if (node < hubCount_) {
+            latitude = hubLatitudes_[node];
+            longitude = hubLongitudes_[node];
+            return;
+        }
+        const size_t hub = hubOf(node);
+        latitude = std::clamp(hubLatitudes_[hub] + (random(1, node) - 0.5) * 8.0, -85.0, 85.0);
+        longitude = hubLongitudes_[hub] + (random(2, node) - 0.5) * 12.0;
+        if (longitude >= 180.0) {
+            longitude -= 360.0;
+        } else if (longitude < -180.0) {
+            longitude += 360.0;
+        }
+    }
+    
+    void getEdges(Index node, std::vector<OutEdge>& edges) const override {
+        const uint8_t flight = modeTag(travel::TransportMode::FLIGHT);
+        if (node >= hubCount_) {
+            const Index hub = static_cast<Index>(hubOf(node));
+            double distance = distanceBetween(node, hub);
+            edges.push_back({hub, distance, 0.6 + distance / 550.0, 60.0 + 0.12 * distance, flight});
+            return;
+        }
+        for (Index other : hubLinks_[node]) {
+            double distance = distanceBetween(node, other);
+            edges.push_back({other, distance, 0.75 + distance / 800.0, 30.0 + 0.06 * distance, flight});
+        }
+        for (size_t spoke = firstSpoke_[node]; spoke < firstSpoke_[node + 1]; ++spoke) {
+            double distance = distanceBetween(node, static_cast<Index>(spoke));
+            edges.push_back({static_cast<Index>(spoke), distance, 0.6 + distance / 550.0, 60.0 + 0.12 * distance,
+                             flight});
+        }
+    }
+
+private:
+    size_t nodeCount_;
+    size_t hubCount_;
+    size_t globalHubCount_;
+    std::vector<size_t> firstSpoke_; ///< Hub r serves airports [firstSpoke_[r], firstSpoke_[r + 1])
+    std::vector<double> hubLatitudes_;
+    std::vector<double> hubLongitudes_;
+    std::vector<std::vector<Index>> hubLinks_;
+    
+    size_t hubOf(size_t spoke) const {
+        return static_cast<size_t>(std::upper_bound(firstSpoke_.begin(), firstSpoke_.end(), spoke) -
+                                   firstSpoke_.begin()) - 1;
+    }
+};
+
+/**
+ * @brief Stops on a square grid of lines: every `lineSpacing`-th row and
+ *        column is a line, with a stop every `stopSpacing` grid points.
+ * 
+ * Stops are numbered row by row. lineSpacing must be a multiple of stopSpacing.
+ */
+struct LineGrid {
+    size_t width;
+    size_t height;
+    size_t lineSpacing;
+    size_t stopSpacing;
+    
+    bool contains(size_t x, size_t y) const {
+        return (y % lineSpacing == 0 && x % stopSpacing == 0) || (x % lineSpacing == 0 && y % stopSpacing == 0);
+    }
+    
+    /**
+     * @brief Get the number of stops in the rows before y.
+     */
+    size_t stopsBefore(size_t y) const {
+        const size_t lineRows = (y + lineSpacing - 1) / lineSpacing;
+        const size_t crossingRows = (y + stopSpacing - 1) / stopSpacing - lineRows;
+        return lineRows * ((width - 1) / stopSpacing + 1) + crossingRows * ((width - 1) / lineSpacing + 1);
+    }
+    
+    size_t size() const { return stopsBefore(height); }
+    
+    size_t indexOf(size_t x, size_t y) const {
+        return stopsBefore(y) + (y % lineSpacing == 0 ? x / stopSpacing : x / lineSpacing);
+    }
+    
+    void positionOf(size_t index, size_t& x, size_t& y) const {
+        size_t low = 0;
+        size_t high = height;
+        while (high - low > 1) {
+            size_t middle = (low + high) / 2;
+            if (stopsBefore(middle) <= index) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        y = low;
+        const size_t rank = index - stopsBefore(y);
+        x = y % lineSpacing == 0 ? rank * stopSpacing : rank * lineSpacing;
+    }
+};
+
+/**
+ * @class MultimodalGenerator
+ * @brief Layered city: a walking street grid with bus and rail networks on top.
+ * 
+ * Buses run along every eighth street with a stop every second block; trains
+ * along every 32nd with a station every eighth block. Boarding costs the fare
+ * and an average wait, leaving is a short walk, and each layer has its own
+ * speed and dwell time, so the time and cost modes favour different layers.
+ */
+class MultimodalGenerator : public GraphGenerator {
+public:
+    MultimodalGenerator(size_t nodeCount, uint64_t seed) : GraphGenerator(seed) {
+        // The bus and rail layers add about 11.6% to the street nodes
+        const size_t side = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(nodeCount) / 1.1162)));
+        layers_[0] = {side, side, 1, 1};
+        layers_[1] = {side, side, 8, 2};
+        layers_[2] = {side, side, 32, 8};
+        firstNode_[0] = 0;
+        for (int layer = 0; layer < 3; ++layer) {
+            firstNode_[layer + 1] = firstNode_[layer] + layers_[layer].size();
+        }
+    }
+    
+    size_t getNodeCount() const override { return firstNode_[3]; }
+    char getIdPrefix() const override { return 'm'; }
+    
+    void getCoordinate(Index node, double& latitude, double& longitude) const override {
+        size_t x, y;
+        locate(node, x, y);
+        gridCoordinate(x, y, streetNode(x, y), latitude, longitude);
+    }
+    
+    void getEdges(Index node, std::vector<OutEdge>& edges) const override {
+        struct Layer {
+            double speed;       ///< km/h
+            double dwell;       ///< Hours per stop
+            double costPerKm;
+            double boardingWait; ///< Hours
+            double fare;
+            travel::TransportMode mode;
+        };
+        static const Layer LAYERS[3] = {
+            {5.0, 0.0, 0.0, 0.0, 0.0, travel::TransportMode::WALKING},
+            {22.0, 0.008, 0.02, 0.08, 1.5, travel::TransportMode::PUBLIC_BUS},
+            {70.0, 0.015, 0.05, 0.067, 2.5, travel::TransportMode::TRAIN}
+        };
+        const uint8_t walking = modeTag(travel::TransportMode::WALKING);
+        
+        size_t x, y;
+        const int layer = locate(node, x, y);
+        const LineGrid& grid = layers_[layer];
+        const Layer& kind = LAYERS[layer];
+        
+        // Along the lines of this layer
+        const size_t step = grid.stopSpacing;
+        auto ride = [&](size_t nx, size_t ny) {
+            const Index target = static_cast<Index>(firstNode_[layer] + grid.indexOf(nx, ny));
+            double distance = distanceBetween(node, target) * (1.0 + 0.2 * randomLink(3, node, target));
+            edges.push_back({target, distance, distance / kind.speed + kind.dwell, distance * kind.costPerKm,
+                             modeTag(kind.mode)});
+        };
+        if (y % grid.lineSpacing == 0) {
+            if (x >= step) {
+                ride(x - step, y);
+            }
+            if (x + step < grid.width) {
+                ride(x + step, y);
+            }
+        }
+        if (x % grid.lineSpacing == 0) {
+            if (y >= step) {
+                ride(x, y - step);
+            }
+            if (y + step < grid.height) {
+                ride(x, y + step);
+            }
+        }
+        
+        // Transfers: board from the street, or step off onto it
+        if (layer == 0) {
+            for (int vehicle = 1; vehicle < 3; ++vehicle) {
+                if (layers_[vehicle].contains(x, y)) {
+                    const Index stop = static_cast<Index>(firstNode_[vehicle] + layers_[vehicle].indexOf(x, y));
+                    edges.push_back({stop, 0.02, LAYERS[vehicle].boardingWait, LAYERS[vehicle].fare,
+                                     modeTag(LAYERS[vehicle].mode)});
+                }
+            }
+        } else {
+            edges.push_back({static_cast<Index>(streetNode(x, y)), 0.02, 0.01, 0.0, walking});
+        }
+    }
+
+private:
+    LineGrid layers_[3];   ///< Street, bus, rail
+    size_t firstNode_[4];  ///< Layer l holds nodes [firstNode_[l], firstNode_[l + 1])
+    
+    size_t streetNode(size_t x, size_t y) const { return y * layers_[0].width + x; }
+    
+    int locate(size_t node, size_t& x, size_t& y) const {
+        int layer = node < firstNode_[1] ? 0 : node < firstNode_[2] ? 1 : 2;
+        layers_[layer].positionOf(node - firstNode_[layer], x, y);
+        return layer;
+    }
+};
+
+/**
+ * @brief Append a node ID: the prefix and the index, zero-padded to a fixed width.
+ * 
+ * The fixed width makes ID order equal index order.
+ */
+void appendNodeId(std::string& out, char prefix, int width, size_t node) {
+    char digits[24];
+    int length = std::snprintf(digits, sizeof(digits), "%c%0*llu", prefix, width,
+                               static_cast<unsigned long long>(node));
+    out.append(digits, static_cast<size_t>(length));
+}
+
+int idWidth(size_t nodeCount) {
+    int width = 1;
+    for (size_t limit = 10; limit < nodeCount; limit *= 10) {
+        ++width;
+    }
+    return width;
+}
+
+/**
+ * @brief Columns of a generated graph, owned by the CompactGraph viewing them.
+ */
+struct GeneratedStorage {
+    std::vector<graph::CompactGraph::EdgeIndex> offsets;
+    std::vector<Index> targets;
+    std::vector<double> distances;
+    std::vector<double> times;
+    std::vector<double> costs;
+    std::vector<uint8_t> modes;
+    std::vector<double> latitudes;
+    std::vector<double> longitudes;
+    std::vector<Index> idOrder;
+    std::vector<uint64_t> nodeIdOffsets;
+    std::string nodeIdChars;
+    std::vector<uint64_t> emptyNodeNames;
+    std::vector<uint64_t> emptyEdgeIds;
+};
+
+/**
+ * @brief Generate a graph straight into CSR columns.
+ * 
+ * One pass counts each node's edges and a second writes them in place, both
+ * in parallel, so the graph is never held twice.
+ */
+graph::CompactGraph generateCompact(const GraphGenerator& generator, unsigned threads) {
+    const size_t nodeCount = generator.getNodeCount();
+    auto storage = std::make_shared<GeneratedStorage>();
+    
+    storage->offsets.assign(nodeCount + 1, 0);
+    util::parallelForRange(nodeCount, threads, [&](size_t begin, size_t end) {
+        std::vector<OutEdge> edges;
+        for (size_t node = begin; node < end; ++node) {
+            edges.clear();
+            generator.getEdges(static_cast<Index>(node), edges);
+            storage->offsets[node + 1] = edges.size();
+        }
+    });
+    std::partial_sum(storage->offsets.begin(), storage->offsets.end(), storage->offsets.begin());
+    const size_t edgeCount = storage->offsets[nodeCount];
+    
+    storage->targets.resize(edgeCount);
+    storage->distances.resize(edgeCount);
+    storage->times.resize(edgeCount);
+    storage->costs.resize(edgeCount);
+    storage->modes.resize(generator.hasModes() ? edgeCount : 0);
+    storage->latitudes.resize(nodeCount);
+    storage->longitudes.resize(nodeCount);
+    const int width = idWidth(nodeCount);
+    const size_t idLength = 1 + static_cast<size_t>(width);
+    storage->nodeIdChars.resize(nodeCount * idLength);
+    util::parallelForRange(nodeCount, threads, [&](size_t begin, size_t end) {
+        std::vector<OutEdge> edges;
+        std::string id;
+        for (size_t node = begin; node < end; ++node) {
+            edges.clear();
+            generator.getEdges(static_cast<Index>(node), edges);
+            size_t position = storage->offsets[node];
+            for (const OutEdge& edge : edges) {
+                storage->targets[position] = edge.target;
+                storage->distances[position] = edge.distance;
+                storage->times[position] = edge.time;
+                storage->costs[position] = edge.cost;
+                if (generator.hasModes()) {
+                    storage->modes[position] = edge.mode;
+                }
+                ++position;
+            }
+            generator.getCoordinate(static_cast<Index>(node), storage->latitudes[node], storage->longitudes[node]);
+            id.clear();
+            appendNodeId(id, generator.getIdPrefix(), width, node);
+            std::copy(id.begin(), id.end(), storage->nodeIdChars.begin() + node * idLength);
+        }
+    });
+    
+    storage->nodeIdOffsets.resize(nodeCount + 1);
+    for (size_t node = 0; node <= nodeCount; ++node) {
+        storage->nodeIdOffsets[node] = node * idLength;
+    }
+    storage->idOrder.resize(nodeCount);
+    std::iota(storage->idOrder.begin(), storage->idOrder.end(), 0);
+    storage->emptyNodeNames.assign(nodeCount + 1, 0);
+    storage->emptyEdgeIds.assign(edgeCount + 1, 0);
+    
+    graph::CompactGraph::Columns columns;
+    columns.nodeCount = nodeCount;
+    columns.edgeCount = edgeCount;
+    columns.offsets = storage->offsets.data();
+    columns.targets = storage->targets.data();
+    columns.distances = storage->distances.data();
+    columns.times = storage->times.data();
+    columns.costs = storage->costs.data();
+    columns.modes = generator.hasModes() ? storage->modes.data() : nullptr;
+    columns.latitudes = storage->latitudes.data();
+    columns.longitudes = storage->longitudes.data();
+    columns.idOrder = storage->idOrder.data();
+    columns.nodeIds = {storage->nodeIdOffsets.data(), storage->nodeIdChars.data()};
+    columns.nodeNames = {storage->emptyNodeNames.data(), ""};
+    columns.edgeIds = {storage->emptyEdgeIds.data(), ""};
+    return graph::CompactGraph(columns, std::move(storage));
+}
+
+/**
+ * @brief Stream a graph as a CSV edge list in constant memory.
+ * 
+ * Blocks of nodes are formatted in parallel and written in node order.
+ * Coordinates and modes have no column in the format and are left out.
+ * 
+ * @param edgeCount Set to the number of edges written
+ * @return True if the whole file was written
+ */
+bool writeCsv(const GraphGenerator& generator, const std::string& filePath, unsigned threads, size_t& edgeCount) {
+    constexpr size_t BLOCK_NODES = 4096;
+    std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "source,destination,distance,time,cost\n";
+    
+    const size_t nodeCount = generator.getNodeCount();
+    const int width = idWidth(nodeCount);
+    const size_t blockCount = (nodeCount + BLOCK_NODES - 1) / BLOCK_NODES;
+    const size_t blocksPerRound = static_cast<size_t>(threads) * 4;
+    std::vector<std::string> blocks(blocksPerRound);
+    std::vector<size_t> blockEdges(blocksPerRound);
+    edgeCount = 0;
+    for (size_t first = 0; first < blockCount; first += blocksPerRound) {
+        const size_t count = std::min(blocksPerRound, blockCount - first);
+        util::parallelForEach(count, threads, [&](size_t item, unsigned) {
+            std::string& text = blocks[item];
+            text.clear();
+            blockEdges[item] = 0;
+            std::vector<OutEdge> edges;
+            std::string source;
+            char numbers[96];
+            const size_t begin = (first + item) * BLOCK_NODES;
+            const size_t end = std::min(begin + BLOCK_NODES, nodeCount);
+            for (size_t node = begin; node < end; ++node) {
+                edges.clear();
+                generator.getEdges(static_cast<Index>(node), edges);
+                source.clear();
+                appendNodeId(source, generator.getIdPrefix(), width, node);
+                for (const OutEdge& edge : edges) {
+                    text += source;
+                    text += ',';
+                    appendNodeId(text, generator.getIdPrefix(), width, edge.target);
+                    int length = std::snprintf(numbers, sizeof(numbers), ",%.4f,%.6f,%.4f\n",
+                                               edge.distance, edge.time, edge.cost);
+                    text.append(numbers, static_cast<size_t>(length));
+                }
+                blockEdges[item] += edges.size();
+            }
+        });
+        for (size_t item = 0; item < count; ++item) {
+            out.write(blocks[item].data(), static_cast<std::streamsize>(blocks[item].size()));
+            edgeCount += blockEdges[item];
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    return static_cast<bool>(out.flush());
+}
+
+/**
+ * @brief Parse a count with an optional K, M or G suffix (powers of 1000).
+ * @return 0 if the text is not a count
+ */
+size_t parseCount(const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    std::string suffix(end);
+    double scale = suffix.empty() ? 1.0 : suffix == "K" || suffix == "k" ? 1e3
+                 : suffix == "M" || suffix == "m" ? 1e6 : suffix == "G" || suffix == "g" ? 1e9 : 0.0;
+    return value > 0.0 ? static_cast<size_t>(value * scale) : 0;
+}
+
+} // namespace
+
+/**
+ * @brief Generates synthetic graphs for scale testing.
+ * 
+ * Families:
+ * - road: perturbed street grid with arterials and motorways (RoadGenerator)
+ * - geometric: random points linked within 500 m (GeometricGenerator)
+ * - airline: scale-free hub-and-spoke flights (AirlineGenerator)
+ * - multimodal: streets, buses and trains with transfers (MultimodalGenerator)
+ * 
+ * Output is a binary graph file, with coordinates and transport modes, or a
+ * CSV edge list for CsvEdgeLoader when the output name ends in ".csv". The
+ * binary graph is built in memory (about 40 bytes per edge and 60 per node);
+ * the CSV is streamed in constant memory. The same family, node count and
+ * seed always give the same graph, whatever the thread count. Road and
+ * airline graphs have exactly the requested node count; the others round it
+ * to fit their grids.
+ * 
+ * Usage: graph_generator <road|geometric|airline|multimodal> <nodes> <output.bin|output.csv>
+ *                        [--seed N] [--threads N]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <road|geometric|airline|multimodal> <nodes> <output.bin|output.csv>"
+                  << " [--seed N] [--threads N]\n"
+                  << "  nodes may use a K, M or G suffix, e.g. 250K or 100M" << std::endl;
+        return 1;
+    }
+    
+    const std::string family = argv[1];
+    const size_t requestedNodes = parseCount(argv[2]);
+    const std::string outputPath = argv[3];
+    uint64_t seed = 42;
+    unsigned threads = 0;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        if (option == "--seed") {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        } else {
+            std::cerr << "Invalid option: " << option << std::endl;
+            return 1;
+        }
+    }
+    threads = util::resolveThreadCount(threads);
+    if (requestedNodes < 16 || requestedNodes >= graph::CompactGraph::INVALID_INDEX) {
+        std::cerr << "Node count must be between 16 and " << graph::CompactGraph::INVALID_INDEX - 1 << std::endl;
+        return 1;
+    }
+    
+    std::unique_ptr<GraphGenerator> generator;
+    if (family == "road") {
+        generator = std::make_unique<RoadGenerator>(requestedNodes, seed);
+    } else if (family == "geometric") {
+        generator = std::make_unique<GeometricGenerator>(requestedNodes, seed);
+    } else if (family == "airline") {
+        generator = std::make_unique<AirlineGenerator>(requestedNodes, seed);
+    } else if (family == "multimodal") {
+        generator = std::make_unique<MultimodalGenerator>(requestedNodes, seed);
+    } else {
+        std::cerr << "Unknown graph family: " << family << std::endl;
+        return 1;
+    }
+    
+    try {
+        auto startTime = std::chrono::steady_clock::now();
+        size_t edgeCount = 0;
+        bool written;
+        const bool csv = outputPath.size() >= 4 && outputPath.compare(outputPath.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            written = writeCsv(*generator, outputPath, threads, edgeCount);
+        } else {
+            graph::CompactGraph graph = generateCompact(*generator, threads);
+            edgeCount = graph.getEdgeCount();
+            written = data::BinaryGraphHandler::writeBinaryGraph(graph, outputPath);
+        }
+        if (!written) {
+            std::cerr << "Failed to write " << outputPath << std::endl;
+            return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        
+        std::cout << "Generated " << family << " graph with " << generator->getNodeCount() << " nodes and "
+                  << edgeCount << " edges (seed " << seed << ") in " << seconds << " s with " << threads
+                  << " threads, peak RSS " << data::LoadStats::queryPeakRssBytes() / (1024 * 1024) << " MiB"
+                  << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
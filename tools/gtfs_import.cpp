@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "data/GtfsImporter.hpp"
+#include "data/BinaryGraphHandler.hpp"
+#include "data/LoadStats.hpp"
+
+using namespace dijkstra;
+
+/**
+ * @brief Imports a GTFS feed directory and writes it as a binary graph file.
+ * 
+ * Prints what was read and built, the throughput and the peak memory use.
+ * The output can be loaded with BinaryGraphHandler::mapBinaryGraph.
+ * 
+ * Usage: gtfs_import <gtfs_dir> <output.bin> [threads] [service_date YYYYMMDD]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <gtfs_dir> <output.bin> [threads] [service_date YYYYMMDD]"
+                  << std::endl;
+        return 1;
+    }
+    
+    const std::string directory = argv[1];
+    const std::string outputPath = argv[2];
+    unsigned threads = (argc > 3) ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+    uint32_t serviceDate = (argc > 4) ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 0;
+    
+    try {
+        auto startTime = std::chrono::steady_clock::now();
+        data::GtfsImporter importer(threads);
+        importer.setServiceDate(serviceDate);
+        auto graph = importer.load(directory);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        
+        std::cout << "stops:           " << importer.getStopsLoaded() << "\n"
+                  << "trips:           " << importer.getTripsLoaded() << "\n"
+                  << "stop_times rows: " << importer.getStopTimesRead() << "\n"
+                  << "connections:     " << importer.getConnectionsBuilt() << "\n"
+                  << "edges:           " << importer.getEdgesBuilt() << "\n"
+                  << "rows skipped:    " << importer.getRowsSkipped() << "\n"
+                  << "threads/ranges:  " << importer.getThreadCount() << "/" << importer.getRangeCount() << "\n"
+                  << "seconds:         " << seconds << "\n"
+                  << "MB/s:            " << (seconds > 0.0 ? importer.getBytesRead() / 1e6 / seconds : 0.0) << "\n"
+                  << "peak RSS MiB:    " << data::LoadStats::queryPeakRssBytes() / (1024.0 * 1024.0) << std::endl;
+        
+        if (!data::BinaryGraphHandler::writeBinaryGraph(graph, outputPath)) {
+            std::cerr << "Failed to write " << outputPath << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data/JsonHandler.hpp"
+#include "data/BinaryGraphHandler.hpp"
+
+using namespace dijkstra;
+
+/**
+ * @brief Measures how JSON graph ingestion scales with the number of threads.
+ * 
+ * Loads the same `nodes`/`edges` file with the sequential SAX loader and then
+ * with the parallel loader at 1, 2, 4, ... threads, checking that every
+ * parallel load produces the same graph as the single-threaded one and the
+ * same node and edge record counts as the sequential loader. (The parallel
+ * loader keeps edges with duplicate IDs, so only the totals are compared.)
+ * 
+ * Usage: ingest_scaling <graph.json> [max_threads] [repetitions]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <graph.json> [max_threads] [repetitions]" << std::endl;
+        return 1;
+    }
+    
+    const std::string filePath = argv[1];
+    unsigned maxThreads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2]))
+                                     : std::max(1u, std::thread::hardware_concurrency());
+    int repetitions = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 3;
+    
+    try {
+        data::LoadStats stats;
+        data::JsonHandler::loadGraphFile(filePath, &stats);
+        std::cout << "sequential SAX: " << stats.toString() << std::endl;
+        const size_t expectedNodes = stats.nodesLoaded;
+        const size_t expectedEdgeRecords = stats.edgesLoaded + stats.edgesSkipped;
+        uint64_t expectedHash = 0;
+        
+        std::cout << std::left << std::setw(10) << "threads" << std::setw(12) << "seconds"
+                  << std::setw(12) << "MB/s" << std::setw(10) << "speedup"
+                  << std::setw(12) << "efficiency" << "peak RSS MiB" << std::endl;
+        
+        double baseSeconds = 0.0;
+        for (unsigned threads = 1; threads <= std::min(maxThreads, 32u); threads *= 2) {
+            double bestSeconds = 0.0;
+            for (int rep = 0; rep < repetitions; ++rep) {
+                auto graph = data::JsonHandler::loadCompactGraphFile(filePath, threads, &stats);
+                uint64_t hash = data::BinaryGraphHandler::computeContentHash(graph);
+                if (threads == 1 && rep == 0) {
+                    expectedHash = hash;
+                }
+                if (hash != expectedHash || graph.getNodeCount() != expectedNodes ||
+                    stats.edgesLoaded + stats.edgesSkipped != expectedEdgeRecords) {
+                    std::cerr << "Graph loaded with " << threads
+                              << " threads differs from the reference load" << std::endl;
+                    return 1;
+                }
+                if (rep == 0 || stats.elapsedSeconds < bestSeconds) {
+                    bestSeconds = stats.elapsedSeconds;
+                }
+            }
+            if (threads == 1) {
+                baseSeconds = bestSeconds;
+            }
+            
+            double speedup = baseSeconds / bestSeconds;
+            std::cout << std::fixed << std::setprecision(3) << std::left
+                      << std::setw(10) << threads << std::setw(12) << bestSeconds
+                      << std::setw(12) << (stats.bytesRead / (1024.0 * 1024.0)) / bestSeconds
+                      << std::setw(10) << speedup << std::setw(12) << speedup / threads
+                      << stats.peakRssBytes / (1024.0 * 1024.0) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,515 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "data/BinaryGraphHandler.hpp"
+#include "data/JsonWriter.hpp"
+#include "graph/ComponentIndex.hpp"
+#include "graph/SpatialIndex.hpp"
+#include "server/QueryHandler.hpp"
+#include "util/Metrics.hpp"
+#include "util/Parallel.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+/**
+ * @brief One client's channel to the system under test; requests are sent one at a time.
+ */
+class Target {
+public:
+    virtual ~Target() = default;
+    
+    /**
+     * @brief Send a request and wait for its response.
+     * @param request JSON request
+     * @return true if the response carries a result, false if it carries an error
+     * @throws std::runtime_error if the connection fails
+     */
+    virtual bool call(const std::string& request) = 0;
+};
+
+/**
+ * @brief Answers requests in process with a QueryHandler of its own.
+ */
+class LocalTarget : public Target {
+public:
+    LocalTarget(const graph::CompactGraph& graph, const graph::ComponentIndex& components) : handler_(graph) {
+        handler_.setComponentIndex(components);
+    }
+    
+    bool call(const std::string& request) override {
+        return handler_.handle(request, response_) == server::QueryHandler::Outcome::ANSWERED;
+    }
+
+private:
+    server::QueryHandler handler_;
+    std::string response_;
+};
+
+/**
+ * @brief A blocking stream socket connection with a read buffer.
+ */
+class SocketTarget : public Target {
+public:
+    ~SocketTarget() override {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+protected:
+    int fd_ = -1;
+    std::string buffer_; ///< Bytes received but not consumed yet
+    
+    void connectTo(int domain, const sockaddr* address, socklen_t length, const std::string& name) {
+        fd_ = socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0 || connect(fd_, address, length) != 0) {
+            throw std::runtime_error("Failed to connect to " + name + ": " + std::strerror(errno));
+        }
+    }
+    
+    void sendAll(const std::string& bytes) {
+        for (size_t sent = 0; sent < bytes.size();) {
+            ssize_t written = send(fd_, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                throw std::runtime_error(std::string("Failed to send a request: ") + std::strerror(errno));
+            }
+            sent += static_cast<size_t>(written);
+        }
+    }
+    
+    /**
+     * @brief Read until the buffer holds a delimiter.
+     * @return Position of the delimiter in the buffer
+     */
+    size_t receiveUntil(const char* delimiter) {
+        size_t searched = 0;
+        for (;;) {
+            size_t found = buffer_.find(delimiter, searched);
+            if (found != std::string::npos) {
+                return found;
+            }
+            searched = buffer_.size() >= std::strlen(delimiter) ? buffer_.size() - std::strlen(delimiter) + 1 : 0;
+            receiveMore();
+        }
+    }
+    
+    void receiveAtLeast(size_t bytes) {
+        while (buffer_.size() < bytes) {
+            receiveMore();
+        }
+    }
+
+private:
+    void receiveMore() {
+        char chunk[1 << 16];
+        ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) {
+            return;
+        }
+        if (received <= 0) {
+            throw std::runtime_error("Failed to read a response: connection closed");
+        }
+        buffer_.append(chunk, static_cast<size_t>(received));
+    }
+};
+
+/**
+ * @brief Client of the server's Unix-domain socket (JSON lines).
+ */
+class UnixTarget : public SocketTarget {
+public:
+    explicit UnixTarget(const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path too long: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        connectTo(AF_UNIX, reinterpret_cast<const sockaddr*>(&address), sizeof(address), path);
+    }
+    
+    bool call(const std::string& request) override {
+        sendAll(request + "\n");
+        size_t end = receiveUntil("\n");
+        bool answered = end > 0 && std::string_view(buffer_.data(), end).find("\"error\":") == std::string_view::npos;
+        buffer_.erase(0, end + 1);
+        return answered;
+    }
+};
+
+/**
+ * @brief Client of the server's HTTP port, using one keep-alive connection.
+ */
+class HttpTarget : public SocketTarget {
+public:
+    explicit HttpTarget(uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        connectTo(AF_INET, reinterpret_cast<const sockaddr*>(&address), sizeof(address),
+                  "127.0.0.1:" + std::to_string(port));
+        int noDelay = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    
+    bool call(const std::string& request) override {
+        sendAll("POST / HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/json\r\nContent-Length: " +
+                std::to_string(request.size()) + "\r\nConnection: keep-alive\r\n\r\n" + request);
+        size_t headEnd = receiveUntil("\r\n\r\n");
+        std::string_view head(buffer_.data(), headEnd);
+        // "HTTP/1.1 200 OK"
+        int status = head.size() > 12 ? std::atoi(std::string(head.substr(9, 3)).c_str()) : 0;
+        size_t contentLength = 0;
+        size_t lengthAt = head.find("Content-Length:");
+        if (lengthAt != std::string_view::npos) {
+            contentLength = std::strtoull(buffer_.c_str() + lengthAt + 15, nullptr, 10);
+        }
+        receiveAtLeast(headEnd + 4 + contentLength);
+        buffer_.erase(0, headEnd + 4 + contentLength);
+        return status == 200;
+    }
+};
+
+std::string routeRequest(std::string_view from, std::string_view to, std::string_view mode) {
+    std::ostringstream out;
+    {
+        data::JsonWriter writer(out);
+        writer.beginObject().member("from", from).member("mode", mode).member("to", to)
+              .member("type", "route").endObject();
+    }
+    return out.str();
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/**
+ * @brief Read a query log.
+ * 
+ * Lines are either JSON requests, sent as they are, or batch queries
+ * (`source,destination[,mode]`, as BatchRunner reads them), sent as route
+ * requests. Blank lines, comments and a header line are skipped.
+ */
+std::vector<std::string> readQueryLog(const std::string& filePath, std::string_view defaultMode) {
+    std::ifstream in(filePath);
+    if (!in) {
+        throw std::runtime_error("Failed to open query log: " + filePath);
+    }
+    std::vector<std::string> requests;
+    std::string line;
+    bool first = true;
+    while (std::getline(in, line)) {
+        std::string_view text = trim(line);
+        bool header = first && (text.rfind("source,", 0) == 0 || text.rfind("from,", 0) == 0);
+        first = false;
+        if (text.empty() || text.front() == '#' || header) {
+            continue;
+        }
+        if (text.front() == '{') {
+            requests.emplace_back(text);
+            continue;
+        }
+        size_t comma = text.find(',');
+        if (comma == std::string_view::npos) {
+            throw std::runtime_error("Failed to parse query log line: " + line);
+        }
+        std::string_view source = trim(text.substr(0, comma));
+        std::string_view rest = text.substr(comma + 1);
+        size_t modeComma = rest.find(',');
+        std::string_view destination = trim(rest.substr(0, modeComma));
+        std::string_view mode = modeComma == std::string_view::npos ? defaultMode : trim(rest.substr(modeComma + 1));
+        requests.push_back(routeRequest(source, destination, mode));
+    }
+    return requests;
+}
+
+/**
+ * @brief Generate route requests whose endpoints cluster around a few cities.
+ * 
+ * Sixteen random nodes act as city centres, weighted by a Zipf law so that a
+ * few cities carry most of the traffic. Endpoints are scattered around their
+ * city with a 5 km spread and snapped to the nearest node. Four trips in five
+ * stay within a city. Without coordinates, endpoints are picked uniformly.
+ */
+std::vector<std::string> syntheticWorkload(const graph::CompactGraph& graph, size_t count, uint64_t seed,
+                                           std::string_view mode) {
+    constexpr size_t CITY_COUNT = 16;
+    constexpr double SPREAD_KM = 5.0;
+    constexpr double LOCAL_SHARE = 0.8;
+    constexpr double KM_PER_DEGREE = 111.2;
+    
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<graph::CompactGraph::Index> anyNode(
+        0, static_cast<graph::CompactGraph::Index>(graph.getNodeCount() - 1));
+    std::vector<std::string> requests;
+    requests.reserve(count);
+    if (!graph.hasCoordinates()) {
+        for (size_t i = 0; i < count; ++i) {
+            requests.push_back(routeRequest(graph.getNodeId(anyNode(random)), graph.getNodeId(anyNode(random)), mode));
+        }
+        return requests;
+    }
+    
+    graph::SpatialIndex spatialIndex = graph::SpatialIndex::build(graph);
+    std::vector<graph::CompactGraph::Index> cities(CITY_COUNT);
+    std::vector<double> weights(CITY_COUNT);
+    for (size_t city = 0; city < CITY_COUNT; ++city) {
+        cities[city] = anyNode(random);
+        weights[city] = 1.0 / static_cast<double>(city + 1);
+    }
+    std::discrete_distribution<size_t> pickCity(weights.begin(), weights.end());
+    std::normal_distribution<double> spread(0.0, SPREAD_KM / KM_PER_DEGREE);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto near = [&](size_t city) {
+        double latitude = std::clamp(graph.getLatitude(cities[city]) + spread(random), -89.0, 89.0);
+        double longitude = graph.getLongitude(cities[city]) +
+                           spread(random) / std::max(0.1, std::cos(latitude * M_PI / 180.0));
+        return spatialIndex.findNearest(graph, latitude, longitude);
+    };
+    for (size_t i = 0; i < count; ++i) {
+        size_t city = pickCity(random);
+        auto source = near(city);
+        auto destination = near(unit(random) < LOCAL_SHARE ? city : pickCity(random));
+        requests.push_back(routeRequest(graph.getNodeId(source), graph.getNodeId(destination), mode));
+    }
+    return requests;
+}
+
+/**
+ * @brief Latencies and errors seen by one client.
+ */
+struct ClientResult {
+    util::LatencyHistogram service;   ///< From sending a request to its response
+    util::LatencyHistogram corrected; ///< From a request's scheduled start to its response
+    util::Counter errors;
+};
+
+void printLatencyRow(const char* name, const util::HistogramSnapshot& histogram) {
+    auto ms = [](uint64_t ns) { return static_cast<double>(ns) / 1e6; };
+    std::cout << std::left << std::setw(11) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << ms(histogram.valueAt(0.5)) << std::setw(10) << ms(histogram.valueAt(0.9))
+              << std::setw(10) << ms(histogram.valueAt(0.99)) << std::setw(10) << ms(histogram.valueAt(0.999))
+              << std::setw(10) << ms(histogram.max) << std::setw(10) << histogram.mean() / 1e6 << std::endl;
+}
+
+} // namespace
+
+/**
+ * @brief Load tester replaying a query workload against the engine or a running server.
+ * 
+ * Targets:
+ * - local: in-process QueryHandler workers over the graph, as the server runs them
+ * - unix:PATH: a server's JSON-lines Unix socket
+ * - http:PORT: a server's HTTP port on 127.0.0.1
+ * 
+ * The workload is a query log (JSON requests or batch `source,destination[,mode]`
+ * lines) or a synthetic one clustered around cities (--synthetic N, which
+ * needs --graph). --requests replays the workload in a loop up to that count.
+ * 
+ * By default the test runs closed-loop: each of --concurrency clients sends
+ * its next request when the previous one is answered. With --rate, requests
+ * are scheduled open-loop at that fixed rate and each client takes the next
+ * scheduled one. Latency is then also measured from the scheduled start
+ * ("corrected"): when the target stalls, the requests that should have been
+ * sent meanwhile count their wait, instead of the stall hiding them
+ * (coordinated omission).
+ * 
+ * Usage: load_tester <local|unix:PATH|http:PORT> (--log FILE | --synthetic N) [--graph FILE]
+ *                    [--concurrency N] [--rate QPS] [--requests N] [--mode MODE] [--seed N]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <local|unix:PATH|http:PORT> (--log FILE | --synthetic N)"
+                  << " [--graph FILE] [--concurrency N] [--rate QPS] [--requests N] [--mode MODE] [--seed N]"
+                  << std::endl;
+        return 1;
+    }
+    
+    const std::string target = argv[1];
+    std::string logPath;
+    std::string graphPath;
+    size_t syntheticCount = 0;
+    size_t requestCount = 0;
+    unsigned concurrency = 0;
+    double rate = 0.0;
+    std::string mode = "distance";
+    uint64_t seed = 42;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string option = argv[i];
+        const char* value = argv[i + 1];
+        if (option == "--log") {
+            logPath = value;
+        } else if (option == "--synthetic") {
+            syntheticCount = std::strtoull(value, nullptr, 10);
+        } else if (option == "--graph") {
+            graphPath = value;
+        } else if (option == "--concurrency") {
+            concurrency = static_cast<unsigned>(std::atoi(value));
+        } else if (option == "--rate") {
+            rate = std::atof(value);
+        } else if (option == "--requests") {
+            requestCount = std::strtoull(value, nullptr, 10);
+        } else if (option == "--mode") {
+            mode = value;
+        } else if (option == "--seed") {
+            seed = std::strtoull(value, nullptr, 10);
+        } else {
+            std::cerr << "Invalid option: " << option << std::endl;
+            return 1;
+        }
+    }
+    OptimizationMode parsedMode;
+    if (!graph::PathFinder::parseMode(mode, parsedMode)) {
+        std::cerr << "Invalid mode: " << mode << std::endl;
+        return 1;
+    }
+    if (logPath.empty() == (syntheticCount == 0)) {
+        std::cerr << "Give either --log or --synthetic" << std::endl;
+        return 1;
+    }
+    const bool local = target == "local";
+    if ((local || syntheticCount > 0) && graphPath.empty()) {
+        std::cerr << "The local target and synthetic workloads need --graph" << std::endl;
+        return 1;
+    }
+    if (!local && target.rfind("unix:", 0) != 0 && target.rfind("http:", 0) != 0) {
+        std::cerr << "Invalid target: " << target << std::endl;
+        return 1;
+    }
+    // Open loop needs spare clients to keep to the schedule while some wait
+    concurrency = concurrency > 0 ? concurrency : rate > 0.0 ? 64 : util::resolveThreadCount(0);
+    
+    try {
+        graph::CompactGraph graph;
+        graph::ComponentIndex components;
+        if (!graphPath.empty()) {
+            graph = data::BinaryGraphHandler::mapBinaryGraph(graphPath);
+            if (local) {
+                components = graph::ComponentIndex::build(graph);
+            }
+        }
+        const std::vector<std::string> workload = syntheticCount > 0
+            ? syntheticWorkload(graph, syntheticCount, seed, mode)
+            : readQueryLog(logPath, mode);
+        if (workload.empty()) {
+            std::cerr << "Error: the workload is empty" << std::endl;
+            return 1;
+        }
+        requestCount = requestCount > 0 ? requestCount : workload.size();
+        
+        // Connect every client before the clock starts
+        std::vector<std::unique_ptr<Target>> clients;
+        std::vector<std::unique_ptr<ClientResult>> results;
+        for (unsigned client = 0; client < concurrency; ++client) {
+            if (local) {
+                clients.push_back(std::make_unique<LocalTarget>(graph, components));
+            } else if (target.rfind("unix:", 0) == 0) {
+                clients.push_back(std::make_unique<UnixTarget>(target.substr(5)));
+            } else {
+                clients.push_back(std::make_unique<HttpTarget>(static_cast<uint16_t>(std::atoi(target.c_str() + 5))));
+            }
+            results.push_back(std::make_unique<ClientResult>());
+        }
+        
+        std::atomic<size_t> next{0};
+        const auto interval = rate > 0.0 ? std::chrono::duration<double>(1.0 / rate) : std::chrono::duration<double>(0);
+        const Clock::time_point startTime = Clock::now();
+        util::parallelForEach(concurrency, concurrency, [&](size_t client, unsigned) {
+            Target& connection = *clients[client];
+            ClientResult& result = *results[client];
+            for (size_t request = next.fetch_add(1); request < requestCount; request = next.fetch_add(1)) {
+                Clock::time_point scheduled = startTime + std::chrono::duration_cast<Clock::duration>(
+                    interval * static_cast<double>(request));
+                if (rate > 0.0) {
+                    std::this_thread::sleep_until(scheduled);
+                }
+                Clock::time_point sent = Clock::now();
+                if (!connection.call(workload[request % workload.size()])) {
+                    result.errors.add();
+                }
+                Clock::time_point done = Clock::now();
+                result.service.record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(done - sent).count()));
+                if (rate > 0.0) {
+                    result.corrected.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(done - scheduled).count()));
+                }
+            }
+        });
+        const double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+        
+        util::HistogramSnapshot service;
+        util::HistogramSnapshot corrected;
+        uint64_t errors = 0;
+        for (const auto& result : results) {
+            service += result->service.snapshot();
+            corrected += result->corrected.snapshot();
+            errors += result->errors.get();
+        }
+        
+        std::cout << "Target " << target << ", " << concurrency << " clients, ";
+        if (rate > 0.0) {
+            std::cout << "open loop at " << rate << " requests/s" << std::endl;
+        } else {
+            std::cout << "closed loop" << std::endl;
+        }
+        std::cout << requestCount << " requests (" << errors << " errors) in " << std::fixed << std::setprecision(2)
+                  << seconds << " s: " << static_cast<double>(requestCount) / seconds << " requests/s" << std::endl;
+        std::cout << std::left << std::setw(11) << "latency ms" << std::right << std::setw(10) << "p50"
+                  << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+                  << std::setw(10) << "max" << std::setw(10) << "mean" << std::endl;
+        printLatencyRow("service", service);
+        if (rate > 0.0) {
+            printLatencyRow("corrected", corrected);
+            if (static_cast<double>(requestCount) / seconds < 0.95 * rate) {
+                std::cout << "The target fell behind the requested rate; see the corrected latencies" << std::endl;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data/BinaryGraphHandler.hpp"
+#include "graph/CompactGraph.hpp"
+#include "graph/CompactPathFinder.hpp"
+#include "graph/ComponentIndex.hpp"
+#include "graph/GraphPartition.hpp"
+#include "graph/OverlayGraph.hpp"
+#include "graph/OverlayPathFinder.hpp"
+#include "graph/PathFinder.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+using Index = graph::CompactGraph::Index;
+using OptimizationMode = graph::PathFinder::OptimizationMode;
+
+constexpr double TOLERANCE = 1e-9; ///< Relative difference allowed between path costs
+constexpr size_t MAX_REPORTED_FAILURES = 10;
+
+/**
+ * @brief What a search variant answered for one query.
+ */
+struct Answer {
+    bool found = false;
+    double cost = std::numeric_limits<double>::infinity(); ///< Path cost for the query's mode
+    bool hasPath = false;     ///< Whether the variant reports a path and totals
+    std::vector<Index> path;  ///< Node indices from source to destination
+    double totalDistance = 0.0;
+    double totalTime = 0.0;
+    double totalCost = 0.0;
+};
+
+/**
+ * @brief A way of answering a shortest path query, checked against the baseline.
+ * 
+ * Accelerated searches (bidirectional, goal-directed, hierarchical, cached)
+ * are added to the harness as one more Variant.
+ */
+struct Variant {
+    std::string name;
+    std::function<Answer(Index source, Index destination, OptimizationMode mode)> run;
+    double seconds = 0.0;
+    size_t failures = 0;
+};
+
+Answer fromResult(const graph::PathResult& result, std::vector<Index> path, OptimizationMode mode) {
+    Answer answer;
+    answer.found = result.isFound();
+    answer.hasPath = true;
+    answer.path = std::move(path);
+    answer.totalDistance = result.getTotalDistance();
+    answer.totalTime = result.getTotalTime();
+    answer.totalCost = result.getTotalCost();
+    if (answer.found) {
+        answer.cost = graph::PathFinder::combineWeights(answer.totalDistance, answer.totalTime, answer.totalCost, mode);
+    }
+    return answer;
+}
+
+bool nearlyEqual(double a, double b) {
+    return std::abs(a - b) <= TOLERANCE * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+}
+
+/**
+ * @brief Get the cost of a path for a mode, using the cheapest edge between consecutive nodes.
+ * @return Infinity if two consecutive nodes are not linked
+ */
+double pathCost(const graph::CompactGraph& graph, const std::vector<Index>& path, OptimizationMode mode) {
+    double total = 0.0;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        double cheapest = std::numeric_limits<double>::infinity();
+        for (auto edge = graph.getFirstEdge(path[i]); edge < graph.getLastEdge(path[i]); ++edge) {
+            if (graph.getTarget(edge) == path[i + 1]) {
+                cheapest = std::min(cheapest, graph::PathFinder::combineWeights(
+                    graph.getDistance(edge), graph.getTime(edge), graph.getCost(edge), mode));
+            }
+        }
+        total += cheapest;
+    }
+    return total;
+}
+
+/**
+ * @brief Check an answer against the baseline's cost.
+ * @return Empty if the answer is correct, otherwise what is wrong with it
+ */
+std::string check(const graph::CompactGraph& graph, const Answer& answer, bool found, double expectedCost,
+                  Index source, Index destination, OptimizationMode mode) {
+    if (answer.found != found) {
+        return answer.found ? "found a path where the baseline found none" : "found no path";
+    }
+    if (!found) {
+        return "";
+    }
+    std::ostringstream problem;
+    if (!nearlyEqual(answer.cost, expectedCost)) {
+        problem << "cost " << answer.cost << " instead of " << expectedCost;
+        return problem.str();
+    }
+    if (!answer.hasPath) {
+        return "";
+    }
+    if (answer.path.empty() || answer.path.front() != source || answer.path.back() != destination) {
+        return "path does not join the source to the destination";
+    }
+    double walked = pathCost(graph, answer.path, mode);
+    if (std::isinf(walked)) {
+        return "path uses a missing edge";
+    }
+    if (!nearlyEqual(walked, expectedCost)) {
+        problem << "path costs " << walked << " but the totals give " << answer.cost;
+        return problem.str();
+    }
+    return "";
+}
+
+} // namespace
+
+/**
+ * @brief Differential test and benchmark of the search variants.
+ * 
+ * Runs random queries in every optimization mode through the baseline
+ * PathFinder::findShortestPath (on the graph converted with toGraph()) and
+ * through each faster variant, and checks that every variant finds a path
+ * exactly when the baseline does, at the same cost, and that reported paths
+ * are real paths whose totals add up. Reports mean query time and speedup
+ * over the baseline per variant. Exits with 1 if any answer was wrong.
+ * 
+ * Graphs to test on come from tools/graph_generator or any importer.
+ * 
+ * Usage: search_oracle <graph.bin> [queries] [seed]
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <graph.bin> [queries] [seed]" << std::endl;
+        return 1;
+    }
+    const size_t queryCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    const uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42;
+    
+    try {
+        graph::CompactGraph compact = data::BinaryGraphHandler::mapBinaryGraph(argv[1]);
+        if (compact.getNodeCount() == 0) {
+            std::cerr << "Error: the graph has no nodes" << std::endl;
+            return 1;
+        }
+        graph::Graph pointerGraph = compact.toGraph();
+        std::cout << "Graph: " << compact.getNodeCount() << " nodes, " << compact.getEdgeCount() << " edges, "
+                  << queryCount << " queries per mode" << std::endl;
+        
+        graph::PathFinder baseline(pointerGraph);
+        graph::CompactPathFinder compactFinder(compact);
+        graph::CompactPathFinder prunedFinder(compact);
+        prunedFinder.setComponentIndex(graph::ComponentIndex::build(compact));
+        
+        std::vector<Variant> variants;
+        variants.push_back({"compact", [&](Index source, Index destination, OptimizationMode mode) {
+            std::vector<Index> path;
+            graph::PathResult result = compactFinder.findShortestPath(source, destination, mode, path);
+            return fromResult(result, std::move(path), mode);
+        }});
+        variants.push_back({"compact+components", [&](Index source, Index destination, OptimizationMode mode) {
+            std::vector<Index> path;
+            graph::PathResult result = prunedFinder.findShortestPath(source, destination, mode, path);
+            return fromResult(result, std::move(path), mode);
+        }});
+        variants.push_back({"findCosts", [&](Index source, Index destination, OptimizationMode mode) {
+            Answer answer;
+            answer.cost = prunedFinder.findCosts(source, {destination}, mode)[0];
+            answer.found = !std::isinf(answer.cost);
+            return answer;
+        }});
+        variants.push_back({"findShortestPaths", [&](Index source, Index destination, OptimizationMode mode) {
+            Answer answer;
+            answer.cost = compactFinder.findShortestPaths(source, mode)[destination];
+            answer.found = !std::isinf(answer.cost);
+            return answer;
+        }});
+        
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<Index> pick(0, static_cast<Index>(compact.getNodeCount() - 1));
+        const OptimizationMode modes[] = {OptimizationMode::DISTANCE, OptimizationMode::TIME,
+                                          OptimizationMode::COST, OptimizationMode::BALANCED};
+        
+        // Multilevel overlay: one partition, customized for each mode
+        auto preprocessingStart = std::chrono::steady_clock::now();
+        graph::GraphPartition partition = graph::GraphPartition::build(compact);
+        std::vector<std::unique_ptr<graph::OverlayGraph>> overlays;
+        std::vector<std::unique_ptr<graph::OverlayPathFinder>> overlayFinders;
+        for (OptimizationMode mode : modes) {
+            overlays.push_back(std::make_unique<graph::OverlayGraph>(compact, partition, mode));
+            overlayFinders.push_back(std::make_unique<graph::OverlayPathFinder>(*overlays.back()));
+        }
+        std::cout << "Overlay: " << partition.getLevelCount() << " levels, partitioned and customized in "
+                  << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - preprocessingStart).count()
+                  << " s" << std::endl;
+        variants.push_back({"overlay", [&](Index source, Index destination, OptimizationMode mode) {
+            std::vector<Index> path;
+            graph::PathResult result =
+                overlayFinders[static_cast<size_t>(mode)]->findShortestPath(source, destination, path);
+            return fromResult(result, std::move(path), mode);
+        }});
+        double baselineSeconds = 0.0;
+        size_t baselineFailures = 0;
+        size_t reported = 0;
+        size_t foundCount = 0;
+        auto report = [&](const std::string& name, OptimizationMode mode, Index source, Index destination,
+                          const std::string& problem) {
+            if (reported++ < MAX_REPORTED_FAILURES) {
+                std::cout << "FAIL " << name << " " << graph::PathFinder::modeName(mode) << " "
+                          << compact.getNodeId(source) << " -> " << compact.getNodeId(destination) << ": "
+                          << problem << std::endl;
+            }
+        };
+        
+        for (OptimizationMode mode : modes) {
+            for (size_t query = 0; query < queryCount; ++query) {
+                const Index source = pick(random);
+                const Index destination = pick(random);
+                
+                auto startTime = std::chrono::steady_clock::now();
+                graph::PathResult result = baseline.findShortestPath(std::string(compact.getNodeId(source)),
+                                                                     std::string(compact.getNodeId(destination)),
+                                                                     mode);
+                baselineSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                
+                std::vector<Index> path;
+                for (const auto& nodeId : result.getPath()) {
+                    path.push_back(compact.findNode(nodeId));
+                }
+                Answer expected = fromResult(result, std::move(path), mode);
+                // The baseline's own path, walked edge by edge, is the reference cost
+                const double expectedCost = expected.found ? pathCost(compact, expected.path, mode) : 0.0;
+                foundCount += expected.found;
+                std::string problem = check(compact, expected, expected.found, expectedCost, source, destination,
+                                            mode);
+                if (!problem.empty()) {
+                    ++baselineFailures;
+                    report("baseline", mode, source, destination, problem);
+                }
+                
+                for (Variant& variant : variants) {
+                    startTime = std::chrono::steady_clock::now();
+                    Answer answer = variant.run(source, destination, mode);
+                    variant.seconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - startTime).count();
+                    problem = check(compact, answer, expected.found, expectedCost, source, destination, mode);
+                    if (!problem.empty()) {
+                        ++variant.failures;
+                        report(variant.name, mode, source, destination, problem);
+                    }
+                }
+            }
+        }
+        
+        const size_t totalQueries = queryCount * std::size(modes);
+        std::cout << foundCount << " of " << totalQueries << " queries have a path" << std::endl;
+        std::cout << std::left << std::setw(22) << "variant" << std::right << std::setw(14) << "mean (us)"
+                  << std::setw(10) << "speedup" << std::setw(10) << "failures" << std::endl;
+        auto printRow = [&](const std::string& name, double seconds, size_t failures) {
+            std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(14) << seconds * 1e6 / static_cast<double>(std::max<size_t>(totalQueries, 1))
+                      << std::setw(9) << std::setprecision(2) << baselineSeconds / std::max(seconds, 1e-12) << "x"
+                      << std::setw(10) << failures << std::endl;
+        };
+        printRow("baseline", baselineSeconds, baselineFailures);
+        size_t failures = baselineFailures;
+        for (const Variant& variant : variants) {
+            printRow(variant.name, variant.seconds, variant.failures);
+            failures += variant.failures;
+        }
+        
+        if (failures > 0) {
+            std::cout << failures << " wrong answers" << std::endl;
+            return 1;
+        }
+        std::cout << "All variants agree with the baseline" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
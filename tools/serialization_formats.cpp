@@ -0,0 +1,181 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "graph/Graph.hpp"
+#include "graph/PathFinder.hpp"
+#include "travel/Transport.hpp"
+#include "data/JsonHandler.hpp"
+
+using namespace dijkstra;
+
+namespace {
+
+/**
+ * @brief A sample document together with the conversion it must survive.
+ */
+struct Document {
+    std::string name;
+    nlohmann::json json;
+    std::function<nlohmann::json(const nlohmann::json&)> roundTrip; ///< json -> object -> json
+};
+
+graph::PathResult makePathResult(int gridSize) {
+    graph::Graph graph;
+    auto nodeId = [](int row, int col) {
+        return "grid_" + std::to_string(row) + "_" + std::to_string(col);
+    };
+    
+    for (int row = 0; row < gridSize; ++row) {
+        for (int col = 0; col < gridSize; ++col) {
+            graph.addNode(std::make_shared<graph::Node>(nodeId(row, col), "Stop " + nodeId(row, col)));
+        }
+    }
+    for (int row = 0; row < gridSize; ++row) {
+        for (int col = 0; col < gridSize; ++col) {
+            auto from = graph.getNode(nodeId(row, col));
+            if (col + 1 < gridSize) {
+                auto edge = std::make_shared<graph::Edge>(nodeId(row, col) + "_e", from,
+                                                          graph.getNode(nodeId(row, col + 1)), 1.0 + (row % 7) * 0.13);
+                edge->setTimeWeight(0.25 + col * 0.01);
+                edge->setCostWeight(2.5);
+                graph.addEdge(edge);
+            }
+            if (row + 1 < gridSize) {
+                auto edge = std::make_shared<graph::Edge>(nodeId(row, col) + "_s", from,
+                                                          graph.getNode(nodeId(row + 1, col)), 1.0 + (col % 5) * 0.17);
+                edge->setTimeWeight(0.3);
+                edge->setCostWeight(1.75 + row * 0.02);
+                graph.addEdge(edge);
+            }
+        }
+    }
+    
+    graph::PathFinder pathFinder(graph);
+    return pathFinder.findShortestPath(nodeId(0, 0), nodeId(gridSize - 1, gridSize - 1));
+}
+
+travel::TravelRoute makeRoute(const std::string& routeId, int segments) {
+    travel::TravelRoute route(routeId);
+    route.setDescription("Synthetic route with " + std::to_string(segments) + " segments");
+    for (int i = 0; i < segments; ++i) {
+        auto segment = std::make_shared<travel::RouteSegment>(
+            "Stop " + std::to_string(i), "Stop " + std::to_string(i + 1),
+            geo::GeoCoordinate(40.0 + i * 0.013, -74.0 + i * 0.021),
+            geo::GeoCoordinate(40.0 + (i + 1) * 0.013, -74.0 + (i + 1) * 0.021),
+            travel::TransportFactory::createTransport(static_cast<travel::TransportMode>(i % 8)));
+        segment->setNotes(i % 3 == 0 ? "Transfer required" : "");
+        route.addSegment(segment);
+    }
+    return route;
+}
+
+travel::Itinerary makeItinerary(int items) {
+    travel::Itinerary itinerary("Synthetic itinerary");
+    itinerary.setDescription("Generated for the serialization benchmark");
+    for (int i = 0; i < items; ++i) {
+        auto item = std::make_shared<travel::ItineraryItem>(
+            static_cast<travel::ItineraryItem::ItemType>(i % 5), "Item " + std::to_string(i), "Details");
+        item->setLocation("Location " + std::to_string(i % 17));
+        item->setDuration(0.5 + (i % 4) * 0.75);
+        item->setCost(i * 3.2);
+        itinerary.addItem(item);
+    }
+    itinerary.addRoute(std::make_shared<travel::TravelRoute>(makeRoute("outbound", items / 2 + 1)));
+    itinerary.addRoute(std::make_shared<travel::TravelRoute>(makeRoute("return", items / 2 + 1)));
+    return itinerary;
+}
+
+template <typename Function>
+double averageMicroseconds(int iterations, Function&& function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+} // namespace
+
+/**
+ * @brief Compares JSON, CBOR and MessagePack encodings of query results.
+ * 
+ * For a path result, a route and an itinerary, reports the encoded size and
+ * encode/decode time in each format, and checks that decoding and converting
+ * back to the domain object reproduces the original document exactly.
+ * Exits with a non-zero status if any round trip fails.
+ * 
+ * Usage: serialization_formats [size] [iterations]
+ */
+int main(int argc, char* argv[]) {
+    int size = (argc > 1) ? std::max(2, std::atoi(argv[1])) : 40;
+    int iterations = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 200;
+    
+    std::vector<Document> documents = {
+        {"path_result", data::JsonHandler::pathResultToJson(makePathResult(size)),
+         [](const nlohmann::json& json) {
+             return data::JsonHandler::pathResultToJson(data::JsonHandler::jsonToPathResult(json));
+         }},
+        {"route", data::JsonHandler::routeToJson(makeRoute("route", size)),
+         [](const nlohmann::json& json) {
+             return data::JsonHandler::routeToJson(data::JsonHandler::jsonToRoute(json));
+         }},
+        {"itinerary", data::JsonHandler::itineraryToJson(makeItinerary(size)),
+         [](const nlohmann::json& json) {
+             return data::JsonHandler::itineraryToJson(data::JsonHandler::jsonToItinerary(json));
+         }},
+    };
+    const data::JsonHandler::Format formats[] = {
+        data::JsonHandler::Format::JSON_PRETTY,
+        data::JsonHandler::Format::JSON_COMPACT,
+        data::JsonHandler::Format::CBOR,
+        data::JsonHandler::Format::MESSAGEPACK,
+    };
+    
+    bool allPassed = true;
+    std::cout << std::left << std::setw(13) << "document" << std::setw(14) << "format"
+              << std::setw(10) << "bytes" << std::setw(10) << "ratio"
+              << std::setw(13) << "encode us" << std::setw(13) << "decode us" << "round trip" << std::endl;
+    
+    for (const auto& document : documents) {
+        size_t prettySize = 0;
+        for (auto format : formats) {
+            auto bytes = data::JsonHandler::encode(document.json, format);
+            if (format == data::JsonHandler::Format::JSON_PRETTY) {
+                prettySize = bytes.size();
+            }
+            
+            bool passed = false;
+            try {
+                auto decoded = data::JsonHandler::decode(bytes, format);
+                passed = (decoded == document.json) && (document.roundTrip(decoded) == document.json);
+            } catch (const std::exception& e) {
+                std::cerr << document.name << " " << data::JsonHandler::formatToString(format)
+                          << ": " << e.what() << std::endl;
+            }
+            allPassed = allPassed && passed;
+            
+            double encodeTime = averageMicroseconds(iterations, [&]() {
+                data::JsonHandler::encode(document.json, format);
+            });
+            double decodeTime = averageMicroseconds(iterations, [&]() {
+                data::JsonHandler::decode(bytes, format);
+            });
+            
+            std::cout << std::fixed << std::setprecision(2) << std::left
+                      << std::setw(13) << document.name
+                      << std::setw(14) << data::JsonHandler::formatToString(format)
+                      << std::setw(10) << bytes.size()
+                      << std::setw(10) << static_cast<double>(bytes.size()) / prettySize
+                      << std::setw(13) << encodeTime << std::setw(13) << decodeTime
+                      << (passed ? "ok" : "FAILED") << std::endl;
+        }
+    }
+    
+    return allPassed ? 0 : 1;
+}